@@ -0,0 +1,181 @@
+#include "EOSAccountIdTable.h"
+
+#include "Engine/Core/Log.h"
+#include "Engine/Core/Collections/Dictionary.h"
+#include "Engine/Platform/CriticalSection.h"
+#include "Engine/Threading/Threading.h"
+#include "Engine/Utilities/StringConverter.h"
+#include <EOSSDK/Include/eos_sdk.h>
+
+namespace
+{
+    struct IdEntry
+    {
+        Guid Id;
+        StringAnsi Text;
+    };
+
+    CriticalSection Locker;
+    Dictionary<EOS_EpicAccountId, IdEntry> EpicAccountIds;
+    Dictionary<EOS_ProductUserId, IdEntry> ProductUserIds;
+    Dictionary<Guid, EOS_EpicAccountId> EpicAccountIdsReverse;
+    Dictionary<Guid, EOS_ProductUserId> ProductUserIdsReverse;
+
+    bool ParseId(const char* text, int32 length, Guid& id)
+    {
+        // EOS ids are 32 hex characters, the same as the Guid without separators
+        if (Guid::Parse(StringAnsiView(text, length), id))
+        {
+            LOG(Warning, "EOS account id '{0}' is not a valid Guid", String(text, length));
+            return true;
+        }
+        return false;
+    }
+
+    StringAnsi FormatId(const Guid& id)
+    {
+        const String text = id.ToString(Guid::FormatType::N);
+        const StringAsANSI<> textAnsi(text.Get(), text.Length());
+        return StringAnsi(textAnsi.Get());
+    }
+
+    // Finds or interns the entry of the id, the caller holds the Locker
+    IdEntry* GetEntry(EOS_EpicAccountId accountId)
+    {
+        IdEntry* entry = EpicAccountIds.TryGet(accountId);
+        if (entry)
+            return entry;
+
+        char text[EOS_EPICACCOUNTID_MAX_LENGTH + 1];
+        int32 length = ARRAY_COUNT(text);
+        const EOS_EResult result = EOS_EpicAccountId_ToString(accountId, text, &length);
+        if (result != EOS_EResult::EOS_Success)
+        {
+            LOG(Error, "EOS failed to convert EpicAccountId to string: {0}", String(EOS_EResult_ToString(result)));
+            return nullptr;
+        }
+        IdEntry newEntry;
+        if (ParseId(text, length - 1, newEntry.Id))
+            return nullptr;
+        newEntry.Text.Set(text, length - 1);
+        EpicAccountIdsReverse[newEntry.Id] = accountId;
+        entry = &EpicAccountIds[accountId];
+        *entry = MoveTemp(newEntry);
+        return entry;
+    }
+
+    IdEntry* GetEntry(EOS_ProductUserId userId)
+    {
+        IdEntry* entry = ProductUserIds.TryGet(userId);
+        if (entry)
+            return entry;
+
+        char text[EOS_PRODUCTUSERID_MAX_LENGTH + 1];
+        int32 length = ARRAY_COUNT(text);
+        const EOS_EResult result = EOS_ProductUserId_ToString(userId, text, &length);
+        if (result != EOS_EResult::EOS_Success)
+        {
+            LOG(Error, "EOS failed to convert ProductUserId to string: {0}", String(EOS_EResult_ToString(result)));
+            return nullptr;
+        }
+        IdEntry newEntry;
+        if (ParseId(text, length - 1, newEntry.Id))
+            return nullptr;
+        newEntry.Text.Set(text, length - 1);
+        ProductUserIdsReverse[newEntry.Id] = userId;
+        entry = &ProductUserIds[userId];
+        *entry = MoveTemp(newEntry);
+        return entry;
+    }
+}
+
+Guid EOSAccountIdTable::GetId(EOS_EpicAccountId accountId)
+{
+    if (!accountId)
+        return Guid::Empty;
+    ScopeLock lock(Locker);
+    const IdEntry* entry = GetEntry(accountId);
+    return entry ? entry->Id : Guid::Empty;
+}
+
+Guid EOSAccountIdTable::GetId(EOS_ProductUserId userId)
+{
+    if (!userId)
+        return Guid::Empty;
+    ScopeLock lock(Locker);
+    const IdEntry* entry = GetEntry(userId);
+    return entry ? entry->Id : Guid::Empty;
+}
+
+EOS_EpicAccountId EOSAccountIdTable::GetEpicAccountId(const Guid& id)
+{
+    if (!id.IsValid())
+        return nullptr;
+    ScopeLock lock(Locker);
+    EOS_EpicAccountId accountId;
+    if (EpicAccountIdsReverse.TryGet(id, accountId))
+        return accountId;
+
+    IdEntry newEntry;
+    newEntry.Id = id;
+    newEntry.Text = FormatId(id);
+    accountId = EOS_EpicAccountId_FromString(newEntry.Text.Get());
+    if (!accountId)
+        return nullptr;
+    EpicAccountIds[accountId] = newEntry;
+    EpicAccountIdsReverse.Add(id, accountId);
+    return accountId;
+}
+
+EOS_ProductUserId EOSAccountIdTable::GetProductUserId(const Guid& id)
+{
+    if (!id.IsValid())
+        return nullptr;
+    ScopeLock lock(Locker);
+    EOS_ProductUserId userId;
+    if (ProductUserIdsReverse.TryGet(id, userId))
+        return userId;
+
+    IdEntry newEntry;
+    newEntry.Id = id;
+    newEntry.Text = FormatId(id);
+    userId = EOS_ProductUserId_FromString(newEntry.Text.Get());
+    if (!userId)
+        return nullptr;
+    ProductUserIds[userId] = newEntry;
+    ProductUserIdsReverse.Add(id, userId);
+    return userId;
+}
+
+StringAnsi EOSAccountIdTable::ToString(EOS_EpicAccountId accountId)
+{
+    if (!accountId)
+        return StringAnsi::Empty;
+    ScopeLock lock(Locker);
+    const IdEntry* entry = GetEntry(accountId);
+    return entry ? entry->Text : StringAnsi::Empty;
+}
+
+StringAnsi EOSAccountIdTable::ToString(EOS_ProductUserId userId)
+{
+    if (!userId)
+        return StringAnsi::Empty;
+    ScopeLock lock(Locker);
+    const IdEntry* entry = GetEntry(userId);
+    return entry ? entry->Text : StringAnsi::Empty;
+}
+
+int32 EOSAccountIdTable::Count()
+{
+    ScopeLock lock(Locker);
+    return EpicAccountIds.Count() + ProductUserIds.Count();
+}
+
+void EOSAccountIdTable::Clear()
+{
+    ScopeLock lock(Locker);
+    EpicAccountIds.Clear();
+    ProductUserIds.Clear();
+    EpicAccountIdsReverse.Clear();
+    ProductUserIdsReverse.Clear();
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Engine/Core/Types/Guid.h"
+#include "Engine/Core/Types/String.h"
+#include "EOSSDK/Include/eos_common.h"
+
+///<summary>
+/// Process-wide table of the interned EOS account ids. Maps the EOS_EpicAccountId and EOS_ProductUserId handles to the Guids used by the online API (eg. OnlineUser.Id) and back.
+/// Every id gets converted only once, when it is seen for the first time. Thread-safe.
+///</summary>
+class ONLINEPLATFORMEOS_API EOSAccountIdTable
+{
+public:
+    /// <summary>
+    /// Gets the Guid of the Epic account. Returns empty Guid for the invalid account id.
+    /// </summary>
+    static Guid GetId(EOS_EpicAccountId accountId);
+
+    /// <summary>
+    /// Gets the Guid of the product user. Returns empty Guid for the invalid product user id.
+    /// </summary>
+    static Guid GetId(EOS_ProductUserId userId);
+
+    /// <summary>
+    /// Gets the Epic account handle of the Guid. Returns null if the Guid is empty.
+    /// </summary>
+    static EOS_EpicAccountId GetEpicAccountId(const Guid& id);
+
+    /// <summary>
+    /// Gets the product user handle of the Guid. Returns null if the Guid is empty.
+    /// </summary>
+    static EOS_ProductUserId GetProductUserId(const Guid& id);
+
+    /// <summary>
+    /// Gets the EOS string form of the Epic account id.
+    /// </summary>
+    static StringAnsi ToString(EOS_EpicAccountId accountId);
+
+    /// <summary>
+    /// Gets the EOS string form of the product user id.
+    /// </summary>
+    static StringAnsi ToString(EOS_ProductUserId userId);
+
+    /// <summary>
+    /// Gets the amount of the interned ids.
+    /// </summary>
+    static int32 Count();
+
+    /// <summary>
+    /// Removes all the interned ids (eg. after the SDK shutdown when the handles are no longer valid).
+    /// </summary>
+    static void Clear();
+};
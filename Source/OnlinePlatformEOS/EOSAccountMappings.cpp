@@ -0,0 +1,304 @@
+#include "EOSAccountMappings.h"
+#include "EOSPlatformContext.h"
+
+#include "Engine/Core/Log.h"
+#include "Engine/Core/Math/Math.h"
+#include "Engine/Platform/Platform.h"
+#include "Engine/Threading/Threading.h"
+#include <EOSSDK/Include/eos_sdk.h>
+
+#include "EOSSDK/Include/eos_connect.h"
+
+struct EOSAccountMappings::Request
+{
+    EOSAccountMappings* Owner;
+    bool Canceled = false;
+    EOS_EExternalAccountType AccountType = EOS_EExternalAccountType::EOS_EAT_EPIC;
+    Array<EOS_ProductUserId> ProductUserIds;
+    Array<StringAnsi> ExternalAccountIds;
+};
+
+namespace
+{
+    // The SDK accepts up to this many ids in a single mapping query (the same limit applies to the product user id query)
+    constexpr int32 MaxBatchSize = EOS_CONNECT_QUERYEXTERNALACCOUNTMAPPINGS_MAX_ACCOUNT_IDS;
+
+    StringAnsi GetExternalKey(const StringAnsiView& externalAccountId, EOS_EExternalAccountType accountType)
+    {
+        return StringAnsi::Format("{0}:{1}", (int32)accountType, externalAccountId);
+    }
+}
+
+EOSAccountMappings::EOSAccountMappings(EOSPlatformContext* context)
+    : _context(context)
+{
+    _context->Ticking.Bind<EOSAccountMappings, &EOSAccountMappings::Flush>(this);
+}
+
+EOSAccountMappings::~EOSAccountMappings()
+{
+    _context->Ticking.Unbind<EOSAccountMappings, &EOSAccountMappings::Flush>(this);
+    Clear();
+    _requests.ClearDelete();
+}
+
+bool EOSAccountMappings::TryGet(EOS_ProductUserId productUserId, EOSProductUserMapping& result)
+{
+    ScopeLock lock(_locker);
+    const EOSProductUserMapping* entry = _users.TryGet(productUserId);
+    if (!entry || !IsValid(entry->FetchTime, Platform::GetTimeSeconds()))
+        return false;
+    result = *entry;
+    return true;
+}
+
+void EOSAccountMappings::Resolve(EOS_ProductUserId productUserId, const ProductUserCallback& callback)
+{
+    EOSProductUserMapping result;
+    if (!productUserId)
+    {
+        callback(nullptr);
+        return;
+    }
+    if (TryGet(productUserId, result))
+    {
+        callback(&result);
+        return;
+    }
+    ScopeLock lock(_locker);
+    auto& waiters = _userWaiters[productUserId];
+    if (waiters.IsEmpty())
+        _queuedUsers.Add(productUserId);
+    waiters.Add(callback);
+}
+
+bool EOSAccountMappings::TryGetProductUserId(const StringAnsiView& externalAccountId, EOS_EExternalAccountType accountType, EOS_ProductUserId& result)
+{
+    const StringAnsi key = GetExternalKey(externalAccountId, accountType);
+    ScopeLock lock(_locker);
+    const ExternalEntry* entry = _externalAccounts.TryGet(key);
+    if (!entry || !IsValid(entry->FetchTime, Platform::GetTimeSeconds()))
+        return false;
+    result = entry->ProductUserId;
+    return true;
+}
+
+void EOSAccountMappings::ResolveProductUserId(const StringAnsiView& externalAccountId, EOS_EExternalAccountType accountType, const ExternalAccountCallback& callback)
+{
+    EOS_ProductUserId result;
+    if (TryGetProductUserId(externalAccountId, accountType, result))
+    {
+        callback(result);
+        return;
+    }
+    const StringAnsi key = GetExternalKey(externalAccountId, accountType);
+    ScopeLock lock(_locker);
+    auto& waiters = _externalWaiters[key];
+    if (waiters.IsEmpty())
+        _queuedExternalAccounts[(int32)accountType].Add(StringAnsi(externalAccountId));
+    waiters.Add(callback);
+}
+
+void EOSAccountMappings::Invalidate(EOS_ProductUserId productUserId)
+{
+    ScopeLock lock(_locker);
+    _users.Remove(productUserId);
+}
+
+void EOSAccountMappings::Clear()
+{
+    ScopeLock lock(_locker);
+    _users.Clear();
+    _externalAccounts.Clear();
+    _userWaiters.Clear();
+    _externalWaiters.Clear();
+    _queuedUsers.Clear();
+    _queuedExternalAccounts.Clear();
+
+    // Requests are owned by the SDK callbacks that may still be in-flight
+    for (auto request : _requests)
+        request->Canceled = true;
+}
+
+void EOSAccountMappings::Flush()
+{
+    Array<Request*, InlinedAllocation<8>> requests;
+    {
+        ScopeLock lock(_locker);
+        if (_queuedUsers.IsEmpty() && _queuedExternalAccounts.IsEmpty())
+            return;
+
+        // Split the queued lookups into the largest batches possible
+        for (int32 start = 0; start < _queuedUsers.Count(); start += MaxBatchSize)
+        {
+            auto request = New<Request>();
+            request->Owner = this;
+            request->ProductUserIds.Add(_queuedUsers.Get() + start, Math::Min(_queuedUsers.Count() - start, MaxBatchSize));
+            requests.Add(request);
+        }
+        for (auto& e : _queuedExternalAccounts)
+        {
+            const auto& ids = e.Value;
+            for (int32 start = 0; start < ids.Count(); start += MaxBatchSize)
+            {
+                auto request = New<Request>();
+                request->Owner = this;
+                request->AccountType = (EOS_EExternalAccountType)e.Key;
+                request->ExternalAccountIds.Add(ids.Get() + start, Math::Min(ids.Count() - start, MaxBatchSize));
+                requests.Add(request);
+            }
+        }
+        _queuedUsers.Clear();
+        _queuedExternalAccounts.Clear();
+        _requests.Add(requests.Get(), requests.Count());
+    }
+
+    const auto connect = _context->GetConnect();
+    for (auto request : requests)
+    {
+        if (!connect)
+        {
+            CompleteRequest(request, false);
+            continue;
+        }
+        if (request->ProductUserIds.HasItems())
+        {
+            EOS_Connect_QueryProductUserIdMappingsOptions options = {};
+            options.ApiVersion = EOS_CONNECT_QUERYPRODUCTUSERIDMAPPINGS_API_LATEST;
+            options.LocalUserId = _context->ProductUserId;
+            options.ProductUserIds = request->ProductUserIds.Get();
+            options.ProductUserIdCount = request->ProductUserIds.Count();
+            EOS_Connect_QueryProductUserIdMappings(connect, &options, request, &EOSAccountMappings::OnQueryProductUserIdMappingsComplete);
+        }
+        else
+        {
+            Array<const char*, InlinedAllocation<MaxBatchSize>> ids;
+            for (const auto& id : request->ExternalAccountIds)
+                ids.Add(id.Get());
+            EOS_Connect_QueryExternalAccountMappingsOptions options = {};
+            options.ApiVersion = EOS_CONNECT_QUERYEXTERNALACCOUNTMAPPINGS_API_LATEST;
+            options.LocalUserId = _context->ProductUserId;
+            options.AccountIdType = request->AccountType;
+            options.ExternalAccountIds = ids.Get();
+            options.ExternalAccountIdCount = ids.Count();
+            EOS_Connect_QueryExternalAccountMappings(connect, &options, request, &EOSAccountMappings::OnQueryExternalAccountMappingsComplete);
+        }
+    }
+}
+
+bool EOSAccountMappings::IsValid(double fetchTime, double now) const
+{
+    return now - fetchTime <= (double)TimeToLive;
+}
+
+void EOSAccountMappings::StoreUser(EOS_ProductUserId productUserId, double now)
+{
+    const auto connect = _context->GetConnect();
+    EOSProductUserMapping& entry = _users[productUserId];
+    entry = EOSProductUserMapping();
+    entry.ProductUserId = productUserId;
+    entry.FetchTime = now;
+
+    EOS_Connect_CopyProductUserInfoOptions infoOptions = {};
+    infoOptions.ApiVersion = EOS_CONNECT_COPYPRODUCTUSERINFO_API_LATEST;
+    infoOptions.TargetUserId = productUserId;
+    EOS_Connect_ExternalAccountInfo* info;
+    if (EOS_Connect_CopyProductUserInfo(connect, &infoOptions, &info) == EOS_EResult::EOS_Success)
+    {
+        entry.AccountType = info->AccountIdType;
+        if (info->AccountId)
+            entry.AccountId = info->AccountId;
+        if (info->DisplayName)
+            entry.DisplayName = String(info->DisplayName);
+        EOS_Connect_ExternalAccountInfo_Release(info);
+    }
+
+    char epicAccountId[EOS_CONNECT_EXTERNAL_ACCOUNT_ID_MAX_LENGTH + 1];
+    int32 epicAccountIdLength = ARRAY_COUNT(epicAccountId);
+    EOS_Connect_GetProductUserIdMappingOptions mappingOptions = {};
+    mappingOptions.ApiVersion = EOS_CONNECT_GETPRODUCTUSERIDMAPPING_API_LATEST;
+    mappingOptions.LocalUserId = _context->ProductUserId;
+    mappingOptions.AccountIdType = EOS_EExternalAccountType::EOS_EAT_EPIC;
+    mappingOptions.TargetProductUserId = productUserId;
+    if (EOS_Connect_GetProductUserIdMapping(connect, &mappingOptions, epicAccountId, &epicAccountIdLength) == EOS_EResult::EOS_Success)
+        entry.EpicAccountId = EOS_EpicAccountId_FromString(epicAccountId);
+}
+
+void EOSAccountMappings::CompleteRequest(Request* request, bool success)
+{
+    Array<Function<void()>> calls;
+    {
+        ScopeLock lock(_locker);
+        _requests.Remove(request);
+        if (!request->Canceled)
+        {
+            const double now = Platform::GetTimeSeconds();
+            for (const EOS_ProductUserId productUserId : request->ProductUserIds)
+            {
+                const EOSProductUserMapping* result = nullptr;
+                if (success)
+                {
+                    StoreUser(productUserId, now);
+                    result = _users.TryGet(productUserId);
+                }
+                Array<ProductUserCallback> waiters;
+                if (_userWaiters.TryGet(productUserId, waiters))
+                {
+                    _userWaiters.Remove(productUserId);
+                    const EOSProductUserMapping mapping = result ? *result : EOSProductUserMapping();
+                    const bool found = result != nullptr;
+                    for (const auto& waiter : waiters)
+                        calls.Add([waiter, mapping, found] { waiter(found ? &mapping : nullptr); });
+                }
+            }
+            for (const StringAnsi& externalAccountId : request->ExternalAccountIds)
+            {
+                EOS_ProductUserId productUserId = nullptr;
+                if (success)
+                {
+                    EOS_Connect_GetExternalAccountMappingsOptions options = {};
+                    options.ApiVersion = EOS_CONNECT_GETEXTERNALACCOUNTMAPPING_API_LATEST;
+                    options.LocalUserId = _context->ProductUserId;
+                    options.AccountIdType = request->AccountType;
+                    options.TargetExternalUserId = externalAccountId.Get();
+                    productUserId = EOS_Connect_GetExternalAccountMapping(_context->GetConnect(), &options);
+                }
+                const StringAnsi key = GetExternalKey(externalAccountId, request->AccountType);
+                if (productUserId)
+                {
+                    ExternalEntry& entry = _externalAccounts[key];
+                    entry.ProductUserId = productUserId;
+                    entry.FetchTime = now;
+                }
+                Array<ExternalAccountCallback> waiters;
+                if (_externalWaiters.TryGet(key, waiters))
+                {
+                    _externalWaiters.Remove(key);
+                    for (const auto& waiter : waiters)
+                        calls.Add([waiter, productUserId] { waiter(productUserId); });
+                }
+            }
+        }
+    }
+    Delete(request);
+
+    // Callbacks run outside the lock so they can start other lookups
+    for (const auto& call : calls)
+        call();
+}
+
+void EOSAccountMappings::OnQueryProductUserIdMappingsComplete(const EOS_Connect_QueryProductUserIdMappingsCallbackInfo* data)
+{
+    const auto request = (Request*)data->ClientData;
+    if (data->ResultCode != EOS_EResult::EOS_Success)
+        LOG(Warning, "EOS failed to query product user id mappings: {0}", String(EOS_EResult_ToString(data->ResultCode)));
+    request->Owner->CompleteRequest(request, data->ResultCode == EOS_EResult::EOS_Success);
+}
+
+void EOSAccountMappings::OnQueryExternalAccountMappingsComplete(const EOS_Connect_QueryExternalAccountMappingsCallbackInfo* data)
+{
+    const auto request = (Request*)data->ClientData;
+    if (data->ResultCode != EOS_EResult::EOS_Success)
+        LOG(Warning, "EOS failed to query external account mappings: {0}", String(EOS_EResult_ToString(data->ResultCode)));
+    request->Owner->CompleteRequest(request, data->ResultCode == EOS_EResult::EOS_Success);
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "Engine/Core/Collections/Array.h"
+#include "Engine/Core/Collections/Dictionary.h"
+#include "Engine/Core/Delegate.h"
+#include "Engine/Core/Types/String.h"
+#include "Engine/Platform/CriticalSection.h"
+#include "EOSSDK/Include/eos_connect_types.h"
+
+class EOSPlatformContext;
+
+///<summary>
+/// The cached identity of the product user (the accounts linked to it).
+///</summary>
+struct EOSProductUserMapping
+{
+    EOS_ProductUserId ProductUserId = nullptr;
+
+    /// <summary>
+    /// The linked Epic account (null if the user has no Epic account linked).
+    /// </summary>
+    EOS_EpicAccountId EpicAccountId = nullptr;
+
+    /// <summary>
+    /// The type of the external account the user logged in with most recently.
+    /// </summary>
+    EOS_EExternalAccountType AccountType = EOS_EExternalAccountType::EOS_EAT_EPIC;
+
+    /// <summary>
+    /// The id of the external account the user logged in with most recently. Can be empty if the account belongs to different account system than the local user.
+    /// </summary>
+    StringAnsi AccountId;
+
+    String DisplayName;
+    double FetchTime = 0.0;
+};
+
+///<summary>
+/// Resolves the identities of the product users (eg. from sessions, lobbies or P2P connections) and the product users of the external accounts.
+/// Lookups are accumulated and issued in the largest batches allowed by the SDK on the next platform tick. Results are cached with the time-to-live, cache hits are returned synchronously.
+///</summary>
+class ONLINEPLATFORMEOS_API EOSAccountMappings
+{
+public:
+    typedef Function<void(const EOSProductUserMapping*)> ProductUserCallback;
+    typedef Function<void(EOS_ProductUserId)> ExternalAccountCallback;
+
+private:
+    struct Request;
+    struct ExternalEntry
+    {
+        EOS_ProductUserId ProductUserId;
+        double FetchTime;
+    };
+
+    EOSPlatformContext* _context;
+    CriticalSection _locker;
+    Dictionary<EOS_ProductUserId, EOSProductUserMapping> _users;
+    Dictionary<StringAnsi, ExternalEntry> _externalAccounts;
+    Dictionary<EOS_ProductUserId, Array<ProductUserCallback>> _userWaiters;
+    Dictionary<StringAnsi, Array<ExternalAccountCallback>> _externalWaiters;
+    Array<EOS_ProductUserId> _queuedUsers;
+    Dictionary<int32, Array<StringAnsi>> _queuedExternalAccounts;
+    Array<Request*> _requests;
+
+public:
+    EOSAccountMappings(EOSPlatformContext* context);
+    ~EOSAccountMappings();
+
+    /// <summary>
+    /// The time (in seconds) after which the cached mappings are queried again.
+    /// </summary>
+    float TimeToLive = 600.0f;
+
+public:
+    /// <summary>
+    /// Gets the cached identity of the product user. Doesn't query the missing or expired user.
+    /// </summary>
+    /// <returns>True if the user is cached, otherwise false.</returns>
+    bool TryGet(EOS_ProductUserId productUserId, EOSProductUserMapping& result);
+
+    /// <summary>
+    /// Resolves the identity of the product user. The callback is called immediately on the cache hit, otherwise the user gets queued for the next batch. Gets null if failed.
+    /// </summary>
+    void Resolve(EOS_ProductUserId productUserId, const ProductUserCallback& callback);
+
+    /// <summary>
+    /// Gets the cached product user of the external account. Doesn't query the missing or expired account.
+    /// </summary>
+    /// <returns>True if the account is cached, otherwise false.</returns>
+    bool TryGetProductUserId(const StringAnsiView& externalAccountId, EOS_EExternalAccountType accountType, EOS_ProductUserId& result);
+
+    /// <summary>
+    /// Resolves the product user of the external account. The callback is called immediately on the cache hit, otherwise the account gets queued for the next batch. Gets null if failed.
+    /// </summary>
+    void ResolveProductUserId(const StringAnsiView& externalAccountId, EOS_EExternalAccountType accountType, const ExternalAccountCallback& callback);
+
+    /// <summary>
+    /// Removes the product user from the cache so it gets queried again on the next lookup.
+    /// </summary>
+    void Invalidate(EOS_ProductUserId productUserId);
+
+    /// <summary>
+    /// Removes all the cached mappings and cancels the pending lookups (without calling their callbacks).
+    /// </summary>
+    void Clear();
+
+    /// <summary>
+    /// Issues the queued lookups. Called on every platform tick.
+    /// </summary>
+    void Flush();
+
+private:
+    bool IsValid(double fetchTime, double now) const;
+    void StoreUser(EOS_ProductUserId productUserId, double now);
+    void CompleteRequest(Request* request, bool success);
+
+    static void EOS_CALL OnQueryProductUserIdMappingsComplete(const EOS_Connect_QueryProductUserIdMappingsCallbackInfo* data);
+    static void EOS_CALL OnQueryExternalAccountMappingsComplete(const EOS_Connect_QueryExternalAccountMappingsCallbackInfo* data);
+};
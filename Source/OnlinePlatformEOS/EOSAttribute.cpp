@@ -0,0 +1,17 @@
+#include "EOSAttribute.h"
+
+#include "Engine/Core/Log.h"
+#include <EOSSDK/Include/eos_sdk.h>
+
+bool EOSModification::CheckResult(EOS_EResult result, const char* what, const char* target)
+{
+    if (result == EOS_EResult::EOS_Success)
+        return false;
+    LOG(Warning, "EOS failed to {0} of the {1} modification: {2}", String(what), String(target), String(EOS_EResult_ToString(result)));
+    return true;
+}
+
+bool EOSModification::IsRetryable(EOS_EResult result)
+{
+    return result == EOS_EResult::EOS_TooManyRequests || result == EOS_EResult::EOS_TimedOut || result == EOS_EResult::EOS_NoConnection || result == EOS_EResult::EOS_ServiceFailure;
+}
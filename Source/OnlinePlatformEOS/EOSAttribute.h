@@ -0,0 +1,176 @@
+#pragma once
+
+#include "Engine/Core/Types/String.h"
+#include "EOSSDK/Include/eos_common.h"
+
+///<summary>
+/// The value of the session or the lobby attribute. Both interfaces use the same layout of the attribute data, they differ only in the data type and the visibility type.
+///</summary>
+template<typename DataType, typename VisibilityType, int32 DataApiVersion, VisibilityType PublicVisibility, VisibilityType PrivateVisibility>
+struct EOSAttribute
+{
+    EOS_EAttributeType Type = EOS_EAttributeType::EOS_AT_INT64;
+
+    /// <summary>
+    /// The advertisement type of the session attribute or the visibility of the lobby attribute.
+    /// </summary>
+    VisibilityType Visibility = PublicVisibility;
+
+    union
+    {
+        int64 AsInt64 = 0;
+        double AsDouble;
+        bool AsBool;
+    };
+
+    StringAnsi AsString;
+
+public:
+    static EOSAttribute FromInt64(int64 value, bool isPublic = true)
+    {
+        EOSAttribute result;
+        result.Type = EOS_EAttributeType::EOS_AT_INT64;
+        result.Visibility = isPublic ? PublicVisibility : PrivateVisibility;
+        result.AsInt64 = value;
+        return result;
+    }
+
+    static EOSAttribute FromDouble(double value, bool isPublic = true)
+    {
+        EOSAttribute result;
+        result.Type = EOS_EAttributeType::EOS_AT_DOUBLE;
+        result.Visibility = isPublic ? PublicVisibility : PrivateVisibility;
+        result.AsDouble = value;
+        return result;
+    }
+
+    static EOSAttribute FromBool(bool value, bool isPublic = true)
+    {
+        EOSAttribute result;
+        result.Type = EOS_EAttributeType::EOS_AT_BOOLEAN;
+        result.Visibility = isPublic ? PublicVisibility : PrivateVisibility;
+        result.AsBool = value;
+        return result;
+    }
+
+    static EOSAttribute FromString(const StringAnsiView& value, bool isPublic = true)
+    {
+        EOSAttribute result;
+        result.Type = EOS_EAttributeType::EOS_AT_STRING;
+        result.Visibility = isPublic ? PublicVisibility : PrivateVisibility;
+        result.AsString = value;
+        return result;
+    }
+
+    static EOSAttribute FromData(const DataType& data, VisibilityType visibility)
+    {
+        EOSAttribute result;
+        result.Type = data.ValueType;
+        result.Visibility = visibility;
+        switch (data.ValueType)
+        {
+        case EOS_EAttributeType::EOS_AT_BOOLEAN:
+            result.AsBool = data.Value.AsBool == EOS_TRUE;
+            break;
+        case EOS_EAttributeType::EOS_AT_INT64:
+            result.AsInt64 = data.Value.AsInt64;
+            break;
+        case EOS_EAttributeType::EOS_AT_DOUBLE:
+            result.AsDouble = data.Value.AsDouble;
+            break;
+        case EOS_EAttributeType::EOS_AT_STRING:
+            result.AsString = data.Value.AsUtf8;
+            break;
+        default:
+            break;
+        }
+        return result;
+    }
+
+    /// <summary>
+    /// Fills the SDK attribute data. The data references the string value, so the attribute has to outlive it.
+    /// </summary>
+    void ToData(const char* key, DataType& data) const
+    {
+        data.ApiVersion = DataApiVersion;
+        data.Key = key;
+        data.ValueType = Type;
+        switch (Type)
+        {
+        case EOS_EAttributeType::EOS_AT_BOOLEAN:
+            data.Value.AsBool = AsBool ? EOS_TRUE : EOS_FALSE;
+            break;
+        case EOS_EAttributeType::EOS_AT_INT64:
+            data.Value.AsInt64 = AsInt64;
+            break;
+        case EOS_EAttributeType::EOS_AT_DOUBLE:
+            data.Value.AsDouble = AsDouble;
+            break;
+        case EOS_EAttributeType::EOS_AT_STRING:
+            data.Value.AsUtf8 = AsString.GetText();
+            break;
+        default:
+            break;
+        }
+    }
+
+    /// <summary>
+    /// Gets the value as the number (strings are 0).
+    /// </summary>
+    double GetNumber() const
+    {
+        switch (Type)
+        {
+        case EOS_EAttributeType::EOS_AT_BOOLEAN:
+            return AsBool ? 1.0 : 0.0;
+        case EOS_EAttributeType::EOS_AT_INT64:
+            return (double)AsInt64;
+        case EOS_EAttributeType::EOS_AT_DOUBLE:
+            return AsDouble;
+        default:
+            return 0.0;
+        }
+    }
+
+    bool operator==(const EOSAttribute& other) const
+    {
+        if (Type != other.Type || Visibility != other.Visibility)
+            return false;
+        switch (Type)
+        {
+        case EOS_EAttributeType::EOS_AT_BOOLEAN:
+            return AsBool == other.AsBool;
+        case EOS_EAttributeType::EOS_AT_INT64:
+            return AsInt64 == other.AsInt64;
+        case EOS_EAttributeType::EOS_AT_DOUBLE:
+            return AsDouble == other.AsDouble;
+        case EOS_EAttributeType::EOS_AT_STRING:
+            return AsString == other.AsString;
+        default:
+            return false;
+        }
+    }
+
+    FORCE_INLINE bool operator!=(const EOSAttribute& other) const
+    {
+        return !operator==(other);
+    }
+};
+
+///<summary>
+/// The helpers shared by the session and the lobby modifications.
+///</summary>
+class ONLINEPLATFORMEOS_API EOSModification
+{
+public:
+    /// <summary>
+    /// Logs the failed call of the modification (eg. what: "set the bucket id", target: "session").
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    static bool CheckResult(EOS_EResult result, const char* what, const char* target);
+
+    /// <summary>
+    /// Checks if the failed update can be retried later (eg. the rate limit or the connection issue).
+    /// </summary>
+    static bool IsRetryable(EOS_EResult result);
+};
@@ -0,0 +1,337 @@
+#include "EOSFriendsLeaderboard.h"
+#include "EOSAccountIdTable.h"
+#include "EOSAccountMappings.h"
+#include "EOSPlatformContext.h"
+
+#include "Engine/Core/Log.h"
+#include "Engine/Core/Collections/Sorting.h"
+#include "Engine/Core/Math/Math.h"
+#include "Engine/Platform/Platform.h"
+#include <EOSSDK/Include/eos_sdk.h>
+
+#include "EOSSDK/Include/eos_friends.h"
+#include "EOSSDK/Include/eos_leaderboards.h"
+
+struct EOSFriendsLeaderboard::ScoreBatch
+{
+    EOSFriendsLeaderboard* Owner;
+    Array<EOS_ProductUserId> UserIds;
+    bool Canceled = false;
+};
+
+namespace
+{
+    // Every stat has its bit in the score mask of the entry
+    constexpr int32 MaxStats = 64;
+    static_assert(MaxStats <= sizeof(EOSFriendsLeaderboardEntry::ScoreMask) * 8, "Every stat needs its bit in the ScoreMask.");
+
+    struct RankKey
+    {
+        int64 Key;
+        int32 Row;
+
+        // Ties keep the previous order so the rows don't jump around between the refreshes
+        bool operator<(const RankKey& other) const
+        {
+            return Key < other.Key || (Key == other.Key && Row < other.Row);
+        }
+    };
+}
+
+EOSFriendsLeaderboard::EOSFriendsLeaderboard(EOSPlatformContext* context, EOSAccountMappings* accountMappings)
+    : _context(context)
+    , _accountMappings(accountMappings)
+{
+    _context->Ticking.Bind<EOSFriendsLeaderboard, &EOSFriendsLeaderboard::Flush>(this);
+}
+
+EOSFriendsLeaderboard::~EOSFriendsLeaderboard()
+{
+    _context->Ticking.Unbind<EOSFriendsLeaderboard, &EOSFriendsLeaderboard::Flush>(this);
+    Clear();
+}
+
+void EOSFriendsLeaderboard::SetStats(const Array<EOSFriendsLeaderboardStat>& stats, int64 startTime, int64 endTime)
+{
+    Clear();
+    if (stats.Count() > MaxStats)
+        LOG(Warning, "EOS friends leaderboard supports up to {0} stats.", MaxStats);
+    _stats.Clear();
+    _stats.Add(stats.Get(), Math::Min(stats.Count(), MaxStats));
+    _startTime = startTime;
+    _endTime = endTime;
+    _sortStat = 0;
+}
+
+bool EOSFriendsLeaderboard::Refresh(bool force)
+{
+    const auto friends = _context->GetFriends();
+    if (_stats.IsEmpty() || !friends || !_context->GetLeaderboards() || !_context->AccountId || !_context->ProductUserId)
+        return true;
+
+    // Mappings of the previous refresh still in progress are ignored, its score batches still update the rows
+    const uint32 generation = ++_generation;
+    _force = force;
+    _refreshing = true;
+    const double now = Platform::GetTimeSeconds();
+
+    EOS_Friends_GetFriendsCountOptions countOptions = {};
+    countOptions.ApiVersion = EOS_FRIENDS_GETFRIENDSCOUNT_API_LATEST;
+    countOptions.LocalUserId = _context->AccountId;
+    const int32 count = EOS_Friends_GetFriendsCount(friends, &countOptions);
+    Array<EOS_EpicAccountId, InlinedAllocation<64>> friendIds;
+    EOS_Friends_GetFriendAtIndexOptions indexOptions = {};
+    indexOptions.ApiVersion = EOS_FRIENDS_GETFRIENDATINDEX_API_LATEST;
+    indexOptions.LocalUserId = _context->AccountId;
+    EOS_Friends_GetStatusOptions statusOptions = {};
+    statusOptions.ApiVersion = EOS_FRIENDS_GETSTATUS_API_LATEST;
+    statusOptions.LocalUserId = _context->AccountId;
+    for (int32 i = 0; i < count; i++)
+    {
+        indexOptions.Index = i;
+        statusOptions.TargetUserId = EOS_Friends_GetFriendAtIndex(friends, &indexOptions);
+        if (statusOptions.TargetUserId && EOS_Friends_GetStatus(friends, &statusOptions) == EOS_EFriendsStatus::EOS_FS_Friends)
+            friendIds.Add(statusOptions.TargetUserId);
+    }
+
+    // Drop the rows of the removed friends (the local user row has no account)
+    bool removed = false;
+    for (int32 i = _entries.Count() - 1; i >= 0; i--)
+    {
+        if (_entries[i].AccountId && !friendIds.Contains(_entries[i].AccountId))
+        {
+            _entries.RemoveAtKeepOrder(i);
+            removed = true;
+        }
+    }
+    if (removed)
+        Sort();
+
+    int32 row = FindRow(_context->ProductUserId);
+    if (row == -1)
+        row = AddEntry(_context->ProductUserId, nullptr);
+    Enqueue(_entries[row], now);
+
+    // Friends are mapped to the product users in batches by the account mappings, the cached ones resolve right away
+    // (the extra pending resolve is the loop itself, so the refresh can't complete before all the friends got requested)
+    _pendingResolves = friendIds.Count() + 1;
+    for (const EOS_EpicAccountId accountId : friendIds)
+    {
+        _accountMappings->ResolveProductUserId(EOSAccountIdTable::ToString(accountId), EOS_EExternalAccountType::EOS_EAT_EPIC, [this, generation, accountId](EOS_ProductUserId userId)
+        {
+            if (generation != _generation)
+                return;
+            _pendingResolves--;
+
+            // Friends that never played the game have no product user
+            if (userId)
+            {
+                const double time = Platform::GetTimeSeconds();
+                int32 index = FindRow(userId);
+                if (index == -1)
+                    index = AddEntry(userId, accountId);
+                Enqueue(_entries[index], time);
+            }
+            TryComplete();
+        });
+    }
+    _pendingResolves--;
+    if (removed)
+        Updated();
+    TryComplete();
+    return false;
+}
+
+void EOSFriendsLeaderboard::SortBy(int32 stat)
+{
+    if (stat < 0 || stat >= _stats.Count())
+        return;
+    _sortStat = stat;
+    Sort();
+    Updated();
+}
+
+int32 EOSFriendsLeaderboard::FindRow(EOS_ProductUserId userId) const
+{
+    int32 row;
+    return _rows.TryGet(userId, row) ? row : -1;
+}
+
+void EOSFriendsLeaderboard::Clear()
+{
+    _generation++;
+    for (ScoreBatch* batch : _batches)
+    {
+        // Released when the query completes
+        batch->Canceled = true;
+    }
+    _batches.Clear();
+    _queued.Clear();
+    _entries.Clear();
+    _rows.Clear();
+    _pendingResolves = 0;
+    _refreshing = false;
+}
+
+void EOSFriendsLeaderboard::Flush()
+{
+    if (_queued.IsEmpty())
+        return;
+    const auto leaderboards = _context->GetLeaderboards();
+    if (!leaderboards || !_context->ProductUserId)
+    {
+        _queued.Clear();
+        TryComplete();
+        return;
+    }
+
+    // Every call queries all the stats of the whole batch of the users
+    Array<EOS_Leaderboards_UserScoresQueryStatInfo, InlinedAllocation<8>> statInfos;
+    statInfos.Resize(_stats.Count());
+    for (int32 i = 0; i < _stats.Count(); i++)
+    {
+        auto& statInfo = statInfos[i];
+        statInfo = {};
+        statInfo.ApiVersion = EOS_LEADERBOARDS_USERSCORESQUERYSTATINFO_API_LATEST;
+        statInfo.StatName = _stats[i].StatName.Get();
+        statInfo.Aggregation = _stats[i].Aggregation;
+    }
+    const int32 batchSize = Math::Max(BatchSize, 1);
+    Array<ScoreBatch*, InlinedAllocation<8>> batches;
+    for (int32 start = 0; start < _queued.Count(); start += batchSize)
+    {
+        auto batch = New<ScoreBatch>();
+        batch->Owner = this;
+        batch->UserIds.Add(_queued.Get() + start, Math::Min(_queued.Count() - start, batchSize));
+        batches.Add(batch);
+    }
+    _queued.Clear();
+    _batches.Add(batches.Get(), batches.Count());
+
+    for (ScoreBatch* batch : batches)
+    {
+        EOS_Leaderboards_QueryLeaderboardUserScoresOptions options = {};
+        options.ApiVersion = EOS_LEADERBOARDS_QUERYLEADERBOARDUSERSCORES_API_LATEST;
+        options.UserIds = batch->UserIds.Get();
+        options.UserIdsCount = (uint32)batch->UserIds.Count();
+        options.StatInfo = statInfos.Get();
+        options.StatInfoCount = (uint32)statInfos.Count();
+        options.StartTime = _startTime;
+        options.EndTime = _endTime;
+        options.LocalUserId = _context->ProductUserId;
+        EOS_Leaderboards_QueryLeaderboardUserScores(leaderboards, &options, batch, &EOSFriendsLeaderboard::OnQueryUserScoresComplete);
+    }
+}
+
+int32 EOSFriendsLeaderboard::AddEntry(EOS_ProductUserId userId, EOS_EpicAccountId accountId)
+{
+    // New rows have no score yet, so they go last without breaking the order
+    const int32 row = _entries.Count();
+    auto& entry = _entries.AddOne();
+    entry.UserId = userId;
+    entry.AccountId = accountId;
+    entry.Scores.Resize(_stats.Count());
+    for (int32& score : entry.Scores)
+        score = 0;
+    _rows.Add(userId, row);
+    return row;
+}
+
+void EOSFriendsLeaderboard::Enqueue(const EOSFriendsLeaderboardEntry& entry, double now)
+{
+    const bool expired = entry.FetchTime < 0.0 || now - entry.FetchTime > (double)TimeToLive;
+    if ((_force || expired) && !_queued.Contains(entry.UserId))
+        _queued.Add(entry.UserId);
+}
+
+void EOSFriendsLeaderboard::CompleteBatch(ScoreBatch* batch, EOS_EResult result)
+{
+    _batches.Remove(batch);
+    if (result == EOS_EResult::EOS_Success)
+    {
+        const auto leaderboards = _context->GetLeaderboards();
+        const double now = Platform::GetTimeSeconds();
+        EOS_Leaderboards_CopyLeaderboardUserScoreByUserIdOptions options = {};
+        options.ApiVersion = EOS_LEADERBOARDS_COPYLEADERBOARDUSERSCOREBYUSERID_API_LATEST;
+        for (const EOS_ProductUserId userId : batch->UserIds)
+        {
+            // The friend could have been removed by another refresh meanwhile
+            const int32 row = FindRow(userId);
+            if (row == -1)
+                continue;
+            auto& entry = _entries[row];
+            entry.ScoreMask = 0;
+            options.UserId = userId;
+            for (int32 stat = 0; stat < _stats.Count(); stat++)
+            {
+                options.StatName = _stats[stat].StatName.Get();
+                EOS_Leaderboards_LeaderboardUserScore* score;
+                if (EOS_Leaderboards_CopyLeaderboardUserScoreByUserId(leaderboards, &options, &score) != EOS_EResult::EOS_Success)
+                    continue;
+                entry.Scores[stat] = score->Score;
+                entry.ScoreMask |= 1ull << stat;
+                EOS_Leaderboards_LeaderboardUserScore_Release(score);
+            }
+            entry.FetchTime = now;
+        }
+        Sort();
+        Updated();
+    }
+    else
+    {
+        LOG(Warning, "EOS failed to query friends leaderboard scores: {0}", String(EOS_EResult_ToString(result)));
+    }
+    TryComplete();
+}
+
+void EOSFriendsLeaderboard::Sort()
+{
+    const int32 stat = _sortStat;
+    const bool ascending = _stats.HasItems() && _stats[stat].Ascending;
+    Array<RankKey> keys;
+    keys.Resize(_entries.Count());
+    for (int32 i = 0; i < _entries.Count(); i++)
+    {
+        const auto& entry = _entries[i];
+        keys[i].Key = !entry.HasScore(stat) ? MAX_int64 : ascending ? (int64)entry.Scores[stat] : -(int64)entry.Scores[stat];
+        keys[i].Row = i;
+    }
+    Sorting::QuickSort(keys.Get(), keys.Count());
+
+    Array<EOSFriendsLeaderboardEntry> entries;
+    entries.Resize(_entries.Count());
+    _rows.Clear();
+    int32 rank = 0;
+    for (int32 i = 0; i < keys.Count(); i++)
+    {
+        auto& entry = entries[i];
+        entry = MoveTemp(_entries[keys[i].Row]);
+        _rows.Add(entry.UserId, i);
+        if (!entry.HasScore(stat))
+        {
+            entry.Rank = 0;
+            continue;
+        }
+        if (i == 0 || keys[i].Key != keys[i - 1].Key)
+            rank = i + 1;
+        entry.Rank = rank;
+    }
+    _entries = MoveTemp(entries);
+}
+
+void EOSFriendsLeaderboard::TryComplete()
+{
+    if (_refreshing && _pendingResolves == 0 && _queued.IsEmpty() && _batches.IsEmpty())
+    {
+        _refreshing = false;
+        RefreshCompleted();
+    }
+}
+
+void EOSFriendsLeaderboard::OnQueryUserScoresComplete(const EOS_Leaderboards_OnQueryLeaderboardUserScoresCompleteCallbackInfo* data)
+{
+    const auto batch = (ScoreBatch*)data->ClientData;
+    if (!batch->Canceled)
+        batch->Owner->CompleteBatch(batch, data->ResultCode);
+    Delete(batch);
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include "Engine/Core/Collections/Array.h"
+#include "Engine/Core/Collections/Dictionary.h"
+#include "Engine/Core/Delegate.h"
+#include "Engine/Core/Types/String.h"
+#include "EOSSDK/Include/eos_leaderboards_types.h"
+
+class EOSPlatformContext;
+class EOSAccountMappings;
+
+///<summary>
+/// The stat (column) of the friends leaderboard.
+///</summary>
+struct EOSFriendsLeaderboardStat
+{
+    StringAnsi StatName;
+    EOS_ELeaderboardAggregation Aggregation = EOS_ELeaderboardAggregation::EOS_LA_Max;
+
+    /// <summary>
+    /// True if the lower score ranks higher (eg. the lap time).
+    /// </summary>
+    bool Ascending = false;
+};
+
+///<summary>
+/// The row of the friends leaderboard (the local user or the friend).
+///</summary>
+struct EOSFriendsLeaderboardEntry
+{
+    EOS_ProductUserId UserId = nullptr;
+
+    /// <summary>
+    /// The Epic account of the friend (null for the local user).
+    /// </summary>
+    EOS_EpicAccountId AccountId = nullptr;
+
+    /// <summary>
+    /// The scores of the stats (in the order of the stats). Valid only if the matching bit of the ScoreMask is set.
+    /// </summary>
+    Array<int32> Scores;
+    uint64 ScoreMask = 0;
+
+    /// <summary>
+    /// The rank by the sorting stat (starting at 1, ties share the rank). Zero for the users without the score.
+    /// </summary>
+    int32 Rank = 0;
+
+    double FetchTime = -1.0;
+
+    FORCE_INLINE bool HasScore(int32 stat) const
+    {
+        return (ScoreMask & (1ull << stat)) != 0;
+    }
+};
+
+///<summary>
+/// The leaderboard of the local user and the friends (from the SDK friends list) for the multiple stats.
+/// Friends are mapped to the product users through the account mappings (batched) and their scores are queried with QueryLeaderboardUserScores for all the stats and many users per call, instead of the call per friend.
+/// Refresh is incremental: only the new friends and the ones with the expired scores are queried, and the table gets re-sorted (Updated) as every batch completes.
+/// Must be used from the thread that ticks the platform (the game thread on the client).
+///</summary>
+class ONLINEPLATFORMEOS_API EOSFriendsLeaderboard
+{
+private:
+    struct ScoreBatch;
+
+    EOSPlatformContext* _context;
+    EOSAccountMappings* _accountMappings;
+    Array<EOSFriendsLeaderboardStat> _stats;
+    int64 _startTime = EOS_LEADERBOARDS_TIME_UNDEFINED;
+    int64 _endTime = EOS_LEADERBOARDS_TIME_UNDEFINED;
+    Array<EOSFriendsLeaderboardEntry> _entries;
+    Dictionary<EOS_ProductUserId, int32> _rows;
+    Array<ScoreBatch*> _batches;
+    Array<EOS_ProductUserId> _queued;
+    int32 _sortStat = 0;
+    int32 _pendingResolves = 0;
+    uint32 _generation = 0;
+    bool _force = false;
+    bool _refreshing = false;
+
+public:
+    EOSFriendsLeaderboard(EOSPlatformContext* context, EOSAccountMappings* accountMappings);
+    ~EOSFriendsLeaderboard();
+
+    /// <summary>
+    /// The time (in seconds) after which the scores of the user are queried again by the refresh.
+    /// </summary>
+    float TimeToLive = 120.0f;
+
+    /// <summary>
+    /// The maximum amount of the users queried in a single QueryLeaderboardUserScores call.
+    /// </summary>
+    int32 BatchSize = 100;
+
+    /// <summary>
+    /// Event called when the table got updated and re-sorted (after every completed batch of the refresh).
+    /// </summary>
+    Action Updated;
+
+    /// <summary>
+    /// Event called when the refresh completed.
+    /// </summary>
+    Action RefreshCompleted;
+
+public:
+    /// <summary>
+    /// Sets the stats of the leaderboard and the time window of the scores. Clears the table.
+    /// </summary>
+    void SetStats(const Array<EOSFriendsLeaderboardStat>& stats, int64 startTime = EOS_LEADERBOARDS_TIME_UNDEFINED, int64 endTime = EOS_LEADERBOARDS_TIME_UNDEFINED);
+
+    FORCE_INLINE const Array<EOSFriendsLeaderboardStat>& GetStats() const
+    {
+        return _stats;
+    }
+
+    /// <summary>
+    /// Refreshes the table with the cached friends list. The removed friends are dropped right away, the new ones and the ones with the expired scores get queried.
+    /// </summary>
+    /// <param name="force">True to query the scores of all the users, even the ones that didn't expire.</param>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool Refresh(bool force = false);
+
+    /// <summary>
+    /// Sorts the table by the stat (index of the stat).
+    /// </summary>
+    void SortBy(int32 stat);
+
+    FORCE_INLINE bool IsRefreshing() const
+    {
+        return _refreshing;
+    }
+
+    /// <summary>
+    /// Gets the table rows sorted by the sorting stat (the users without the score are last).
+    /// </summary>
+    FORCE_INLINE const Array<EOSFriendsLeaderboardEntry>& GetEntries() const
+    {
+        return _entries;
+    }
+
+    /// <summary>
+    /// Finds the row of the user.
+    /// </summary>
+    /// <returns>The row index or -1 if not found.</returns>
+    int32 FindRow(EOS_ProductUserId userId) const;
+
+    /// <summary>
+    /// Removes all the rows and cancels the refresh in progress.
+    /// </summary>
+    void Clear();
+
+    /// <summary>
+    /// Issues the queued score queries. Called on every platform tick.
+    /// </summary>
+    void Flush();
+
+private:
+    int32 AddEntry(EOS_ProductUserId userId, EOS_EpicAccountId accountId);
+    void Enqueue(const EOSFriendsLeaderboardEntry& entry, double now);
+    void CompleteBatch(ScoreBatch* batch, EOS_EResult result);
+    void Sort();
+    void TryComplete();
+
+    static void EOS_CALL OnQueryUserScoresComplete(const EOS_Leaderboards_OnQueryLeaderboardUserScoresCompleteCallbackInfo* data);
+};
@@ -0,0 +1,544 @@
+#include "EOSLeaderboards.h"
+#include "EOSPlatformContext.h"
+
+#include "Engine/Core/Log.h"
+#include "Engine/Core/Math/Math.h"
+#include "Engine/Platform/Platform.h"
+#include <EOSSDK/Include/eos_sdk.h>
+
+#include "EOSSDK/Include/eos_leaderboards.h"
+
+struct EOSLeaderboards::RangeRequest
+{
+    int32 First = 0;
+    int32 Count = 0;
+
+    // The records above and below the local user (-1 for the fixed range)
+    int32 Radius = -1;
+
+    RecordsCallback Callback;
+};
+
+struct EOSLeaderboards::Board
+{
+    StringAnsi LeaderboardId;
+    double FetchTime = -1.0;
+    int32 Count = 0;
+    int32 PageSize = 1;
+    uint32 LocalRank = 0;
+    Dictionary<int32, Array<EOSLeaderboardRecord>> Pages;
+    RanksQuery* Query = nullptr;
+    Array<RangeRequest> Waiting;
+};
+
+struct EOSLeaderboards::RanksQuery
+{
+    EOSLeaderboards* Owner;
+    Board* Target;
+    bool Canceled = false;
+};
+
+struct EOSLeaderboards::DefinitionsQuery
+{
+    EOSLeaderboards* Owner;
+    Array<Callback> Callbacks;
+    bool Canceled = false;
+};
+
+struct EOSLeaderboards::ScoreQuery
+{
+    EOSLeaderboards* Owner;
+    EOS_ProductUserId UserId;
+    StringAnsi StatName;
+    RecordsCallback Callback;
+    bool Canceled = false;
+};
+
+EOSLeaderboards::EOSLeaderboards(EOSPlatformContext* context)
+    : _context(context)
+{
+    _context->Ticking.Bind<EOSLeaderboards, &EOSLeaderboards::Flush>(this);
+}
+
+EOSLeaderboards::~EOSLeaderboards()
+{
+    _context->Ticking.Unbind<EOSLeaderboards, &EOSLeaderboards::Flush>(this);
+    Clear();
+}
+
+bool EOSLeaderboards::QueryDefinitions(const Callback& callback)
+{
+    if (_definitionsTime >= 0.0 && Platform::GetTimeSeconds() - _definitionsTime <= (double)DefinitionsTimeToLive)
+    {
+        if (callback.IsBinded())
+            callback(EOS_EResult::EOS_Success);
+        return false;
+    }
+    if (_definitionsQuery)
+    {
+        _definitionsQuery->Callbacks.Add(callback);
+        return false;
+    }
+    const auto leaderboards = _context->GetLeaderboards();
+    if (!leaderboards || !_context->ProductUserId)
+        return true;
+
+    _definitionsQuery = New<DefinitionsQuery>();
+    _definitionsQuery->Owner = this;
+    _definitionsQuery->Callbacks.Add(callback);
+    EOS_Leaderboards_QueryLeaderboardDefinitionsOptions options = {};
+    options.ApiVersion = EOS_LEADERBOARDS_QUERYLEADERBOARDDEFINITIONS_API_LATEST;
+    options.StartTime = EOS_LEADERBOARDS_TIME_UNDEFINED;
+    options.EndTime = EOS_LEADERBOARDS_TIME_UNDEFINED;
+    options.LocalUserId = _context->ProductUserId;
+    EOS_Leaderboards_QueryLeaderboardDefinitions(leaderboards, &options, _definitionsQuery, &EOSLeaderboards::OnQueryDefinitionsComplete);
+    return false;
+}
+
+const EOSLeaderboardDefinition* EOSLeaderboards::FindDefinition(const StringAnsiView& leaderboardId) const
+{
+    for (const EOSLeaderboardDefinition& definition : _definitions)
+    {
+        if (definition.LeaderboardId == leaderboardId)
+            return &definition;
+    }
+    return nullptr;
+}
+
+bool EOSLeaderboards::GetPage(const StringAnsiView& leaderboardId, int32 page, const RecordsCallback& callback)
+{
+    if (page < 0)
+        return true;
+    RangeRequest request;
+    request.First = page * Math::Max(PageSize, 1);
+    request.Count = Math::Max(PageSize, 1);
+    request.Callback = callback;
+    return Request(leaderboardId, request);
+}
+
+bool EOSLeaderboards::GetTop(const StringAnsiView& leaderboardId, int32 count, const RecordsCallback& callback)
+{
+    if (count <= 0)
+        return true;
+    RangeRequest request;
+    request.Count = count;
+    request.Callback = callback;
+    return Request(leaderboardId, request);
+}
+
+bool EOSLeaderboards::GetAroundMe(const StringAnsiView& leaderboardId, int32 radius, const RecordsCallback& callback)
+{
+    RangeRequest request;
+    request.Radius = Math::Max(radius, 0);
+    request.Callback = callback;
+    return Request(leaderboardId, request);
+}
+
+bool EOSLeaderboards::TryGetPage(const StringAnsiView& leaderboardId, int32 page, Array<EOSLeaderboardRecord>& result, bool allowExpired) const
+{
+    Board* board;
+    if (!_boards.TryGet(StringAnsi(leaderboardId), board) || (!allowExpired && !IsValid(board, Platform::GetTimeSeconds())))
+        return false;
+    const Array<EOSLeaderboardRecord>* records = board->Pages.TryGet(page);
+    if (!records)
+        return false;
+    result = *records;
+    return true;
+}
+
+int32 EOSLeaderboards::GetRecordCount(const StringAnsiView& leaderboardId) const
+{
+    Board* board;
+    return _boards.TryGet(StringAnsi(leaderboardId), board) && board->FetchTime >= 0.0 ? board->Count : -1;
+}
+
+uint32 EOSLeaderboards::GetLocalRank(const StringAnsiView& leaderboardId) const
+{
+    Board* board;
+    return _boards.TryGet(StringAnsi(leaderboardId), board) ? board->LocalRank : 0;
+}
+
+void EOSLeaderboards::Prefetch(const StringAnsiView& leaderboardId, int32 page)
+{
+    if (page < 0 || leaderboardId.IsEmpty())
+        return;
+    for (const PrefetchRequest& prefetch : _prefetch)
+    {
+        if (prefetch.Page == page && prefetch.LeaderboardId == leaderboardId)
+            return;
+    }
+    auto& prefetch = _prefetch.AddOne();
+    prefetch.LeaderboardId = leaderboardId;
+    prefetch.Page = page;
+}
+
+void EOSLeaderboards::Invalidate(const StringAnsiView& leaderboardId)
+{
+    Board* board;
+    if (_boards.TryGet(StringAnsi(leaderboardId), board))
+        board->FetchTime = -1.0;
+}
+
+void EOSLeaderboards::Clear()
+{
+    // Queries are owned by the SDK callbacks that may still be in-flight
+    for (auto i = _boards.Begin(); i.IsNotEnd(); ++i)
+    {
+        if (i->Value->Query)
+            i->Value->Query->Canceled = true;
+        Delete(i->Value);
+    }
+    _boards.Clear();
+    if (_definitionsQuery)
+    {
+        _definitionsQuery->Canceled = true;
+        _definitionsQuery = nullptr;
+    }
+    for (ScoreQuery* query : _scoreQueries)
+        query->Canceled = true;
+    _scoreQueries.Clear();
+    _definitions.Clear();
+    _definitionsTime = -1.0;
+    _prefetch.Clear();
+    _sdkRecords.Clear();
+}
+
+void EOSLeaderboards::Flush()
+{
+    if (_prefetch.IsEmpty())
+        return;
+    const double now = Platform::GetTimeSeconds();
+    Array<PrefetchRequest> prefetches = MoveTemp(_prefetch);
+    _prefetch.Clear();
+    for (const PrefetchRequest& prefetch : prefetches)
+    {
+        Board* board = GetBoard(prefetch.LeaderboardId);
+        if (board->Query)
+            continue;
+        if (IsValid(board, now))
+        {
+            if (prefetch.Page * board->PageSize >= board->Count || board->Pages.ContainsKey(prefetch.Page))
+                continue;
+            if (!CopyPage(board, prefetch.Page))
+                continue;
+        }
+
+        // The ranks expired or the SDK holds the records of another leaderboard
+        QueryRanks(board);
+    }
+}
+
+EOSLeaderboards::Board* EOSLeaderboards::GetBoard(const StringAnsiView& leaderboardId)
+{
+    const StringAnsi key(leaderboardId);
+    Board* board;
+    if (!_boards.TryGet(key, board))
+    {
+        board = New<Board>();
+        board->LeaderboardId = key;
+        _boards.Add(key, board);
+    }
+    return board;
+}
+
+bool EOSLeaderboards::IsValid(const Board* board, double now) const
+{
+    return board->FetchTime >= 0.0 && now - board->FetchTime <= (double)TimeToLive;
+}
+
+bool EOSLeaderboards::Request(const StringAnsiView& leaderboardId, const RangeRequest& request)
+{
+    if (leaderboardId.IsEmpty() || !_context->GetLeaderboards() || !_context->ProductUserId)
+        return true;
+    Board* board = GetBoard(leaderboardId);
+    if (!board->Query && IsValid(board, Platform::GetTimeSeconds()))
+    {
+        if (request.Radius >= 0 && board->LocalRank == 0)
+            return QueryLocalScore(board->LeaderboardId, request.Callback);
+        Array<EOSLeaderboardRecord> result;
+        if (!Serve(board, request, result))
+        {
+            request.Callback(EOS_EResult::EOS_Success, result);
+            return false;
+        }
+    }
+
+    // Wait for the ranks query (shared by all the requests of the leaderboard)
+    board->Waiting.Add(request);
+    if (!board->Query && QueryRanks(board))
+    {
+        board->Waiting.RemoveLast();
+        return true;
+    }
+    return false;
+}
+
+bool EOSLeaderboards::QueryRanks(Board* board)
+{
+    const auto leaderboards = _context->GetLeaderboards();
+    if (!leaderboards || !_context->ProductUserId)
+        return true;
+    auto query = New<RanksQuery>();
+    query->Owner = this;
+    query->Target = board;
+    board->Query = query;
+    EOS_Leaderboards_QueryLeaderboardRanksOptions options = {};
+    options.ApiVersion = EOS_LEADERBOARDS_QUERYLEADERBOARDRANKS_API_LATEST;
+    options.LeaderboardId = board->LeaderboardId.Get();
+    options.LocalUserId = _context->ProductUserId;
+    EOS_Leaderboards_QueryLeaderboardRanks(leaderboards, &options, query, &EOSLeaderboards::OnQueryRanksComplete);
+    return false;
+}
+
+bool EOSLeaderboards::CopyPage(Board* board, int32 page)
+{
+    const auto leaderboards = _context->GetLeaderboards();
+    if (!leaderboards || _sdkRecords != board->LeaderboardId)
+        return true;
+    auto& records = board->Pages[page];
+    records.Clear();
+    const int32 first = page * board->PageSize;
+    const int32 last = Math::Min(first + board->PageSize, board->Count);
+    EOS_Leaderboards_CopyLeaderboardRecordByIndexOptions options = {};
+    options.ApiVersion = EOS_LEADERBOARDS_COPYLEADERBOARDRECORDBYINDEX_API_LATEST;
+    for (int32 i = first; i < last; i++)
+    {
+        options.LeaderboardRecordIndex = (uint32)i;
+        EOS_Leaderboards_LeaderboardRecord* record;
+        if (EOS_Leaderboards_CopyLeaderboardRecordByIndex(leaderboards, &options, &record) != EOS_EResult::EOS_Success)
+        {
+            // The gap would shift all the later records of the page, fail it so the ranks get queried again
+            board->Pages.Remove(page);
+            return true;
+        }
+        auto& entry = records.AddOne();
+        entry.UserId = record->UserId;
+        entry.Rank = record->Rank;
+        entry.Score = record->Score;
+        if (record->UserDisplayName)
+            entry.DisplayName = String(record->UserDisplayName);
+        EOS_Leaderboards_LeaderboardRecord_Release(record);
+    }
+    return false;
+}
+
+bool EOSLeaderboards::Serve(Board* board, const RangeRequest& request, Array<EOSLeaderboardRecord>& result)
+{
+    result.Clear();
+    int32 first = request.First, count = request.Count;
+    if (request.Radius >= 0)
+    {
+        first = (int32)board->LocalRank - 1 - request.Radius;
+        count = request.Radius * 2 + 1;
+        if (first < 0)
+        {
+            count += first;
+            first = 0;
+        }
+    }
+    const int32 last = Math::Min(first + count, board->Count);
+    if (first >= last)
+        return false;
+
+    const int32 lastPage = (last - 1) / board->PageSize;
+    for (int32 page = first / board->PageSize; page <= lastPage; page++)
+    {
+        const Array<EOSLeaderboardRecord>* records = board->Pages.TryGet(page);
+        if (!records)
+        {
+            if (CopyPage(board, page))
+                return true;
+            records = board->Pages.TryGet(page);
+        }
+        const int32 pageFirst = page * board->PageSize;
+        for (int32 i = Math::Max(first - pageFirst, 0); i < records->Count() && pageFirst + i < last; i++)
+            result.Add(records->At(i));
+    }
+
+    // The UI is likely to scroll to the next page
+    if ((lastPage + 1) * board->PageSize < board->Count && !board->Pages.ContainsKey(lastPage + 1))
+        Prefetch(board->LeaderboardId, lastPage + 1);
+    return false;
+}
+
+bool EOSLeaderboards::QueryLocalScore(const StringAnsi& leaderboardId, const RecordsCallback& callback)
+{
+    // The user outside of the ranked records has no rank, but the score can be queried with the stat of the leaderboard
+    const EOSLeaderboardDefinition* definition = FindDefinition(leaderboardId);
+    const auto leaderboards = _context->GetLeaderboards();
+    if (!definition || !leaderboards || !_context->ProductUserId)
+        return true;
+    auto query = New<ScoreQuery>();
+    query->Owner = this;
+    query->UserId = _context->ProductUserId;
+    query->StatName = definition->StatName;
+    query->Callback = callback;
+    _scoreQueries.Add(query);
+    EOS_Leaderboards_UserScoresQueryStatInfo statInfo = {};
+    statInfo.ApiVersion = EOS_LEADERBOARDS_USERSCORESQUERYSTATINFO_API_LATEST;
+    statInfo.StatName = query->StatName.Get();
+    statInfo.Aggregation = definition->Aggregation;
+    EOS_Leaderboards_QueryLeaderboardUserScoresOptions options = {};
+    options.ApiVersion = EOS_LEADERBOARDS_QUERYLEADERBOARDUSERSCORES_API_LATEST;
+    options.UserIds = &query->UserId;
+    options.UserIdsCount = 1;
+    options.StatInfo = &statInfo;
+    options.StatInfoCount = 1;
+    options.StartTime = definition->StartTime;
+    options.EndTime = definition->EndTime;
+    options.LocalUserId = _context->ProductUserId;
+    EOS_Leaderboards_QueryLeaderboardUserScores(leaderboards, &options, query, &EOSLeaderboards::OnQueryUserScoresComplete);
+    return false;
+}
+
+void EOSLeaderboards::CompleteRanks(Board* board, EOS_EResult result)
+{
+    const StringAnsi leaderboardId = board->LeaderboardId;
+    Array<RangeRequest> waiting = MoveTemp(board->Waiting);
+    board->Waiting.Clear();
+    Array<EOSLeaderboardRecord> records;
+    if (result != EOS_EResult::EOS_Success)
+    {
+        LOG(Warning, "EOS failed to query leaderboard {0} ranks: {1}", String(leaderboardId), String(EOS_EResult_ToString(result)));
+        for (const RangeRequest& request : waiting)
+            request.Callback(result, records);
+        return;
+    }
+
+    // The SDK now holds the records of this leaderboard, the pages are copied out of it on demand
+    const auto leaderboards = _context->GetLeaderboards();
+    _sdkRecords = leaderboardId;
+    board->FetchTime = Platform::GetTimeSeconds();
+    board->PageSize = Math::Max(PageSize, 1);
+    board->Pages.Clear();
+    EOS_Leaderboards_GetLeaderboardRecordCountOptions countOptions = {};
+    countOptions.ApiVersion = EOS_LEADERBOARDS_GETLEADERBOARDRECORDCOUNT_API_LATEST;
+    board->Count = (int32)EOS_Leaderboards_GetLeaderboardRecordCount(leaderboards, &countOptions);
+    board->LocalRank = 0;
+    EOS_Leaderboards_CopyLeaderboardRecordByUserIdOptions userOptions = {};
+    userOptions.ApiVersion = EOS_LEADERBOARDS_COPYLEADERBOARDRECORDBYUSERID_API_LATEST;
+    userOptions.UserId = _context->ProductUserId;
+    EOS_Leaderboards_LeaderboardRecord* record;
+    if (userOptions.UserId && EOS_Leaderboards_CopyLeaderboardRecordByUserId(leaderboards, &userOptions, &record) == EOS_EResult::EOS_Success)
+    {
+        board->LocalRank = record->Rank;
+        EOS_Leaderboards_LeaderboardRecord_Release(record);
+    }
+
+    // Serve all the requests before calling back, so the callbacks can use the leaderboards freely
+    Array<Array<EOSLeaderboardRecord>> results;
+    results.Resize(waiting.Count());
+    Array<EOS_EResult> codes;
+    codes.Resize(waiting.Count());
+    Array<bool> unranked;
+    unranked.Resize(waiting.Count());
+    for (int32 i = 0; i < waiting.Count(); i++)
+    {
+        codes[i] = EOS_EResult::EOS_Success;
+        unranked[i] = waiting[i].Radius >= 0 && board->LocalRank == 0;
+        if (!unranked[i] && Serve(board, waiting[i], results[i]))
+        {
+            codes[i] = EOS_EResult::EOS_UnexpectedError;
+            results[i].Clear();
+        }
+    }
+    for (int32 i = 0; i < waiting.Count(); i++)
+    {
+        if (!unranked[i])
+            waiting[i].Callback(codes[i], results[i]);
+        else if (QueryLocalScore(leaderboardId, waiting[i].Callback))
+            waiting[i].Callback(EOS_EResult::EOS_NotFound, records);
+    }
+    RanksUpdated(leaderboardId);
+}
+
+void EOSLeaderboards::OnQueryDefinitionsComplete(const EOS_Leaderboards_OnQueryLeaderboardDefinitionsCompleteCallbackInfo* data)
+{
+    const auto query = (DefinitionsQuery*)data->ClientData;
+    if (!query->Canceled)
+    {
+        EOSLeaderboards* leaderboards = query->Owner;
+        leaderboards->_definitionsQuery = nullptr;
+        if (data->ResultCode == EOS_EResult::EOS_Success)
+        {
+            const auto handle = leaderboards->_context->GetLeaderboards();
+            EOS_Leaderboards_GetLeaderboardDefinitionCountOptions countOptions = {};
+            countOptions.ApiVersion = EOS_LEADERBOARDS_GETLEADERBOARDDEFINITIONCOUNT_API_LATEST;
+            const uint32 count = EOS_Leaderboards_GetLeaderboardDefinitionCount(handle, &countOptions);
+            leaderboards->_definitions.Clear();
+            leaderboards->_definitions.EnsureCapacity((int32)count);
+            EOS_Leaderboards_CopyLeaderboardDefinitionByIndexOptions options = {};
+            options.ApiVersion = EOS_LEADERBOARDS_COPYLEADERBOARDDEFINITIONBYINDEX_API_LATEST;
+            for (uint32 i = 0; i < count; i++)
+            {
+                options.LeaderboardIndex = i;
+                EOS_Leaderboards_Definition* definition;
+                if (EOS_Leaderboards_CopyLeaderboardDefinitionByIndex(handle, &options, &definition) != EOS_EResult::EOS_Success)
+                    continue;
+                auto& entry = leaderboards->_definitions.AddOne();
+                entry.LeaderboardId = definition->LeaderboardId;
+                entry.StatName = definition->StatName;
+                entry.Aggregation = definition->Aggregation;
+                entry.StartTime = definition->StartTime;
+                entry.EndTime = definition->EndTime;
+                EOS_Leaderboards_Definition_Release(definition);
+            }
+            leaderboards->_definitionsTime = Platform::GetTimeSeconds();
+        }
+        else
+        {
+            LOG(Warning, "EOS failed to query leaderboard definitions: {0}", String(EOS_EResult_ToString(data->ResultCode)));
+        }
+        for (const Callback& callback : query->Callbacks)
+        {
+            if (callback.IsBinded())
+                callback(data->ResultCode);
+        }
+    }
+    Delete(query);
+}
+
+void EOSLeaderboards::OnQueryRanksComplete(const EOS_Leaderboards_OnQueryLeaderboardRanksCompleteCallbackInfo* data)
+{
+    const auto query = (RanksQuery*)data->ClientData;
+    if (!query->Canceled)
+    {
+        query->Target->Query = nullptr;
+        query->Owner->CompleteRanks(query->Target, data->ResultCode);
+    }
+    Delete(query);
+}
+
+void EOSLeaderboards::OnQueryUserScoresComplete(const EOS_Leaderboards_OnQueryLeaderboardUserScoresCompleteCallbackInfo* data)
+{
+    const auto query = (ScoreQuery*)data->ClientData;
+    if (!query->Canceled)
+    {
+        EOSLeaderboards* leaderboards = query->Owner;
+        leaderboards->_scoreQueries.Remove(query);
+        Array<EOSLeaderboardRecord> records;
+        EOS_EResult result = data->ResultCode;
+        if (result == EOS_EResult::EOS_Success)
+        {
+            EOS_Leaderboards_CopyLeaderboardUserScoreByUserIdOptions options = {};
+            options.ApiVersion = EOS_LEADERBOARDS_COPYLEADERBOARDUSERSCOREBYUSERID_API_LATEST;
+            options.UserId = query->UserId;
+            options.StatName = query->StatName.Get();
+            EOS_Leaderboards_LeaderboardUserScore* score;
+            result = EOS_Leaderboards_CopyLeaderboardUserScoreByUserId(leaderboards->_context->GetLeaderboards(), &options, &score);
+            if (result == EOS_EResult::EOS_Success)
+            {
+                auto& entry = records.AddOne();
+                entry.UserId = score->UserId;
+                entry.Score = score->Score;
+                EOS_Leaderboards_LeaderboardUserScore_Release(score);
+            }
+        }
+        else
+        {
+            LOG(Warning, "EOS failed to query leaderboard user scores: {0}", String(EOS_EResult_ToString(result)));
+        }
+        query->Callback(result, records);
+    }
+    Delete(query);
+}
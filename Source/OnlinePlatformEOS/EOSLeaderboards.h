@@ -0,0 +1,190 @@
+#pragma once
+
+#include "Engine/Core/Collections/Array.h"
+#include "Engine/Core/Collections/Dictionary.h"
+#include "Engine/Core/Delegate.h"
+#include "Engine/Core/Types/String.h"
+#include "EOSSDK/Include/eos_leaderboards_types.h"
+
+class EOSPlatformContext;
+
+///<summary>
+/// The definition of the leaderboard (the stat it ranks and the time window).
+///</summary>
+struct EOSLeaderboardDefinition
+{
+    StringAnsi LeaderboardId;
+    StringAnsi StatName;
+    EOS_ELeaderboardAggregation Aggregation = EOS_ELeaderboardAggregation::EOS_LA_Max;
+    int64 StartTime = EOS_LEADERBOARDS_TIME_UNDEFINED;
+    int64 EndTime = EOS_LEADERBOARDS_TIME_UNDEFINED;
+};
+
+///<summary>
+/// The single row of the leaderboard.
+///</summary>
+struct EOSLeaderboardRecord
+{
+    EOS_ProductUserId UserId = nullptr;
+
+    /// <summary>
+    /// The rank (starting at 1). Zero for the user outside of the ranked records (see GetAroundMe).
+    /// </summary>
+    uint32 Rank = 0;
+
+    int32 Score = 0;
+    String DisplayName;
+};
+
+///<summary>
+/// The leaderboards with the paged rank windows cached on the client.
+/// The ranks of the leaderboard are queried once per time-to-live and the pages are copied out of the SDK on demand, so the top N and the around-me views of the opened leaderboard are served from the cache without any request. The page after the requested one gets prefetched on the next tick, so it's ready before the UI scrolls to it.
+/// The SDK keeps the records of the last queried leaderboard only, so the pages of the other leaderboards that weren't copied yet require another ranks query.
+/// Must be used from the thread that ticks the platform (the game thread on the client).
+///</summary>
+class ONLINEPLATFORMEOS_API EOSLeaderboards
+{
+public:
+    typedef Function<void(EOS_EResult)> Callback;
+    typedef Function<void(EOS_EResult, const Array<EOSLeaderboardRecord>&)> RecordsCallback;
+
+private:
+    struct Board;
+    struct RangeRequest;
+    struct RanksQuery;
+    struct DefinitionsQuery;
+    struct ScoreQuery;
+    struct PrefetchRequest
+    {
+        StringAnsi LeaderboardId;
+        int32 Page;
+    };
+
+    EOSPlatformContext* _context;
+    Array<EOSLeaderboardDefinition> _definitions;
+    double _definitionsTime = -1.0;
+    DefinitionsQuery* _definitionsQuery = nullptr;
+    Dictionary<StringAnsi, Board*> _boards;
+    Array<ScoreQuery*> _scoreQueries;
+    Array<PrefetchRequest> _prefetch;
+    StringAnsi _sdkRecords;
+
+public:
+    EOSLeaderboards(EOSPlatformContext* context);
+    ~EOSLeaderboards();
+
+    /// <summary>
+    /// The time (in seconds) after which the cached ranks of the leaderboard are queried again.
+    /// </summary>
+    float TimeToLive = 60.0f;
+
+    /// <summary>
+    /// The time (in seconds) after which the leaderboard definitions are queried again.
+    /// </summary>
+    float DefinitionsTimeToLive = 3600.0f;
+
+    /// <summary>
+    /// The amount of the records in the page.
+    /// </summary>
+    int32 PageSize = 25;
+
+    /// <summary>
+    /// Event called when the ranks of the leaderboard got queried (the cached pages got replaced).
+    /// </summary>
+    Delegate<const StringAnsi&> RanksUpdated;
+
+public:
+    /// <summary>
+    /// Queries the leaderboard definitions. Calls back immediately if the cached ones didn't expire.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool QueryDefinitions(const Callback& callback);
+
+    /// <summary>
+    /// Gets the cached leaderboard definitions.
+    /// </summary>
+    FORCE_INLINE const Array<EOSLeaderboardDefinition>& GetDefinitions() const
+    {
+        return _definitions;
+    }
+
+    /// <summary>
+    /// Finds the cached leaderboard definition.
+    /// </summary>
+    /// <returns>The definition or null if not found.</returns>
+    const EOSLeaderboardDefinition* FindDefinition(const StringAnsiView& leaderboardId) const;
+
+    /// <summary>
+    /// Gets the page of the leaderboard (starting at 0). Calls back immediately if the page is cached.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool GetPage(const StringAnsiView& leaderboardId, int32 page, const RecordsCallback& callback);
+
+    /// <summary>
+    /// Gets the top records of the leaderboard. Calls back immediately if the records are cached.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool GetTop(const StringAnsiView& leaderboardId, int32 count, const RecordsCallback& callback);
+
+    /// <summary>
+    /// Gets the records around the local user (radius records above and below). Calls back immediately if the records are cached.
+    /// The local user outside of the ranked records gets the single record with the score and without the rank (queried with the stat of the leaderboard, so it requires the definitions, see QueryDefinitions).
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool GetAroundMe(const StringAnsiView& leaderboardId, int32 radius, const RecordsCallback& callback);
+
+    /// <summary>
+    /// Gets the cached page of the leaderboard. Doesn't query the missing page.
+    /// </summary>
+    /// <param name="leaderboardId">The leaderboard.</param>
+    /// <param name="page">The page (starting at 0).</param>
+    /// <param name="result">The page records.</param>
+    /// <param name="allowExpired">True to get the expired page too (eg. to show it while the new one is queried).</param>
+    /// <returns>True if the page is cached, otherwise false.</returns>
+    bool TryGetPage(const StringAnsiView& leaderboardId, int32 page, Array<EOSLeaderboardRecord>& result, bool allowExpired = false) const;
+
+    /// <summary>
+    /// Gets the amount of the ranked records of the leaderboard.
+    /// </summary>
+    /// <returns>The amount of records or -1 if the ranks weren't queried yet.</returns>
+    int32 GetRecordCount(const StringAnsiView& leaderboardId) const;
+
+    /// <summary>
+    /// Gets the rank of the local user (zero if the local user isn't ranked or the ranks weren't queried yet).
+    /// </summary>
+    uint32 GetLocalRank(const StringAnsiView& leaderboardId) const;
+
+    /// <summary>
+    /// Prefetches the page of the leaderboard on the next tick (eg. when the UI is about to scroll to it).
+    /// </summary>
+    void Prefetch(const StringAnsiView& leaderboardId, int32 page);
+
+    /// <summary>
+    /// Expires the cached ranks of the leaderboard (eg. after the local user posted the new score). The pages are kept for TryGetPage with allowExpired.
+    /// </summary>
+    void Invalidate(const StringAnsiView& leaderboardId);
+
+    /// <summary>
+    /// Removes all the cached leaderboards and cancels the pending queries (without calling their callbacks).
+    /// </summary>
+    void Clear();
+
+    /// <summary>
+    /// Copies the prefetched pages. Called on every platform tick.
+    /// </summary>
+    void Flush();
+
+private:
+    Board* GetBoard(const StringAnsiView& leaderboardId);
+    bool IsValid(const Board* board, double now) const;
+    bool Request(const StringAnsiView& leaderboardId, const RangeRequest& request);
+    bool QueryRanks(Board* board);
+    bool CopyPage(Board* board, int32 page);
+    bool Serve(Board* board, const RangeRequest& request, Array<EOSLeaderboardRecord>& result);
+    bool QueryLocalScore(const StringAnsi& leaderboardId, const RecordsCallback& callback);
+    void CompleteRanks(Board* board, EOS_EResult result);
+
+    static void EOS_CALL OnQueryDefinitionsComplete(const EOS_Leaderboards_OnQueryLeaderboardDefinitionsCompleteCallbackInfo* data);
+    static void EOS_CALL OnQueryRanksComplete(const EOS_Leaderboards_OnQueryLeaderboardRanksCompleteCallbackInfo* data);
+    static void EOS_CALL OnQueryUserScoresComplete(const EOS_Leaderboards_OnQueryLeaderboardUserScoresCompleteCallbackInfo* data);
+};
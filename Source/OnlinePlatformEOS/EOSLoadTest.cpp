@@ -0,0 +1,318 @@
+#include "EOSLoadTest.h"
+#include "EOSPlatformContext.h"
+#include "OnlinePlatformEOS.h"
+
+#include "Engine/Core/Log.h"
+#include "Engine/Core/Collections/Sorting.h"
+#include "Engine/Core/Math/Math.h"
+#include "Engine/Engine/Engine.h"
+#include "Engine/Platform/Platform.h"
+#include <EOSSDK/Include/eos_sdk.h>
+
+#include "EOSSDK/Include/eos_auth.h"
+#include "EOSSDK/Include/eos_connect.h"
+#include "EOSSDK/Include/eos_friends.h"
+#include "EOSSDK/Include/eos_userinfo.h"
+
+/// <summary>
+/// A single simulated client of the load test. Runs: Auth login (Dev Auth Tool) -> Connect login -> N x (friends query -> user info query).
+/// </summary>
+class EOSLoadTestClient
+{
+public:
+    EOSLoadTest* Owner = nullptr;
+    int32 Index = 0;
+    EOSPlatformContext Context;
+    int32 Iteration = 0;
+    double RequestTime = 0.0;
+    bool Done = false;
+
+public:
+    void Start()
+    {
+        const auto credentialName = Owner->_settings.CredentialPrefix + StringAnsi::Format("{0}", Index % Math::Max(Owner->_settings.CredentialsCount, 1));
+
+        EOS_Auth_Credentials credentials = {};
+        credentials.ApiVersion = EOS_AUTH_CREDENTIALS_API_LATEST;
+        credentials.Type = EOS_ELoginCredentialType::EOS_LCT_Developer;
+        credentials.Id = Owner->_settings.DevAuthHost.Get();
+        credentials.Token = credentialName.Get();
+
+        EOS_Auth_LoginOptions loginOptions = {};
+        loginOptions.ApiVersion = EOS_AUTH_LOGIN_API_LATEST;
+        loginOptions.ScopeFlags = EOS_EAuthScopeFlags::EOS_AS_BasicProfile | EOS_EAuthScopeFlags::EOS_AS_FriendsList | EOS_EAuthScopeFlags::EOS_AS_Presence;
+        loginOptions.Credentials = &credentials;
+
+        RequestTime = Platform::GetTimeSeconds();
+        EOS_Auth_Login(Context.GetAuth(), &loginOptions, this, &OnAuthLoginComplete);
+    }
+
+    void NextRequest()
+    {
+        if (Iteration >= Owner->_settings.IterationsPerClient)
+        {
+            Finish();
+            return;
+        }
+        EOS_Friends_QueryFriendsOptions queryOptions = {};
+        queryOptions.ApiVersion = EOS_FRIENDS_QUERYFRIENDS_API_LATEST;
+        queryOptions.LocalUserId = Context.AccountId;
+        RequestTime = Platform::GetTimeSeconds();
+        EOS_Friends_QueryFriends(Context.GetFriends(), &queryOptions, this, &OnQueryFriendsComplete);
+    }
+
+    void Finish()
+    {
+        if (Done)
+            return;
+        Done = true;
+        Owner->OnClientFinished();
+    }
+
+    bool RequestDone(EOS_EResult result, const char* name)
+    {
+        Owner->OnRequestDone(RequestTime);
+        return CheckResult(result, name);
+    }
+
+    bool CheckResult(EOS_EResult result, const char* name)
+    {
+        if (result == EOS_EResult::EOS_Success)
+            return false;
+        Owner->_failures++;
+        LOG(Warning, "EOS load test client {0} failed {1}: {2}", Index, String(name), String(EOS_EResult_ToString(result)));
+        Finish();
+        return true;
+    }
+
+    static void EOS_CALL OnAuthLoginComplete(const EOS_Auth_LoginCallbackInfo* data)
+    {
+        const auto client = (EOSLoadTestClient*)data->ClientData;
+        if (client->RequestDone(data->ResultCode, "auth login"))
+            return;
+        client->Context.AccountId = data->LocalUserId;
+
+        EOS_Auth_CopyIdTokenOptions idCopyOptions = {};
+        idCopyOptions.ApiVersion = EOS_AUTH_COPYIDTOKEN_API_LATEST;
+        idCopyOptions.AccountId = data->LocalUserId;
+        EOS_Auth_IdToken* idToken;
+        auto result = EOS_Auth_CopyIdToken(client->Context.GetAuth(), &idCopyOptions, &idToken);
+        if (client->CheckResult(result, "copy id token"))
+            return;
+
+        EOS_Connect_Credentials connectCreds = {};
+        connectCreds.ApiVersion = EOS_CONNECT_CREDENTIALS_API_LATEST;
+        connectCreds.Type = EOS_EExternalCredentialType::EOS_ECT_EPIC_ID_TOKEN;
+        connectCreds.Token = idToken->JsonWebToken;
+        EOS_Connect_LoginOptions connectLoginOptions = {};
+        connectLoginOptions.ApiVersion = EOS_CONNECT_LOGIN_API_LATEST;
+        connectLoginOptions.Credentials = &connectCreds;
+        client->RequestTime = Platform::GetTimeSeconds();
+        EOS_Connect_Login(client->Context.GetConnect(), &connectLoginOptions, client, &OnConnectLoginComplete);
+        EOS_Auth_IdToken_Release(idToken);
+    }
+
+    static void EOS_CALL OnConnectLoginComplete(const EOS_Connect_LoginCallbackInfo* data)
+    {
+        const auto client = (EOSLoadTestClient*)data->ClientData;
+        if (data->ResultCode == EOS_EResult::EOS_InvalidUser)
+        {
+            client->Owner->OnRequestDone(client->RequestTime);
+            EOS_Connect_CreateUserOptions options = {};
+            options.ApiVersion = EOS_CONNECT_CREATEUSER_API_LATEST;
+            options.ContinuanceToken = data->ContinuanceToken;
+            client->RequestTime = Platform::GetTimeSeconds();
+            EOS_Connect_CreateUser(client->Context.GetConnect(), &options, client, &OnConnectCreateUserComplete);
+            return;
+        }
+        if (client->RequestDone(data->ResultCode, "connect login"))
+            return;
+        client->Context.ProductUserId = data->LocalUserId;
+        client->NextRequest();
+    }
+
+    static void EOS_CALL OnConnectCreateUserComplete(const EOS_Connect_CreateUserCallbackInfo* data)
+    {
+        const auto client = (EOSLoadTestClient*)data->ClientData;
+        if (client->RequestDone(data->ResultCode, "create user"))
+            return;
+        client->Context.ProductUserId = data->LocalUserId;
+        client->NextRequest();
+    }
+
+    static void EOS_CALL OnQueryFriendsComplete(const EOS_Friends_QueryFriendsCallbackInfo* data)
+    {
+        const auto client = (EOSLoadTestClient*)data->ClientData;
+        if (client->RequestDone(data->ResultCode, "friends query"))
+            return;
+
+        EOS_UserInfo_QueryUserInfoOptions queryOptions = {};
+        queryOptions.ApiVersion = EOS_USERINFO_QUERYUSERINFO_API_LATEST;
+        queryOptions.LocalUserId = client->Context.AccountId;
+        queryOptions.TargetUserId = client->Context.AccountId;
+        client->RequestTime = Platform::GetTimeSeconds();
+        EOS_UserInfo_QueryUserInfo(client->Context.GetUserInfo(), &queryOptions, client, &OnQueryUserInfoComplete);
+    }
+
+    static void EOS_CALL OnQueryUserInfoComplete(const EOS_UserInfo_QueryUserInfoCallbackInfo* data)
+    {
+        const auto client = (EOSLoadTestClient*)data->ClientData;
+        if (client->RequestDone(data->ResultCode, "user info query"))
+            return;
+        client->Iteration++;
+        client->NextRequest();
+    }
+};
+
+namespace
+{
+    float GetPercentile(const Array<float>& sorted, float percentile)
+    {
+        if (sorted.IsEmpty())
+            return 0.0f;
+        const int32 index = Math::Clamp((int32)Math::Ceil(percentile * (float)sorted.Count()) - 1, 0, sorted.Count() - 1);
+        return sorted[index];
+    }
+}
+
+EOSLoadTest::EOSLoadTest(const SpawnParams& params)
+    : ScriptingObject(params)
+{
+}
+
+EOSLoadTest::~EOSLoadTest()
+{
+    Stop();
+}
+
+bool EOSLoadTest::Start(const EOSLoadTestSettings& settings)
+{
+    if (_running)
+    {
+        LOG(Warning, "EOS load test is already running.");
+        return true;
+    }
+    if (settings.ClientsCount <= 0)
+    {
+        LOG(Warning, "EOS load test requires at least one client.");
+        return true;
+    }
+    const auto eosSettings = EOSSettings::Get();
+    if (!eosSettings)
+    {
+        LOG(Error, "EOS Settings failed to load.");
+        return true;
+    }
+    if (EOSPlatformContext::InitializeSDK(*eosSettings))
+        return true;
+
+    _settings = settings;
+    _clients.Clear();
+    _clients.EnsureCapacity(settings.ClientsCount);
+    _latencies.Clear();
+    _latencies.EnsureCapacity(settings.ClientsCount * (settings.IterationsPerClient * 2 + 2));
+    _failures = 0;
+    _spawned = 0;
+    _finished = 0;
+    _startTime = Platform::GetTimeSeconds();
+    _endTime = 0.0;
+    _running = true;
+    LOG(Info, "EOS load test started with {0} clients", settings.ClientsCount);
+    Engine::LateUpdate.Bind<EOSLoadTest, &EOSLoadTest::OnUpdate>(this);
+    return false;
+}
+
+void EOSLoadTest::Stop()
+{
+    if (!_running && _clients.IsEmpty())
+        return;
+    Engine::LateUpdate.Unbind<EOSLoadTest, &EOSLoadTest::OnUpdate>(this);
+    if (_endTime <= 0.0)
+        _endTime = Platform::GetTimeSeconds();
+    _clients.ClearDelete();
+    if (_running)
+    {
+        _running = false;
+        EOSPlatformContext::ShutdownSDK();
+    }
+}
+
+EOSLoadTestReport EOSLoadTest::GetReport() const
+{
+    EOSLoadTestReport report;
+    report.ClientsSpawned = _spawned;
+    report.ClientsFinished = _finished;
+    report.Requests = _latencies.Count();
+    report.Failures = _failures;
+    const double endTime = _endTime > 0.0 ? _endTime : Platform::GetTimeSeconds();
+    report.Duration = _startTime > 0.0 ? (float)(endTime - _startTime) : 0.0f;
+    report.Throughput = report.Duration > 0.0f ? (float)report.Requests / report.Duration : 0.0f;
+
+    Array<float> sorted(_latencies);
+    Sorting::QuickSort(sorted.Get(), sorted.Count());
+    report.LatencyP50 = GetPercentile(sorted, 0.50f);
+    report.LatencyP90 = GetPercentile(sorted, 0.90f);
+    report.LatencyP99 = GetPercentile(sorted, 0.99f);
+    report.LatencyMax = sorted.HasItems() ? sorted.Last() : 0.0f;
+    return report;
+}
+
+void EOSLoadTest::OnUpdate()
+{
+    // Ramp-up clients
+    const double elapsed = Platform::GetTimeSeconds() - _startTime;
+    const int32 targetCount = Math::Min(_settings.ClientsCount, (int32)(elapsed * Math::Max(_settings.SpawnRate, 0.001f)) + 1);
+    if (_clients.Count() < targetCount)
+    {
+        const auto settings = EOSSettings::Get();
+        while (_clients.Count() < targetCount)
+        {
+            auto client = New<EOSLoadTestClient>();
+            client->Owner = this;
+            client->Index = _clients.Count();
+            _clients.Add(client);
+            _spawned++;
+
+            EOSPlatformContextOptions options;
+            options.CacheName = String::Format(TEXT("EOSLoadTest/{0}"), client->Index);
+            if (!settings || client->Context.Create(*settings, options))
+            {
+                _failures++;
+                client->Finish();
+                continue;
+            }
+            client->Start();
+        }
+    }
+
+    for (auto client : _clients)
+    {
+        if (!client->Done)
+            client->Context.Tick();
+
+        // Finished clients release their platform right away instead of keeping it until the test stops (not from its tick that runs the callbacks)
+        if (client->Done && client->Context.IsCreated())
+            client->Context.Release();
+    }
+    if (_finished < _settings.ClientsCount)
+        return;
+
+    // All the clients finished, stop before reporting so the Finished handler can start the next test
+    _endTime = Platform::GetTimeSeconds();
+    const auto report = GetReport();
+    LOG(Info, "EOS load test finished: {0} requests ({1} failed) in {2}s, {3} req/s, latency p50: {4}ms, p90: {5}ms, p99: {6}ms, max: {7}ms",
+        report.Requests, report.Failures, report.Duration, report.Throughput, report.LatencyP50, report.LatencyP90, report.LatencyP99, report.LatencyMax);
+    Stop();
+    Finished();
+}
+
+void EOSLoadTest::OnRequestDone(double startTime)
+{
+    _latencies.Add((float)((Platform::GetTimeSeconds() - startTime) * 1000.0));
+}
+
+void EOSLoadTest::OnClientFinished()
+{
+    // Completed by the update, the client may still be inside its platform tick
+    _finished++;
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "Engine/Core/Collections/Array.h"
+#include "Engine/Core/Delegate.h"
+#include "Engine/Core/Types/String.h"
+#include "Engine/Scripting/ScriptingObject.h"
+
+class EOSLoadTestClient;
+
+/// <summary>
+/// The configuration of the EOS load test.
+/// </summary>
+API_STRUCT(NoDefault, Namespace="FlaxEngine.Online.EOS") struct ONLINEPLATFORMEOS_API EOSLoadTestSettings
+{
+    DECLARE_SCRIPTING_TYPE_MINIMAL(EOSLoadTestSettings);
+
+    /// <summary>
+    /// The amount of simulated clients (each one owns a separate EOS platform instance).
+    /// </summary>
+    API_FIELD() int32 ClientsCount = 100;
+
+    /// <summary>
+    /// The amount of clients spawned per second (ramp-up rate).
+    /// </summary>
+    API_FIELD() float SpawnRate = 20.0f;
+
+    /// <summary>
+    /// The amount of workload iterations (friends query followed by the user info query) executed by every client after login.
+    /// </summary>
+    API_FIELD() int32 IterationsPerClient = 10;
+
+    /// <summary>
+    /// The host of the local EOS Developer Authentication Tool used as a stand-in for the account backend.
+    /// </summary>
+    API_FIELD() StringAnsi DevAuthHost = "localhost:6547";
+
+    /// <summary>
+    /// The prefix of the credential names registered in the EOS Developer Authentication Tool. Client N uses credential named Prefix + (N % CredentialsCount).
+    /// </summary>
+    API_FIELD() StringAnsi CredentialPrefix = "loadtest";
+
+    /// <summary>
+    /// The amount of credentials registered in the EOS Developer Authentication Tool.
+    /// </summary>
+    API_FIELD() int32 CredentialsCount = 1;
+};
+
+/// <summary>
+/// The results of the EOS load test. Latencies are in milliseconds.
+/// </summary>
+API_STRUCT(NoDefault, Namespace="FlaxEngine.Online.EOS") struct ONLINEPLATFORMEOS_API EOSLoadTestReport
+{
+    DECLARE_SCRIPTING_TYPE_MINIMAL(EOSLoadTestReport);
+
+    API_FIELD() int32 ClientsSpawned = 0;
+    API_FIELD() int32 ClientsFinished = 0;
+    API_FIELD() int32 Requests = 0;
+    API_FIELD() int32 Failures = 0;
+    API_FIELD() float Duration = 0.0f;
+    API_FIELD() float Throughput = 0.0f;
+    API_FIELD() float LatencyP50 = 0.0f;
+    API_FIELD() float LatencyP90 = 0.0f;
+    API_FIELD() float LatencyP99 = 0.0f;
+    API_FIELD() float LatencyMax = 0.0f;
+};
+
+/// <summary>
+/// Load test driver that spawns many simulated EOS clients in a single process (one EOS platform instance per client) and measures the backend throughput and latency.
+/// </summary>
+API_CLASS(Sealed, Namespace="FlaxEngine.Online.EOS") class ONLINEPLATFORMEOS_API EOSLoadTest : public ScriptingObject
+{
+    DECLARE_SCRIPTING_TYPE(EOSLoadTest);
+    friend EOSLoadTestClient;
+private:
+    EOSLoadTestSettings _settings;
+    Array<EOSLoadTestClient*> _clients;
+    Array<float> _latencies;
+    int32 _failures = 0;
+    int32 _spawned = 0;
+    int32 _finished = 0;
+    double _startTime = 0.0;
+    double _endTime = 0.0;
+    bool _running = false;
+
+public:
+    ~EOSLoadTest();
+
+    /// <summary>
+    /// Event called when all the simulated clients finished their workload. The load test is already stopped, the results stay available with GetReport.
+    /// </summary>
+    API_EVENT() Action Finished;
+
+    /// <summary>
+    /// Starts the load test.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    API_FUNCTION() bool Start(const EOSLoadTestSettings& settings);
+
+    /// <summary>
+    /// Stops the load test and releases all the simulated clients. Called automatically once all the clients finished.
+    /// </summary>
+    API_FUNCTION() void Stop();
+
+    /// <summary>
+    /// Returns true if the load test is in progress.
+    /// </summary>
+    API_PROPERTY() bool IsRunning() const
+    {
+        return _running;
+    }
+
+    /// <summary>
+    /// Gets the current results of the load test.
+    /// </summary>
+    API_FUNCTION() EOSLoadTestReport GetReport() const;
+
+private:
+    void OnUpdate();
+    void OnRequestDone(double startTime);
+    void OnClientFinished();
+};
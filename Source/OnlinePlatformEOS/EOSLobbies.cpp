@@ -0,0 +1,1245 @@
+#include "EOSLobbies.h"
+#include "EOSPlatformContext.h"
+
+#include "Engine/Core/Log.h"
+#include "Engine/Core/Math/Math.h"
+#include "Engine/Platform/Platform.h"
+#include "Engine/Threading/Threading.h"
+#include <EOSSDK/Include/eos_sdk.h>
+
+#include "EOSSDK/Include/eos_lobby.h"
+
+namespace
+{
+    // The attribute changes not acknowledged by the backend yet
+    struct AttributeChanges
+    {
+        Dictionary<StringAnsi, EOSLobbyAttribute> Set;
+        Array<StringAnsi> Removed;
+
+        bool IsEmpty() const
+        {
+            return Set.IsEmpty() && Removed.IsEmpty();
+        }
+
+        void Clear()
+        {
+            Set.Clear();
+            Removed.Clear();
+        }
+
+        bool Touches(const StringAnsi& key) const
+        {
+            return Set.ContainsKey(key) || Removed.Contains(key);
+        }
+    };
+}
+
+struct EOSLobbies::Member
+{
+    EOS_ProductUserId UserId;
+    Dictionary<StringAnsi, EOSLobbyAttribute> Attributes;
+};
+
+struct EOSLobbies::Lobby
+{
+    StringAnsi Id;
+    EOS_ProductUserId Owner = nullptr;
+    bool Leaving = false;
+
+    // The mirror of the backend state (refreshed from the notifications)
+    EOSLobbySettings Settings;
+    Dictionary<StringAnsi, EOSLobbyAttribute> Attributes;
+    Array<Member> Members;
+
+    // The local changes not sent yet
+    bool HasPendingSettings = false;
+    EOSLobbySettings PendingSettings;
+    AttributeChanges PendingAttributes;
+    AttributeChanges PendingMemberAttributes;
+
+    Operation* Update = nullptr;
+    double DirtyTime = 0.0;
+    double LastUpdateTime = 0.0;
+
+    Member* FindMember(EOS_ProductUserId userId)
+    {
+        for (Member& member : Members)
+        {
+            if (member.UserId == userId)
+                return &member;
+        }
+        return nullptr;
+    }
+};
+
+struct EOSLobbies::Operation
+{
+    EOSLobbies* Owner;
+    StringAnsi LobbyId;
+    Callback OnComplete;
+    bool Canceled = false;
+
+    // The search in progress
+    EOS_HLobbySearch Search = nullptr;
+    SearchCallback OnSearchComplete;
+
+    // The changes sent with the update (requeued if it fails with the retryable error)
+    bool HasSettings = false;
+    EOSLobbySettings Settings;
+    AttributeChanges Attributes;
+    AttributeChanges MemberAttributes;
+};
+
+namespace
+{
+    // Finds the attribute value seen by the local user: the pending changes go first, then the ones in flight and then the mirror
+    const EOSLobbyAttribute* FindAttribute(const AttributeChanges& pending, const AttributeChanges* inFlight, const Dictionary<StringAnsi, EOSLobbyAttribute>* mirror, const StringAnsi& key)
+    {
+        if (pending.Removed.Contains(key))
+            return nullptr;
+        if (const EOSLobbyAttribute* value = pending.Set.TryGet(key))
+            return value;
+        if (inFlight)
+        {
+            if (inFlight->Removed.Contains(key))
+                return nullptr;
+            if (const EOSLobbyAttribute* value = inFlight->Set.TryGet(key))
+                return value;
+        }
+        return mirror ? mirror->TryGet(key) : nullptr;
+    }
+
+    bool SetPending(AttributeChanges& pending, const AttributeChanges* inFlight, const Dictionary<StringAnsi, EOSLobbyAttribute>* mirror, const StringAnsi& key, const EOSLobbyAttribute& value)
+    {
+        const EOSLobbyAttribute* current = FindAttribute(pending, inFlight, mirror, key);
+        if (current && *current == value)
+            return false;
+        pending.Removed.Remove(key);
+        pending.Set[key] = value;
+        return true;
+    }
+
+    bool RemovePending(AttributeChanges& pending, const AttributeChanges* inFlight, const Dictionary<StringAnsi, EOSLobbyAttribute>* mirror, const StringAnsi& key)
+    {
+        if (!FindAttribute(pending, inFlight, mirror, key))
+            return false;
+        pending.Set.Remove(key);
+        pending.Removed.Add(key);
+        return true;
+    }
+
+    // Moves the changes of the failed update back to the pending ones (unless they got changed again meanwhile)
+    void Requeue(AttributeChanges& pending, const AttributeChanges& sent)
+    {
+        for (const auto& e : sent.Set)
+        {
+            if (!pending.Touches(e.Key))
+                pending.Set.Add(e.Key, e.Value);
+        }
+        for (const StringAnsi& key : sent.Removed)
+        {
+            if (!pending.Touches(key))
+                pending.Removed.Add(key);
+        }
+    }
+
+    // Applies the acknowledged changes to the mirror (the notification that follows refreshes it anyway)
+    void Commit(Dictionary<StringAnsi, EOSLobbyAttribute>& mirror, const AttributeChanges& sent)
+    {
+        for (const auto& e : sent.Set)
+            mirror[e.Key] = e.Value;
+        for (const StringAnsi& key : sent.Removed)
+            mirror.Remove(key);
+    }
+
+    void ReadLobbyAttributes(EOS_HLobbyDetails details, Dictionary<StringAnsi, EOSLobbyAttribute>& result)
+    {
+        result.Clear();
+        EOS_LobbyDetails_GetAttributeCountOptions countOptions = {};
+        countOptions.ApiVersion = EOS_LOBBYDETAILS_GETATTRIBUTECOUNT_API_LATEST;
+        const uint32 count = EOS_LobbyDetails_GetAttributeCount(details, &countOptions);
+        EOS_LobbyDetails_CopyAttributeByIndexOptions options = {};
+        options.ApiVersion = EOS_LOBBYDETAILS_COPYATTRIBUTEBYINDEX_API_LATEST;
+        for (uint32 i = 0; i < count; i++)
+        {
+            options.AttrIndex = i;
+            EOS_Lobby_Attribute* attribute;
+            if (EOS_LobbyDetails_CopyAttributeByIndex(details, &options, &attribute) != EOS_EResult::EOS_Success)
+                continue;
+            if (attribute->Data && attribute->Data->Key)
+                result[StringAnsi(attribute->Data->Key)] = EOSLobbyAttribute::FromData(*attribute->Data, attribute->Visibility);
+            EOS_Lobby_Attribute_Release(attribute);
+        }
+    }
+
+    void ReadMemberAttributes(EOS_HLobbyDetails details, EOS_ProductUserId userId, Dictionary<StringAnsi, EOSLobbyAttribute>& result)
+    {
+        result.Clear();
+        EOS_LobbyDetails_GetMemberAttributeCountOptions countOptions = {};
+        countOptions.ApiVersion = EOS_LOBBYDETAILS_GETMEMBERATTRIBUTECOUNT_API_LATEST;
+        countOptions.TargetUserId = userId;
+        const uint32 count = EOS_LobbyDetails_GetMemberAttributeCount(details, &countOptions);
+        EOS_LobbyDetails_CopyMemberAttributeByIndexOptions options = {};
+        options.ApiVersion = EOS_LOBBYDETAILS_COPYMEMBERATTRIBUTEBYINDEX_API_LATEST;
+        options.TargetUserId = userId;
+        for (uint32 i = 0; i < count; i++)
+        {
+            options.AttrIndex = i;
+            EOS_Lobby_Attribute* attribute;
+            if (EOS_LobbyDetails_CopyMemberAttributeByIndex(details, &options, &attribute) != EOS_EResult::EOS_Success)
+                continue;
+            if (attribute->Data && attribute->Data->Key)
+                result[StringAnsi(attribute->Data->Key)] = EOSLobbyAttribute::FromData(*attribute->Data, attribute->Visibility);
+            EOS_Lobby_Attribute_Release(attribute);
+        }
+    }
+
+    void ReadInfo(const EOS_LobbyDetails_Info& info, EOSLobbySettings& result)
+    {
+        result.BucketId = info.BucketId;
+        result.MaxMembers = info.MaxMembers;
+        result.PermissionLevel = info.PermissionLevel;
+        result.InvitesAllowed = info.bAllowInvites == EOS_TRUE;
+        result.HostMigrationAllowed = info.bAllowHostMigration == EOS_TRUE;
+        result.JoinByIdAllowed = info.bAllowJoinById == EOS_TRUE;
+    }
+
+    bool SetSearchParameter(EOS_HLobbySearch search, const char* key, const EOSLobbyAttribute& value, EOS_EOnlineComparisonOp comparison)
+    {
+        EOS_Lobby_AttributeData data = {};
+        value.ToData(key, data);
+        EOS_LobbySearch_SetParameterOptions options = {};
+        options.ApiVersion = EOS_LOBBYSEARCH_SETPARAMETER_API_LATEST;
+        options.Parameter = &data;
+        options.ComparisonOp = comparison;
+        const EOS_EResult result = EOS_LobbySearch_SetParameter(search, &options);
+        if (result != EOS_EResult::EOS_Success)
+        {
+            LOG(Warning, "EOS failed to set the lobby search parameter {0}: {1}", String(key), String(EOS_EResult_ToString(result)));
+            return true;
+        }
+        return false;
+    }
+}
+
+EOSLobbies::EOSLobbies(EOSPlatformContext* context)
+    : _context(context)
+{
+    _context->Ticking.Bind<EOSLobbies, &EOSLobbies::Flush>(this);
+}
+
+EOSLobbies::~EOSLobbies()
+{
+    _context->Ticking.Unbind<EOSLobbies, &EOSLobbies::Flush>(this);
+    Clear();
+    for (auto operation : _operations)
+    {
+        if (operation->Search)
+            EOS_LobbySearch_Release(operation->Search);
+    }
+    _operations.ClearDelete();
+}
+
+bool EOSLobbies::CreateLobby(const EOSLobbySettings& settings, const Callback& callback)
+{
+    ScopeLock lock(_context->Locker);
+    const auto lobbies = _context->GetLobby();
+    if (!lobbies || !_context->ProductUserId || settings.MaxMembers == 0 || settings.MaxMembers > EOS_LOBBY_MAX_LOBBY_MEMBERS || AddNotifications())
+        return true;
+    EOS_Lobby_CreateLobbyOptions options = {};
+    options.ApiVersion = EOS_LOBBY_CREATELOBBY_API_LATEST;
+    options.LocalUserId = _context->ProductUserId;
+    options.MaxLobbyMembers = settings.MaxMembers;
+    options.PermissionLevel = settings.PermissionLevel;
+    options.bPresenceEnabled = settings.PresenceEnabled ? EOS_TRUE : EOS_FALSE;
+    options.bAllowInvites = settings.InvitesAllowed ? EOS_TRUE : EOS_FALSE;
+    options.BucketId = settings.BucketId.GetText();
+    options.bDisableHostMigration = settings.HostMigrationAllowed ? EOS_FALSE : EOS_TRUE;
+    options.bEnableRTCRoom = EOS_FALSE;
+    options.bEnableJoinById = settings.JoinByIdAllowed ? EOS_TRUE : EOS_FALSE;
+    options.bRejoinAfterKickRequiresInvite = EOS_FALSE;
+    EOS_Lobby_CreateLobby(lobbies, &options, BeginOperation(StringAnsiView::Empty, callback), &EOSLobbies::OnCreateLobbyComplete);
+    return false;
+}
+
+bool EOSLobbies::Search(const EOSLobbySearch& search, const SearchCallback& callback)
+{
+    ScopeLock lock(_context->Locker);
+    const auto lobbies = _context->GetLobby();
+    if (!lobbies || !_context->ProductUserId)
+        return true;
+    EOS_Lobby_CreateLobbySearchOptions createOptions = {};
+    createOptions.ApiVersion = EOS_LOBBY_CREATELOBBYSEARCH_API_LATEST;
+    createOptions.MaxResults = Math::Clamp<uint32>(search.MaxResults, 1, EOS_LOBBY_MAX_SEARCH_RESULTS);
+    EOS_HLobbySearch handle;
+    const EOS_EResult result = EOS_Lobby_CreateLobbySearch(lobbies, &createOptions, &handle);
+    if (result != EOS_EResult::EOS_Success)
+    {
+        LOG(Warning, "EOS failed to create the lobby search: {0}", String(EOS_EResult_ToString(result)));
+        return true;
+    }
+    bool failed = false;
+    if (search.BucketId.HasChars())
+        failed |= SetSearchParameter(handle, EOS_LOBBY_SEARCH_BUCKET_ID, EOSLobbyAttribute::FromString(search.BucketId), EOS_EComparisonOp::EOS_CO_EQUAL);
+    if (search.MinSlotsAvailable != 0)
+        failed |= SetSearchParameter(handle, EOS_LOBBY_SEARCH_MINSLOTSAVAILABLE, EOSLobbyAttribute::FromInt64(search.MinSlotsAvailable), EOS_EComparisonOp::EOS_CO_GREATERTHANOREQUAL);
+    for (const EOSLobbySearchParameter& parameter : search.Parameters)
+        failed |= SetSearchParameter(handle, parameter.Key.Get(), parameter.Value, parameter.Comparison);
+    if (failed)
+    {
+        EOS_LobbySearch_Release(handle);
+        return true;
+    }
+
+    Operation* operation = BeginOperation(StringAnsiView::Empty, Callback());
+    operation->Search = handle;
+    operation->OnSearchComplete = callback;
+    EOS_LobbySearch_FindOptions options = {};
+    options.ApiVersion = EOS_LOBBYSEARCH_FIND_API_LATEST;
+    options.LocalUserId = _context->ProductUserId;
+    EOS_LobbySearch_Find(handle, &options, operation, &EOSLobbies::OnFindComplete);
+    return false;
+}
+
+bool EOSLobbies::JoinLobbyById(const StringAnsiView& lobbyId, bool presenceEnabled, const Callback& callback)
+{
+    ScopeLock lock(_context->Locker);
+    const auto lobbies = _context->GetLobby();
+    if (!lobbies || !_context->ProductUserId || lobbyId.IsEmpty() || FindLobby(lobbyId) || AddNotifications())
+        return true;
+    Operation* operation = BeginOperation(lobbyId, callback);
+    EOS_Lobby_JoinLobbyByIdOptions options = {};
+    options.ApiVersion = EOS_LOBBY_JOINLOBBYBYID_API_LATEST;
+    options.LobbyId = operation->LobbyId.Get();
+    options.LocalUserId = _context->ProductUserId;
+    options.bPresenceEnabled = presenceEnabled ? EOS_TRUE : EOS_FALSE;
+    options.LocalRTCOptions = nullptr;
+    EOS_Lobby_JoinLobbyById(lobbies, &options, operation, &EOSLobbies::OnJoinLobbyByIdComplete);
+    return false;
+}
+
+bool EOSLobbies::JoinInvite(const StringAnsiView& inviteId, bool presenceEnabled, const Callback& callback)
+{
+    ScopeLock lock(_context->Locker);
+    const auto lobbies = _context->GetLobby();
+    if (!lobbies || !_context->ProductUserId || inviteId.IsEmpty() || AddNotifications())
+        return true;
+    const StringAnsi invite(inviteId);
+    EOS_Lobby_CopyLobbyDetailsHandleByInviteIdOptions copyOptions = {};
+    copyOptions.ApiVersion = EOS_LOBBY_COPYLOBBYDETAILSHANDLEBYINVITEID_API_LATEST;
+    copyOptions.InviteId = invite.Get();
+    EOS_HLobbyDetails details;
+    const EOS_EResult result = EOS_Lobby_CopyLobbyDetailsHandleByInviteId(lobbies, &copyOptions, &details);
+    if (result != EOS_EResult::EOS_Success)
+    {
+        LOG(Warning, "EOS failed to get the lobby of invite {0}: {1}", String(invite), String(EOS_EResult_ToString(result)));
+        return true;
+    }
+    EOS_Lobby_JoinLobbyOptions options = {};
+    options.ApiVersion = EOS_LOBBY_JOINLOBBY_API_LATEST;
+    options.LobbyDetailsHandle = details;
+    options.LocalUserId = _context->ProductUserId;
+    options.bPresenceEnabled = presenceEnabled ? EOS_TRUE : EOS_FALSE;
+    options.LocalRTCOptions = nullptr;
+    EOS_Lobby_JoinLobby(lobbies, &options, BeginOperation(StringAnsiView::Empty, callback), &EOSLobbies::OnJoinLobbyComplete);
+    EOS_LobbyDetails_Release(details);
+    return false;
+}
+
+bool EOSLobbies::RejectInvite(const StringAnsiView& inviteId, const Callback& callback)
+{
+    ScopeLock lock(_context->Locker);
+    const auto lobbies = _context->GetLobby();
+    if (!lobbies || !_context->ProductUserId || inviteId.IsEmpty())
+        return true;
+    const StringAnsi invite(inviteId);
+    EOS_Lobby_RejectInviteOptions options = {};
+    options.ApiVersion = EOS_LOBBY_REJECTINVITE_API_LATEST;
+    options.InviteId = invite.Get();
+    options.LocalUserId = _context->ProductUserId;
+    EOS_Lobby_RejectInvite(lobbies, &options, BeginOperation(StringAnsiView::Empty, callback), &EOSLobbies::OnRejectInviteComplete);
+    return false;
+}
+
+bool EOSLobbies::SendInvite(const StringAnsiView& lobbyId, EOS_ProductUserId user, const Callback& callback)
+{
+    ScopeLock lock(_context->Locker);
+    const auto lobbies = _context->GetLobby();
+    Lobby* lobby = FindLobby(lobbyId);
+    if (!lobbies || !lobby || !user)
+        return true;
+    EOS_Lobby_SendInviteOptions options = {};
+    options.ApiVersion = EOS_LOBBY_SENDINVITE_API_LATEST;
+    options.LobbyId = lobby->Id.Get();
+    options.LocalUserId = _context->ProductUserId;
+    options.TargetUserId = user;
+    EOS_Lobby_SendInvite(lobbies, &options, BeginOperation(lobbyId, callback), &EOSLobbies::OnSendInviteComplete);
+    return false;
+}
+
+bool EOSLobbies::LeaveLobby(const StringAnsiView& lobbyId, bool destroy, const Callback& callback)
+{
+    ScopeLock lock(_context->Locker);
+    const auto lobbies = _context->GetLobby();
+    Lobby* lobby = FindLobby(lobbyId);
+    if (!lobbies || !lobby)
+        return true;
+    lobby->Leaving = true;
+    lobby->DirtyTime = 0.0;
+    lobby->HasPendingSettings = false;
+    lobby->PendingAttributes.Clear();
+    lobby->PendingMemberAttributes.Clear();
+    if (destroy && lobby->Owner == _context->ProductUserId)
+    {
+        EOS_Lobby_DestroyLobbyOptions options = {};
+        options.ApiVersion = EOS_LOBBY_DESTROYLOBBY_API_LATEST;
+        options.LocalUserId = _context->ProductUserId;
+        options.LobbyId = lobby->Id.Get();
+        EOS_Lobby_DestroyLobby(lobbies, &options, BeginOperation(lobbyId, callback), &EOSLobbies::OnDestroyLobbyComplete);
+    }
+    else
+    {
+        EOS_Lobby_LeaveLobbyOptions options = {};
+        options.ApiVersion = EOS_LOBBY_LEAVELOBBY_API_LATEST;
+        options.LocalUserId = _context->ProductUserId;
+        options.LobbyId = lobby->Id.Get();
+        EOS_Lobby_LeaveLobby(lobbies, &options, BeginOperation(lobbyId, callback), &EOSLobbies::OnLeaveLobbyComplete);
+    }
+    return false;
+}
+
+bool EOSLobbies::KickMember(const StringAnsiView& lobbyId, EOS_ProductUserId member, const Callback& callback)
+{
+    ScopeLock lock(_context->Locker);
+    const auto lobbies = _context->GetLobby();
+    Lobby* lobby = FindLobby(lobbyId);
+    if (!lobbies || !lobby || !member || lobby->Owner != _context->ProductUserId)
+        return true;
+    EOS_Lobby_KickMemberOptions options = {};
+    options.ApiVersion = EOS_LOBBY_KICKMEMBER_API_LATEST;
+    options.LobbyId = lobby->Id.Get();
+    options.LocalUserId = _context->ProductUserId;
+    options.TargetUserId = member;
+    EOS_Lobby_KickMember(lobbies, &options, BeginOperation(lobbyId, callback), &EOSLobbies::OnKickMemberComplete);
+    return false;
+}
+
+bool EOSLobbies::PromoteMember(const StringAnsiView& lobbyId, EOS_ProductUserId member, const Callback& callback)
+{
+    ScopeLock lock(_context->Locker);
+    const auto lobbies = _context->GetLobby();
+    Lobby* lobby = FindLobby(lobbyId);
+    if (!lobbies || !lobby || !member || lobby->Owner != _context->ProductUserId)
+        return true;
+    EOS_Lobby_PromoteMemberOptions options = {};
+    options.ApiVersion = EOS_LOBBY_PROMOTEMEMBER_API_LATEST;
+    options.LobbyId = lobby->Id.Get();
+    options.LocalUserId = _context->ProductUserId;
+    options.TargetUserId = member;
+    EOS_Lobby_PromoteMember(lobbies, &options, BeginOperation(lobbyId, callback), &EOSLobbies::OnPromoteMemberComplete);
+    return false;
+}
+
+bool EOSLobbies::SetLobbyAttribute(const StringAnsiView& lobbyId, const StringAnsiView& key, const EOSLobbyAttribute& value)
+{
+    ScopeLock lock(_context->Locker);
+    Lobby* lobby = FindLobby(lobbyId);
+    if (!lobby || lobby->Owner != _context->ProductUserId || key.IsEmpty() || key.Length() > EOS_LOBBYMODIFICATION_MAX_ATTRIBUTE_LENGTH)
+        return true;
+    const StringAnsi attributeKey(key);
+    if (!lobby->Attributes.ContainsKey(attributeKey) && lobby->Attributes.Count() + lobby->PendingAttributes.Set.Count() >= EOS_LOBBYMODIFICATION_MAX_ATTRIBUTES)
+    {
+        LOG(Warning, "EOS lobby {0} has too many attributes to add {1}.", String(lobby->Id), String(attributeKey));
+        return true;
+    }
+    const AttributeChanges* inFlight = lobby->Update ? &lobby->Update->Attributes : nullptr;
+    if (SetPending(lobby->PendingAttributes, inFlight, &lobby->Attributes, attributeKey, value))
+        MarkDirty(lobby, Platform::GetTimeSeconds());
+    return false;
+}
+
+bool EOSLobbies::RemoveLobbyAttribute(const StringAnsiView& lobbyId, const StringAnsiView& key)
+{
+    ScopeLock lock(_context->Locker);
+    Lobby* lobby = FindLobby(lobbyId);
+    if (!lobby || lobby->Owner != _context->ProductUserId)
+        return true;
+    const AttributeChanges* inFlight = lobby->Update ? &lobby->Update->Attributes : nullptr;
+    if (RemovePending(lobby->PendingAttributes, inFlight, &lobby->Attributes, StringAnsi(key)))
+        MarkDirty(lobby, Platform::GetTimeSeconds());
+    return false;
+}
+
+bool EOSLobbies::SetMemberAttribute(const StringAnsiView& lobbyId, const StringAnsiView& key, const EOSLobbyAttribute& value)
+{
+    ScopeLock lock(_context->Locker);
+    Lobby* lobby = FindLobby(lobbyId);
+    if (!lobby || key.IsEmpty() || key.Length() > EOS_LOBBYMODIFICATION_MAX_ATTRIBUTE_LENGTH)
+        return true;
+    const Member* member = lobby->FindMember(_context->ProductUserId);
+    const AttributeChanges* inFlight = lobby->Update ? &lobby->Update->MemberAttributes : nullptr;
+    if (SetPending(lobby->PendingMemberAttributes, inFlight, member ? &member->Attributes : nullptr, StringAnsi(key), value))
+        MarkDirty(lobby, Platform::GetTimeSeconds());
+    return false;
+}
+
+bool EOSLobbies::RemoveMemberAttribute(const StringAnsiView& lobbyId, const StringAnsiView& key)
+{
+    ScopeLock lock(_context->Locker);
+    Lobby* lobby = FindLobby(lobbyId);
+    if (!lobby)
+        return true;
+    const Member* member = lobby->FindMember(_context->ProductUserId);
+    const AttributeChanges* inFlight = lobby->Update ? &lobby->Update->MemberAttributes : nullptr;
+    if (RemovePending(lobby->PendingMemberAttributes, inFlight, member ? &member->Attributes : nullptr, StringAnsi(key)))
+        MarkDirty(lobby, Platform::GetTimeSeconds());
+    return false;
+}
+
+bool EOSLobbies::SetSettings(const StringAnsiView& lobbyId, const EOSLobbySettings& settings)
+{
+    ScopeLock lock(_context->Locker);
+    Lobby* lobby = FindLobby(lobbyId);
+    if (!lobby || lobby->Owner != _context->ProductUserId || settings.MaxMembers == 0 || settings.MaxMembers > EOS_LOBBY_MAX_LOBBY_MEMBERS)
+        return true;
+    EOSLobbySettings current;
+    GetSettings(lobbyId, current);
+    if (current.UpdatableEquals(settings))
+        return false;
+    lobby->PendingSettings = settings;
+    lobby->HasPendingSettings = true;
+    MarkDirty(lobby, Platform::GetTimeSeconds());
+    return false;
+}
+
+bool EOSLobbies::GetLobbyAttribute(const StringAnsiView& lobbyId, const StringAnsiView& key, EOSLobbyAttribute& result)
+{
+    ScopeLock lock(_context->Locker);
+    Lobby* lobby = FindLobby(lobbyId);
+    if (!lobby)
+        return false;
+    const AttributeChanges* inFlight = lobby->Update ? &lobby->Update->Attributes : nullptr;
+    const EOSLobbyAttribute* value = FindAttribute(lobby->PendingAttributes, inFlight, &lobby->Attributes, StringAnsi(key));
+    if (!value)
+        return false;
+    result = *value;
+    return true;
+}
+
+bool EOSLobbies::GetMemberAttribute(const StringAnsiView& lobbyId, EOS_ProductUserId member, const StringAnsiView& key, EOSLobbyAttribute& result)
+{
+    ScopeLock lock(_context->Locker);
+    Lobby* lobby = FindLobby(lobbyId);
+    if (!lobby)
+        return false;
+    const Member* entry = lobby->FindMember(member);
+    const EOSLobbyAttribute* value;
+    if (member == _context->ProductUserId)
+    {
+        const AttributeChanges* inFlight = lobby->Update ? &lobby->Update->MemberAttributes : nullptr;
+        value = FindAttribute(lobby->PendingMemberAttributes, inFlight, entry ? &entry->Attributes : nullptr, StringAnsi(key));
+    }
+    else
+    {
+        value = entry ? entry->Attributes.TryGet(StringAnsi(key)) : nullptr;
+    }
+    if (!value)
+        return false;
+    result = *value;
+    return true;
+}
+
+bool EOSLobbies::GetSettings(const StringAnsiView& lobbyId, EOSLobbySettings& result)
+{
+    ScopeLock lock(_context->Locker);
+    Lobby* lobby = FindLobby(lobbyId);
+    if (!lobby)
+        return false;
+    if (lobby->HasPendingSettings)
+        result = lobby->PendingSettings;
+    else if (lobby->Update && lobby->Update->HasSettings)
+        result = lobby->Update->Settings;
+    else
+        result = lobby->Settings;
+    return true;
+}
+
+bool EOSLobbies::GetMembers(const StringAnsiView& lobbyId, Array<EOS_ProductUserId>& result)
+{
+    ScopeLock lock(_context->Locker);
+    Lobby* lobby = FindLobby(lobbyId);
+    if (!lobby)
+        return false;
+    result.Clear();
+    for (const Member& member : lobby->Members)
+        result.Add(member.UserId);
+    return true;
+}
+
+EOS_ProductUserId EOSLobbies::GetOwner(const StringAnsiView& lobbyId)
+{
+    ScopeLock lock(_context->Locker);
+    Lobby* lobby = FindLobby(lobbyId);
+    return lobby ? lobby->Owner : nullptr;
+}
+
+void EOSLobbies::GetLobbies(Array<StringAnsi>& result)
+{
+    ScopeLock lock(_context->Locker);
+    result.Clear();
+    for (const auto& e : _lobbies)
+    {
+        if (!e.Value->Leaving)
+            result.Add(e.Key);
+    }
+}
+
+int64 EOSLobbies::GetUpdateCount()
+{
+    ScopeLock lock(_context->Locker);
+    return _updateCount;
+}
+
+int64 EOSLobbies::GetChangeCount()
+{
+    ScopeLock lock(_context->Locker);
+    return _changeCount;
+}
+
+void EOSLobbies::Clear()
+{
+    ScopeLock lock(_context->Locker);
+    RemoveNotifications();
+    for (auto& e : _lobbies)
+        Delete(e.Value);
+    _lobbies.Clear();
+
+    // Operations are owned by the SDK callbacks that may still be in-flight
+    for (auto operation : _operations)
+        operation->Canceled = true;
+}
+
+void EOSLobbies::Flush()
+{
+    ScopeLock lock(_context->Locker);
+
+    // Invites can arrive before any lobby gets created or joined
+    if (_lobbyUpdateId == EOS_INVALID_NOTIFICATIONID && !_notificationsFailed && !_context->IsServer)
+        AddNotifications();
+    if (_lobbies.IsEmpty())
+        return;
+    const double now = Platform::GetTimeSeconds();
+    const double window = (double)UpdateWindow;
+    for (auto& e : _lobbies)
+    {
+        Lobby* lobby = e.Value;
+        if (lobby->Leaving || lobby->Update || lobby->DirtyTime <= 0.0)
+            continue;
+        if (now >= Math::Max(lobby->DirtyTime, lobby->LastUpdateTime) + window && SendUpdate(lobby))
+        {
+            // Try again in the next window
+            lobby->DirtyTime = now;
+        }
+    }
+}
+
+bool EOSLobbies::AddNotifications()
+{
+    if (_lobbyUpdateId != EOS_INVALID_NOTIFICATIONID)
+        return false;
+    const auto lobbies = _context->GetLobby();
+    if (!lobbies)
+        return true;
+    {
+        EOS_Lobby_AddNotifyLobbyUpdateReceivedOptions options = {};
+        options.ApiVersion = EOS_LOBBY_ADDNOTIFYLOBBYUPDATERECEIVED_API_LATEST;
+        _lobbyUpdateId = EOS_Lobby_AddNotifyLobbyUpdateReceived(lobbies, &options, this, &EOSLobbies::OnLobbyUpdateReceived);
+    }
+    {
+        EOS_Lobby_AddNotifyLobbyMemberUpdateReceivedOptions options = {};
+        options.ApiVersion = EOS_LOBBY_ADDNOTIFYLOBBYMEMBERUPDATERECEIVED_API_LATEST;
+        _memberUpdateId = EOS_Lobby_AddNotifyLobbyMemberUpdateReceived(lobbies, &options, this, &EOSLobbies::OnMemberUpdateReceived);
+    }
+    {
+        EOS_Lobby_AddNotifyLobbyMemberStatusReceivedOptions options = {};
+        options.ApiVersion = EOS_LOBBY_ADDNOTIFYLOBBYMEMBERSTATUSRECEIVED_API_LATEST;
+        _memberStatusId = EOS_Lobby_AddNotifyLobbyMemberStatusReceived(lobbies, &options, this, &EOSLobbies::OnMemberStatusReceived);
+    }
+    {
+        EOS_Lobby_AddNotifyLobbyInviteReceivedOptions options = {};
+        options.ApiVersion = EOS_LOBBY_ADDNOTIFYLOBBYINVITERECEIVED_API_LATEST;
+        _inviteReceivedId = EOS_Lobby_AddNotifyLobbyInviteReceived(lobbies, &options, this, &EOSLobbies::OnInviteReceived);
+    }
+    {
+        EOS_Lobby_AddNotifyLobbyInviteAcceptedOptions options = {};
+        options.ApiVersion = EOS_LOBBY_ADDNOTIFYLOBBYINVITEACCEPTED_API_LATEST;
+        _inviteAcceptedId = EOS_Lobby_AddNotifyLobbyInviteAccepted(lobbies, &options, this, &EOSLobbies::OnInviteAccepted);
+    }
+    if (_lobbyUpdateId == EOS_INVALID_NOTIFICATIONID || _memberUpdateId == EOS_INVALID_NOTIFICATIONID || _memberStatusId == EOS_INVALID_NOTIFICATIONID)
+    {
+        // The mirror can't be kept up to date without them
+        LOG(Warning, "EOS failed to add the lobby notifications.");
+        RemoveNotifications();
+        _notificationsFailed = true;
+        return true;
+    }
+    _notificationsFailed = false;
+    return false;
+}
+
+void EOSLobbies::RemoveNotifications()
+{
+    const auto lobbies = _context->GetLobby();
+    if (!lobbies)
+    {
+        _lobbyUpdateId = _memberUpdateId = _memberStatusId = _inviteReceivedId = _inviteAcceptedId = EOS_INVALID_NOTIFICATIONID;
+        return;
+    }
+    if (_lobbyUpdateId != EOS_INVALID_NOTIFICATIONID)
+    {
+        EOS_Lobby_RemoveNotifyLobbyUpdateReceived(lobbies, _lobbyUpdateId);
+        _lobbyUpdateId = EOS_INVALID_NOTIFICATIONID;
+    }
+    if (_memberUpdateId != EOS_INVALID_NOTIFICATIONID)
+    {
+        EOS_Lobby_RemoveNotifyLobbyMemberUpdateReceived(lobbies, _memberUpdateId);
+        _memberUpdateId = EOS_INVALID_NOTIFICATIONID;
+    }
+    if (_memberStatusId != EOS_INVALID_NOTIFICATIONID)
+    {
+        EOS_Lobby_RemoveNotifyLobbyMemberStatusReceived(lobbies, _memberStatusId);
+        _memberStatusId = EOS_INVALID_NOTIFICATIONID;
+    }
+    if (_inviteReceivedId != EOS_INVALID_NOTIFICATIONID)
+    {
+        EOS_Lobby_RemoveNotifyLobbyInviteReceived(lobbies, _inviteReceivedId);
+        _inviteReceivedId = EOS_INVALID_NOTIFICATIONID;
+    }
+    if (_inviteAcceptedId != EOS_INVALID_NOTIFICATIONID)
+    {
+        EOS_Lobby_RemoveNotifyLobbyInviteAccepted(lobbies, _inviteAcceptedId);
+        _inviteAcceptedId = EOS_INVALID_NOTIFICATIONID;
+    }
+}
+
+EOSLobbies::Lobby* EOSLobbies::FindLobby(const StringAnsiView& lobbyId)
+{
+    Lobby* lobby;
+    if (!_lobbies.TryGet(StringAnsi(lobbyId), lobby) || lobby->Leaving)
+        return nullptr;
+    return lobby;
+}
+
+EOSLobbies::Lobby* EOSLobbies::AddLobby(const char* lobbyId, bool isOwner)
+{
+    const StringAnsi id(lobbyId);
+    Lobby* lobby;
+    if (!_lobbies.TryGet(id, lobby))
+    {
+        lobby = New<Lobby>();
+        lobby->Id = id;
+        _lobbies[id] = lobby;
+    }
+    if (isOwner)
+        lobby->Owner = _context->ProductUserId;
+    RefreshLobby(lobby, nullptr);
+    return lobby;
+}
+
+void EOSLobbies::MarkDirty(Lobby* lobby, double now)
+{
+    _changeCount++;
+    if (lobby->DirtyTime <= 0.0)
+        lobby->DirtyTime = now;
+}
+
+bool EOSLobbies::SendUpdate(Lobby* lobby)
+{
+    const auto lobbies = _context->GetLobby();
+    if (!lobbies)
+        return true;
+    EOS_Lobby_UpdateLobbyModificationOptions modificationOptions = {};
+    modificationOptions.ApiVersion = EOS_LOBBY_UPDATELOBBYMODIFICATION_API_LATEST;
+    modificationOptions.LocalUserId = _context->ProductUserId;
+    modificationOptions.LobbyId = lobby->Id.Get();
+    EOS_HLobbyModification modification;
+    const EOS_EResult result = EOS_Lobby_UpdateLobbyModification(lobbies, &modificationOptions, &modification);
+    if (result != EOS_EResult::EOS_Success)
+    {
+        LOG(Warning, "EOS failed to modify lobby {0}: {1}", String(lobby->Id), String(EOS_EResult_ToString(result)));
+        return true;
+    }
+
+    const int32 changes = ApplyChanges(lobby, modification);
+    if (changes <= 0)
+    {
+        // Nothing to send if the changes got reverted within the window
+        EOS_LobbyModification_Release(modification);
+        if (changes < 0)
+            return true;
+        lobby->HasPendingSettings = false;
+        lobby->PendingAttributes.Clear();
+        lobby->PendingMemberAttributes.Clear();
+        lobby->DirtyTime = 0.0;
+        return false;
+    }
+
+    // The sent changes stay visible to the reads until they get acknowledged
+    Operation* operation = BeginOperation(lobby->Id, Callback());
+    operation->HasSettings = lobby->HasPendingSettings;
+    operation->Settings = lobby->PendingSettings;
+    operation->Attributes = MoveTemp(lobby->PendingAttributes);
+    operation->MemberAttributes = MoveTemp(lobby->PendingMemberAttributes);
+    lobby->HasPendingSettings = false;
+    lobby->PendingAttributes.Clear();
+    lobby->PendingMemberAttributes.Clear();
+    lobby->Update = operation;
+    lobby->DirtyTime = 0.0;
+    lobby->LastUpdateTime = Platform::GetTimeSeconds();
+    _updateCount++;
+
+    EOS_Lobby_UpdateLobbyOptions options = {};
+    options.ApiVersion = EOS_LOBBY_UPDATELOBBY_API_LATEST;
+    options.LobbyModificationHandle = modification;
+    EOS_Lobby_UpdateLobby(lobbies, &options, operation, &EOSLobbies::OnUpdateLobbyComplete);
+    EOS_LobbyModification_Release(modification);
+    return false;
+}
+
+int32 EOSLobbies::ApplyChanges(Lobby* lobby, EOS_HLobbyModification modification)
+{
+    int32 changes = 0;
+    if (lobby->HasPendingSettings)
+    {
+        const EOSLobbySettings& settings = lobby->PendingSettings;
+        const EOSLobbySettings& current = lobby->Settings;
+        if (settings.BucketId != current.BucketId)
+        {
+            EOS_LobbyModification_SetBucketIdOptions options = {};
+            options.ApiVersion = EOS_LOBBYMODIFICATION_SETBUCKETID_API_LATEST;
+            options.BucketId = settings.BucketId.GetText();
+            if (EOSModification::CheckResult(EOS_LobbyModification_SetBucketId(modification, &options), "set the bucket id", "lobby"))
+                return -1;
+            changes++;
+        }
+        if (settings.MaxMembers != current.MaxMembers)
+        {
+            EOS_LobbyModification_SetMaxMembersOptions options = {};
+            options.ApiVersion = EOS_LOBBYMODIFICATION_SETMAXMEMBERS_API_LATEST;
+            options.MaxMembers = settings.MaxMembers;
+            if (EOSModification::CheckResult(EOS_LobbyModification_SetMaxMembers(modification, &options), "set the max members", "lobby"))
+                return -1;
+            changes++;
+        }
+        if (settings.PermissionLevel != current.PermissionLevel)
+        {
+            EOS_LobbyModification_SetPermissionLevelOptions options = {};
+            options.ApiVersion = EOS_LOBBYMODIFICATION_SETPERMISSIONLEVEL_API_LATEST;
+            options.PermissionLevel = settings.PermissionLevel;
+            if (EOSModification::CheckResult(EOS_LobbyModification_SetPermissionLevel(modification, &options), "set the permission level", "lobby"))
+                return -1;
+            changes++;
+        }
+        if (settings.InvitesAllowed != current.InvitesAllowed)
+        {
+            EOS_LobbyModification_SetInvitesAllowedOptions options = {};
+            options.ApiVersion = EOS_LOBBYMODIFICATION_SETINVITESALLOWED_API_LATEST;
+            options.bInvitesAllowed = settings.InvitesAllowed ? EOS_TRUE : EOS_FALSE;
+            if (EOSModification::CheckResult(EOS_LobbyModification_SetInvitesAllowed(modification, &options), "set the invites", "lobby"))
+                return -1;
+            changes++;
+        }
+    }
+
+    // Values set back to the mirrored ones within the window are skipped
+    for (const auto& e : lobby->PendingAttributes.Set)
+    {
+        const EOSLobbyAttribute* current = lobby->Attributes.TryGet(e.Key);
+        if (current && *current == e.Value)
+            continue;
+        EOS_Lobby_AttributeData data = {};
+        e.Value.ToData(e.Key.Get(), data);
+        EOS_LobbyModification_AddAttributeOptions options = {};
+        options.ApiVersion = EOS_LOBBYMODIFICATION_ADDATTRIBUTE_API_LATEST;
+        options.Attribute = &data;
+        options.Visibility = e.Value.Visibility;
+        if (EOSModification::CheckResult(EOS_LobbyModification_AddAttribute(modification, &options), "add the attribute", "lobby"))
+            return -1;
+        changes++;
+    }
+    for (const StringAnsi& key : lobby->PendingAttributes.Removed)
+    {
+        if (!lobby->Attributes.ContainsKey(key))
+            continue;
+        EOS_LobbyModification_RemoveAttributeOptions options = {};
+        options.ApiVersion = EOS_LOBBYMODIFICATION_REMOVEATTRIBUTE_API_LATEST;
+        options.Key = key.Get();
+        if (EOSModification::CheckResult(EOS_LobbyModification_RemoveAttribute(modification, &options), "remove the attribute", "lobby"))
+            return -1;
+        changes++;
+    }
+
+    const Member* member = lobby->FindMember(_context->ProductUserId);
+    for (const auto& e : lobby->PendingMemberAttributes.Set)
+    {
+        const EOSLobbyAttribute* current = member ? member->Attributes.TryGet(e.Key) : nullptr;
+        if (current && *current == e.Value)
+            continue;
+        EOS_Lobby_AttributeData data = {};
+        e.Value.ToData(e.Key.Get(), data);
+        EOS_LobbyModification_AddMemberAttributeOptions options = {};
+        options.ApiVersion = EOS_LOBBYMODIFICATION_ADDMEMBERATTRIBUTE_API_LATEST;
+        options.Attribute = &data;
+        options.Visibility = e.Value.Visibility;
+        if (EOSModification::CheckResult(EOS_LobbyModification_AddMemberAttribute(modification, &options), "add the member attribute", "lobby"))
+            return -1;
+        changes++;
+    }
+    for (const StringAnsi& key : lobby->PendingMemberAttributes.Removed)
+    {
+        if (!member || !member->Attributes.ContainsKey(key))
+            continue;
+        EOS_LobbyModification_RemoveMemberAttributeOptions options = {};
+        options.ApiVersion = EOS_LOBBYMODIFICATION_REMOVEMEMBERATTRIBUTE_API_LATEST;
+        options.Key = key.Get();
+        if (EOSModification::CheckResult(EOS_LobbyModification_RemoveMemberAttribute(modification, &options), "remove the member attribute", "lobby"))
+            return -1;
+        changes++;
+    }
+    return changes;
+}
+
+bool EOSLobbies::RefreshLobby(Lobby* lobby, EOS_ProductUserId member)
+{
+    // The only place that copies the lobby details, reads use the mirror
+    EOS_Lobby_CopyLobbyDetailsHandleOptions options = {};
+    options.ApiVersion = EOS_LOBBY_COPYLOBBYDETAILSHANDLE_API_LATEST;
+    options.LobbyId = lobby->Id.Get();
+    options.LocalUserId = _context->ProductUserId;
+    EOS_HLobbyDetails details;
+    const EOS_EResult result = EOS_Lobby_CopyLobbyDetailsHandle(_context->GetLobby(), &options, &details);
+    if (result != EOS_EResult::EOS_Success)
+    {
+        LOG(Warning, "EOS failed to get the details of lobby {0}: {1}", String(lobby->Id), String(EOS_EResult_ToString(result)));
+        return true;
+    }
+
+    if (member)
+    {
+        Member* entry = lobby->FindMember(member);
+        if (!entry)
+        {
+            entry = &lobby->Members.AddOne();
+            entry->UserId = member;
+        }
+        ReadMemberAttributes(details, member, entry->Attributes);
+    }
+    else
+    {
+        EOS_LobbyDetails_CopyInfoOptions infoOptions = {};
+        infoOptions.ApiVersion = EOS_LOBBYDETAILS_COPYINFO_API_LATEST;
+        EOS_LobbyDetails_Info* info;
+        if (EOS_LobbyDetails_CopyInfo(details, &infoOptions, &info) == EOS_EResult::EOS_Success)
+        {
+            lobby->Owner = info->LobbyOwnerUserId;
+            ReadInfo(*info, lobby->Settings);
+            EOS_LobbyDetails_Info_Release(info);
+        }
+        ReadLobbyAttributes(details, lobby->Attributes);
+
+        EOS_LobbyDetails_GetMemberCountOptions countOptions = {};
+        countOptions.ApiVersion = EOS_LOBBYDETAILS_GETMEMBERCOUNT_API_LATEST;
+        const uint32 count = EOS_LobbyDetails_GetMemberCount(details, &countOptions);
+        EOS_LobbyDetails_GetMemberByIndexOptions memberOptions = {};
+        memberOptions.ApiVersion = EOS_LOBBYDETAILS_GETMEMBERBYINDEX_API_LATEST;
+        lobby->Members.Resize(count);
+        for (uint32 i = 0; i < count; i++)
+        {
+            memberOptions.MemberIndex = i;
+            Member& entry = lobby->Members[i];
+            entry.UserId = EOS_LobbyDetails_GetMemberByIndex(details, &memberOptions);
+            ReadMemberAttributes(details, entry.UserId, entry.Attributes);
+        }
+    }
+    EOS_LobbyDetails_Release(details);
+    return false;
+}
+
+EOSLobbies::Operation* EOSLobbies::BeginOperation(const StringAnsiView& lobbyId, const Callback& callback)
+{
+    auto operation = New<Operation>();
+    operation->Owner = this;
+    operation->LobbyId = lobbyId;
+    operation->OnComplete = callback;
+    _operations.Add(operation);
+    return operation;
+}
+
+void EOSLobbies::EndOperation(Operation* operation, EOS_EResult result, const char* lobbyId)
+{
+    _operations.Remove(operation);
+    if (operation->Search)
+        EOS_LobbySearch_Release(operation->Search);
+    if (!operation->Canceled && operation->OnComplete.IsBinded())
+        operation->OnComplete(result, lobbyId ? StringAnsi(lobbyId) : operation->LobbyId);
+    Delete(operation);
+}
+
+void EOSLobbies::OnCreateLobbyComplete(const EOS_Lobby_CreateLobbyCallbackInfo* data)
+{
+    const auto operation = (Operation*)data->ClientData;
+    if (data->ResultCode != EOS_EResult::EOS_Success)
+        LOG(Warning, "EOS failed to create lobby: {0}", String(EOS_EResult_ToString(data->ResultCode)));
+    else if (!operation->Canceled)
+        operation->Owner->AddLobby(data->LobbyId, true);
+    operation->Owner->EndOperation(operation, data->ResultCode, data->LobbyId);
+}
+
+void EOSLobbies::OnFindComplete(const EOS_LobbySearch_FindCallbackInfo* data)
+{
+    const auto operation = (Operation*)data->ClientData;
+    Array<EOSLobbySearchResult> results;
+    if (data->ResultCode != EOS_EResult::EOS_Success && data->ResultCode != EOS_EResult::EOS_NotFound)
+    {
+        LOG(Warning, "EOS failed to find lobbies: {0}", String(EOS_EResult_ToString(data->ResultCode)));
+    }
+    else if (!operation->Canceled)
+    {
+        EOS_LobbySearch_GetSearchResultCountOptions countOptions = {};
+        countOptions.ApiVersion = EOS_LOBBYSEARCH_GETSEARCHRESULTCOUNT_API_LATEST;
+        const uint32 count = EOS_LobbySearch_GetSearchResultCount(operation->Search, &countOptions);
+        results.EnsureCapacity((int32)count);
+        EOS_LobbySearch_CopySearchResultByIndexOptions options = {};
+        options.ApiVersion = EOS_LOBBYSEARCH_COPYSEARCHRESULTBYINDEX_API_LATEST;
+        for (uint32 i = 0; i < count; i++)
+        {
+            options.LobbyIndex = i;
+            EOS_HLobbyDetails details;
+            if (EOS_LobbySearch_CopySearchResultByIndex(operation->Search, &options, &details) != EOS_EResult::EOS_Success)
+                continue;
+            EOS_LobbyDetails_CopyInfoOptions infoOptions = {};
+            infoOptions.ApiVersion = EOS_LOBBYDETAILS_COPYINFO_API_LATEST;
+            EOS_LobbyDetails_Info* info;
+            if (EOS_LobbyDetails_CopyInfo(details, &infoOptions, &info) == EOS_EResult::EOS_Success)
+            {
+                EOSLobbySearchResult& result = results.AddOne();
+                result.LobbyId = info->LobbyId;
+                result.Owner = info->LobbyOwnerUserId;
+                result.BucketId = info->BucketId;
+                result.MaxMembers = info->MaxMembers;
+                result.AvailableSlots = info->AvailableSlots;
+                ReadLobbyAttributes(details, result.Attributes);
+                EOS_LobbyDetails_Info_Release(info);
+            }
+            EOS_LobbyDetails_Release(details);
+        }
+    }
+
+    // No matches is not an error for the caller
+    const EOS_EResult result = data->ResultCode == EOS_EResult::EOS_NotFound ? EOS_EResult::EOS_Success : data->ResultCode;
+    if (!operation->Canceled && operation->OnSearchComplete.IsBinded())
+        operation->OnSearchComplete(result, results);
+    operation->Owner->EndOperation(operation, result);
+}
+
+void EOSLobbies::OnJoinLobbyByIdComplete(const EOS_Lobby_JoinLobbyByIdCallbackInfo* data)
+{
+    const auto operation = (Operation*)data->ClientData;
+    if (data->ResultCode != EOS_EResult::EOS_Success)
+        LOG(Warning, "EOS failed to join lobby {0}: {1}", String(operation->LobbyId), String(EOS_EResult_ToString(data->ResultCode)));
+    else if (!operation->Canceled)
+        operation->Owner->AddLobby(data->LobbyId, false);
+    operation->Owner->EndOperation(operation, data->ResultCode, data->LobbyId);
+}
+
+void EOSLobbies::OnJoinLobbyComplete(const EOS_Lobby_JoinLobbyCallbackInfo* data)
+{
+    const auto operation = (Operation*)data->ClientData;
+    if (data->ResultCode != EOS_EResult::EOS_Success)
+        LOG(Warning, "EOS failed to join lobby: {0}", String(EOS_EResult_ToString(data->ResultCode)));
+    else if (!operation->Canceled)
+        operation->Owner->AddLobby(data->LobbyId, false);
+    operation->Owner->EndOperation(operation, data->ResultCode, data->LobbyId);
+}
+
+void EOSLobbies::OnRejectInviteComplete(const EOS_Lobby_RejectInviteCallbackInfo* data)
+{
+    const auto operation = (Operation*)data->ClientData;
+    if (data->ResultCode != EOS_EResult::EOS_Success)
+        LOG(Warning, "EOS failed to reject lobby invite: {0}", String(EOS_EResult_ToString(data->ResultCode)));
+    operation->Owner->EndOperation(operation, data->ResultCode);
+}
+
+void EOSLobbies::OnSendInviteComplete(const EOS_Lobby_SendInviteCallbackInfo* data)
+{
+    const auto operation = (Operation*)data->ClientData;
+    if (data->ResultCode != EOS_EResult::EOS_Success)
+        LOG(Warning, "EOS failed to send invite to lobby {0}: {1}", String(operation->LobbyId), String(EOS_EResult_ToString(data->ResultCode)));
+    operation->Owner->EndOperation(operation, data->ResultCode);
+}
+
+void EOSLobbies::OnLeaveLobbyComplete(const EOS_Lobby_LeaveLobbyCallbackInfo* data)
+{
+    const auto operation = (Operation*)data->ClientData;
+    const auto owner = operation->Owner;
+    Lobby* lobby;
+    if (data->ResultCode != EOS_EResult::EOS_Success)
+        LOG(Warning, "EOS failed to leave lobby {0}: {1}", String(operation->LobbyId), String(EOS_EResult_ToString(data->ResultCode)));
+
+    // The lobby is gone locally even if the backend failed (the member times out there on its own)
+    if (!operation->Canceled && owner->_lobbies.TryGet(operation->LobbyId, lobby) && lobby->Leaving)
+    {
+        owner->_lobbies.Remove(operation->LobbyId);
+        Delete(lobby);
+    }
+    owner->EndOperation(operation, data->ResultCode);
+}
+
+void EOSLobbies::OnDestroyLobbyComplete(const EOS_Lobby_DestroyLobbyCallbackInfo* data)
+{
+    const auto operation = (Operation*)data->ClientData;
+    const auto owner = operation->Owner;
+    Lobby* lobby;
+    if (data->ResultCode != EOS_EResult::EOS_Success)
+        LOG(Warning, "EOS failed to destroy lobby {0}: {1}", String(operation->LobbyId), String(EOS_EResult_ToString(data->ResultCode)));
+    if (!operation->Canceled && owner->_lobbies.TryGet(operation->LobbyId, lobby) && lobby->Leaving)
+    {
+        owner->_lobbies.Remove(operation->LobbyId);
+        Delete(lobby);
+    }
+    owner->EndOperation(operation, data->ResultCode);
+}
+
+void EOSLobbies::OnKickMemberComplete(const EOS_Lobby_KickMemberCallbackInfo* data)
+{
+    const auto operation = (Operation*)data->ClientData;
+    if (data->ResultCode != EOS_EResult::EOS_Success)
+        LOG(Warning, "EOS failed to kick member from lobby {0}: {1}", String(operation->LobbyId), String(EOS_EResult_ToString(data->ResultCode)));
+    operation->Owner->EndOperation(operation, data->ResultCode);
+}
+
+void EOSLobbies::OnPromoteMemberComplete(const EOS_Lobby_PromoteMemberCallbackInfo* data)
+{
+    const auto operation = (Operation*)data->ClientData;
+    if (data->ResultCode != EOS_EResult::EOS_Success)
+        LOG(Warning, "EOS failed to promote member of lobby {0}: {1}", String(operation->LobbyId), String(EOS_EResult_ToString(data->ResultCode)));
+    operation->Owner->EndOperation(operation, data->ResultCode);
+}
+
+void EOSLobbies::OnUpdateLobbyComplete(const EOS_Lobby_UpdateLobbyCallbackInfo* data)
+{
+    const auto operation = (Operation*)data->ClientData;
+    const auto owner = operation->Owner;
+    const EOS_EResult result = data->ResultCode;
+    Lobby* lobby;
+    if (!operation->Canceled && owner->_lobbies.TryGet(operation->LobbyId, lobby) && lobby->Update == operation)
+    {
+        lobby->Update = nullptr;
+        if (result == EOS_EResult::EOS_Success)
+        {
+            if (operation->HasSettings)
+            {
+                lobby->Settings.BucketId = operation->Settings.BucketId;
+                lobby->Settings.MaxMembers = operation->Settings.MaxMembers;
+                lobby->Settings.PermissionLevel = operation->Settings.PermissionLevel;
+                lobby->Settings.InvitesAllowed = operation->Settings.InvitesAllowed;
+            }
+            Commit(lobby->Attributes, operation->Attributes);
+            Member* member = lobby->FindMember(owner->_context->ProductUserId);
+            if (member)
+                Commit(member->Attributes, operation->MemberAttributes);
+        }
+        else if (lobby->Leaving)
+        {
+            // The changes are dropped with the lobby
+        }
+        else if (EOSModification::IsRetryable(result))
+        {
+            LOG(Warning, "EOS failed to update lobby {0}, retrying: {1}", String(lobby->Id), String(EOS_EResult_ToString(result)));
+            if (operation->HasSettings && !lobby->HasPendingSettings)
+            {
+                lobby->PendingSettings = operation->Settings;
+                lobby->HasPendingSettings = true;
+            }
+            Requeue(lobby->PendingAttributes, operation->Attributes);
+            Requeue(lobby->PendingMemberAttributes, operation->MemberAttributes);
+            lobby->DirtyTime = Platform::GetTimeSeconds();
+        }
+        else
+        {
+            // The reads fall back to the mirror that matches the backend
+            LOG(Warning, "EOS failed to update lobby {0}: {1}", String(lobby->Id), String(EOS_EResult_ToString(result)));
+            if (!operation->Attributes.IsEmpty() || operation->HasSettings)
+                owner->LobbyUpdated(lobby->Id);
+            if (!operation->MemberAttributes.IsEmpty())
+                owner->MemberUpdated(lobby->Id, owner->_context->ProductUserId);
+        }
+    }
+    owner->EndOperation(operation, result);
+}
+
+void EOSLobbies::OnLobbyUpdateReceived(const EOS_Lobby_LobbyUpdateReceivedCallbackInfo* data)
+{
+    const auto owner = (EOSLobbies*)data->ClientData;
+    Lobby* lobby = owner->FindLobby(StringAnsiView(data->LobbyId));
+    if (lobby && !owner->RefreshLobby(lobby, nullptr))
+        owner->LobbyUpdated(lobby->Id);
+}
+
+void EOSLobbies::OnMemberUpdateReceived(const EOS_Lobby_LobbyMemberUpdateReceivedCallbackInfo* data)
+{
+    const auto owner = (EOSLobbies*)data->ClientData;
+    Lobby* lobby = owner->FindLobby(StringAnsiView(data->LobbyId));
+    if (lobby && !owner->RefreshLobby(lobby, data->TargetUserId))
+        owner->MemberUpdated(lobby->Id, data->TargetUserId);
+}
+
+void EOSLobbies::OnMemberStatusReceived(const EOS_Lobby_LobbyMemberStatusReceivedCallbackInfo* data)
+{
+    const auto owner = (EOSLobbies*)data->ClientData;
+    const StringAnsi lobbyId(data->LobbyId);
+    Lobby* lobby = owner->FindLobby(lobbyId);
+    if (!lobby)
+        return;
+    const EOS_ELobbyMemberStatus status = data->CurrentStatus;
+    const bool removed = status == EOS_ELobbyMemberStatus::EOS_LMS_LEFT || status == EOS_ELobbyMemberStatus::EOS_LMS_DISCONNECTED || status == EOS_ELobbyMemberStatus::EOS_LMS_KICKED;
+    if (status == EOS_ELobbyMemberStatus::EOS_LMS_CLOSED || (removed && data->TargetUserId == owner->_context->ProductUserId))
+    {
+        // The local user is no longer in the lobby
+        owner->_lobbies.Remove(lobbyId);
+        Delete(lobby);
+    }
+    else if (removed)
+    {
+        for (int32 i = 0; i < lobby->Members.Count(); i++)
+        {
+            if (lobby->Members[i].UserId == data->TargetUserId)
+            {
+                lobby->Members.RemoveAtKeepOrder(i);
+                break;
+            }
+        }
+    }
+    else if (status == EOS_ELobbyMemberStatus::EOS_LMS_PROMOTED)
+    {
+        lobby->Owner = data->TargetUserId;
+    }
+    else if (status == EOS_ELobbyMemberStatus::EOS_LMS_JOINED)
+    {
+        owner->RefreshLobby(lobby, data->TargetUserId);
+    }
+    owner->MemberStatusChanged(lobbyId, data->TargetUserId, status);
+}
+
+void EOSLobbies::OnInviteReceived(const EOS_Lobby_LobbyInviteReceivedCallbackInfo* data)
+{
+    const auto owner = (EOSLobbies*)data->ClientData;
+    owner->InviteReceived(StringAnsi(data->InviteId), data->TargetUserId);
+}
+
+void EOSLobbies::OnInviteAccepted(const EOS_Lobby_LobbyInviteAcceptedCallbackInfo* data)
+{
+    const auto owner = (EOSLobbies*)data->ClientData;
+    owner->InviteAccepted(StringAnsi(data->InviteId));
+}
@@ -0,0 +1,330 @@
+#pragma once
+
+#include "Engine/Core/Collections/Array.h"
+#include "Engine/Core/Collections/Dictionary.h"
+#include "Engine/Core/Delegate.h"
+#include "Engine/Core/Types/String.h"
+#include "EOSAttribute.h"
+#include "EOSSDK/Include/eos_lobby_types.h"
+
+class EOSPlatformContext;
+
+///<summary>
+/// The value of the lobby (or the lobby member) attribute.
+///</summary>
+typedef EOSAttribute<EOS_Lobby_AttributeData, EOS_ELobbyAttributeVisibility, EOS_LOBBY_ATTRIBUTEDATA_API_LATEST, EOS_ELobbyAttributeVisibility::EOS_LAT_PUBLIC, EOS_ELobbyAttributeVisibility::EOS_LAT_PRIVATE> EOSLobbyAttribute;
+
+///<summary>
+/// The settings of the lobby.
+///</summary>
+struct EOSLobbySettings
+{
+    /// <summary>
+    /// The bucket used by the searches to find the lobby (eg. "Mode:Region").
+    /// </summary>
+    StringAnsi BucketId;
+
+    uint32 MaxMembers = 16;
+    EOS_ELobbyPermissionLevel PermissionLevel = EOS_ELobbyPermissionLevel::EOS_LPL_PUBLICADVERTISED;
+    bool InvitesAllowed = true;
+
+    /// <summary>
+    /// True if the lobby is associated with the presence of the local user. Used only on the creation.
+    /// </summary>
+    bool PresenceEnabled = false;
+
+    /// <summary>
+    /// True if the lobby stays open when the owner leaves (the ownership moves to the other member). Used only on the creation.
+    /// </summary>
+    bool HostMigrationAllowed = true;
+
+    /// <summary>
+    /// True if the lobby can be joined with its id (see JoinLobbyById). Used only on the creation.
+    /// </summary>
+    bool JoinByIdAllowed = true;
+
+    /// <summary>
+    /// Compares the settings sent with the lobby updates (the ones used only on the creation are ignored).
+    /// </summary>
+    bool UpdatableEquals(const EOSLobbySettings& other) const
+    {
+        return BucketId == other.BucketId &&
+                MaxMembers == other.MaxMembers &&
+                PermissionLevel == other.PermissionLevel &&
+                InvitesAllowed == other.InvitesAllowed;
+    }
+};
+
+///<summary>
+/// The parameter of the lobby search (compared with the lobby attribute on the backend).
+///</summary>
+struct EOSLobbySearchParameter
+{
+    StringAnsi Key;
+    EOSLobbyAttribute Value;
+    EOS_EOnlineComparisonOp Comparison = EOS_EComparisonOp::EOS_CO_EQUAL;
+};
+
+///<summary>
+/// The lobby search.
+///</summary>
+struct EOSLobbySearch
+{
+    /// <summary>
+    /// The bucket to search (empty to search all the buckets).
+    /// </summary>
+    StringAnsi BucketId;
+
+    /// <summary>
+    /// The minimum amount of the free slots (0 to find the full lobbies too).
+    /// </summary>
+    uint32 MinSlotsAvailable = 1;
+
+    uint32 MaxResults = 50;
+    Array<EOSLobbySearchParameter> Parameters;
+};
+
+///<summary>
+/// The lobby found by the search (a copy of its state, so it doesn't hold the SDK handle).
+///</summary>
+struct EOSLobbySearchResult
+{
+    StringAnsi LobbyId;
+    EOS_ProductUserId Owner = nullptr;
+    StringAnsi BucketId;
+    uint32 MaxMembers = 0;
+    uint32 AvailableSlots = 0;
+    Dictionary<StringAnsi, EOSLobbyAttribute> Attributes;
+};
+
+///<summary>
+/// The lobbies of the local user.
+/// The attributes of the joined lobbies and their members are mirrored locally. The mirror is refreshed from the lobby update, member update and member status notifications, so reads never copy the lobby details from the SDK.
+/// Attribute and setting changes made within the update window are coalesced into a single lobby update (and the lobbies never have more than one update in flight), so members toggling their ready state, loadout or team don't flood the backend with the updates.
+/// Completion callbacks are called from the thread that ticks the platform (with the context locker held).
+///</summary>
+class ONLINEPLATFORMEOS_API EOSLobbies
+{
+public:
+    typedef Function<void(EOS_EResult, const StringAnsi&)> Callback;
+    typedef Function<void(EOS_EResult, const Array<EOSLobbySearchResult>&)> SearchCallback;
+
+private:
+    struct Member;
+    struct Lobby;
+    struct Operation;
+
+    EOSPlatformContext* _context;
+    Dictionary<StringAnsi, Lobby*> _lobbies;
+    Array<Operation*> _operations;
+    EOS_NotificationId _lobbyUpdateId = EOS_INVALID_NOTIFICATIONID;
+    EOS_NotificationId _memberUpdateId = EOS_INVALID_NOTIFICATIONID;
+    EOS_NotificationId _memberStatusId = EOS_INVALID_NOTIFICATIONID;
+    EOS_NotificationId _inviteReceivedId = EOS_INVALID_NOTIFICATIONID;
+    EOS_NotificationId _inviteAcceptedId = EOS_INVALID_NOTIFICATIONID;
+    bool _notificationsFailed = false;
+    int64 _updateCount = 0;
+    int64 _changeCount = 0;
+
+public:
+    EOSLobbies(EOSPlatformContext* context);
+    ~EOSLobbies();
+
+    /// <summary>
+    /// The time (in seconds) the changes wait for the other changes before the lobby gets updated. Also the minimal interval between the updates of the lobby.
+    /// </summary>
+    float UpdateWindow = 0.5f;
+
+    /// <summary>
+    /// Event called when the lobby attributes or settings in the mirror changed (with the lobby id).
+    /// </summary>
+    Delegate<const StringAnsi&> LobbyUpdated;
+
+    /// <summary>
+    /// Event called when the attributes of the lobby member in the mirror changed (with the lobby id and the member).
+    /// </summary>
+    Delegate<const StringAnsi&, EOS_ProductUserId> MemberUpdated;
+
+    /// <summary>
+    /// Event called when the member joined, left, got kicked or promoted (with the lobby id, the member and the status). Called after the mirror got updated.
+    /// </summary>
+    Delegate<const StringAnsi&, EOS_ProductUserId, EOS_ELobbyMemberStatus> MemberStatusChanged;
+
+    /// <summary>
+    /// Event called when the local user received the lobby invite (with the invite id and the sender).
+    /// </summary>
+    Delegate<const StringAnsi&, EOS_ProductUserId> InviteReceived;
+
+    /// <summary>
+    /// Event called when the local user accepted the lobby invite in the overlay (with the invite id). Join it with JoinInvite.
+    /// </summary>
+    Delegate<const StringAnsi&> InviteAccepted;
+
+public:
+    /// <summary>
+    /// Creates the lobby owned by the local user. The callback gets the id of the created lobby.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool CreateLobby(const EOSLobbySettings& settings, const Callback& callback = Callback());
+
+    /// <summary>
+    /// Finds the lobbies.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool Search(const EOSLobbySearch& search, const SearchCallback& callback);
+
+    /// <summary>
+    /// Joins the lobby with its id (eg. found by the search or shared by the other player).
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool JoinLobbyById(const StringAnsiView& lobbyId, bool presenceEnabled, const Callback& callback = Callback());
+
+    /// <summary>
+    /// Joins the lobby of the received invite. The callback gets the id of the joined lobby.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool JoinInvite(const StringAnsiView& inviteId, bool presenceEnabled, const Callback& callback = Callback());
+
+    /// <summary>
+    /// Rejects the received invite.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool RejectInvite(const StringAnsiView& inviteId, const Callback& callback = Callback());
+
+    /// <summary>
+    /// Invites the user to the lobby.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool SendInvite(const StringAnsiView& lobbyId, EOS_ProductUserId user, const Callback& callback = Callback());
+
+    /// <summary>
+    /// Leaves the lobby (or destroys it if owned and the destroy is requested). The pending changes are dropped.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool LeaveLobby(const StringAnsiView& lobbyId, bool destroy = false, const Callback& callback = Callback());
+
+    /// <summary>
+    /// Removes the member from the owned lobby.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool KickMember(const StringAnsiView& lobbyId, EOS_ProductUserId member, const Callback& callback = Callback());
+
+    /// <summary>
+    /// Passes the ownership of the owned lobby to the member.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool PromoteMember(const StringAnsiView& lobbyId, EOS_ProductUserId member, const Callback& callback = Callback());
+
+    /// <summary>
+    /// Sets the attribute of the owned lobby. Setting the current value does nothing, otherwise the change gets sent with the next update.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool SetLobbyAttribute(const StringAnsiView& lobbyId, const StringAnsiView& key, const EOSLobbyAttribute& value);
+
+    /// <summary>
+    /// Removes the attribute of the owned lobby. The change gets sent with the next update.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool RemoveLobbyAttribute(const StringAnsiView& lobbyId, const StringAnsiView& key);
+
+    /// <summary>
+    /// Sets the attribute of the local member (eg. ready state, loadout or team). Setting the current value does nothing, otherwise the change gets sent with the next update.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool SetMemberAttribute(const StringAnsiView& lobbyId, const StringAnsiView& key, const EOSLobbyAttribute& value);
+
+    /// <summary>
+    /// Removes the attribute of the local member. The change gets sent with the next update.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool RemoveMemberAttribute(const StringAnsiView& lobbyId, const StringAnsiView& key);
+
+    /// <summary>
+    /// Changes the settings of the owned lobby. Only the modified settings get sent with the next update.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool SetSettings(const StringAnsiView& lobbyId, const EOSLobbySettings& settings);
+
+    /// <summary>
+    /// Gets the attribute of the lobby from the mirror (including the local changes not sent yet).
+    /// </summary>
+    /// <returns>True if the attribute exists, otherwise false.</returns>
+    bool GetLobbyAttribute(const StringAnsiView& lobbyId, const StringAnsiView& key, EOSLobbyAttribute& result);
+
+    /// <summary>
+    /// Gets the attribute of the lobby member from the mirror (including the local changes not sent yet).
+    /// </summary>
+    /// <returns>True if the attribute exists, otherwise false.</returns>
+    bool GetMemberAttribute(const StringAnsiView& lobbyId, EOS_ProductUserId member, const StringAnsiView& key, EOSLobbyAttribute& result);
+
+    /// <summary>
+    /// Gets the settings of the lobby from the mirror (including the local changes not sent yet).
+    /// </summary>
+    /// <returns>True if the lobby exists, otherwise false.</returns>
+    bool GetSettings(const StringAnsiView& lobbyId, EOSLobbySettings& result);
+
+    /// <summary>
+    /// Gets the members of the lobby from the mirror.
+    /// </summary>
+    /// <returns>True if the lobby exists, otherwise false.</returns>
+    bool GetMembers(const StringAnsiView& lobbyId, Array<EOS_ProductUserId>& result);
+
+    /// <summary>
+    /// Gets the owner of the lobby (null if the lobby isn't joined).
+    /// </summary>
+    EOS_ProductUserId GetOwner(const StringAnsiView& lobbyId);
+
+    /// <summary>
+    /// Gets the ids of the joined lobbies.
+    /// </summary>
+    void GetLobbies(Array<StringAnsi>& result);
+
+    /// <summary>
+    /// Gets the total amount of the sent lobby updates.
+    /// </summary>
+    int64 GetUpdateCount();
+
+    /// <summary>
+    /// Gets the total amount of the attribute and setting changes made locally. Compared with the update count shows how many changes got coalesced.
+    /// </summary>
+    int64 GetChangeCount();
+
+    /// <summary>
+    /// Removes all the lobbies from the mirror (doesn't leave them), removes the notifications and cancels the pending operations (without calling their callbacks).
+    /// </summary>
+    void Clear();
+
+    /// <summary>
+    /// Sends the updates of the lobbies whose windows have passed. Called on every platform tick.
+    /// </summary>
+    void Flush();
+
+private:
+    bool AddNotifications();
+    void RemoveNotifications();
+    Lobby* FindLobby(const StringAnsiView& lobbyId);
+    Lobby* AddLobby(const char* lobbyId, bool isOwner);
+    void MarkDirty(Lobby* lobby, double now);
+    bool SendUpdate(Lobby* lobby);
+    int32 ApplyChanges(Lobby* lobby, EOS_HLobbyModification modification);
+    bool RefreshLobby(Lobby* lobby, EOS_ProductUserId member);
+    Operation* BeginOperation(const StringAnsiView& lobbyId, const Callback& callback);
+    void EndOperation(Operation* operation, EOS_EResult result, const char* lobbyId = nullptr);
+
+    static void EOS_CALL OnCreateLobbyComplete(const EOS_Lobby_CreateLobbyCallbackInfo* data);
+    static void EOS_CALL OnFindComplete(const EOS_LobbySearch_FindCallbackInfo* data);
+    static void EOS_CALL OnJoinLobbyByIdComplete(const EOS_Lobby_JoinLobbyByIdCallbackInfo* data);
+    static void EOS_CALL OnJoinLobbyComplete(const EOS_Lobby_JoinLobbyCallbackInfo* data);
+    static void EOS_CALL OnRejectInviteComplete(const EOS_Lobby_RejectInviteCallbackInfo* data);
+    static void EOS_CALL OnSendInviteComplete(const EOS_Lobby_SendInviteCallbackInfo* data);
+    static void EOS_CALL OnLeaveLobbyComplete(const EOS_Lobby_LeaveLobbyCallbackInfo* data);
+    static void EOS_CALL OnDestroyLobbyComplete(const EOS_Lobby_DestroyLobbyCallbackInfo* data);
+    static void EOS_CALL OnKickMemberComplete(const EOS_Lobby_KickMemberCallbackInfo* data);
+    static void EOS_CALL OnPromoteMemberComplete(const EOS_Lobby_PromoteMemberCallbackInfo* data);
+    static void EOS_CALL OnUpdateLobbyComplete(const EOS_Lobby_UpdateLobbyCallbackInfo* data);
+    static void EOS_CALL OnLobbyUpdateReceived(const EOS_Lobby_LobbyUpdateReceivedCallbackInfo* data);
+    static void EOS_CALL OnMemberUpdateReceived(const EOS_Lobby_LobbyMemberUpdateReceivedCallbackInfo* data);
+    static void EOS_CALL OnMemberStatusReceived(const EOS_Lobby_LobbyMemberStatusReceivedCallbackInfo* data);
+    static void EOS_CALL OnInviteReceived(const EOS_Lobby_LobbyInviteReceivedCallbackInfo* data);
+    static void EOS_CALL OnInviteAccepted(const EOS_Lobby_LobbyInviteAcceptedCallbackInfo* data);
+};
@@ -0,0 +1,506 @@
+#include "EOSMatchmaker.h"
+#include "EOSPlatformContext.h"
+
+#include "Engine/Core/Log.h"
+#include "Engine/Core/Collections/Sorting.h"
+#include "Engine/Core/Math/Math.h"
+#include "Engine/Platform/Platform.h"
+#include "Engine/Threading/Threading.h"
+#include <EOSSDK/Include/eos_sdk.h>
+
+#include "EOSSDK/Include/eos_lobby.h"
+#include "EOSSDK/Include/eos_sessions.h"
+
+struct EOSMatchmaker::PendingSearch
+{
+    EOSMatchmaker* Owner;
+    EOS_HLobbySearch LobbyHandle = nullptr;
+    EOS_HSessionSearch SessionHandle = nullptr;
+    bool Canceled = false;
+    int32 Stage;
+    StringAnsi BucketId;
+
+    void Release()
+    {
+        if (LobbyHandle)
+            EOS_LobbySearch_Release(LobbyHandle);
+        if (SessionHandle)
+            EOS_SessionSearch_Release(SessionHandle);
+    }
+};
+
+namespace
+{
+    struct ScoreKey
+    {
+        float Score;
+        int32 Index;
+
+        // Best first, ties keep the discovery order
+        bool operator<(const ScoreKey& other) const
+        {
+            return Score > other.Score || (Score == other.Score && Index < other.Index);
+        }
+    };
+
+    bool SetParameter(EOS_HLobbySearch lobbySearch, EOS_HSessionSearch sessionSearch, const char* key, const EOSSessionAttribute& value, EOS_EOnlineComparisonOp comparison)
+    {
+        EOS_Sessions_AttributeData data = {};
+        value.ToData(key, data);
+        EOS_EResult result;
+        if (lobbySearch)
+        {
+            // Lobby attribute data has the same layout
+            EOS_Lobby_AttributeData lobbyData = {};
+            lobbyData.ApiVersion = EOS_LOBBY_ATTRIBUTEDATA_API_LATEST;
+            lobbyData.Key = data.Key;
+            lobbyData.ValueType = data.ValueType;
+            Platform::MemoryCopy(&lobbyData.Value, &data.Value, sizeof(lobbyData.Value));
+            EOS_LobbySearch_SetParameterOptions options = {};
+            options.ApiVersion = EOS_LOBBYSEARCH_SETPARAMETER_API_LATEST;
+            options.Parameter = &lobbyData;
+            options.ComparisonOp = comparison;
+            result = EOS_LobbySearch_SetParameter(lobbySearch, &options);
+        }
+        else
+        {
+            EOS_SessionSearch_SetParameterOptions options = {};
+            options.ApiVersion = EOS_SESSIONSEARCH_SETPARAMETER_API_LATEST;
+            options.Parameter = &data;
+            options.ComparisonOp = comparison;
+            result = EOS_SessionSearch_SetParameter(sessionSearch, &options);
+        }
+        if (result != EOS_EResult::EOS_Success)
+        {
+            LOG(Warning, "EOS failed to set the matchmaking search parameter {0}: {1}", String(key), String(EOS_EResult_ToString(result)));
+            return true;
+        }
+        return false;
+    }
+
+    bool CopyAttribute(EOS_HLobbyDetails lobby, EOS_HSessionDetails session, const StringAnsi& key, EOSSessionAttribute& result)
+    {
+        if (key.IsEmpty())
+            return false;
+        bool valid = false;
+        if (lobby)
+        {
+            EOS_LobbyDetails_CopyAttributeByKeyOptions options = {};
+            options.ApiVersion = EOS_LOBBYDETAILS_COPYATTRIBUTEBYKEY_API_LATEST;
+            options.AttrKey = key.Get();
+            EOS_Lobby_Attribute* attribute;
+            if (EOS_LobbyDetails_CopyAttributeByKey(lobby, &options, &attribute) != EOS_EResult::EOS_Success)
+                return false;
+            if (attribute->Data)
+            {
+                EOS_Sessions_AttributeData data = {};
+                data.Key = attribute->Data->Key;
+                data.ValueType = attribute->Data->ValueType;
+                Platform::MemoryCopy(&data.Value, &attribute->Data->Value, sizeof(data.Value));
+                result = EOSSessionAttribute::FromData(data, EOS_ESessionAttributeAdvertisementType::EOS_SAAT_Advertise);
+                valid = true;
+            }
+            EOS_Lobby_Attribute_Release(attribute);
+        }
+        else
+        {
+            EOS_SessionDetails_CopySessionAttributeByKeyOptions options = {};
+            options.ApiVersion = EOS_SESSIONDETAILS_COPYSESSIONATTRIBUTEBYKEY_API_LATEST;
+            options.AttrKey = key.Get();
+            EOS_SessionDetails_Attribute* attribute;
+            if (EOS_SessionDetails_CopySessionAttributeByKey(session, &options, &attribute) != EOS_EResult::EOS_Success)
+                return false;
+            if (attribute->Data)
+            {
+                result = EOSSessionAttribute::FromData(*attribute->Data, attribute->AdvertisementType);
+                valid = true;
+            }
+            EOS_SessionDetails_Attribute_Release(attribute);
+        }
+        return valid;
+    }
+}
+
+EOSMatchmaker::EOSMatchmaker(EOSPlatformContext* context)
+    : _context(context)
+{
+    _context->Ticking.Bind<EOSMatchmaker, &EOSMatchmaker::Flush>(this);
+}
+
+EOSMatchmaker::~EOSMatchmaker()
+{
+    _context->Ticking.Unbind<EOSMatchmaker, &EOSMatchmaker::Flush>(this);
+    Clear();
+}
+
+bool EOSMatchmaker::Start(const EOSMatchmakingSettings& settings)
+{
+    ScopeLock lock(_context->Locker);
+    Clear();
+    const bool lobbies = settings.Target == EOSMatchmakingTarget::Lobbies;
+    if (lobbies ? !_context->GetLobby() || !_context->ProductUserId : !_context->GetSessions())
+        return true;
+    _settings = settings;
+    _stats = EOSMatchmakingStats();
+    _startTime = Platform::GetTimeSeconds();
+    _nextStage = 0;
+    _searching = true;
+    if (StartStage())
+    {
+        _searching = false;
+        return true;
+    }
+    return false;
+}
+
+void EOSMatchmaker::Cancel()
+{
+    ScopeLock lock(_context->Locker);
+    CancelSearches();
+    _searching = false;
+}
+
+void EOSMatchmaker::Clear()
+{
+    ScopeLock lock(_context->Locker);
+    Cancel();
+    for (const EOSMatchmakingCandidate& candidate : _candidates)
+    {
+        if (candidate.Details)
+            EOS_SessionDetails_Release(candidate.Details);
+    }
+    _candidates.Clear();
+    _candidateIds.Clear();
+}
+
+void EOSMatchmaker::Flush()
+{
+    ScopeLock lock(_context->Locker);
+    if (!_searching)
+        return;
+    const double now = Platform::GetTimeSeconds();
+    if (now - _startTime >= (double)_settings.Timeout)
+    {
+        Finish();
+        return;
+    }
+
+    // Later stages don't wait for the slow searches of the previous ones
+    if (_nextStage < Math::Max(_settings.SkillRanges.Count(), 1) && now - _stageTime >= (double)_settings.StageInterval)
+    {
+        if (StartStage() && _pending.IsEmpty())
+            Finish();
+    }
+}
+
+bool EOSMatchmaker::StartStage()
+{
+    const int32 stage = _nextStage++;
+    _stageTime = Platform::GetTimeSeconds();
+    _stats.StagesStarted++;
+    bool failed = true;
+    if (_settings.Buckets.IsEmpty())
+    {
+        failed &= StartSearch(stage, StringAnsi::Empty);
+    }
+    else
+    {
+        for (const StringAnsi& bucketId : _settings.Buckets)
+            failed &= StartSearch(stage, bucketId);
+    }
+    return failed;
+}
+
+bool EOSMatchmaker::StartSearch(int32 stage, const StringAnsi& bucketId)
+{
+    const bool lobbies = _settings.Target == EOSMatchmakingTarget::Lobbies;
+    EOS_HLobbySearch lobbySearch = nullptr;
+    EOS_HSessionSearch sessionSearch = nullptr;
+    EOS_EResult result;
+    if (lobbies)
+    {
+        EOS_Lobby_CreateLobbySearchOptions options = {};
+        options.ApiVersion = EOS_LOBBY_CREATELOBBYSEARCH_API_LATEST;
+        options.MaxResults = Math::Clamp<uint32>(_settings.MaxResults, 1, EOS_LOBBY_MAX_SEARCH_RESULTS);
+        result = EOS_Lobby_CreateLobbySearch(_context->GetLobby(), &options, &lobbySearch);
+    }
+    else
+    {
+        EOS_Sessions_CreateSessionSearchOptions options = {};
+        options.ApiVersion = EOS_SESSIONS_CREATESESSIONSEARCH_API_LATEST;
+        options.MaxSearchResults = Math::Clamp<uint32>(_settings.MaxResults, 1, EOS_SESSIONS_MAX_SEARCH_RESULTS);
+        result = EOS_Sessions_CreateSessionSearch(_context->GetSessions(), &options, &sessionSearch);
+    }
+    if (result != EOS_EResult::EOS_Success)
+    {
+        LOG(Warning, "EOS failed to create the matchmaking search: {0}", String(EOS_EResult_ToString(result)));
+        return true;
+    }
+
+    // Bucket and slots keys are the same for the lobbies and the sessions
+    bool failed = false;
+    if (bucketId.HasChars())
+        failed |= SetParameter(lobbySearch, sessionSearch, EOS_LOBBY_SEARCH_BUCKET_ID, EOSSessionAttribute::FromString(bucketId), EOS_EComparisonOp::EOS_CO_EQUAL);
+    failed |= SetParameter(lobbySearch, sessionSearch, EOS_LOBBY_SEARCH_MINSLOTSAVAILABLE, EOSSessionAttribute::FromInt64(1), EOS_EComparisonOp::EOS_CO_GREATERTHANOREQUAL);
+    for (const EOSServerSearchParameter& parameter : _settings.Parameters)
+        failed |= SetParameter(lobbySearch, sessionSearch, parameter.Key.Get(), parameter.Value, parameter.Comparison);
+    const double range = stage < _settings.SkillRanges.Count() ? _settings.SkillRanges[stage] : 0.0;
+    if (range > 0.0 && _settings.SkillAttribute.HasChars())
+    {
+        failed |= SetParameter(lobbySearch, sessionSearch, _settings.SkillAttribute.Get(), EOSSessionAttribute::FromDouble(_settings.Skill - range), EOS_EComparisonOp::EOS_CO_GREATERTHANOREQUAL);
+        failed |= SetParameter(lobbySearch, sessionSearch, _settings.SkillAttribute.Get(), EOSSessionAttribute::FromDouble(_settings.Skill + range), EOS_EComparisonOp::EOS_CO_LESSTHANOREQUAL);
+    }
+
+    auto search = New<PendingSearch>();
+    search->Owner = this;
+    search->LobbyHandle = lobbySearch;
+    search->SessionHandle = sessionSearch;
+    search->Stage = stage;
+    search->BucketId = bucketId;
+    if (failed)
+    {
+        search->Release();
+        Delete(search);
+        return true;
+    }
+    _pending.Add(search);
+    _stats.SearchesStarted++;
+    if (lobbies)
+    {
+        EOS_LobbySearch_FindOptions options = {};
+        options.ApiVersion = EOS_LOBBYSEARCH_FIND_API_LATEST;
+        options.LocalUserId = _context->ProductUserId;
+        EOS_LobbySearch_Find(lobbySearch, &options, search, &EOSMatchmaker::OnLobbyFindComplete);
+    }
+    else
+    {
+        EOS_SessionSearch_FindOptions options = {};
+        options.ApiVersion = EOS_SESSIONSEARCH_FIND_API_LATEST;
+        options.LocalUserId = _context->IsServer ? nullptr : _context->ProductUserId;
+        EOS_SessionSearch_Find(sessionSearch, &options, search, &EOSMatchmaker::OnSessionFindComplete);
+    }
+    return false;
+}
+
+void EOSMatchmaker::CancelSearches()
+{
+    // EOS can't abort the find, the searches get released when it completes and their results are dropped
+    for (PendingSearch* search : _pending)
+        search->Canceled = true;
+    _pending.Clear();
+}
+
+bool EOSMatchmaker::AddCandidate(PendingSearch* search, EOS_HLobbyDetails lobby, EOS_HSessionDetails session)
+{
+    StringAnsi id, bucketId;
+    int32 members = 0, maxMembers = 0;
+    if (lobby)
+    {
+        EOS_LobbyDetails_CopyInfoOptions options = {};
+        options.ApiVersion = EOS_LOBBYDETAILS_COPYINFO_API_LATEST;
+        EOS_LobbyDetails_Info* info;
+        if (EOS_LobbyDetails_CopyInfo(lobby, &options, &info) != EOS_EResult::EOS_Success)
+            return false;
+        id = info->LobbyId;
+        bucketId = info->BucketId;
+        maxMembers = (int32)info->MaxMembers;
+        members = Math::Max(maxMembers - (int32)info->AvailableSlots, 0);
+        EOS_LobbyDetails_Info_Release(info);
+    }
+    else
+    {
+        EOS_SessionDetails_CopyInfoOptions options = {};
+        options.ApiVersion = EOS_SESSIONDETAILS_COPYINFO_API_LATEST;
+        EOS_SessionDetails_Info* info;
+        if (EOS_SessionDetails_CopyInfo(session, &options, &info) != EOS_EResult::EOS_Success)
+            return false;
+        id = info->SessionId;
+        if (info->Settings)
+        {
+            bucketId = info->Settings->BucketId;
+            maxMembers = (int32)info->Settings->NumPublicConnections;
+        }
+        members = Math::Max(maxMembers - (int32)info->NumOpenPublicConnections, 0);
+        EOS_SessionDetails_Info_Release(info);
+    }
+    if (id.IsEmpty())
+        return false;
+
+    // The same match found by the other buckets or stages gets refreshed
+    int32 index;
+    if (!_candidateIds.TryGet(id, index))
+    {
+        index = _candidates.Count();
+        auto& candidate = _candidates.AddOne();
+        candidate.Id = id;
+        candidate.Stage = search->Stage;
+        _candidateIds.Add(id, index);
+    }
+    EOSMatchmakingCandidate& candidate = _candidates[index];
+    if (session)
+    {
+        // The session details of the candidate get replaced with the fresh ones
+        if (candidate.Details)
+            EOS_SessionDetails_Release(candidate.Details);
+        candidate.Details = session;
+    }
+    candidate.BucketId = bucketId;
+    candidate.Members = members;
+    candidate.MaxMembers = maxMembers;
+    EOSSessionAttribute attribute;
+    candidate.Region = CopyAttribute(lobby, session, _settings.RegionAttribute, attribute) && attribute.Type == EOS_EAttributeType::EOS_AT_STRING ? attribute.AsString : StringAnsi::Empty;
+    candidate.Skill = CopyAttribute(lobby, session, _settings.SkillAttribute, attribute) ? attribute.GetNumber() : _settings.Skill;
+    candidate.Score = Score(candidate);
+    return true;
+}
+
+float EOSMatchmaker::Score(const EOSMatchmakingCandidate& candidate) const
+{
+    float region = 0.0f;
+    if (_settings.Region.IsEmpty() || candidate.Region == _settings.Region)
+        region = 1.0f;
+    else if (_settings.NearbyRegions.Contains(candidate.Region))
+        region = 0.5f;
+
+    double scale = 0.0;
+    for (const double range : _settings.SkillRanges)
+        scale = Math::Max(scale, range);
+    const float skill = scale > 0.0 ? 1.0f - (float)Math::Min(Math::Abs(candidate.Skill - _settings.Skill) / scale, 1.0) : 1.0f;
+
+    // Fuller matches start sooner
+    const float fill = candidate.MaxMembers > 0 ? (float)candidate.Members / (float)candidate.MaxMembers : 0.0f;
+
+    const float weights = _settings.RegionWeight + _settings.SkillWeight + _settings.FillWeight;
+    if (weights <= 0.0f)
+        return 0.0f;
+    return (_settings.RegionWeight * region + _settings.SkillWeight * skill + _settings.FillWeight * fill) / weights;
+}
+
+void EOSMatchmaker::CompleteSearch(PendingSearch* search)
+{
+    _pending.Remove(search);
+    search->Release();
+    Delete(search);
+    _stats.SearchesCompleted++;
+
+    for (const EOSMatchmakingCandidate& candidate : _candidates)
+    {
+        if (candidate.Score >= _settings.GoodEnoughScore)
+        {
+            Finish();
+            return;
+        }
+    }
+
+    // Widen the search right away if the stage found nothing good enough
+    if (_pending.IsEmpty())
+    {
+        if (_nextStage >= Math::Max(_settings.SkillRanges.Count(), 1) || (StartStage() && _pending.IsEmpty()))
+            Finish();
+    }
+}
+
+void EOSMatchmaker::Finish()
+{
+    _searching = false;
+    _stats.SearchesCanceled = _pending.Count();
+    CancelSearches();
+    _stats.TimeToMatch = (float)(Platform::GetTimeSeconds() - _startTime);
+    _stats.Candidates = _candidates.Count();
+
+    Array<ScoreKey> keys;
+    keys.Resize(_candidates.Count());
+    for (int32 i = 0; i < keys.Count(); i++)
+        keys[i] = { _candidates[i].Score, i };
+    Sorting::QuickSort(keys.Get(), keys.Count());
+    Array<EOSMatchmakingCandidate> sorted;
+    sorted.Resize(keys.Count());
+    _candidateIds.Clear();
+    for (int32 i = 0; i < keys.Count(); i++)
+    {
+        sorted[i] = _candidates[keys[i].Index];
+        _candidateIds.Add(sorted[i].Id, i);
+    }
+    _candidates = MoveTemp(sorted);
+
+    if (_candidates.HasItems())
+    {
+        const EOSMatchmakingCandidate& best = _candidates[0];
+        LOG(Info, "EOS matchmaking found {0} (score {1}) in {2}s ({3} searches, {4} canceled)", String(best.Id), best.Score, _stats.TimeToMatch, _stats.SearchesStarted, _stats.SearchesCanceled);
+        MatchFound(best);
+    }
+    else
+    {
+        LOG(Info, "EOS matchmaking found no match in {0}s ({1} searches)", _stats.TimeToMatch, _stats.SearchesStarted);
+        MatchFailed();
+    }
+}
+
+void EOSMatchmaker::OnLobbyFindComplete(const EOS_LobbySearch_FindCallbackInfo* data)
+{
+    const auto search = (PendingSearch*)data->ClientData;
+    if (search->Canceled)
+    {
+        search->Release();
+        Delete(search);
+        return;
+    }
+    const auto owner = search->Owner;
+    if (data->ResultCode == EOS_EResult::EOS_Success)
+    {
+        EOS_LobbySearch_GetSearchResultCountOptions countOptions = {};
+        countOptions.ApiVersion = EOS_LOBBYSEARCH_GETSEARCHRESULTCOUNT_API_LATEST;
+        const uint32 count = EOS_LobbySearch_GetSearchResultCount(search->LobbyHandle, &countOptions);
+        EOS_LobbySearch_CopySearchResultByIndexOptions options = {};
+        options.ApiVersion = EOS_LOBBYSEARCH_COPYSEARCHRESULTBYINDEX_API_LATEST;
+        for (uint32 i = 0; i < count; i++)
+        {
+            options.LobbyIndex = i;
+            EOS_HLobbyDetails details;
+            if (EOS_LobbySearch_CopySearchResultByIndex(search->LobbyHandle, &options, &details) != EOS_EResult::EOS_Success)
+                continue;
+            owner->AddCandidate(search, details, nullptr);
+            EOS_LobbyDetails_Release(details);
+        }
+    }
+    else if (data->ResultCode != EOS_EResult::EOS_NotFound)
+    {
+        LOG(Warning, "EOS failed to find lobbies in bucket {0}: {1}", String(search->BucketId), String(EOS_EResult_ToString(data->ResultCode)));
+    }
+    owner->CompleteSearch(search);
+}
+
+void EOSMatchmaker::OnSessionFindComplete(const EOS_SessionSearch_FindCallbackInfo* data)
+{
+    const auto search = (PendingSearch*)data->ClientData;
+    if (search->Canceled)
+    {
+        search->Release();
+        Delete(search);
+        return;
+    }
+    const auto owner = search->Owner;
+    if (data->ResultCode == EOS_EResult::EOS_Success)
+    {
+        EOS_SessionSearch_GetSearchResultCountOptions countOptions = {};
+        countOptions.ApiVersion = EOS_SESSIONSEARCH_GETSEARCHRESULTCOUNT_API_LATEST;
+        const uint32 count = EOS_SessionSearch_GetSearchResultCount(search->SessionHandle, &countOptions);
+        EOS_SessionSearch_CopySearchResultByIndexOptions options = {};
+        options.ApiVersion = EOS_SESSIONSEARCH_COPYSEARCHRESULTBYINDEX_API_LATEST;
+        for (uint32 i = 0; i < count; i++)
+        {
+            options.SessionIndex = i;
+            EOS_HSessionDetails details;
+            if (EOS_SessionSearch_CopySearchResultByIndex(search->SessionHandle, &options, &details) != EOS_EResult::EOS_Success)
+                continue;
+
+            if (!owner->AddCandidate(search, nullptr, details))
+                EOS_SessionDetails_Release(details);
+        }
+    }
+    else if (data->ResultCode != EOS_EResult::EOS_NotFound)
+    {
+        LOG(Warning, "EOS failed to find sessions in bucket {0}: {1}", String(search->BucketId), String(EOS_EResult_ToString(data->ResultCode)));
+    }
+    owner->CompleteSearch(search);
+}
@@ -0,0 +1,225 @@
+#pragma once
+
+#include "Engine/Core/Collections/Array.h"
+#include "Engine/Core/Collections/Dictionary.h"
+#include "Engine/Core/Delegate.h"
+#include "Engine/Core/Types/String.h"
+#include "EOSServerBrowser.h"
+#include "EOSSDK/Include/eos_lobby_types.h"
+
+class EOSPlatformContext;
+
+///<summary>
+/// The kind of the matches searched by the matchmaker.
+///</summary>
+enum class EOSMatchmakingTarget
+{
+    Lobbies = 0,
+    Sessions,
+};
+
+///<summary>
+/// The settings of the matchmaking search.
+///</summary>
+struct EOSMatchmakingSettings
+{
+    EOSMatchmakingTarget Target = EOSMatchmakingTarget::Lobbies;
+
+    /// <summary>
+    /// The buckets searched in parallel (eg. the same mode in the nearby regions). Empty to search all the buckets with a single search per stage.
+    /// </summary>
+    Array<StringAnsi> Buckets;
+
+    /// <summary>
+    /// The parameters added to every search (eg. the game mode).
+    /// </summary>
+    Array<EOSServerSearchParameter> Parameters;
+
+    /// <summary>
+    /// The attribute with the ping region of the match and the region of the local player.
+    /// </summary>
+    StringAnsi RegionAttribute = "REGION";
+    StringAnsi Region;
+
+    /// <summary>
+    /// The regions with the acceptable ping (score half of the local region).
+    /// </summary>
+    Array<StringAnsi> NearbyRegions;
+
+    /// <summary>
+    /// The attribute with the skill of the match (double) and the skill of the local player.
+    /// </summary>
+    StringAnsi SkillAttribute = "SKILL";
+    double Skill = 0.0;
+
+    /// <summary>
+    /// The skill ranges of the widening stages. Every stage searches all the buckets with its range (0 for any skill). The widest range is also the scale of the skill score.
+    /// </summary>
+    Array<double> SkillRanges = { 100.0, 300.0, 0.0 };
+
+    /// <summary>
+    /// The time (in seconds) after which the next stage starts even if the searches of the previous one are still in progress.
+    /// </summary>
+    float StageInterval = 2.0f;
+
+    /// <summary>
+    /// The weights of the score components.
+    /// </summary>
+    float RegionWeight = 1.0f;
+    float SkillWeight = 1.0f;
+    float FillWeight = 0.5f;
+
+    /// <summary>
+    /// The score (0-1) of the match good enough to stop the matchmaking right away (the outstanding searches get canceled).
+    /// </summary>
+    float GoodEnoughScore = 0.8f;
+
+    /// <summary>
+    /// The time (in seconds) after which the matchmaking ends with the best match found so far.
+    /// </summary>
+    float Timeout = 30.0f;
+
+    /// <summary>
+    /// The maximum amount of the results of a single search.
+    /// </summary>
+    uint32 MaxResults = 50;
+};
+
+///<summary>
+/// The match found by the matchmaker.
+///</summary>
+struct EOSMatchmakingCandidate
+{
+    /// <summary>
+    /// The lobby id (join it with EOSLobbies::JoinLobbyById) or the session id.
+    /// </summary>
+    StringAnsi Id;
+
+    /// <summary>
+    /// The session details (join it with EOSSessions::JoinSession). Owned by the matchmaker and valid until the next matchmaking. Null for the lobbies.
+    /// </summary>
+    EOS_HSessionDetails Details = nullptr;
+
+    StringAnsi BucketId;
+    StringAnsi Region;
+    double Skill = 0.0;
+    int32 Members = 0;
+    int32 MaxMembers = 0;
+
+    /// <summary>
+    /// The stage that found the match first.
+    /// </summary>
+    int32 Stage = 0;
+
+    float Score = 0.0f;
+};
+
+///<summary>
+/// The statistics of the last matchmaking.
+///</summary>
+struct EOSMatchmakingStats
+{
+    int32 StagesStarted = 0;
+    int32 SearchesStarted = 0;
+    int32 SearchesCompleted = 0;
+
+    /// <summary>
+    /// The amount of the searches still in flight when the matchmaking ended (their results are dropped).
+    /// </summary>
+    int32 SearchesCanceled = 0;
+
+    int32 Candidates = 0;
+
+    /// <summary>
+    /// The time (in seconds) from the start to the end of the matchmaking.
+    /// </summary>
+    float TimeToMatch = 0.0f;
+};
+
+///<summary>
+/// The matchmaker that fans out the lobby (or session) searches across the buckets and the widening skill ranges in parallel.
+/// The results are merged and scored by the ping region, the skill and the fill level, and the matchmaking ends as soon as a good enough match is found (the outstanding searches get canceled) instead of waiting for every search.
+/// Events are called from the thread that ticks the platform (with the context locker held). Hold the context locker while reading the candidates or the stats from the other thread.
+///</summary>
+class ONLINEPLATFORMEOS_API EOSMatchmaker
+{
+private:
+    struct PendingSearch;
+
+    EOSPlatformContext* _context;
+    EOSMatchmakingSettings _settings;
+    Array<EOSMatchmakingCandidate> _candidates;
+    Dictionary<StringAnsi, int32> _candidateIds;
+    Array<PendingSearch*> _pending;
+    EOSMatchmakingStats _stats;
+    double _startTime = 0.0;
+    double _stageTime = 0.0;
+    int32 _nextStage = 0;
+    bool _searching = false;
+
+public:
+    EOSMatchmaker(EOSPlatformContext* context);
+    ~EOSMatchmaker();
+
+    /// <summary>
+    /// Event called when the matchmaking ends with the match (the good enough one or the best one found until all the stages completed or the timeout).
+    /// </summary>
+    Delegate<const EOSMatchmakingCandidate&> MatchFound;
+
+    /// <summary>
+    /// Event called when the matchmaking ends without any match.
+    /// </summary>
+    Action MatchFailed;
+
+public:
+    /// <summary>
+    /// Starts the matchmaking (cancels the one in progress).
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool Start(const EOSMatchmakingSettings& settings);
+
+    /// <summary>
+    /// Cancels the matchmaking in progress (without calling the events). The candidates found so far are kept.
+    /// </summary>
+    void Cancel();
+
+    /// <summary>
+    /// Cancels the matchmaking and removes the candidates.
+    /// </summary>
+    void Clear();
+
+    FORCE_INLINE bool IsSearching() const
+    {
+        return _searching;
+    }
+
+    /// <summary>
+    /// Gets the candidates found so far (sorted by the score from the best one once the matchmaking ends).
+    /// </summary>
+    FORCE_INLINE const Array<EOSMatchmakingCandidate>& GetCandidates() const
+    {
+        return _candidates;
+    }
+
+    FORCE_INLINE const EOSMatchmakingStats& GetStats() const
+    {
+        return _stats;
+    }
+
+    /// <summary>
+    /// Starts the next stages and ends the matchmaking on the timeout. Called on every platform tick.
+    /// </summary>
+    void Flush();
+
+private:
+    bool StartStage();
+    bool StartSearch(int32 stage, const StringAnsi& bucketId);
+    void CancelSearches();
+    bool AddCandidate(PendingSearch* search, EOS_HLobbyDetails lobby, EOS_HSessionDetails session);
+    float Score(const EOSMatchmakingCandidate& candidate) const;
+    void CompleteSearch(PendingSearch* search);
+    void Finish();
+
+    static void EOS_CALL OnLobbyFindComplete(const EOS_LobbySearch_FindCallbackInfo* data);
+    static void EOS_CALL OnSessionFindComplete(const EOS_SessionSearch_FindCallbackInfo* data);
+};
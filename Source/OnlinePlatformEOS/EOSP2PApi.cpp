@@ -0,0 +1,29 @@
+#include "EOSP2PApi.h"
+
+#include <EOSSDK/Include/eos_sdk.h>
+
+#include "EOSSDK/Include/eos_p2p.h"
+
+const EOSP2PApi EOSP2PApi::Default =
+{
+    EOS_P2P_SendPacket,
+    EOS_P2P_GetNextReceivedPacketSize,
+    EOS_P2P_ReceivePacket,
+    EOS_P2P_AcceptConnection,
+    EOS_P2P_CloseConnection,
+    EOS_P2P_CloseConnections,
+    EOS_P2P_AddNotifyPeerConnectionRequest,
+    EOS_P2P_RemoveNotifyPeerConnectionRequest,
+    EOS_P2P_AddNotifyPeerConnectionEstablished,
+    EOS_P2P_RemoveNotifyPeerConnectionEstablished,
+    EOS_P2P_AddNotifyPeerConnectionClosed,
+    EOS_P2P_RemoveNotifyPeerConnectionClosed,
+    EOS_P2P_AddNotifyIncomingPacketQueueFull,
+    EOS_P2P_RemoveNotifyIncomingPacketQueueFull,
+    EOS_P2P_SetPacketQueueSize,
+    EOS_P2P_GetPacketQueueInfo,
+    EOS_P2P_SetRelayControl,
+    EOS_P2P_SetPortRange,
+    EOS_ProductUserId_FromString,
+    EOS_ProductUserId_ToString,
+};
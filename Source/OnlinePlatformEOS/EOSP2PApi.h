@@ -0,0 +1,35 @@
+#pragma once
+
+#include "EOSSDK/Include/eos_p2p_types.h"
+
+///<summary>
+/// The EOS P2P functions used by the P2P driver. Lets the driver run on top of the stand-in implementation (eg. the in-process loopback used for benchmarking) instead of the EOS SDK.
+///</summary>
+struct ONLINEPLATFORMEOS_API EOSP2PApi
+{
+    /// <summary>
+    /// The EOS SDK functions.
+    /// </summary>
+    static const EOSP2PApi Default;
+
+    EOS_EResult (EOS_CALL *SendPacket)(EOS_HP2P handle, const EOS_P2P_SendPacketOptions* options);
+    EOS_EResult (EOS_CALL *GetNextReceivedPacketSize)(EOS_HP2P handle, const EOS_P2P_GetNextReceivedPacketSizeOptions* options, uint32_t* outPacketSizeBytes);
+    EOS_EResult (EOS_CALL *ReceivePacket)(EOS_HP2P handle, const EOS_P2P_ReceivePacketOptions* options, EOS_ProductUserId* outPeerId, EOS_P2P_SocketId* outSocketId, uint8_t* outChannel, void* outData, uint32_t* outBytesWritten);
+    EOS_EResult (EOS_CALL *AcceptConnection)(EOS_HP2P handle, const EOS_P2P_AcceptConnectionOptions* options);
+    EOS_EResult (EOS_CALL *CloseConnection)(EOS_HP2P handle, const EOS_P2P_CloseConnectionOptions* options);
+    EOS_EResult (EOS_CALL *CloseConnections)(EOS_HP2P handle, const EOS_P2P_CloseConnectionsOptions* options);
+    EOS_NotificationId (EOS_CALL *AddNotifyPeerConnectionRequest)(EOS_HP2P handle, const EOS_P2P_AddNotifyPeerConnectionRequestOptions* options, void* clientData, EOS_P2P_OnIncomingConnectionRequestCallback handler);
+    void (EOS_CALL *RemoveNotifyPeerConnectionRequest)(EOS_HP2P handle, EOS_NotificationId notificationId);
+    EOS_NotificationId (EOS_CALL *AddNotifyPeerConnectionEstablished)(EOS_HP2P handle, const EOS_P2P_AddNotifyPeerConnectionEstablishedOptions* options, void* clientData, EOS_P2P_OnPeerConnectionEstablishedCallback handler);
+    void (EOS_CALL *RemoveNotifyPeerConnectionEstablished)(EOS_HP2P handle, EOS_NotificationId notificationId);
+    EOS_NotificationId (EOS_CALL *AddNotifyPeerConnectionClosed)(EOS_HP2P handle, const EOS_P2P_AddNotifyPeerConnectionClosedOptions* options, void* clientData, EOS_P2P_OnRemoteConnectionClosedCallback handler);
+    void (EOS_CALL *RemoveNotifyPeerConnectionClosed)(EOS_HP2P handle, EOS_NotificationId notificationId);
+    EOS_NotificationId (EOS_CALL *AddNotifyIncomingPacketQueueFull)(EOS_HP2P handle, const EOS_P2P_AddNotifyIncomingPacketQueueFullOptions* options, void* clientData, EOS_P2P_OnIncomingPacketQueueFullCallback handler);
+    void (EOS_CALL *RemoveNotifyIncomingPacketQueueFull)(EOS_HP2P handle, EOS_NotificationId notificationId);
+    EOS_EResult (EOS_CALL *SetPacketQueueSize)(EOS_HP2P handle, const EOS_P2P_SetPacketQueueSizeOptions* options);
+    EOS_EResult (EOS_CALL *GetPacketQueueInfo)(EOS_HP2P handle, const EOS_P2P_GetPacketQueueInfoOptions* options, EOS_P2P_PacketQueueInfo* outPacketQueueInfo);
+    EOS_EResult (EOS_CALL *SetRelayControl)(EOS_HP2P handle, const EOS_P2P_SetRelayControlOptions* options);
+    EOS_EResult (EOS_CALL *SetPortRange)(EOS_HP2P handle, const EOS_P2P_SetPortRangeOptions* options);
+    EOS_ProductUserId (EOS_CALL *ProductUserIdFromString)(const char* productUserIdString);
+    EOS_EResult (EOS_CALL *ProductUserIdToString)(EOS_ProductUserId accountId, char* outBuffer, int32_t* inOutBufferLength);
+};
@@ -0,0 +1,279 @@
+#include "EOSP2PBenchmark.h"
+#include "EOSP2PDriver.h"
+
+#include "Engine/Core/Log.h"
+#include "Engine/Core/Collections/Sorting.h"
+#include "Engine/Core/Math/Math.h"
+#include "Engine/Engine/Engine.h"
+#include "Engine/Networking/NetworkConfig.h"
+#include "Engine/Networking/NetworkEvent.h"
+#include "Engine/Networking/NetworkPeer.h"
+#include "Engine/Platform/Platform.h"
+#include "Engine/Scripting/Enums.h"
+
+namespace
+{
+    // Written at the beginning of every message (the rest is the filler)
+    struct MessageHeader
+    {
+        double SendTime;
+        uint32 Sequence;
+        uint32 Size;
+    };
+
+    constexpr int32 MaxMessageSize = 16 * 1024;
+
+    // Time (in seconds) to wait for the connection and for the last messages after the sending ends
+    constexpr double ConnectTimeout = 10.0;
+    constexpr double DrainTimeout = 5.0;
+
+    float GetPercentile(const Array<float>& sorted, float percentile)
+    {
+        if (sorted.IsEmpty())
+            return 0.0f;
+        const int32 index = Math::Clamp((int32)Math::Ceil(percentile * (float)sorted.Count()) - 1, 0, sorted.Count() - 1);
+        return sorted[index];
+    }
+}
+
+EOSP2PBenchmark::EOSP2PBenchmark(const SpawnParams& params)
+    : ScriptingObject(params)
+{
+}
+
+EOSP2PBenchmark::~EOSP2PBenchmark()
+{
+    Stop();
+}
+
+bool EOSP2PBenchmark::Start(const EOSP2PBenchmarkSettings& settings)
+{
+    if (_running)
+    {
+        LOG(Warning, "EOS P2P benchmark is already running.");
+        return true;
+    }
+    Stop();
+    _settings = settings;
+    _latencies.Clear();
+    _latencies.EnsureCapacity((int32)(settings.Duration * (float)settings.MessagesPerSecond) + 1);
+    _sent = 0;
+    _bytesReceived = 0;
+    _random = (uint64)(uint32)settings.Link.Seed + 1;
+    _sendBudget = 0.0;
+    _startTime = Platform::GetTimeSeconds();
+    _sendStartTime = 0.0;
+    _endTime = 0.0;
+    _memoryGrowth = 0;
+    _packetsSent = 0;
+    _packetsLost = 0;
+    _connected = false;
+    _running = true;
+
+    // Bound before the drivers so the messages sent in the update get flushed in the same frame
+    Engine::LateUpdate.Bind<EOSP2PBenchmark, &EOSP2PBenchmark::OnUpdate>(this);
+
+    // Drivers are owned (and deleted) by the peers
+    _loopback = New<EOSP2PLoopback>(settings.Link);
+    EOSP2PDriver* drivers[2];
+    String addresses[2];
+    for (int32 i = 0; i < 2; i++)
+    {
+        drivers[i] = NewObject<EOSP2PDriver>();
+        drivers[i]->Batching = settings.Batching;
+        drivers[i]->UseIOThread = settings.UseIOThread;
+        drivers[i]->UseReliableStreams = settings.UseReliableStreams;
+        addresses[i] = _loopback->Attach(drivers[i]);
+    }
+    NetworkConfig config;
+    config.NetworkDriver = drivers[0];
+    config.ConnectionsLimit = 1;
+    config.MessageSize = MaxMessageSize;
+    config.MessagePoolSize = settings.MessagePoolSize;
+    _host = NetworkPeer::CreatePeer(config);
+    config.NetworkDriver = drivers[1];
+    config.Address = addresses[0];
+    _client = NetworkPeer::CreatePeer(config);
+    if (!_host || !_client || !_host->Listen() || !_client->Connect())
+    {
+        LOG(Error, "EOS P2P benchmark failed to start the peers.");
+        Stop();
+        return true;
+    }
+    LOG(Info, "EOS P2P benchmark started ({0} messages per second, {1} on {2} channel)", settings.MessagesPerSecond, ScriptingEnum::ToString(settings.Mix), ScriptingEnum::ToString(settings.Channel));
+    return false;
+}
+
+void EOSP2PBenchmark::Stop()
+{
+    Engine::LateUpdate.Unbind<EOSP2PBenchmark, &EOSP2PBenchmark::OnUpdate>(this);
+    if (_running && _endTime <= 0.0)
+        _endTime = Platform::GetTimeSeconds();
+    _running = false;
+    ReleasePeers();
+}
+
+EOSP2PBenchmarkReport EOSP2PBenchmark::GetReport() const
+{
+    EOSP2PBenchmarkReport report;
+    report.MessagesSent = _sent;
+    report.MessagesReceived = _latencies.Count();
+    report.PacketsSent = _loopback ? _loopback->GetPacketsSent() : _packetsSent;
+    report.PacketsLost = _loopback ? _loopback->GetPacketsLost() : _packetsLost;
+    const double endTime = _endTime > 0.0 ? _endTime : Platform::GetTimeSeconds();
+    report.Duration = _sendStartTime > 0.0 ? (float)(endTime - _sendStartTime) : 0.0f;
+    report.MessagesPerSecond = report.Duration > 0.0f ? (float)report.MessagesReceived / report.Duration : 0.0f;
+    report.BytesPerSecond = report.Duration > 0.0f ? (float)((double)_bytesReceived / report.Duration) : 0.0f;
+    report.MemoryGrowth = _memoryGrowth;
+
+    Array<float> sorted(_latencies);
+    Sorting::QuickSort(sorted.Get(), sorted.Count());
+    report.LatencyP50 = GetPercentile(sorted, 0.50f);
+    report.LatencyP90 = GetPercentile(sorted, 0.90f);
+    report.LatencyP99 = GetPercentile(sorted, 0.99f);
+    report.LatencyMax = sorted.HasItems() ? sorted.Last() : 0.0f;
+    return report;
+}
+
+void EOSP2PBenchmark::OnUpdate()
+{
+    const double now = Platform::GetTimeSeconds();
+    _loopback->Tick();
+    ReceiveMessages(_client, now);
+    ReceiveMessages(_host, now);
+    if (!_connected)
+    {
+        if (now - _startTime > ConnectTimeout)
+        {
+            LOG(Error, "EOS P2P benchmark failed to connect.");
+            Finish();
+        }
+        return;
+    }
+
+    const double sendEnd = _sendStartTime + (double)_settings.Duration;
+    if (now < sendEnd)
+    {
+        SendMessages(now);
+        _memoryGrowth = (int64)Platform::GetProcessMemoryStats().UsedPhysicalMemory - (int64)_startMemory;
+    }
+    else if (_latencies.Count() >= _sent || now - sendEnd > DrainTimeout)
+    {
+        Finish();
+    }
+}
+
+void EOSP2PBenchmark::SendMessages(double now)
+{
+    _sendBudget += (now - _lastSendTime) * (double)_settings.MessagesPerSecond;
+    _lastSendTime = now;
+    MessageHeader header;
+    header.SendTime = now;
+    while (_sendBudget >= 1.0)
+    {
+        _sendBudget -= 1.0;
+        header.Sequence = (uint32)_sent++;
+        header.Size = GetMessageSize();
+        NetworkMessage message = _client->BeginSendMessage();
+        message.WriteBytes((const uint8*)&header, sizeof(header));
+        Platform::MemorySet(message.Buffer + sizeof(header), header.Size - sizeof(header), (uint8)header.Sequence);
+        message.Position = header.Size;
+        message.Length = header.Size;
+        _client->EndSendMessage(_settings.Channel, message);
+    }
+}
+
+void EOSP2PBenchmark::ReceiveMessages(NetworkPeer* peer, double now)
+{
+    NetworkEvent event;
+    while (peer->PopEvent(event))
+    {
+        switch (event.EventType)
+        {
+        case NetworkEventType::Connected:
+            if (peer == _client && !_connected)
+            {
+                _connected = true;
+                _sendStartTime = now;
+                _lastSendTime = now;
+                _startMemory = Platform::GetProcessMemoryStats().UsedPhysicalMemory;
+            }
+            break;
+        case NetworkEventType::Disconnected:
+        case NetworkEventType::Timeout:
+            LOG(Warning, "EOS P2P benchmark peer got disconnected.");
+            break;
+        case NetworkEventType::Message:
+        {
+            MessageHeader header;
+            if (event.Message.Length >= sizeof(header))
+            {
+                Platform::MemoryCopy(&header, event.Message.Buffer, sizeof(header));
+                _latencies.Add((float)((now - header.SendTime) * 1000.0));
+                _bytesReceived += event.Message.Length;
+            }
+            peer->RecycleMessage(event.Message);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+}
+
+uint32 EOSP2PBenchmark::GetMessageSize()
+{
+    _random = _random * 6364136223846793005ull + 1442695040888963407ull;
+    const uint32 value = (uint32)(_random >> 33);
+    EOSP2PBenchmarkMix mix = _settings.Mix;
+    if (mix == EOSP2PBenchmarkMix::Mixed)
+    {
+        const uint32 roll = value % 100;
+        mix = roll < 80 ? EOSP2PBenchmarkMix::Small : roll < 95 ? EOSP2PBenchmarkMix::Medium : EOSP2PBenchmarkMix::Large;
+    }
+    switch (mix)
+    {
+    case EOSP2PBenchmarkMix::Small:
+        return 32 + (value >> 8) % 97;
+    case EOSP2PBenchmarkMix::Medium:
+        return 256 + (value >> 8) % 769;
+    default:
+        return 2048 + (value >> 8) % (MaxMessageSize - 2048 + 1);
+    }
+}
+
+void EOSP2PBenchmark::Finish()
+{
+    _endTime = Platform::GetTimeSeconds();
+    const auto report = GetReport();
+    LOG(Info, "EOS P2P benchmark finished: {0}/{1} messages received in {2}s, {3} msg/s, {4} B/s, latency p50: {5}ms, p90: {6}ms, p99: {7}ms, max: {8}ms, {9} packets ({10} lost), memory growth: {11} bytes",
+        report.MessagesReceived, report.MessagesSent, report.Duration, report.MessagesPerSecond, report.BytesPerSecond, report.LatencyP50, report.LatencyP90, report.LatencyP99, report.LatencyMax, report.PacketsSent, report.PacketsLost, report.MemoryGrowth);
+    Stop();
+    Finished();
+}
+
+void EOSP2PBenchmark::ReleasePeers()
+{
+    if (_loopback)
+    {
+        _packetsSent = _loopback->GetPacketsSent();
+        _packetsLost = _loopback->GetPacketsLost();
+    }
+
+    // Peers go first as their drivers use the loopback endpoints
+    if (_client)
+    {
+        NetworkPeer::ShutdownPeer(_client);
+        _client = nullptr;
+    }
+    if (_host)
+    {
+        NetworkPeer::ShutdownPeer(_host);
+        _host = nullptr;
+    }
+    if (_loopback)
+    {
+        Delete(_loopback);
+        _loopback = nullptr;
+    }
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "Engine/Core/Collections/Array.h"
+#include "Engine/Core/Delegate.h"
+#include "Engine/Networking/NetworkChannelType.h"
+#include "Engine/Scripting/ScriptingObject.h"
+#include "EOSP2PLoopback.h"
+
+class NetworkPeer;
+
+///<summary>
+/// The sizes of the messages sent by the P2P benchmark.
+///</summary>
+API_ENUM() enum class EOSP2PBenchmarkMix
+{
+    /** 32-128 bytes (eg. input and gameplay events), fits the batches */
+    Small = 0,
+    /** 256-1024 bytes (eg. state updates), single packet */
+    Medium = 1,
+    /** 2-16 KB (eg. level state), split into fragments */
+    Large = 2,
+    /** 80% small, 15% medium and 5% large messages */
+    Mixed = 3
+};
+
+/// <summary>
+/// The configuration of the EOS P2P benchmark.
+/// </summary>
+API_STRUCT(NoDefault, Namespace="FlaxEngine.Online.EOS") struct ONLINEPLATFORMEOS_API EOSP2PBenchmarkSettings
+{
+    DECLARE_SCRIPTING_TYPE_MINIMAL(EOSP2PBenchmarkSettings);
+
+    /// <summary>
+    /// The time (in seconds) of sending the messages.
+    /// </summary>
+    API_FIELD() float Duration = 10.0f;
+
+    /// <summary>
+    /// The amount of messages sent by the client to the host per second.
+    /// </summary>
+    API_FIELD() int32 MessagesPerSecond = 2000;
+
+    /// <summary>
+    /// The sizes of the sent messages.
+    /// </summary>
+    API_FIELD() EOSP2PBenchmarkMix Mix = EOSP2PBenchmarkMix::Mixed;
+
+    /// <summary>
+    /// The channel used to send the messages.
+    /// </summary>
+    API_FIELD() NetworkChannelType Channel = NetworkChannelType::ReliableOrdered;
+
+    /// <summary>
+    /// The driver batching option.
+    /// </summary>
+    API_FIELD() bool Batching = true;
+
+    /// <summary>
+    /// The driver I/O thread option.
+    /// </summary>
+    API_FIELD() bool UseIOThread = true;
+
+    /// <summary>
+    /// The driver reliable streams option.
+    /// </summary>
+    API_FIELD() bool UseReliableStreams = false;
+
+    /// <summary>
+    /// The network peers message pool size.
+    /// </summary>
+    API_FIELD() int32 MessagePoolSize = 2048;
+
+    /// <summary>
+    /// The simulated link between the client and the host.
+    /// </summary>
+    API_FIELD() EOSP2PLoopbackSettings Link;
+};
+
+/// <summary>
+/// The results of the EOS P2P benchmark. Latencies are in milliseconds.
+/// </summary>
+API_STRUCT(NoDefault, Namespace="FlaxEngine.Online.EOS") struct ONLINEPLATFORMEOS_API EOSP2PBenchmarkReport
+{
+    DECLARE_SCRIPTING_TYPE_MINIMAL(EOSP2PBenchmarkReport);
+
+    API_FIELD() int32 MessagesSent = 0;
+    API_FIELD() int32 MessagesReceived = 0;
+    API_FIELD() int64 PacketsSent = 0;
+    API_FIELD() int64 PacketsLost = 0;
+    API_FIELD() float Duration = 0.0f;
+    API_FIELD() float MessagesPerSecond = 0.0f;
+    API_FIELD() float BytesPerSecond = 0.0f;
+    API_FIELD() float LatencyP50 = 0.0f;
+    API_FIELD() float LatencyP90 = 0.0f;
+    API_FIELD() float LatencyP99 = 0.0f;
+    API_FIELD() float LatencyMax = 0.0f;
+
+    /// <summary>
+    /// The growth of the process memory (in bytes) while sending the messages. The allocations made on the hot path show up here once the pools stop covering them.
+    /// </summary>
+    API_FIELD() int64 MemoryGrowth = 0;
+};
+
+/// <summary>
+/// Benchmark of the EOS P2P driver that connects the client and the host in a single process through the loopback stand-in of the EOS P2P interface (no EOS platform or login needed).
+/// The client sends the messages at the fixed rate and the host measures the throughput and the latency (including the frame time, as the messages are received once per frame).
+/// </summary>
+API_CLASS(Sealed, Namespace="FlaxEngine.Online.EOS") class ONLINEPLATFORMEOS_API EOSP2PBenchmark : public ScriptingObject
+{
+    DECLARE_SCRIPTING_TYPE(EOSP2PBenchmark);
+private:
+    EOSP2PBenchmarkSettings _settings;
+    EOSP2PLoopback* _loopback = nullptr;
+    NetworkPeer* _host = nullptr;
+    NetworkPeer* _client = nullptr;
+    Array<float> _latencies;
+    int32 _sent = 0;
+    uint64 _bytesReceived = 0;
+    uint64 _random = 0;
+    double _sendBudget = 0.0;
+    double _startTime = 0.0;
+    double _sendStartTime = 0.0;
+    double _lastSendTime = 0.0;
+    double _endTime = 0.0;
+    uint64 _startMemory = 0;
+    int64 _memoryGrowth = 0;
+    int64 _packetsSent = 0;
+    int64 _packetsLost = 0;
+    bool _connected = false;
+    bool _running = false;
+
+public:
+    ~EOSP2PBenchmark();
+
+    /// <summary>
+    /// Event called when the benchmark finished.
+    /// </summary>
+    API_EVENT() Action Finished;
+
+    /// <summary>
+    /// Starts the benchmark.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    API_FUNCTION() bool Start(const EOSP2PBenchmarkSettings& settings);
+
+    /// <summary>
+    /// Stops the benchmark and releases the peers.
+    /// </summary>
+    API_FUNCTION() void Stop();
+
+    /// <summary>
+    /// Returns true if the benchmark is in progress.
+    /// </summary>
+    API_PROPERTY() bool IsRunning() const
+    {
+        return _running;
+    }
+
+    /// <summary>
+    /// Gets the current results of the benchmark.
+    /// </summary>
+    API_FUNCTION() EOSP2PBenchmarkReport GetReport() const;
+
+private:
+    void OnUpdate();
+    void SendMessages(double now);
+    void ReceiveMessages(NetworkPeer* peer, double now);
+    uint32 GetMessageSize();
+    void Finish();
+    void ReleasePeers();
+};
@@ -0,0 +1,1516 @@
+#include "EOSP2PDriver.h"
+#include "EOSPlatformContext.h"
+#include "OnlinePlatformEOS.h"
+
+#include "Engine/Core/Log.h"
+#include "Engine/Core/Math/Math.h"
+#include "Engine/Engine/Engine.h"
+#include "Engine/Networking/NetworkMessage.h"
+#include "Engine/Networking/NetworkPeer.h"
+#include "Engine/Networking/NetworkStats.h"
+#include "Engine/Online/Online.h"
+#include "Engine/Platform/Thread.h"
+#include "Engine/Scripting/Enums.h"
+#include "Engine/Threading/Threading.h"
+#include "Engine/Threading/ThreadSpawner.h"
+#include "Engine/Utilities/StringConverter.h"
+#include <EOSSDK/Include/eos_sdk.h>
+
+#include "EOSSDK/Include/eos_p2p.h"
+
+namespace
+{
+    // Every packet ends with its type so the payload starts at the beginning of the packet and whole messages can be received in-place
+    enum class PacketType : uint8
+    {
+        Message = 0,
+        Fragment = 1,
+        Batch = 2,
+        Ping = 3,
+        Pong = 4,
+        SnapshotAck = 5,
+    };
+
+    // Ping is sent back as pong with the same content
+    struct PingData
+    {
+        double Time;
+        uint32 Sequence;
+        uint32 Padding;
+    };
+
+    // Amount of the recent pings used to measure the packet loss
+    constexpr uint32 LossWindow = 16;
+
+    // NAT type detected in this session, -1 if not queried yet
+    volatile int64 CachedNATType = -1;
+
+    // Batched messages are prefixed with their length
+    typedef uint16 BatchLength;
+
+    // Fragment info written right before the packet type
+    struct FragmentHeader
+    {
+        uint32 Length;
+        uint16 MessageId;
+        uint16 Index;
+    };
+
+    constexpr uint32 MessageOverhead = sizeof(PacketType);
+    constexpr uint32 FragmentOverhead = sizeof(FragmentHeader) + sizeof(PacketType);
+    constexpr uint32 FragmentSize = EOS_P2P_MAX_PACKET_SIZE - FragmentOverhead;
+    constexpr uint32 BatchCapacity = EOS_P2P_MAX_PACKET_SIZE - sizeof(PacketType);
+
+    // Time (in seconds) the queues need to stay mostly empty before they shrink
+    constexpr double QueueShrinkDelay = 10.0;
+
+    EOS_EPacketReliability GetReliability(NetworkChannelType channelType)
+    {
+        switch (channelType)
+        {
+        case NetworkChannelType::Reliable:
+            return EOS_EPacketReliability::EOS_PR_ReliableUnordered;
+        case NetworkChannelType::ReliableOrdered:
+            return EOS_EPacketReliability::EOS_PR_ReliableOrdered;
+        default:
+            return EOS_EPacketReliability::EOS_PR_UnreliableUnordered;
+        }
+    }
+
+    EOS_ERelayControl GetRelayControl(EOSRelayPolicy policy)
+    {
+        switch (policy)
+        {
+        case EOSRelayPolicy::NoRelays:
+            return EOS_ERelayControl::EOS_RC_NoRelays;
+        case EOSRelayPolicy::ForceRelays:
+            return EOS_ERelayControl::EOS_RC_ForceRelays;
+        default:
+            return EOS_ERelayControl::EOS_RC_AllowRelays;
+        }
+    }
+
+    double GetOccupancy(uint64 size, uint64 maxSize)
+    {
+        return maxSize != EOS_P2P_MAX_QUEUE_SIZE_UNLIMITED ? (double)size / (double)maxSize : 0.0;
+    }
+}
+
+EOSP2PDriver::EOSP2PDriver(const SpawnParams& params)
+    : ScriptingObject(params)
+{
+    // Streams used by the Reliable and ReliableOrdered channels
+    AddStream(false);
+    AddStream(true);
+}
+
+bool EOSP2PDriver::Initialize(NetworkPeer* host, const NetworkConfig& config)
+{
+    _host = host;
+    _config = config;
+    if (!_context)
+    {
+        const auto platform = dynamic_cast<OnlinePlatformEOS*>(Online::Platform);
+        if (!platform)
+        {
+            LOG(Error, "EOS P2P driver requires the EOS online platform.");
+            return true;
+        }
+        _context = &platform->GetContext();
+    }
+    if (_api == &EOSP2PApi::Default)
+        _p2p = _context->GetP2P();
+    if (!_p2p || !_context->ProductUserId)
+    {
+        LOG(Error, "EOS P2P driver requires the user to be logged in (EOS P2P is not available with the server profile).");
+        return true;
+    }
+    if (SocketName.IsEmpty() || SocketName.Length() >= EOS_P2P_SOCKETID_SOCKETNAME_SIZE)
+    {
+        LOG(Error, "EOS P2P driver has invalid socket name.");
+        return true;
+    }
+
+    _socketId.ApiVersion = EOS_P2P_SOCKETID_API_LATEST;
+    Platform::MemoryClear(_socketId.SocketName, sizeof(_socketId.SocketName));
+    Platform::MemoryCopy(_socketId.SocketName, SocketName.Get(), SocketName.Length());
+    _nextConnectionId = 1;
+    _totalDataSent = 0;
+    _totalDataReceived = 0;
+    _queueFullCount = 0;
+    _streams.Init(host, _streamDescs, EOSP2PStreams::SendPacketCallback(this, &EOSP2PDriver::SendStreamPacket));
+    _snapshots.RawBytes = 0;
+    _snapshots.EncodedBytes = 0;
+    Platform::AtomicStore(&_droppedPackets, 0);
+    Platform::AtomicStore(&_congested, 0);
+    {
+        ScopeLock lock(_context->Locker);
+        SetPacketQueueSize(Math::Max(PacketQueueSize, 0), Math::Max(PacketQueueSize, 0));
+        ApplyConnectionPolicy();
+    }
+    if (UseIOThread)
+    {
+        for (EOSPacketRing& ring : _receiveRings)
+            ring.Init(PacketRingSize);
+        _sendRing.Init(PacketRingSize);
+        Platform::AtomicStore(&_threadExit, 0);
+        _thread = ThreadSpawner::Start(Function<int32()>(this, &EOSP2PDriver::ThreadRun), TEXT("EOS P2P"), ThreadPriority::AboveNormal);
+        if (!_thread)
+        {
+            LOG(Error, "EOS P2P driver failed to start the I/O thread.");
+            ReleaseRings();
+            return true;
+        }
+        if (!_context->HasServiceThread())
+            LOG(Info, "EOS P2P driver uses the I/O thread but the EOS platform is ticked on the game thread (packets arrive only on the platform tick).");
+    }
+    Engine::LateUpdate.Bind<EOSP2PDriver, &EOSP2PDriver::Flush>(this);
+    LOG(Info, "Initialized EOS P2P driver (socket: {0})", String(SocketName));
+    return false;
+}
+
+void EOSP2PDriver::Dispose()
+{
+    if (!_context)
+        return;
+    Engine::LateUpdate.Unbind<EOSP2PDriver, &EOSP2PDriver::Flush>(this);
+    if (_thread)
+    {
+        Platform::AtomicStore(&_threadExit, 1);
+        _thread->Join();
+        Delete(_thread);
+        _thread = nullptr;
+    }
+    Disconnect();
+    ReleaseRings();
+    _host = nullptr;
+    _context = nullptr;
+}
+
+bool EOSP2PDriver::Listen()
+{
+    _isServer = true;
+    return !AddNotifications();
+}
+
+bool EOSP2PDriver::Connect()
+{
+    _isServer = false;
+    const StringAsANSI<> address(_config.Address.Get(), _config.Address.Length());
+    const EOS_ProductUserId hostId = _api->ProductUserIdFromString(address.Get());
+    if (!hostId)
+    {
+        LOG(Error, "EOS P2P driver failed to connect, invalid host Product User ID: {0}", _config.Address);
+        return false;
+    }
+    if (AddNotifications())
+        return false;
+
+    // Accepting the connection to the host starts the connection negotiation
+    ScopeLock lock(_context->Locker);
+    const uint32 connectionId = GetConnectionId(hostId);
+    EOS_P2P_AcceptConnectionOptions options = {};
+    options.ApiVersion = EOS_P2P_ACCEPTCONNECTION_API_LATEST;
+    options.LocalUserId = _context->ProductUserId;
+    options.RemoteUserId = hostId;
+    options.SocketId = &_socketId;
+    const EOS_EResult result = _api->AcceptConnection(_p2p, &options);
+    if (result != EOS_EResult::EOS_Success)
+    {
+        LOG(Error, "EOS P2P driver failed to connect: {0}", String(EOS_EResult_ToString(result)));
+        return false;
+    }
+    _peers[connectionId].Accepted = true;
+    return true;
+}
+
+void EOSP2PDriver::Disconnect()
+{
+    if (!_context)
+        return;
+    {
+        ScopeLock lock(_context->Locker);
+        if (_p2p && _context->ProductUserId)
+        {
+            EOS_P2P_CloseConnectionsOptions options = {};
+            options.ApiVersion = EOS_P2P_CLOSECONNECTIONS_API_LATEST;
+            options.LocalUserId = _context->ProductUserId;
+            options.SocketId = &_socketId;
+            _api->CloseConnections(_p2p, &options);
+        }
+        RemoveNotifications();
+        for (auto& e : _peers)
+            ReleasePeer(e.Value);
+        _peers.Clear();
+        _connectionIds.Clear();
+        _streams.Clear(_releasedMessages);
+        _snapshots.Clear();
+        RecycleReleasedMessages();
+        if (_receivedBatch.Buffer)
+        {
+            _host->RecycleMessage(_receivedBatch);
+            _receivedBatch = NetworkMessage();
+        }
+        _receivedBatchData = nullptr;
+        _receivedBatchRing = nullptr;
+
+        // Drop the queued packets (send ring consumer is guarded by the context lock)
+        for (EOSPacketRing& ring : _receiveRings)
+        {
+            while (ring.Peek())
+                ring.Pop();
+        }
+        while (_sendRing.Peek())
+            _sendRing.Pop();
+    }
+    ScopeLock lock(_eventsLocker);
+    _events.Clear();
+    _eventsStart = 0;
+}
+
+void EOSP2PDriver::Disconnect(const NetworkConnection& connection)
+{
+    ScopeLock lock(_context->Locker);
+    Peer* peer = _peers.TryGet(connection.ConnectionId);
+    if (!peer)
+        return;
+    EOS_P2P_CloseConnectionOptions options = {};
+    options.ApiVersion = EOS_P2P_CLOSECONNECTION_API_LATEST;
+    options.LocalUserId = _context->ProductUserId;
+    options.RemoteUserId = peer->UserId;
+    options.SocketId = &_socketId;
+    _api->CloseConnection(_p2p, &options);
+    ReleasePeer(*peer);
+    _connectionIds.Remove(peer->UserId);
+    _peers.Remove(connection.ConnectionId);
+}
+
+bool EOSP2PDriver::PopEvent(NetworkEvent& eventPtr)
+{
+    // Connection events first
+    {
+        ScopeLock lock(_eventsLocker);
+        if (_eventsStart < _events.Count())
+        {
+            eventPtr = _events[_eventsStart++];
+            if (_eventsStart == _events.Count())
+            {
+                _events.Clear();
+                _eventsStart = 0;
+            }
+            return true;
+        }
+    }
+
+    const double now = Platform::GetTimeSeconds();
+    if (_thread)
+    {
+        if (now - _lastFragmentsUpdate >= 0.5)
+        {
+            ScopeLock lock(_context->Locker);
+            _lastFragmentsUpdate = now;
+            UpdateFragments(now);
+            RecycleReleasedMessages();
+        }
+        return PopReceivedPacket(eventPtr);
+    }
+
+    ScopeLock lock(_context->Locker);
+    RecycleReleasedMessages();
+    if (PopBatchMessage(eventPtr) || _streams.PopMessage(eventPtr))
+        return true;
+    const auto p2p = _p2p;
+    if (!p2p)
+        return false;
+    if (now - _lastFragmentsUpdate >= 0.5)
+    {
+        _lastFragmentsUpdate = now;
+        UpdateFragments(now);
+    }
+    while (true)
+    {
+        EOS_P2P_GetNextReceivedPacketSizeOptions sizeOptions = {};
+        sizeOptions.ApiVersion = EOS_P2P_GETNEXTRECEIVEDPACKETSIZE_API_LATEST;
+        sizeOptions.LocalUserId = _context->ProductUserId;
+        sizeOptions.RequestedChannel = nullptr;
+        uint32 packetSize;
+        if (_api->GetNextReceivedPacketSize(p2p, &sizeOptions, &packetSize) != EOS_EResult::EOS_Success)
+            return false;
+
+        // Receive directly into the pooled message buffer (the scratch buffer is used only if the message size is smaller than the packet)
+        NetworkMessage message = _host->CreateMessage();
+        uint8* data = packetSize <= message.BufferSize ? message.Buffer : _receiveBuffer;
+        EOS_P2P_ReceivePacketOptions options = {};
+        options.ApiVersion = EOS_P2P_RECEIVEPACKET_API_LATEST;
+        options.LocalUserId = _context->ProductUserId;
+        options.MaxDataSizeBytes = data == _receiveBuffer ? EOS_P2P_MAX_PACKET_SIZE : message.BufferSize;
+        options.RequestedChannel = nullptr;
+        EOS_ProductUserId peerId;
+        EOS_P2P_SocketId socketId;
+        uint8 channel;
+        uint32 bytesWritten = 0;
+        const EOS_EResult result = _api->ReceivePacket(p2p, &options, &peerId, &socketId, &channel, data, &bytesWritten);
+        if (result != EOS_EResult::EOS_Success)
+        {
+            _host->RecycleMessage(message);
+            return false;
+        }
+        _totalDataReceived += bytesWritten;
+        const uint32 connectionId = GetConnectionId(peerId);
+        const PacketType type = bytesWritten != 0 ? (PacketType)data[bytesWritten - 1] : PacketType::Message;
+        if (channel == ControlChannel)
+        {
+            ReceiveControl(connectionId, data, bytesWritten);
+            _host->RecycleMessage(message);
+            continue;
+        }
+        if (channel == StreamChannel)
+        {
+            _streams.Receive(connectionId, data, bytesWritten, now);
+            _host->RecycleMessage(message);
+            if (_streams.PopMessage(eventPtr))
+                return true;
+            continue;
+        }
+        if (channel == SnapshotChannel)
+        {
+            const bool decoded = ReceiveSnapshot(connectionId, data, bytesWritten, eventPtr);
+            _host->RecycleMessage(message);
+            if (decoded)
+                return true;
+            continue;
+        }
+        if (type == PacketType::Fragment)
+        {
+            const bool completed = ReceiveFragment(connectionId, channel, data, bytesWritten, eventPtr);
+            _host->RecycleMessage(message);
+            if (completed)
+                return true;
+            continue;
+        }
+        if (type == PacketType::Batch)
+        {
+            // Batch is unpacked in-place, messages are popped one by one from it
+            _receivedBatch = message;
+            _receivedBatchData = data;
+            _receivedBatchSize = bytesWritten - sizeof(PacketType);
+            _receivedBatchPosition = 0;
+            _receivedBatchSender = connectionId;
+            if (PopBatchMessage(eventPtr))
+                return true;
+            continue;
+        }
+        if (type != PacketType::Message || bytesWritten < MessageOverhead || data != message.Buffer)
+        {
+            LOG(Warning, "EOS P2P driver dropped invalid {0} bytes packet (message size limit is {1})", bytesWritten, message.BufferSize);
+            _host->RecycleMessage(message);
+            continue;
+        }
+        message.Length = bytesWritten - MessageOverhead;
+        message.Position = 0;
+        eventPtr.EventType = NetworkEventType::Message;
+        eventPtr.Message = message;
+        eventPtr.Sender.ConnectionId = connectionId;
+        return true;
+    }
+}
+
+void EOSP2PDriver::SendMessage(NetworkChannelType channelType, const NetworkMessage& message)
+{
+    ScopeLock lock(_context->Locker);
+    Array<Peer*, InlinedAllocation<64>> peers;
+    for (auto& e : _peers)
+    {
+        if (e.Value.Connected)
+            peers.Add(&e.Value);
+    }
+    Send(channelType, message, ToSpan(peers));
+}
+
+void EOSP2PDriver::SendMessage(NetworkChannelType channelType, const NetworkMessage& message, NetworkConnection target)
+{
+    ScopeLock lock(_context->Locker);
+    Peer* peer = _peers.TryGet(target.ConnectionId);
+    if (peer)
+        Send(channelType, message, Span<Peer*>(&peer, 1));
+}
+
+void EOSP2PDriver::SendMessage(NetworkChannelType channelType, const NetworkMessage& message, const Array<NetworkConnection, HeapAllocation>& targets)
+{
+    ScopeLock lock(_context->Locker);
+    Array<Peer*, InlinedAllocation<64>> peers;
+    for (const NetworkConnection& target : targets)
+    {
+        Peer* peer = _peers.TryGet(target.ConnectionId);
+        if (peer)
+            peers.Add(peer);
+    }
+    Send(channelType, message, ToSpan(peers));
+}
+
+void EOSP2PDriver::Flush()
+{
+    if (!_context)
+        return;
+    bool congestionChanged = false;
+    {
+        ScopeLock lock(_context->Locker);
+        const auto p2p = _p2p;
+        const double now = Platform::GetTimeSeconds();
+        for (auto& e : _peers)
+        {
+            for (int32 channel = 0; channel < ChannelsCount; channel++)
+                FlushBatch(p2p, (NetworkChannelType)channel, e.Value);
+            if (e.Value.Connected && PingInterval > 0.0f && now - e.Value.Quality.LastPingTime >= PingInterval)
+                SendPing(p2p, e.Value, now);
+            uint32 snapshot;
+            if (e.Value.Connected && _snapshots.PopAck(e.Key, snapshot))
+                SendSnapshotAck(p2p, e.Value, snapshot);
+        }
+        _streams.Update(now);
+        UpdatePacketQueues(now, congestionChanged);
+    }
+    if (congestionChanged)
+        CongestionChanged(IsCongested());
+}
+
+EOSP2PQueueStats EOSP2PDriver::GetQueueStats()
+{
+    EOSP2PQueueStats stats;
+    if (_context)
+    {
+        ScopeLock lock(_context->Locker);
+        stats.IncomingQueueMaxSize = _queueInfo.IncomingPacketQueueMaxSizeBytes;
+        stats.IncomingQueueSize = _queueInfo.IncomingPacketQueueCurrentSizeBytes;
+        stats.IncomingQueuePackets = _queueInfo.IncomingPacketQueueCurrentPacketCount;
+        stats.OutgoingQueueMaxSize = _queueInfo.OutgoingPacketQueueMaxSizeBytes;
+        stats.OutgoingQueueSize = _queueInfo.OutgoingPacketQueueCurrentSizeBytes;
+        stats.OutgoingQueuePackets = _queueInfo.OutgoingPacketQueueCurrentPacketCount;
+        stats.IncomingQueueFullCount = _queueFullCount;
+    }
+    stats.DroppedPackets = Platform::AtomicRead(&_droppedPackets);
+    stats.IsCongested = IsCongested();
+    return stats;
+}
+
+NetworkDriverStats EOSP2PDriver::GetStats()
+{
+    NetworkDriverStats stats;
+    stats.TotalDataSent = _totalDataSent;
+    stats.TotalDataReceived = _totalDataReceived;
+    if (_context)
+    {
+        // Average over all the connections
+        ScopeLock lock(_context->Locker);
+        int32 count = 0;
+        for (const auto& e : _peers)
+        {
+            if (e.Value.Connected)
+            {
+                stats.RTT += e.Value.Quality.RTT;
+                count++;
+            }
+        }
+        if (count != 0)
+            stats.RTT /= (float)count;
+    }
+    return stats;
+}
+
+NetworkDriverStats EOSP2PDriver::GetStats(NetworkConnection target)
+{
+    NetworkDriverStats stats;
+    stats.TotalDataSent = _totalDataSent;
+    stats.TotalDataReceived = _totalDataReceived;
+    EOSP2PConnectionQuality quality;
+    if (GetConnectionQuality(target.ConnectionId, quality))
+        stats.RTT = quality.RTT;
+    return stats;
+}
+
+int32 EOSP2PDriver::AddStream(bool ordered, int32 priority)
+{
+    EOSP2PStreams::StreamDesc desc;
+    desc.Ordered = ordered;
+    desc.Priority = priority;
+    _streamDescs.Add(desc);
+    return _streamDescs.Count() - 1;
+}
+
+bool EOSP2PDriver::SendStreamMessage(int32 stream, const NetworkMessage& message, const NetworkConnection& target)
+{
+    if (!_context)
+        return true;
+    ScopeLock lock(_context->Locker);
+    const Peer* peer = _peers.TryGet(target.ConnectionId);
+    if (!peer)
+        return true;
+    return _streams.Send(peer->ConnectionId, stream, message);
+}
+
+bool EOSP2PDriver::SendSnapshot(const NetworkMessage& message, const NetworkConnection& target)
+{
+    if (!_context)
+        return true;
+    ScopeLock lock(_context->Locker);
+    Peer* peer = _peers.TryGet(target.ConnectionId);
+    if (!peer || !peer->Connected)
+        return true;
+    const uint8* data;
+    uint32 size;
+    _snapshots.Encode(peer->ConnectionId, message.Buffer, message.Length, data, size);
+    SendData(_p2p, SnapshotChannel, data, size, Span<Peer*>(&peer, 1));
+    return false;
+}
+
+float EOSP2PDriver::GetSnapshotCompressionRatio()
+{
+    if (!_context)
+        return 1.0f;
+    ScopeLock lock(_context->Locker);
+    return _snapshots.RawBytes != 0 ? (float)((double)_snapshots.EncodedBytes / (double)_snapshots.RawBytes) : 1.0f;
+}
+
+EOSNATType EOSP2PDriver::GetNATType()
+{
+    const int64 natType = Platform::AtomicRead(&CachedNATType);
+    return natType > 0 ? (EOSNATType)natType : EOSNATType::Unknown;
+}
+
+bool EOSP2PDriver::GetConnectionQuality(uint32 connectionId, EOSP2PConnectionQuality& result)
+{
+    if (!_context)
+        return false;
+    ScopeLock lock(_context->Locker);
+    const Peer* peer = _peers.TryGet(connectionId);
+    if (!peer)
+        return false;
+    const PeerQuality& quality = peer->Quality;
+    result.RTT = quality.RTT;
+    result.Jitter = quality.Jitter;
+    result.IsRelayed = quality.Relayed;
+
+    // The most recent ping can be still in-flight so it's skipped
+    const uint32 count = Math::Min(quality.PingSequence > 0 ? quality.PingSequence - 1 : 0, LossWindow);
+    uint32 lost = 0;
+    for (uint32 i = 1; i <= count; i++)
+    {
+        if ((quality.PongMask & (1u << i)) == 0)
+            lost++;
+    }
+    result.PacketLoss = count != 0 ? (float)lost / (float)count : 0.0f;
+    return true;
+}
+
+bool EOSP2PDriver::AddNotifications()
+{
+    ScopeLock lock(_context->Locker);
+    const auto p2p = _p2p;
+    if (_connectionRequestId == EOS_INVALID_NOTIFICATIONID)
+    {
+        EOS_P2P_AddNotifyPeerConnectionRequestOptions options = {};
+        options.ApiVersion = EOS_P2P_ADDNOTIFYPEERCONNECTIONREQUEST_API_LATEST;
+        options.LocalUserId = _context->ProductUserId;
+        options.SocketId = &_socketId;
+        _connectionRequestId = _api->AddNotifyPeerConnectionRequest(p2p, &options, this, &EOSP2PDriver::OnConnectionRequest);
+    }
+    if (_connectionEstablishedId == EOS_INVALID_NOTIFICATIONID)
+    {
+        EOS_P2P_AddNotifyPeerConnectionEstablishedOptions options = {};
+        options.ApiVersion = EOS_P2P_ADDNOTIFYPEERCONNECTIONESTABLISHED_API_LATEST;
+        options.LocalUserId = _context->ProductUserId;
+        options.SocketId = &_socketId;
+        _connectionEstablishedId = _api->AddNotifyPeerConnectionEstablished(p2p, &options, this, &EOSP2PDriver::OnConnectionEstablished);
+    }
+    if (_connectionClosedId == EOS_INVALID_NOTIFICATIONID)
+    {
+        EOS_P2P_AddNotifyPeerConnectionClosedOptions options = {};
+        options.ApiVersion = EOS_P2P_ADDNOTIFYPEERCONNECTIONCLOSED_API_LATEST;
+        options.LocalUserId = _context->ProductUserId;
+        options.SocketId = &_socketId;
+        _connectionClosedId = _api->AddNotifyPeerConnectionClosed(p2p, &options, this, &EOSP2PDriver::OnConnectionClosed);
+    }
+    if (_queueFullId == EOS_INVALID_NOTIFICATIONID)
+    {
+        EOS_P2P_AddNotifyIncomingPacketQueueFullOptions options = {};
+        options.ApiVersion = EOS_P2P_ADDNOTIFYINCOMINGPACKETQUEUEFULL_API_LATEST;
+        _queueFullId = _api->AddNotifyIncomingPacketQueueFull(p2p, &options, this, &EOSP2PDriver::OnIncomingPacketQueueFull);
+        if (_queueFullId == EOS_INVALID_NOTIFICATIONID)
+            LOG(Warning, "EOS P2P driver failed to register the packet queue notification.");
+    }
+    if (_connectionRequestId == EOS_INVALID_NOTIFICATIONID || _connectionEstablishedId == EOS_INVALID_NOTIFICATIONID || _connectionClosedId == EOS_INVALID_NOTIFICATIONID)
+    {
+        LOG(Error, "EOS P2P driver failed to register the connection notifications.");
+        RemoveNotifications();
+        return true;
+    }
+    return false;
+}
+
+void EOSP2PDriver::RemoveNotifications()
+{
+    const auto p2p = _p2p;
+    if (_connectionRequestId != EOS_INVALID_NOTIFICATIONID)
+    {
+        _api->RemoveNotifyPeerConnectionRequest(p2p, _connectionRequestId);
+        _connectionRequestId = EOS_INVALID_NOTIFICATIONID;
+    }
+    if (_connectionEstablishedId != EOS_INVALID_NOTIFICATIONID)
+    {
+        _api->RemoveNotifyPeerConnectionEstablished(p2p, _connectionEstablishedId);
+        _connectionEstablishedId = EOS_INVALID_NOTIFICATIONID;
+    }
+    if (_connectionClosedId != EOS_INVALID_NOTIFICATIONID)
+    {
+        _api->RemoveNotifyPeerConnectionClosed(p2p, _connectionClosedId);
+        _connectionClosedId = EOS_INVALID_NOTIFICATIONID;
+    }
+    if (_queueFullId != EOS_INVALID_NOTIFICATIONID)
+    {
+        _api->RemoveNotifyIncomingPacketQueueFull(p2p, _queueFullId);
+        _queueFullId = EOS_INVALID_NOTIFICATIONID;
+    }
+}
+
+uint32 EOSP2PDriver::GetConnectionId(EOS_ProductUserId userId)
+{
+    uint32 connectionId;
+    if (_connectionIds.TryGet(userId, connectionId))
+        return connectionId;
+    connectionId = _nextConnectionId++;
+    Peer& peer = _peers[connectionId];
+    peer.UserId = userId;
+    peer.ConnectionId = connectionId;
+    peer.Connected = false;
+    peer.Accepted = false;
+    _connectionIds.Add(userId, connectionId);
+    return connectionId;
+}
+
+String EOSP2PDriver::GetUserName(EOS_ProductUserId userId) const
+{
+    char buffer[EOS_PRODUCTUSERID_MAX_LENGTH + 1];
+    int32_t length = sizeof(buffer);
+    if (_api->ProductUserIdToString(userId, buffer, &length) != EOS_EResult::EOS_Success)
+        return String::Empty;
+    return String(buffer);
+}
+
+void EOSP2PDriver::PushEvent(NetworkEventType type, uint32 connectionId)
+{
+    NetworkEvent e;
+    e.EventType = type;
+    e.Sender.ConnectionId = connectionId;
+    ScopeLock lock(_eventsLocker);
+    _events.Add(e);
+}
+
+void EOSP2PDriver::Send(NetworkChannelType channelType, const NetworkMessage& message, const Span<Peer*>& targets)
+{
+    if (targets.Length() == 0)
+        return;
+    const auto p2p = _p2p;
+
+    if (UseReliableStreams && (channelType == NetworkChannelType::Reliable || channelType == NetworkChannelType::ReliableOrdered))
+    {
+        const int32 stream = channelType == NetworkChannelType::Reliable ? 0 : 1;
+        for (int32 i = 0; i < targets.Length(); i++)
+            _streams.Send(targets[i]->ConnectionId, stream, message);
+        return;
+    }
+
+    // Small message is appended to the batch of each target (flushed when full and at the end of the frame)
+    if (Batching && message.Length + sizeof(BatchLength) <= BatchCapacity)
+    {
+        const BatchLength length = (BatchLength)message.Length;
+        for (int32 i = 0; i < targets.Length(); i++)
+        {
+            Peer* peer = targets[i];
+            Batch& batch = peer->Batches[(int32)channelType];
+            if (batch.Size + sizeof(BatchLength) + length > BatchCapacity)
+                FlushBatch(p2p, channelType, *peer);
+            Platform::MemoryCopy(batch.Data + batch.Size, &length, sizeof(BatchLength));
+            Platform::MemoryCopy(batch.Data + batch.Size + sizeof(BatchLength), message.Buffer, length);
+            batch.Size += sizeof(BatchLength) + length;
+        }
+        return;
+    }
+
+    // Keep the order with the already batched messages on this channel
+    for (int32 i = 0; i < targets.Length(); i++)
+        FlushBatch(p2p, channelType, *targets[i]);
+    SendData(p2p, (uint8)channelType, message.Buffer, message.Length, targets);
+}
+
+void EOSP2PDriver::SendData(EOS_HP2P p2p, uint8 channel, const uint8* data, uint32 length, const Span<Peer*>& targets)
+{
+    // Small message goes as a single packet
+    if (length + MessageOverhead <= EOS_P2P_MAX_PACKET_SIZE)
+    {
+        Platform::MemoryCopy(_packetBuffer, data, length);
+        _packetBuffer[length] = (uint8)PacketType::Message;
+        for (int32 i = 0; i < targets.Length(); i++)
+            SendPacket(p2p, (NetworkChannelType)channel, _packetBuffer, length + MessageOverhead, targets[i]->UserId);
+        return;
+    }
+
+    // Large message is split into fragments (sent over the same channel so they follow the channel reliability)
+    const uint32 count = (length + FragmentSize - 1) / FragmentSize;
+    if (count > MAX_uint16)
+    {
+        LOG(Error, "EOS P2P driver can't send {0} bytes message (too many fragments)", length);
+        return;
+    }
+    FragmentHeader header;
+    header.Length = length;
+    header.MessageId = _nextMessageId++;
+    for (uint32 index = 0; index < count; index++)
+    {
+        const uint32 offset = index * FragmentSize;
+        const uint32 size = Math::Min(FragmentSize, length - offset);
+        header.Index = (uint16)index;
+        Platform::MemoryCopy(_packetBuffer, data + offset, size);
+        Platform::MemoryCopy(_packetBuffer + size, &header, sizeof(header));
+        _packetBuffer[size + sizeof(header)] = (uint8)PacketType::Fragment;
+        for (int32 i = 0; i < targets.Length(); i++)
+            SendPacket(p2p, (NetworkChannelType)channel, _packetBuffer, size + FragmentOverhead, targets[i]->UserId);
+    }
+}
+
+void EOSP2PDriver::SendPacket(EOS_HP2P p2p, NetworkChannelType channelType, const uint8* data, uint32 size, EOS_ProductUserId target)
+{
+    if (_thread)
+    {
+        if (DropPacket((uint8)channelType))
+            return;
+
+        // Queue for the I/O thread, when the ring is full send the queued packets right away to keep the order
+        EOSPacketRing::Packet* packet = _sendRing.BeginWrite();
+        if (!packet)
+        {
+            SendQueuedPackets(p2p);
+            packet = _sendRing.BeginWrite();
+        }
+        packet->UserId = target;
+        packet->Channel = (uint8)channelType;
+        packet->Size = size;
+        Platform::MemoryCopy(packet->Data, data, size);
+        _sendRing.EndWrite();
+        return;
+    }
+    if (DropPacket((uint8)channelType))
+        return;
+    SendPacketNow(p2p, (uint8)channelType, data, size, target);
+}
+
+void EOSP2PDriver::SendPacketNow(EOS_HP2P p2p, uint8 channel, const uint8* data, uint32 size, EOS_ProductUserId target)
+{
+    EOS_P2P_SendPacketOptions options = {};
+    options.ApiVersion = EOS_P2P_SENDPACKET_API_LATEST;
+    options.LocalUserId = _context->ProductUserId;
+    options.RemoteUserId = target;
+    options.SocketId = &_socketId;
+    options.Channel = channel;
+    options.DataLengthBytes = size;
+    options.Data = data;
+    options.bAllowDelayedDelivery = EOS_TRUE;
+    options.Reliability = GetReliability((NetworkChannelType)channel);
+    options.bDisableAutoAcceptConnection = EOS_TRUE;
+    const EOS_EResult result = _api->SendPacket(p2p, &options);
+    if (result != EOS_EResult::EOS_Success)
+    {
+        LOG(Warning, "EOS P2P driver failed to send packet: {0}", String(EOS_EResult_ToString(result)));
+        return;
+    }
+    _totalDataSent += size;
+}
+
+void EOSP2PDriver::FlushBatch(EOS_HP2P p2p, NetworkChannelType channelType, Peer& peer)
+{
+    Batch& batch = peer.Batches[(int32)channelType];
+    if (batch.Size == 0)
+        return;
+    batch.Data[batch.Size] = (uint8)PacketType::Batch;
+    SendPacket(p2p, channelType, batch.Data, batch.Size + sizeof(PacketType), peer.UserId);
+    batch.Size = 0;
+}
+
+bool EOSP2PDriver::PopBatchMessage(NetworkEvent& eventPtr)
+{
+    while (_receivedBatchData)
+    {
+        if (_receivedBatchPosition + sizeof(BatchLength) > _receivedBatchSize)
+        {
+            // Batch fully read
+            if (_receivedBatchRing)
+                _receivedBatchRing->Pop();
+            else if (_receivedBatch.Buffer)
+                _host->RecycleMessage(_receivedBatch);
+            _receivedBatch = NetworkMessage();
+            _receivedBatchRing = nullptr;
+            _receivedBatchData = nullptr;
+            return false;
+        }
+        BatchLength length;
+        Platform::MemoryCopy(&length, _receivedBatchData + _receivedBatchPosition, sizeof(BatchLength));
+        const uint8* data = _receivedBatchData + _receivedBatchPosition + sizeof(BatchLength);
+        _receivedBatchPosition += sizeof(BatchLength) + length;
+        if (_receivedBatchPosition > _receivedBatchSize)
+        {
+            LOG(Warning, "EOS P2P driver dropped invalid batch");
+            _receivedBatchPosition = _receivedBatchSize;
+            continue;
+        }
+
+        // Each message owns the pooled buffer (recycled by the peer) so it's copied straight from the received packet
+        NetworkMessage message = _host->CreateMessage();
+        if (length > message.BufferSize)
+        {
+            LOG(Warning, "EOS P2P driver dropped {0} bytes message (message size limit is {1})", length, message.BufferSize);
+            _host->RecycleMessage(message);
+            continue;
+        }
+        Platform::MemoryCopy(message.Buffer, data, length);
+        message.Length = length;
+        message.Position = 0;
+        eventPtr.EventType = NetworkEventType::Message;
+        eventPtr.Message = message;
+        eventPtr.Sender.ConnectionId = _receivedBatchSender;
+        return true;
+    }
+    return false;
+}
+
+bool EOSP2PDriver::PopReceivedPacket(NetworkEvent& eventPtr)
+{
+    if (PopBatchMessage(eventPtr))
+        return true;
+    {
+        ScopeLock lock(_context->Locker);
+        if (_streams.PopMessage(eventPtr))
+            return true;
+    }
+    for (EOSPacketRing& ring : _receiveRings)
+    {
+        while (EOSPacketRing::Packet* packet = ring.Peek())
+        {
+            if (packet->Channel == StreamChannel)
+            {
+                bool delivered;
+                {
+                    ScopeLock lock(_context->Locker);
+                    _streams.Receive(packet->ConnectionId, packet->Data, packet->Size, Platform::GetTimeSeconds());
+                    delivered = _streams.PopMessage(eventPtr);
+                }
+                ring.Pop();
+                if (delivered)
+                    return true;
+                continue;
+            }
+            if (packet->Channel == SnapshotChannel)
+            {
+                bool decoded;
+                {
+                    ScopeLock lock(_context->Locker);
+                    decoded = ReceiveSnapshot(packet->ConnectionId, packet->Data, packet->Size, eventPtr);
+                }
+                ring.Pop();
+                if (decoded)
+                    return true;
+                continue;
+            }
+            const PacketType type = packet->Size != 0 ? (PacketType)packet->Data[packet->Size - 1] : PacketType::Message;
+            if (type == PacketType::Fragment)
+            {
+                bool completed;
+                {
+                    ScopeLock lock(_context->Locker);
+                    completed = ReceiveFragment(packet->ConnectionId, packet->Channel, packet->Data, packet->Size, eventPtr);
+                }
+                ring.Pop();
+                if (completed)
+                    return true;
+                continue;
+            }
+            if (type == PacketType::Batch)
+            {
+                // Batch stays in the ring slot until all of its messages are popped
+                _receivedBatchRing = &ring;
+                _receivedBatchData = packet->Data;
+                _receivedBatchSize = packet->Size - sizeof(PacketType);
+                _receivedBatchPosition = 0;
+                _receivedBatchSender = packet->ConnectionId;
+                if (PopBatchMessage(eventPtr))
+                    return true;
+                continue;
+            }
+            NetworkMessage message = _host->CreateMessage();
+            if (type != PacketType::Message || packet->Size < MessageOverhead || packet->Size - MessageOverhead > message.BufferSize)
+            {
+                LOG(Warning, "EOS P2P driver dropped invalid {0} bytes packet (message size limit is {1})", packet->Size, message.BufferSize);
+                _host->RecycleMessage(message);
+                ring.Pop();
+                continue;
+            }
+            message.Length = packet->Size - MessageOverhead;
+            message.Position = 0;
+            Platform::MemoryCopy(message.Buffer, packet->Data, message.Length);
+            eventPtr.EventType = NetworkEventType::Message;
+            eventPtr.Message = message;
+            eventPtr.Sender.ConnectionId = packet->ConnectionId;
+            ring.Pop();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool EOSP2PDriver::ReceivePackets(EOS_HP2P p2p)
+{
+    bool received = false;
+    for (int32 channel = 0; channel <= SnapshotChannel; channel++)
+    {
+        // Channels are received separately so the full ring doesn't block the others
+        EOSPacketRing& ring = _receiveRings[channel];
+        const uint8 requestedChannel = (uint8)channel;
+        EOS_P2P_GetNextReceivedPacketSizeOptions sizeOptions = {};
+        sizeOptions.ApiVersion = EOS_P2P_GETNEXTRECEIVEDPACKETSIZE_API_LATEST;
+        sizeOptions.LocalUserId = _context->ProductUserId;
+        sizeOptions.RequestedChannel = &requestedChannel;
+        EOS_P2P_ReceivePacketOptions options = {};
+        options.ApiVersion = EOS_P2P_RECEIVEPACKET_API_LATEST;
+        options.LocalUserId = _context->ProductUserId;
+        options.MaxDataSizeBytes = EOS_P2P_MAX_PACKET_SIZE;
+        options.RequestedChannel = &requestedChannel;
+        EOSPacketRing::Packet* packet;
+        uint32 packetSize;
+        while ((packet = ring.BeginWrite()) != nullptr && _api->GetNextReceivedPacketSize(p2p, &sizeOptions, &packetSize) == EOS_EResult::EOS_Success)
+        {
+            EOS_P2P_SocketId socketId;
+            if (_api->ReceivePacket(p2p, &options, &packet->UserId, &socketId, &packet->Channel, packet->Data, &packet->Size) != EOS_EResult::EOS_Success)
+                break;
+            packet->ConnectionId = GetConnectionId(packet->UserId);
+            _totalDataReceived += packet->Size;
+            received = true;
+            if (packet->Channel == ControlChannel)
+            {
+                // Pings are answered right away so the measured time doesn't include the frame time
+                ReceiveControl(packet->ConnectionId, packet->Data, packet->Size);
+                continue;
+            }
+            ring.EndWrite();
+        }
+    }
+    return received;
+}
+
+bool EOSP2PDriver::SendQueuedPackets(EOS_HP2P p2p)
+{
+    EOS_P2P_SendPacketOptions options = {};
+    options.ApiVersion = EOS_P2P_SENDPACKET_API_LATEST;
+    options.LocalUserId = _context->ProductUserId;
+    options.SocketId = &_socketId;
+    options.bAllowDelayedDelivery = EOS_TRUE;
+    options.bDisableAutoAcceptConnection = EOS_TRUE;
+    bool sent = false;
+    while (EOSPacketRing::Packet* packet = _sendRing.Peek())
+    {
+        if (DropPacket(packet->Channel))
+        {
+            // Stale unreliable packet that waited in the ring during the congestion
+            _sendRing.Pop();
+            continue;
+        }
+        options.RemoteUserId = packet->UserId;
+        options.Channel = packet->Channel;
+        options.DataLengthBytes = packet->Size;
+        options.Data = packet->Data;
+        options.Reliability = GetReliability((NetworkChannelType)packet->Channel);
+        const EOS_EResult result = _api->SendPacket(p2p, &options);
+        if (result != EOS_EResult::EOS_Success)
+            LOG(Warning, "EOS P2P driver failed to send packet: {0}", String(EOS_EResult_ToString(result)));
+        else
+            _totalDataSent += packet->Size;
+        _sendRing.Pop();
+        sent = true;
+    }
+    return sent;
+}
+
+void EOSP2PDriver::RecycleReleasedMessages()
+{
+    if (!_host)
+        return;
+    for (const NetworkMessage& message : _releasedMessages)
+        _host->RecycleMessage(message);
+    _releasedMessages.Clear();
+}
+
+bool EOSP2PDriver::DropPacket(uint8 channel)
+{
+    // Unreliable traffic (with the snapshots) is dropped first so the reliable one can still get through the congested queue (streams and pings are never dropped)
+    if (Platform::AtomicRead(&_congested) == 0 || channel == ControlChannel || channel == StreamChannel || GetReliability((NetworkChannelType)channel) != EOS_EPacketReliability::EOS_PR_UnreliableUnordered)
+        return false;
+    Platform::InterlockedIncrement(&_droppedPackets);
+    return true;
+}
+
+void EOSP2PDriver::SetPacketQueueSize(uint64 incoming, uint64 outgoing)
+{
+    EOS_P2P_SetPacketQueueSizeOptions options = {};
+    options.ApiVersion = EOS_P2P_SETPACKETQUEUESIZE_API_LATEST;
+    options.IncomingPacketQueueMaxSizeBytes = incoming;
+    options.OutgoingPacketQueueMaxSizeBytes = outgoing;
+    const EOS_EResult result = _api->SetPacketQueueSize(_p2p, &options);
+    if (result != EOS_EResult::EOS_Success)
+    {
+        LOG(Warning, "EOS P2P driver failed to set the packet queue size: {0}", String(EOS_EResult_ToString(result)));
+        return;
+    }
+    _incomingQueueSize = incoming;
+    _outgoingQueueSize = outgoing;
+}
+
+void EOSP2PDriver::UpdatePacketQueues(double now, bool& congestionChanged)
+{
+    EOS_P2P_GetPacketQueueInfoOptions options = {};
+    options.ApiVersion = EOS_P2P_GETPACKETQUEUEINFO_API_LATEST;
+    if (_api->GetPacketQueueInfo(_p2p, &options, &_queueInfo) != EOS_EResult::EOS_Success)
+        return;
+    const double incoming = GetOccupancy(_queueInfo.IncomingPacketQueueCurrentSizeBytes, _queueInfo.IncomingPacketQueueMaxSizeBytes);
+    const double outgoing = GetOccupancy(_queueInfo.OutgoingPacketQueueCurrentSizeBytes, _queueInfo.OutgoingPacketQueueMaxSizeBytes);
+    const uint64 minSize = (uint64)Math::Max(PacketQueueSize, 0);
+    const uint64 maxSize = Math::Max((uint64)Math::Max(MaxPacketQueueSize, 0), minSize);
+    if (minSize != EOS_P2P_MAX_QUEUE_SIZE_UNLIMITED)
+    {
+        // Grow the outgoing queue before treating the connection as congested
+        if (outgoing >= CongestionThreshold && _outgoingQueueSize < maxSize)
+        {
+            SetPacketQueueSize(_incomingQueueSize, Math::Min(_outgoingQueueSize * 2, maxSize));
+            LOG(Info, "EOS P2P outgoing packet queue grown to {0} bytes", _outgoingQueueSize);
+        }
+
+        // Shrink back once the queues stay mostly empty for a while
+        if (incoming < 0.25 && outgoing < 0.25 && (_incomingQueueSize > minSize || _outgoingQueueSize > minSize))
+        {
+            if (_queueIdleTime <= 0.0)
+                _queueIdleTime = now;
+            else if (now - _queueIdleTime >= QueueShrinkDelay)
+            {
+                SetPacketQueueSize(Math::Max(_incomingQueueSize / 2, minSize), Math::Max(_outgoingQueueSize / 2, minSize));
+                _queueIdleTime = now;
+            }
+        }
+        else
+        {
+            _queueIdleTime = 0.0;
+        }
+    }
+
+    // Congestion starts when the queue can't grow anymore and ends once it drains below the half of the threshold
+    const bool wasCongested = IsCongested();
+    const bool congested = wasCongested ? outgoing >= CongestionThreshold * 0.5 : outgoing >= CongestionThreshold && (minSize == EOS_P2P_MAX_QUEUE_SIZE_UNLIMITED || _outgoingQueueSize >= maxSize);
+    if (congested != wasCongested)
+    {
+        Platform::AtomicStore(&_congested, congested ? 1 : 0);
+        congestionChanged = true;
+        if (congested)
+            LOG(Warning, "EOS P2P outgoing traffic is congested ({0} bytes queued), dropping unreliable packets", _queueInfo.OutgoingPacketQueueCurrentSizeBytes);
+        else
+            LOG(Info, "EOS P2P outgoing traffic recovered from the congestion ({0} unreliable packets dropped)", Platform::AtomicRead(&_droppedPackets));
+    }
+}
+
+void EOSP2PDriver::ApplyConnectionPolicy()
+{
+    const auto p2p = _p2p;
+
+    // NAT type is detected once per session (the query takes a while, so the first session uses the default port range), stand-in APIs have no NAT
+    if (Platform::AtomicRead(&CachedNATType) < 0 && _api == &EOSP2PApi::Default)
+    {
+        Platform::AtomicStore(&CachedNATType, (int64)EOSNATType::Unknown);
+        EOS_P2P_QueryNATTypeOptions options = {};
+        options.ApiVersion = EOS_P2P_QUERYNATTYPE_API_LATEST;
+        EOS_P2P_QueryNATType(p2p, &options, nullptr, &EOSP2PDriver::OnQueryNATTypeComplete);
+    }
+    const EOSNATType natType = GetNATType();
+
+    EOS_P2P_SetRelayControlOptions relayOptions = {};
+    relayOptions.ApiVersion = EOS_P2P_SETRELAYCONTROL_API_LATEST;
+    relayOptions.RelayControl = GetRelayControl(RelayPolicy);
+    EOS_EResult result = _api->SetRelayControl(p2p, &relayOptions);
+    if (result != EOS_EResult::EOS_Success)
+        LOG(Warning, "EOS P2P driver failed to set the relay control: {0}", String(EOS_EResult_ToString(result)));
+
+    EOS_P2P_SetPortRangeOptions portOptions = {};
+    portOptions.ApiVersion = EOS_P2P_SETPORTRANGE_API_LATEST;
+    portOptions.Port = Port;
+    portOptions.MaxAdditionalPortsToTry = Port != 0 ? MaxAdditionalPorts : 0;
+    if (RelayPolicy == EOSRelayPolicy::Auto && natType == EOSNATType::Open)
+        portOptions.MaxAdditionalPortsToTry = Math::Min<uint16>(portOptions.MaxAdditionalPortsToTry, 9);
+    result = _api->SetPortRange(p2p, &portOptions);
+    if (result != EOS_EResult::EOS_Success)
+        LOG(Warning, "EOS P2P driver failed to set the port range: {0}", String(EOS_EResult_ToString(result)));
+
+    if (natType == EOSNATType::Strict && RelayPolicy != EOSRelayPolicy::ForceRelays)
+        LOG(Warning, "EOS P2P local network has Strict NAT, most of the connections will be relayed");
+    LOG(Info, "EOS P2P driver relay policy: {0}, NAT type: {1}, ports: {2}-{3}", ScriptingEnum::ToString(RelayPolicy), ScriptingEnum::ToString(natType), portOptions.Port, portOptions.Port + portOptions.MaxAdditionalPortsToTry);
+}
+
+void EOSP2PDriver::SendPing(EOS_HP2P p2p, Peer& peer, double now)
+{
+    PeerQuality& quality = peer.Quality;
+    quality.LastPingTime = now;
+    quality.PongMask <<= 1;
+    PingData ping;
+    ping.Time = now;
+    ping.Sequence = ++quality.PingSequence;
+    ping.Padding = 0;
+    Platform::MemoryCopy(_packetBuffer, &ping, sizeof(ping));
+    _packetBuffer[sizeof(ping)] = (uint8)PacketType::Ping;
+    SendPacket(p2p, (NetworkChannelType)ControlChannel, _packetBuffer, sizeof(ping) + sizeof(PacketType), peer.UserId);
+}
+
+void EOSP2PDriver::ReceiveControl(uint32 connectionId, uint8* data, uint32 size)
+{
+    Peer* peer = _peers.TryGet(connectionId);
+    if (!peer || size == 0)
+        return;
+    const PacketType type = (PacketType)data[size - 1];
+    if (type == PacketType::SnapshotAck)
+    {
+        uint32 sequence;
+        if (size != sizeof(sequence) + sizeof(PacketType))
+            return;
+        Platform::MemoryCopy(&sequence, data, sizeof(sequence));
+        _snapshots.ReceiveAck(connectionId, sequence);
+        return;
+    }
+    if (size != sizeof(PingData) + sizeof(PacketType))
+        return;
+    if (type == PacketType::Ping)
+    {
+        data[size - 1] = (uint8)PacketType::Pong;
+        SendPacketNow(_p2p, ControlChannel, data, size, peer->UserId);
+        return;
+    }
+    if (type != PacketType::Pong)
+        return;
+
+    PingData ping;
+    Platform::MemoryCopy(&ping, data, sizeof(ping));
+    PeerQuality& quality = peer->Quality;
+    const uint32 age = quality.PingSequence - ping.Sequence;
+    if (age >= 32 || quality.PongMask & (1u << age))
+        return;
+    quality.PongMask |= 1u << age;
+
+    // Smoothed RTT and its variation (as in TCP)
+    const float rtt = (float)((Platform::GetTimeSeconds() - ping.Time) * 1000.0);
+    if (quality.RTT <= 0.0f)
+    {
+        quality.RTT = rtt;
+        quality.Jitter = rtt * 0.5f;
+    }
+    else
+    {
+        quality.Jitter = quality.Jitter * 0.75f + Math::Abs(quality.RTT - rtt) * 0.25f;
+        quality.RTT = quality.RTT * 0.875f + rtt * 0.125f;
+    }
+}
+
+void EOSP2PDriver::SendStreamPacket(uint32 connectionId, const uint8* data, uint32 size)
+{
+    const Peer* peer = _peers.TryGet(connectionId);
+    if (peer)
+        SendPacket(_p2p, (NetworkChannelType)StreamChannel, data, size, peer->UserId);
+}
+
+void EOSP2PDriver::SendSnapshotAck(EOS_HP2P p2p, Peer& peer, uint32 sequence)
+{
+    Platform::MemoryCopy(_packetBuffer, &sequence, sizeof(sequence));
+    _packetBuffer[sizeof(sequence)] = (uint8)PacketType::SnapshotAck;
+    SendPacket(p2p, (NetworkChannelType)ControlChannel, _packetBuffer, sizeof(sequence) + sizeof(PacketType), peer.UserId);
+}
+
+bool EOSP2PDriver::ReceiveSnapshot(uint32 connectionId, const uint8* data, uint32 size, NetworkEvent& eventPtr)
+{
+    if (size == 0)
+        return false;
+
+    // Large snapshot is reassembled from the fragments first
+    NetworkMessage fragmented;
+    const PacketType type = (PacketType)data[size - 1];
+    if (type == PacketType::Fragment)
+    {
+        NetworkEvent e;
+        if (!ReceiveFragment(connectionId, SnapshotChannel, data, size, e))
+            return false;
+        fragmented = e.Message;
+        data = fragmented.Buffer;
+        size = fragmented.Length;
+    }
+    else if (type == PacketType::Message)
+    {
+        size -= MessageOverhead;
+    }
+    else
+    {
+        return false;
+    }
+
+    NetworkMessage message = _host->CreateMessage();
+    const bool failed = _snapshots.Decode(connectionId, data, size, message);
+    if (fragmented.Buffer)
+        _host->RecycleMessage(fragmented);
+    if (failed)
+    {
+        _host->RecycleMessage(message);
+        return false;
+    }
+    eventPtr.EventType = NetworkEventType::Message;
+    eventPtr.Message = message;
+    eventPtr.Sender.ConnectionId = connectionId;
+    return true;
+}
+
+int32 EOSP2PDriver::ThreadRun()
+{
+    while (Platform::AtomicRead(&_threadExit) == 0)
+    {
+        bool active;
+        {
+            // SDK is not thread-safe so the P2P calls are serialized with the platform tick
+            ScopeLock lock(_context->Locker);
+            const auto p2p = _p2p;
+            active = SendQueuedPackets(p2p);
+            active |= ReceivePackets(p2p);
+        }
+        if (!active)
+            Platform::Sleep(1);
+    }
+    return 0;
+}
+
+void EOSP2PDriver::ReleaseRings()
+{
+    for (EOSPacketRing& ring : _receiveRings)
+        ring.Release();
+    _sendRing.Release();
+}
+
+bool EOSP2PDriver::ReceiveFragment(uint32 connectionId, uint8 channel, const uint8* data, uint32 size, NetworkEvent& eventPtr)
+{
+    Peer* peer = _peers.TryGet(connectionId);
+    if (!peer || size < FragmentOverhead)
+        return false;
+    FragmentHeader header;
+    size -= FragmentOverhead;
+    Platform::MemoryCopy(&header, data + size, sizeof(header));
+    const uint32 count = (header.Length + FragmentSize - 1) / FragmentSize;
+    const uint32 offset = header.Index * FragmentSize;
+    if (header.Index >= count || size != Math::Min(FragmentSize, header.Length - offset))
+    {
+        LOG(Warning, "EOS P2P driver dropped invalid fragment");
+        return false;
+    }
+
+    // Find the message the fragment belongs to, start the new one in the free slot (or in place of the oldest one)
+    const double now = Platform::GetTimeSeconds();
+    Reassembly* slot = nullptr;
+    Reassembly* freeSlot = nullptr;
+    for (Reassembly& e : peer->Fragments)
+    {
+        if (!e.Message.Buffer)
+        {
+            if (!freeSlot)
+                freeSlot = &e;
+        }
+        else if (e.MessageId == header.MessageId && e.Channel == channel)
+        {
+            slot = &e;
+            break;
+        }
+        else if (!freeSlot || (freeSlot->Message.Buffer && e.LastTime < freeSlot->LastTime))
+        {
+            freeSlot = &e;
+        }
+    }
+    if (slot && slot->Length != header.Length)
+    {
+        // The mask and the buffer are sized by the first fragment of the message
+        LOG(Warning, "EOS P2P driver dropped fragment of {0} bytes message (expected {1} bytes)", header.Length, slot->Length);
+        return false;
+    }
+    if (!slot)
+    {
+        slot = freeSlot;
+        if (slot->Message.Buffer)
+        {
+            LOG(Warning, "EOS P2P driver dropped incomplete {0} bytes message", slot->Length);
+            _host->RecycleMessage(slot->Message);
+        }
+        slot->Message = _host->CreateMessage();
+        if (header.Length > slot->Message.BufferSize)
+        {
+            LOG(Warning, "EOS P2P driver dropped {0} bytes message (message size limit is {1})", header.Length, slot->Message.BufferSize);
+            _host->RecycleMessage(slot->Message);
+            slot->Message = NetworkMessage();
+            return false;
+        }
+        slot->Length = header.Length;
+        slot->MessageId = header.MessageId;
+        slot->Count = (uint16)count;
+        slot->Received = 0;
+        slot->Channel = channel;
+        slot->Mask.Resize((count + 31) / 32, false);
+        Platform::MemoryClear(slot->Mask.Get(), slot->Mask.Count() * sizeof(uint32));
+    }
+    slot->LastTime = now;
+
+    // Copy the fragment into place (duplicates are skipped)
+    uint32& mask = slot->Mask[header.Index / 32];
+    const uint32 bit = 1u << (header.Index % 32);
+    if (mask & bit)
+        return false;
+    mask |= bit;
+    Platform::MemoryCopy(slot->Message.Buffer + offset, data, size);
+    if (++slot->Received != slot->Count)
+        return false;
+
+    eventPtr.EventType = NetworkEventType::Message;
+    eventPtr.Message = slot->Message;
+    eventPtr.Message.Length = slot->Length;
+    eventPtr.Message.Position = 0;
+    eventPtr.Sender.ConnectionId = connectionId;
+    slot->Message = NetworkMessage();
+    return true;
+}
+
+void EOSP2PDriver::UpdateFragments(double now)
+{
+    for (auto& e : _peers)
+    {
+        for (Reassembly& slot : e.Value.Fragments)
+        {
+            if (slot.Message.Buffer && now - slot.LastTime > (double)FragmentTimeout)
+            {
+                LOG(Warning, "EOS P2P driver dropped incomplete {0} bytes message ({1}/{2} fragments received)", slot.Length, slot.Received, slot.Count);
+                _host->RecycleMessage(slot.Message);
+                slot.Message = NetworkMessage();
+            }
+        }
+    }
+}
+
+void EOSP2PDriver::ReleasePeer(Peer& peer)
+{
+    _streams.RemoveConnection(peer.ConnectionId, _releasedMessages);
+    _snapshots.RemoveConnection(peer.ConnectionId);
+    // Peer can be removed from the EOS callback on the service thread so the messages are recycled later on the game thread
+    for (Reassembly& slot : peer.Fragments)
+    {
+        if (slot.Message.Buffer)
+        {
+            _releasedMessages.Add(slot.Message);
+            slot.Message = NetworkMessage();
+        }
+    }
+}
+
+void EOSP2PDriver::OnConnectionRequest(const EOS_P2P_OnIncomingConnectionRequestInfo* data)
+{
+    const auto driver = (EOSP2PDriver*)data->ClientData;
+    if (!driver->_isServer)
+        return;
+    if (driver->_config.ConnectionsLimit > 0)
+    {
+        // Only the accepted connections count, the peers created for the packets of unknown senders don't
+        int32 accepted = 0;
+        bool known = false;
+        for (const auto& e : driver->_peers)
+        {
+            if (!e.Value.Accepted)
+                continue;
+            accepted++;
+            known |= e.Value.UserId == data->RemoteUserId;
+        }
+        if (!known && accepted >= driver->_config.ConnectionsLimit)
+        {
+            LOG(Warning, "EOS P2P driver rejected the connection, connections limit reached");
+            return;
+        }
+    }
+
+    EOS_P2P_AcceptConnectionOptions options = {};
+    options.ApiVersion = EOS_P2P_ACCEPTCONNECTION_API_LATEST;
+    options.LocalUserId = data->LocalUserId;
+    options.RemoteUserId = data->RemoteUserId;
+    options.SocketId = &driver->_socketId;
+    const EOS_EResult result = driver->_api->AcceptConnection(driver->_p2p, &options);
+    if (result != EOS_EResult::EOS_Success)
+    {
+        LOG(Warning, "EOS P2P driver failed to accept the connection: {0}", String(EOS_EResult_ToString(result)));
+        return;
+    }
+    driver->_peers[driver->GetConnectionId(data->RemoteUserId)].Accepted = true;
+}
+
+void EOSP2PDriver::OnConnectionEstablished(const EOS_P2P_OnPeerConnectionEstablishedInfo* data)
+{
+    const auto driver = (EOSP2PDriver*)data->ClientData;
+    const uint32 connectionId = driver->GetConnectionId(data->RemoteUserId);
+    Peer& peer = driver->_peers[connectionId];
+    peer.Quality.Relayed = data->NetworkType == EOS_ENetworkConnectionType::EOS_NCT_RelayedConnection;
+    peer.Accepted = true;
+    if (peer.Connected)
+        return;
+    peer.Connected = true;
+    LOG(Info, "EOS P2P connection established with {0} ({1})", driver->GetUserName(data->RemoteUserId), data->NetworkType == EOS_ENetworkConnectionType::EOS_NCT_RelayedConnection ? TEXT("relayed") : TEXT("direct"));
+    driver->PushEvent(NetworkEventType::Connected, connectionId);
+}
+
+void EOSP2PDriver::OnConnectionClosed(const EOS_P2P_OnRemoteConnectionClosedInfo* data)
+{
+    const auto driver = (EOSP2PDriver*)data->ClientData;
+    uint32 connectionId;
+    if (!driver->_connectionIds.TryGet(data->RemoteUserId, connectionId))
+        return;
+    driver->_connectionIds.Remove(data->RemoteUserId);
+    Peer* peer = driver->_peers.TryGet(connectionId);
+    if (peer)
+        driver->ReleasePeer(*peer);
+    driver->_peers.Remove(connectionId);
+    const bool timeout = data->Reason == EOS_EConnectionClosedReason::EOS_CCR_TimedOut || data->Reason == EOS_EConnectionClosedReason::EOS_CCR_ConnectionFailed;
+    driver->PushEvent(timeout ? NetworkEventType::Timeout : NetworkEventType::Disconnected, connectionId);
+}
+
+void EOSP2PDriver::OnIncomingPacketQueueFull(const EOS_P2P_OnIncomingPacketQueueFullInfo* data)
+{
+    const auto driver = (EOSP2PDriver*)data->ClientData;
+    driver->_queueFullCount++;
+    const uint64 maxSize = (uint64)Math::Max(driver->MaxPacketQueueSize, 0);
+    if (driver->_incomingQueueSize != EOS_P2P_MAX_QUEUE_SIZE_UNLIMITED && driver->_incomingQueueSize < maxSize)
+    {
+        // Grow right away so the following packets are not discarded
+        driver->SetPacketQueueSize(Math::Min(driver->_incomingQueueSize * 2, maxSize), driver->_outgoingQueueSize);
+        LOG(Warning, "EOS P2P incoming packet queue is full ({0} bytes), grown to {1} bytes", data->PacketQueueCurrentSizeBytes, driver->_incomingQueueSize);
+    }
+    else
+    {
+        LOG(Warning, "EOS P2P incoming packet queue is full ({0} bytes), packets on channel {1} are discarded", data->PacketQueueCurrentSizeBytes, data->OverflowPacketChannel);
+    }
+}
+
+void EOSP2PDriver::OnQueryNATTypeComplete(const EOS_P2P_OnQueryNATTypeCompleteInfo* data)
+{
+    if (data->ResultCode != EOS_EResult::EOS_Success)
+    {
+        // Query again with the next driver
+        LOG(Warning, "EOS P2P failed to query NAT type: {0}", String(EOS_EResult_ToString(data->ResultCode)));
+        Platform::AtomicStore(&CachedNATType, -1);
+        return;
+    }
+    Platform::AtomicStore(&CachedNATType, (int64)data->NATType);
+    LOG(Info, "EOS P2P NAT type: {0}", ScriptingEnum::ToString((EOSNATType)data->NATType));
+}
@@ -0,0 +1,412 @@
+#pragma once
+
+#include "Engine/Core/Collections/Array.h"
+#include "Engine/Core/Collections/Dictionary.h"
+#include "Engine/Core/Delegate.h"
+#include "Engine/Core/Types/Span.h"
+#include "Engine/Core/Types/String.h"
+#include "Engine/Networking/INetworkDriver.h"
+#include "Engine/Networking/NetworkConfig.h"
+#include "Engine/Networking/NetworkConnection.h"
+#include "Engine/Networking/NetworkEvent.h"
+#include "Engine/Networking/NetworkMessage.h"
+#include "Engine/Platform/CriticalSection.h"
+#include "Engine/Scripting/ScriptingObject.h"
+#include "EOSP2PApi.h"
+#include "EOSPacketRing.h"
+#include "EOSP2PSnapshots.h"
+#include "EOSP2PStreams.h"
+#include "EOSSDK/Include/eos_p2p_types.h"
+
+class EOSPlatformContext;
+class Thread;
+
+///<summary>
+/// The NAT type of the local network detected by EOS.
+///</summary>
+API_ENUM() enum class EOSNATType
+{
+    /** Not detected yet */
+    Unknown = 0,
+    /** Can connect directly to all the peers */
+    Open = 1,
+    /** Can connect directly to the peers with Open or Moderate NAT */
+    Moderate = 2,
+    /** Can connect directly only to the peers with Open NAT */
+    Strict = 3
+};
+
+///<summary>
+/// The policy of using the Epic relay servers for the P2P connections.
+///</summary>
+API_ENUM() enum class EOSRelayPolicy
+{
+    /** Relays are allowed (used only when the direct connection can't be established) and the port range is picked from the local NAT type */
+    Auto = 0,
+    /** Only direct connections (fails with the peers that require the relay) */
+    NoRelays = 1,
+    /** Relays are used only when the direct connection can't be established */
+    AllowRelays = 2,
+    /** All connections go through the relay (hides the IP addresses of the peers) */
+    ForceRelays = 3
+};
+
+/// <summary>
+/// The quality of the P2P connection measured by the driver with the ping packets.
+/// </summary>
+API_STRUCT(NoDefault, Namespace="FlaxEngine.Online.EOS") struct ONLINEPLATFORMEOS_API EOSP2PConnectionQuality
+{
+    DECLARE_SCRIPTING_TYPE_MINIMAL(EOSP2PConnectionQuality);
+
+    /// <summary>
+    /// The smoothed round-trip time (in milliseconds).
+    /// </summary>
+    API_FIELD() float RTT = 0.0f;
+
+    /// <summary>
+    /// The round-trip time variation (in milliseconds).
+    /// </summary>
+    API_FIELD() float Jitter = 0.0f;
+
+    /// <summary>
+    /// The ratio of the lost pings (0-1) over the recent pings.
+    /// </summary>
+    API_FIELD() float PacketLoss = 0.0f;
+
+    /// <summary>
+    /// True if the connection goes through the Epic relay server, otherwise it's direct.
+    /// </summary>
+    API_FIELD() bool IsRelayed = false;
+};
+
+/// <summary>
+/// The state of the EOS P2P packet queues and the driver backpressure.
+/// </summary>
+API_STRUCT(NoDefault, Namespace="FlaxEngine.Online.EOS") struct ONLINEPLATFORMEOS_API EOSP2PQueueStats
+{
+    DECLARE_SCRIPTING_TYPE_MINIMAL(EOSP2PQueueStats);
+
+    API_FIELD() uint64 IncomingQueueMaxSize = 0;
+    API_FIELD() uint64 IncomingQueueSize = 0;
+    API_FIELD() uint64 IncomingQueuePackets = 0;
+    API_FIELD() uint64 OutgoingQueueMaxSize = 0;
+    API_FIELD() uint64 OutgoingQueueSize = 0;
+    API_FIELD() uint64 OutgoingQueuePackets = 0;
+
+    /// <summary>
+    /// The amount of times the incoming queue got full.
+    /// </summary>
+    API_FIELD() int32 IncomingQueueFullCount = 0;
+
+    /// <summary>
+    /// The amount of unreliable packets dropped by the driver because of the congestion.
+    /// </summary>
+    API_FIELD() int64 DroppedPackets = 0;
+
+    API_FIELD() bool IsCongested = false;
+};
+
+/// <summary>
+/// Network driver implementation for Flax networking that uses EOS P2P (NAT-traversal with the fallback to the Epic relay servers).
+/// Peers are addressed with the Product User IDs so both sides need the user logged in (Connect login). To connect, set the NetworkConfig.Address to the host Product User ID string.
+/// Messages larger than the P2P packet are split into fragments and reassembled on the receiving side (the message still has to fit into NetworkConfig.MessageSize).
+/// Small messages are packed together per connection and channel and sent once per frame (see Batching).
+/// The EOS packet queues grow when they get full and shrink back when idle. When the outgoing queue stays full, the unreliable packets are dropped before reaching it and CongestionChanged is raised so the game can lower its send rate.
+/// With UseReliableStreams, the reliable messages use the driver streams on top of the unreliable packets instead of the EOS reliability, so the lost packet doesn't stall the unrelated traffic.
+/// SendSnapshot delta-encodes the state snapshot against the last one acknowledged by the connection, the receiver gets the whole decoded snapshot as a regular message.
+/// With UseIOThread, packets are received and sent on a dedicated thread and exchanged with the game thread through the packet rings (best used with the EOS platform ticked on the service thread).
+/// </summary>
+API_CLASS(Sealed, Namespace="FlaxEngine.Online.EOS") class ONLINEPLATFORMEOS_API EOSP2PDriver : public ScriptingObject, public INetworkDriver
+{
+    DECLARE_SCRIPTING_TYPE(EOSP2PDriver);
+private:
+    static constexpr int32 ReassemblySlots = 4;
+    static constexpr int32 ChannelsCount = (int32)NetworkChannelType::ReliableOrdered + 1;
+    static constexpr uint8 ControlChannel = (uint8)ChannelsCount;
+    static constexpr uint8 StreamChannel = ControlChannel + 1;
+    static constexpr uint8 SnapshotChannel = StreamChannel + 1;
+
+    struct Reassembly
+    {
+        // Message from the peer pool the fragments are copied into, null buffer if the slot is free
+        NetworkMessage Message;
+        uint32 Length = 0;
+        uint16 MessageId = 0;
+        uint16 Count = 0;
+        uint16 Received = 0;
+        uint8 Channel = 0;
+        double LastTime = 0.0;
+        Array<uint32> Mask;
+    };
+
+    struct Batch
+    {
+        uint32 Size = 0;
+        uint8 Data[EOS_P2P_MAX_PACKET_SIZE];
+    };
+
+    struct PeerQuality
+    {
+        uint32 PingSequence = 0;
+        uint32 PongMask = 0;
+        double LastPingTime = 0.0;
+        float RTT = 0.0f;
+        float Jitter = 0.0f;
+        bool Relayed = false;
+    };
+
+    struct Peer
+    {
+        EOS_ProductUserId UserId;
+        uint32 ConnectionId;
+        bool Connected;
+        // True once the connection got accepted (the peers of unknown senders don't count towards the connections limit)
+        bool Accepted;
+        PeerQuality Quality;
+        Reassembly Fragments[ReassemblySlots];
+        Batch Batches[ChannelsCount];
+    };
+
+    NetworkPeer* _host = nullptr;
+    NetworkConfig _config;
+    EOSPlatformContext* _context = nullptr;
+    const EOSP2PApi* _api = &EOSP2PApi::Default;
+    EOS_HP2P _p2p = nullptr;
+    EOS_P2P_SocketId _socketId = {};
+    bool _isServer = false;
+    uint32 _nextConnectionId = 1;
+    Dictionary<uint32, Peer> _peers;
+    Dictionary<EOS_ProductUserId, uint32> _connectionIds;
+    CriticalSection _eventsLocker;
+    Array<NetworkEvent> _events;
+    int32 _eventsStart = 0;
+    EOS_NotificationId _connectionRequestId = EOS_INVALID_NOTIFICATIONID;
+    EOS_NotificationId _connectionEstablishedId = EOS_INVALID_NOTIFICATIONID;
+    EOS_NotificationId _connectionClosedId = EOS_INVALID_NOTIFICATIONID;
+    uint32 _totalDataSent = 0;
+    uint32 _totalDataReceived = 0;
+    uint16 _nextMessageId = 0;
+    double _lastFragmentsUpdate = 0.0;
+    uint8 _packetBuffer[EOS_P2P_MAX_PACKET_SIZE];
+    uint8 _receiveBuffer[EOS_P2P_MAX_PACKET_SIZE];
+    NetworkMessage _receivedBatch;
+    EOSPacketRing* _receivedBatchRing = nullptr;
+    const uint8* _receivedBatchData = nullptr;
+    uint32 _receivedBatchSize = 0;
+    uint32 _receivedBatchPosition = 0;
+    uint32 _receivedBatchSender = 0;
+    Array<NetworkMessage> _releasedMessages;
+    EOSPacketRing _receiveRings[SnapshotChannel + 1];
+    EOSPacketRing _sendRing;
+    Thread* _thread = nullptr;
+    volatile int64 _threadExit = 0;
+    EOS_NotificationId _queueFullId = EOS_INVALID_NOTIFICATIONID;
+    EOS_P2P_PacketQueueInfo _queueInfo = {};
+    uint64 _incomingQueueSize = 0;
+    uint64 _outgoingQueueSize = 0;
+    double _queueIdleTime = 0.0;
+    int32 _queueFullCount = 0;
+    volatile int64 _droppedPackets = 0;
+    volatile int64 _congested = 0;
+    EOSP2PStreams _streams;
+    Array<EOSP2PStreams::StreamDesc> _streamDescs;
+    EOSP2PSnapshots _snapshots;
+
+public:
+    /// <summary>
+    /// The name of the P2P socket used by the game connections. Must be the same on all peers (1-32 alpha-numeric characters).
+    /// </summary>
+    API_FIELD() StringAnsi SocketName = "FlaxGame";
+
+    /// <summary>
+    /// The time (in seconds) after which the partially received message is dropped if no more of its fragments arrive.
+    /// </summary>
+    API_FIELD() float FragmentTimeout = 5.0f;
+
+    /// <summary>
+    /// If checked, small messages are packed into the shared packets (per connection and channel) that are sent at the end of the frame, otherwise every message is sent right away as a separate packet.
+    /// </summary>
+    API_FIELD() bool Batching = true;
+
+    /// <summary>
+    /// If checked, the packets are received and sent on the dedicated thread so the receive latency doesn't depend on the frame rate. Applied on initialization.
+    /// </summary>
+    API_FIELD() bool UseIOThread = true;
+
+    /// <summary>
+    /// The capacity (in packets) of the rings between the I/O thread and the game thread. There is one receive ring per channel and one send ring. When the receive ring is full, packets wait in the EOS queue.
+    /// </summary>
+    API_FIELD() int32 PacketRingSize = 256;
+
+    /// <summary>
+    /// The initial limit (in bytes) of the EOS incoming and outgoing packet queues. Note that the limits are shared by the whole P2P interface.
+    /// </summary>
+    API_FIELD() int32 PacketQueueSize = 1024 * 1024;
+
+    /// <summary>
+    /// The limit (in bytes) up to which the EOS packet queues can grow.
+    /// </summary>
+    API_FIELD() int32 MaxPacketQueueSize = 16 * 1024 * 1024;
+
+    /// <summary>
+    /// The outgoing queue occupancy (normalized) above which the connection is considered congested (once the queue can't grow anymore).
+    /// </summary>
+    API_FIELD() float CongestionThreshold = 0.75f;
+
+    /// <summary>
+    /// Event called when the outgoing traffic becomes congested (true) or recovers (false). Called on the game thread.
+    /// </summary>
+    API_EVENT() Delegate<bool> CongestionChanged;
+
+    /// <summary>
+    /// The relay servers usage policy. Applied on initialization, note that it's shared by the whole P2P interface.
+    /// </summary>
+    API_FIELD() EOSRelayPolicy RelayPolicy = EOSRelayPolicy::Auto;
+
+    /// <summary>
+    /// The preferred local port for the P2P traffic.
+    /// </summary>
+    API_FIELD() uint16 Port = 7777;
+
+    /// <summary>
+    /// The maximum amount of the ports after the Port to try if it's not available. The Auto relay policy narrows it with the Open NAT (so the port-forwarding rules stay predictable).
+    /// </summary>
+    API_FIELD() uint16 MaxAdditionalPorts = 99;
+
+    /// <summary>
+    /// The interval (in seconds) of the ping packets used to measure the connection quality.
+    /// </summary>
+    API_FIELD() float PingInterval = 1.0f;
+
+    /// <summary>
+    /// If checked, the Reliable and ReliableOrdered messages are sent over the driver streams (0 and 1) with the selective acknowledgements instead of the EOS reliable packets. Must match on all peers.
+    /// </summary>
+    API_FIELD() bool UseReliableStreams = false;
+
+    /// <summary>
+    /// Sets the EOS platform context to use (eg. one of the load test clients). By default the context of the active EOS online platform is used.
+    /// </summary>
+    void SetContext(EOSPlatformContext* context)
+    {
+        _context = context;
+    }
+
+    /// <summary>
+    /// Sets the P2P functions to use instead of the EOS SDK (eg. the loopback stand-in) and the P2P handle passed to them. Must be called before the initialization.
+    /// </summary>
+    void SetApi(const EOSP2PApi* api, EOS_HP2P p2p)
+    {
+        _api = api;
+        _p2p = p2p;
+    }
+
+    /// <summary>
+    /// Sends all the batched messages. Called automatically at the end of every frame.
+    /// </summary>
+    API_FUNCTION() void Flush();
+
+    /// <summary>
+    /// Returns true if the outgoing traffic is congested (unreliable packets are dropped).
+    /// </summary>
+    API_PROPERTY() bool IsCongested() const
+    {
+        return Platform::AtomicRead((volatile int64*)&_congested) != 0;
+    }
+
+    /// <summary>
+    /// Gets the state of the packet queues.
+    /// </summary>
+    API_FUNCTION() EOSP2PQueueStats GetQueueStats();
+
+    /// <summary>
+    /// Adds the reliable stream (independent from the other streams, so its lost packets don't stall them). Streams 0 (unordered) and 1 (ordered) always exist. Must be called before the initialization in the same order on all peers.
+    /// </summary>
+    /// <param name="ordered">True if messages are delivered in the order they were sent, otherwise as soon as they arrive.</param>
+    /// <param name="priority">The stream priority. Streams with the higher priority send their queued messages first.</param>
+    /// <returns>The stream index.</returns>
+    API_FUNCTION() int32 AddStream(bool ordered, int32 priority = 0);
+
+    /// <summary>
+    /// Sends the message over the reliable stream. The message is not recycled (as with the NetworkPeer.EndSendMessage).
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    API_FUNCTION() bool SendStreamMessage(int32 stream, const NetworkMessage& message, const NetworkConnection& target);
+
+    /// <summary>
+    /// Sends the state snapshot over the unreliable channel, delta-encoded against the latest snapshot acknowledged by the target. Stale snapshots (arriving after the newer ones) are dropped by the receiver. The message is not recycled (as with the NetworkPeer.EndSendMessage).
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    API_FUNCTION() bool SendSnapshot(const NetworkMessage& message, const NetworkConnection& target);
+
+    /// <summary>
+    /// Gets the ratio of the encoded to the raw size of all the snapshots sent so far (1 if none were sent).
+    /// </summary>
+    API_PROPERTY() float GetSnapshotCompressionRatio();
+
+    /// <summary>
+    /// Gets the NAT type of the local network. Detected once per session when the first driver is initialized.
+    /// </summary>
+    API_PROPERTY() static EOSNATType GetNATType();
+
+    /// <summary>
+    /// Gets the quality of the connection.
+    /// </summary>
+    /// <returns>True if the connection exists, otherwise false.</returns>
+    API_FUNCTION() bool GetConnectionQuality(uint32 connectionId, API_PARAM(Out) EOSP2PConnectionQuality& result);
+
+public:
+    // [INetworkDriver]
+    String DriverName() const override
+    {
+        return String("EOSP2PDriver");
+    }
+    bool Initialize(NetworkPeer* host, const NetworkConfig& config) override;
+    void Dispose() override;
+    bool Listen() override;
+    bool Connect() override;
+    void Disconnect() override;
+    void Disconnect(const NetworkConnection& connection) override;
+    bool PopEvent(NetworkEvent& eventPtr) override;
+    void SendMessage(NetworkChannelType channelType, const NetworkMessage& message) override;
+    void SendMessage(NetworkChannelType channelType, const NetworkMessage& message, NetworkConnection target) override;
+    void SendMessage(NetworkChannelType channelType, const NetworkMessage& message, const Array<NetworkConnection, HeapAllocation>& targets) override;
+    NetworkDriverStats GetStats() override;
+    NetworkDriverStats GetStats(NetworkConnection target) override;
+
+private:
+    bool AddNotifications();
+    void RemoveNotifications();
+    uint32 GetConnectionId(EOS_ProductUserId userId);
+    String GetUserName(EOS_ProductUserId userId) const;
+    void PushEvent(NetworkEventType type, uint32 connectionId);
+    void Send(NetworkChannelType channelType, const NetworkMessage& message, const Span<Peer*>& targets);
+    void SendData(EOS_HP2P p2p, uint8 channel, const uint8* data, uint32 length, const Span<Peer*>& targets);
+    void SendPacket(EOS_HP2P p2p, NetworkChannelType channelType, const uint8* data, uint32 size, EOS_ProductUserId target);
+    void SendPacketNow(EOS_HP2P p2p, uint8 channel, const uint8* data, uint32 size, EOS_ProductUserId target);
+    void FlushBatch(EOS_HP2P p2p, NetworkChannelType channelType, Peer& peer);
+    bool PopBatchMessage(NetworkEvent& eventPtr);
+    bool PopReceivedPacket(NetworkEvent& eventPtr);
+    bool ReceivePackets(EOS_HP2P p2p);
+    bool SendQueuedPackets(EOS_HP2P p2p);
+    void RecycleReleasedMessages();
+    bool DropPacket(uint8 channel);
+    void SetPacketQueueSize(uint64 incoming, uint64 outgoing);
+    void UpdatePacketQueues(double now, bool& congestionChanged);
+    void ApplyConnectionPolicy();
+    void SendPing(EOS_HP2P p2p, Peer& peer, double now);
+    void ReceiveControl(uint32 connectionId, uint8* data, uint32 size);
+    void SendStreamPacket(uint32 connectionId, const uint8* data, uint32 size);
+    void SendSnapshotAck(EOS_HP2P p2p, Peer& peer, uint32 sequence);
+    bool ReceiveSnapshot(uint32 connectionId, const uint8* data, uint32 size, NetworkEvent& eventPtr);
+    int32 ThreadRun();
+    void ReleaseRings();
+    bool ReceiveFragment(uint32 connectionId, uint8 channel, const uint8* data, uint32 size, NetworkEvent& eventPtr);
+    void UpdateFragments(double now);
+    void ReleasePeer(Peer& peer);
+
+    static void EOS_CALL OnConnectionRequest(const EOS_P2P_OnIncomingConnectionRequestInfo* data);
+    static void EOS_CALL OnConnectionEstablished(const EOS_P2P_OnPeerConnectionEstablishedInfo* data);
+    static void EOS_CALL OnConnectionClosed(const EOS_P2P_OnRemoteConnectionClosedInfo* data);
+    static void EOS_CALL OnIncomingPacketQueueFull(const EOS_P2P_OnIncomingPacketQueueFullInfo* data);
+    static void EOS_CALL OnQueryNATTypeComplete(const EOS_P2P_OnQueryNATTypeCompleteInfo* data);
+};
@@ -0,0 +1,532 @@
+#include "EOSP2PLoopback.h"
+#include "EOSP2PDriver.h"
+
+#include "Engine/Core/Collections/Dictionary.h"
+#include "Engine/Core/Collections/HashSet.h"
+#include "Engine/Core/Math/Math.h"
+#include "Engine/Platform/Platform.h"
+#include "Engine/Platform/StringUtils.h"
+
+struct EOSP2PLoopback::Packet
+{
+    Endpoint* Sender;
+    double DeliverTime;
+    uint32 Size;
+    uint8 Channel;
+    EOS_P2P_SocketId SocketId;
+    uint8 Data[EOS_P2P_MAX_PACKET_SIZE];
+};
+
+struct EOSP2PLoopback::Endpoint
+{
+    enum class EventType
+    {
+        ConnectionRequest,
+        ConnectionEstablished,
+        ConnectionClosed,
+    };
+
+    struct Event
+    {
+        EventType Type;
+        Endpoint* Remote;
+    };
+
+    EOSP2PLoopback* Owner;
+    uint32 Id;
+    EOSPlatformContext Context;
+    EOS_P2P_SocketId SocketId = {};
+    HashSet<Endpoint*> Accepted;
+    HashSet<Endpoint*> Connected;
+    Array<Event> Events;
+
+    // Sorted by the delivery time
+    Array<Packet*> Incoming;
+    uint64 IncomingSize = 0;
+
+    // Times when the packets waiting for the upload link get sent
+    Array<double> Outgoing;
+    double LinkFreeTime = 0.0;
+    double OrderedTime = 0.0;
+    uint64 IncomingMaxSize = EOS_P2P_MAX_QUEUE_SIZE_UNLIMITED;
+    uint64 OutgoingMaxSize = EOS_P2P_MAX_QUEUE_SIZE_UNLIMITED;
+
+    void* RequestData = nullptr;
+    EOS_P2P_OnIncomingConnectionRequestCallback RequestHandler = nullptr;
+    void* EstablishedData = nullptr;
+    EOS_P2P_OnPeerConnectionEstablishedCallback EstablishedHandler = nullptr;
+    void* ClosedData = nullptr;
+    EOS_P2P_OnRemoteConnectionClosedCallback ClosedHandler = nullptr;
+
+    int32 FindPacket(const uint8* channel, double now) const
+    {
+        for (int32 i = 0; i < Incoming.Count() && Incoming[i]->DeliverTime <= now; i++)
+        {
+            if (!channel || Incoming[i]->Channel == *channel)
+                return i;
+        }
+        return -1;
+    }
+
+    void UpdateOutgoing(double now)
+    {
+        int32 sent = 0;
+        while (sent < Outgoing.Count() && Outgoing[sent] <= now)
+            sent++;
+        if (sent == 0)
+            return;
+        for (int32 i = sent; i < Outgoing.Count(); i++)
+            Outgoing[i - sent] = Outgoing[i];
+        Outgoing.Resize(Outgoing.Count() - sent);
+    }
+};
+
+namespace
+{
+    // Endpoints are addressed with the fake Product User IDs (the endpoint pointers), the registry validates them and resolves the address strings
+    CriticalSection RegistryLocker;
+    HashSet<EOSP2PLoopback::Endpoint*> Endpoints;
+    Dictionary<uint32, EOSP2PLoopback::Endpoint*> EndpointIds;
+    uint32 NextEndpointId = 1;
+
+    constexpr char AddressPrefix[] = "loopback-";
+
+    // Notification ids are fixed per type, endpoint has only one handler of each
+    constexpr EOS_NotificationId RequestNotification = 1;
+    constexpr EOS_NotificationId EstablishedNotification = 2;
+    constexpr EOS_NotificationId ClosedNotification = 3;
+    constexpr EOS_NotificationId QueueFullNotification = 4;
+}
+
+const EOSP2PApi EOSP2PLoopback::Api =
+{
+    SendPacket,
+    GetNextReceivedPacketSize,
+    ReceivePacket,
+    AcceptConnection,
+    CloseConnection,
+    CloseConnections,
+    AddNotifyPeerConnectionRequest,
+    RemoveNotifyPeerConnectionRequest,
+    AddNotifyPeerConnectionEstablished,
+    RemoveNotifyPeerConnectionEstablished,
+    AddNotifyPeerConnectionClosed,
+    RemoveNotifyPeerConnectionClosed,
+    AddNotifyIncomingPacketQueueFull,
+    RemoveNotifyIncomingPacketQueueFull,
+    SetPacketQueueSize,
+    GetPacketQueueInfo,
+    SetRelayControl,
+    SetPortRange,
+    ProductUserIdFromString,
+    ProductUserIdToString,
+};
+
+EOSP2PLoopback::EOSP2PLoopback(const EOSP2PLoopbackSettings& settings)
+    : Settings(settings)
+{
+    _random = (uint64)(uint32)settings.Seed * 0x9E3779B97F4A7C15ull + 1;
+}
+
+EOSP2PLoopback::~EOSP2PLoopback()
+{
+    {
+        ScopeLock lock(RegistryLocker);
+        for (Endpoint* endpoint : _endpoints)
+        {
+            Endpoints.Remove(endpoint);
+            EndpointIds.Remove(endpoint->Id);
+        }
+    }
+    for (Endpoint* endpoint : _endpoints)
+        _pool.Add(endpoint->Incoming);
+    _endpoints.ClearDelete();
+    _pool.ClearDelete();
+}
+
+String EOSP2PLoopback::Attach(EOSP2PDriver* driver)
+{
+    auto endpoint = New<Endpoint>();
+    endpoint->Owner = this;
+    endpoint->Context.ProductUserId = (EOS_ProductUserId)endpoint;
+    {
+        ScopeLock lock(RegistryLocker);
+        endpoint->Id = NextEndpointId++;
+        Endpoints.Add(endpoint);
+        EndpointIds.Add(endpoint->Id, endpoint);
+    }
+    _endpoints.Add(endpoint);
+    driver->SetContext(&endpoint->Context);
+    driver->SetApi(&Api, (EOS_HP2P)endpoint);
+    return String::Format(TEXT("{0}{1}"), String(AddressPrefix), endpoint->Id);
+}
+
+void EOSP2PLoopback::Tick()
+{
+    Array<Endpoint::Event> events;
+    for (Endpoint* endpoint : _endpoints)
+    {
+        // Callbacks run with the context lock held, the same way as during the EOS platform tick
+        ScopeLock contextLock(endpoint->Context.Locker);
+        {
+            ScopeLock lock(_locker);
+            events.Clear();
+            events.Add(endpoint->Events);
+            endpoint->Events.Clear();
+        }
+        for (const Endpoint::Event& e : events)
+        {
+            switch (e.Type)
+            {
+            case Endpoint::EventType::ConnectionRequest:
+                if (endpoint->RequestHandler)
+                {
+                    EOS_P2P_OnIncomingConnectionRequestInfo info = {};
+                    info.ClientData = endpoint->RequestData;
+                    info.LocalUserId = endpoint->Context.ProductUserId;
+                    info.RemoteUserId = (EOS_ProductUserId)e.Remote;
+                    info.SocketId = &endpoint->SocketId;
+                    endpoint->RequestHandler(&info);
+                }
+                break;
+            case Endpoint::EventType::ConnectionEstablished:
+                if (endpoint->EstablishedHandler)
+                {
+                    EOS_P2P_OnPeerConnectionEstablishedInfo info = {};
+                    info.ClientData = endpoint->EstablishedData;
+                    info.LocalUserId = endpoint->Context.ProductUserId;
+                    info.RemoteUserId = (EOS_ProductUserId)e.Remote;
+                    info.SocketId = &endpoint->SocketId;
+                    info.ConnectionType = EOS_EConnectionEstablishedType::EOS_CET_NewConnection;
+                    info.NetworkType = EOS_ENetworkConnectionType::EOS_NCT_DirectConnection;
+                    endpoint->EstablishedHandler(&info);
+                }
+                break;
+            case Endpoint::EventType::ConnectionClosed:
+                if (endpoint->ClosedHandler)
+                {
+                    EOS_P2P_OnRemoteConnectionClosedInfo info = {};
+                    info.ClientData = endpoint->ClosedData;
+                    info.LocalUserId = endpoint->Context.ProductUserId;
+                    info.RemoteUserId = (EOS_ProductUserId)e.Remote;
+                    info.SocketId = &endpoint->SocketId;
+                    info.Reason = EOS_EConnectionClosedReason::EOS_CCR_ClosedByPeer;
+                    endpoint->ClosedHandler(&info);
+                }
+                break;
+            }
+        }
+    }
+}
+
+int64 EOSP2PLoopback::GetPacketsSent()
+{
+    ScopeLock lock(_locker);
+    return _packetsSent;
+}
+
+int64 EOSP2PLoopback::GetPacketsLost()
+{
+    ScopeLock lock(_locker);
+    return _packetsLost;
+}
+
+float EOSP2PLoopback::Random()
+{
+    // xorshift64* (deterministic for the given seed)
+    _random ^= _random >> 12;
+    _random ^= _random << 25;
+    _random ^= _random >> 27;
+    return (float)((_random * 0x2545F4914F6CDD1Dull) >> 40) / (float)(1 << 24);
+}
+
+EOSP2PLoopback::Endpoint* EOSP2PLoopback::GetEndpoint(EOS_HP2P handle)
+{
+    return (Endpoint*)handle;
+}
+
+EOSP2PLoopback::Endpoint* EOSP2PLoopback::FindEndpoint(EOS_ProductUserId userId)
+{
+    const auto endpoint = (Endpoint*)userId;
+    ScopeLock lock(RegistryLocker);
+    return Endpoints.Contains(endpoint) ? endpoint : nullptr;
+}
+
+void EOSP2PLoopback::Disconnect(Endpoint* endpoint, Endpoint* remote)
+{
+    endpoint->Accepted.Remove(remote);
+    remote->Accepted.Remove(endpoint);
+    if (endpoint->Connected.Remove(remote))
+    {
+        remote->Connected.Remove(endpoint);
+        remote->Events.Add({ Endpoint::EventType::ConnectionClosed, endpoint });
+    }
+}
+
+EOS_EResult EOSP2PLoopback::SendPacket(EOS_HP2P handle, const EOS_P2P_SendPacketOptions* options)
+{
+    Endpoint* endpoint = GetEndpoint(handle);
+    Endpoint* remote = FindEndpoint(options->RemoteUserId);
+    if (!remote || options->DataLengthBytes > EOS_P2P_MAX_PACKET_SIZE)
+        return EOS_EResult::EOS_InvalidParameters;
+    EOSP2PLoopback* loopback = endpoint->Owner;
+    const EOSP2PLoopbackSettings& settings = loopback->Settings;
+    ScopeLock lock(loopback->_locker);
+    const double now = Platform::GetTimeSeconds();
+
+    // Upload link sends the packets one after another, the ones waiting for it form the outgoing queue
+    double sendTime = now;
+    if (settings.Bandwidth > 0)
+    {
+        endpoint->UpdateOutgoing(now);
+        sendTime = Math::Max(now, endpoint->LinkFreeTime);
+        const uint64 queued = (uint64)((sendTime - now) * settings.Bandwidth);
+        if (endpoint->OutgoingMaxSize != EOS_P2P_MAX_QUEUE_SIZE_UNLIMITED && queued + options->DataLengthBytes > endpoint->OutgoingMaxSize)
+            return EOS_EResult::EOS_LimitExceeded;
+        sendTime += (double)options->DataLengthBytes / settings.Bandwidth;
+        endpoint->LinkFreeTime = sendTime;
+        endpoint->Outgoing.Add(sendTime);
+    }
+    loopback->_packetsSent++;
+
+    // Reliable packets are never lost, the ordered ones never arrive before the previous ones
+    const bool reliable = options->Reliability != EOS_EPacketReliability::EOS_PR_UnreliableUnordered;
+    if (!reliable && loopback->Random() < settings.PacketLoss)
+    {
+        loopback->_packetsLost++;
+        return EOS_EResult::EOS_Success;
+    }
+    double deliverTime = sendTime + (settings.Latency + settings.Jitter * loopback->Random()) * 0.001;
+    if (!reliable && loopback->Random() < settings.Reordering)
+        deliverTime += Math::Max(settings.Latency, 1.0f) * 0.001;
+    if (options->Reliability == EOS_EPacketReliability::EOS_PR_ReliableOrdered)
+    {
+        deliverTime = Math::Max(deliverTime, endpoint->OrderedTime);
+        endpoint->OrderedTime = deliverTime;
+    }
+
+    Packet* packet = loopback->_pool.HasItems() ? loopback->_pool.Pop() : New<Packet>();
+    packet->Sender = endpoint;
+    packet->DeliverTime = deliverTime;
+    packet->Size = options->DataLengthBytes;
+    packet->Channel = options->Channel;
+    packet->SocketId = *options->SocketId;
+    Platform::MemoryCopy(packet->Data, options->Data, options->DataLengthBytes);
+    int32 index = remote->Incoming.Count();
+    while (index > 0 && remote->Incoming[index - 1]->DeliverTime > deliverTime)
+        index--;
+    remote->Incoming.Insert(index, packet);
+    remote->IncomingSize += packet->Size;
+    return EOS_EResult::EOS_Success;
+}
+
+EOS_EResult EOSP2PLoopback::GetNextReceivedPacketSize(EOS_HP2P handle, const EOS_P2P_GetNextReceivedPacketSizeOptions* options, uint32_t* outPacketSizeBytes)
+{
+    Endpoint* endpoint = GetEndpoint(handle);
+    ScopeLock lock(endpoint->Owner->_locker);
+    const int32 index = endpoint->FindPacket(options->RequestedChannel, Platform::GetTimeSeconds());
+    if (index == -1)
+        return EOS_EResult::EOS_NotFound;
+    *outPacketSizeBytes = endpoint->Incoming[index]->Size;
+    return EOS_EResult::EOS_Success;
+}
+
+EOS_EResult EOSP2PLoopback::ReceivePacket(EOS_HP2P handle, const EOS_P2P_ReceivePacketOptions* options, EOS_ProductUserId* outPeerId, EOS_P2P_SocketId* outSocketId, uint8_t* outChannel, void* outData, uint32_t* outBytesWritten)
+{
+    Endpoint* endpoint = GetEndpoint(handle);
+    EOSP2PLoopback* loopback = endpoint->Owner;
+    ScopeLock lock(loopback->_locker);
+    const int32 index = endpoint->FindPacket(options->RequestedChannel, Platform::GetTimeSeconds());
+    if (index == -1)
+        return EOS_EResult::EOS_NotFound;
+    Packet* packet = endpoint->Incoming[index];
+    if (packet->Size > options->MaxDataSizeBytes)
+        return EOS_EResult::EOS_InvalidParameters;
+    *outPeerId = (EOS_ProductUserId)packet->Sender;
+    *outSocketId = packet->SocketId;
+    *outChannel = packet->Channel;
+    *outBytesWritten = packet->Size;
+    Platform::MemoryCopy(outData, packet->Data, packet->Size);
+    endpoint->Incoming.RemoveAtKeepOrder(index);
+    endpoint->IncomingSize -= packet->Size;
+    loopback->_pool.Add(packet);
+    return EOS_EResult::EOS_Success;
+}
+
+EOS_EResult EOSP2PLoopback::AcceptConnection(EOS_HP2P handle, const EOS_P2P_AcceptConnectionOptions* options)
+{
+    Endpoint* endpoint = GetEndpoint(handle);
+    Endpoint* remote = FindEndpoint(options->RemoteUserId);
+    if (!remote)
+        return EOS_EResult::EOS_InvalidParameters;
+    ScopeLock lock(endpoint->Owner->_locker);
+    endpoint->Accepted.Add(remote);
+    if (endpoint->Connected.Contains(remote))
+        return EOS_EResult::EOS_Success;
+
+    // Connection gets established once both sides accept it
+    if (remote->Accepted.Contains(endpoint))
+    {
+        endpoint->Connected.Add(remote);
+        remote->Connected.Add(endpoint);
+        endpoint->Events.Add({ Endpoint::EventType::ConnectionEstablished, remote });
+        remote->Events.Add({ Endpoint::EventType::ConnectionEstablished, endpoint });
+    }
+    else
+    {
+        remote->Events.Add({ Endpoint::EventType::ConnectionRequest, endpoint });
+    }
+    return EOS_EResult::EOS_Success;
+}
+
+EOS_EResult EOSP2PLoopback::CloseConnection(EOS_HP2P handle, const EOS_P2P_CloseConnectionOptions* options)
+{
+    Endpoint* endpoint = GetEndpoint(handle);
+    Endpoint* remote = FindEndpoint(options->RemoteUserId);
+    if (!remote)
+        return EOS_EResult::EOS_InvalidParameters;
+    ScopeLock lock(endpoint->Owner->_locker);
+    Disconnect(endpoint, remote);
+    return EOS_EResult::EOS_Success;
+}
+
+EOS_EResult EOSP2PLoopback::CloseConnections(EOS_HP2P handle, const EOS_P2P_CloseConnectionsOptions* options)
+{
+    Endpoint* endpoint = GetEndpoint(handle);
+    ScopeLock lock(endpoint->Owner->_locker);
+    Array<Endpoint*> remotes;
+    for (const auto& e : endpoint->Accepted)
+        remotes.Add(e.Item);
+    for (Endpoint* remote : remotes)
+        Disconnect(endpoint, remote);
+    return EOS_EResult::EOS_Success;
+}
+
+EOS_NotificationId EOSP2PLoopback::AddNotifyPeerConnectionRequest(EOS_HP2P handle, const EOS_P2P_AddNotifyPeerConnectionRequestOptions* options, void* clientData, EOS_P2P_OnIncomingConnectionRequestCallback handler)
+{
+    Endpoint* endpoint = GetEndpoint(handle);
+    ScopeLock lock(endpoint->Owner->_locker);
+    if (options->SocketId)
+        endpoint->SocketId = *options->SocketId;
+    endpoint->RequestData = clientData;
+    endpoint->RequestHandler = handler;
+    return RequestNotification;
+}
+
+void EOSP2PLoopback::RemoveNotifyPeerConnectionRequest(EOS_HP2P handle, EOS_NotificationId notificationId)
+{
+    Endpoint* endpoint = GetEndpoint(handle);
+    ScopeLock lock(endpoint->Owner->_locker);
+    endpoint->RequestHandler = nullptr;
+}
+
+EOS_NotificationId EOSP2PLoopback::AddNotifyPeerConnectionEstablished(EOS_HP2P handle, const EOS_P2P_AddNotifyPeerConnectionEstablishedOptions* options, void* clientData, EOS_P2P_OnPeerConnectionEstablishedCallback handler)
+{
+    Endpoint* endpoint = GetEndpoint(handle);
+    ScopeLock lock(endpoint->Owner->_locker);
+    endpoint->EstablishedData = clientData;
+    endpoint->EstablishedHandler = handler;
+    return EstablishedNotification;
+}
+
+void EOSP2PLoopback::RemoveNotifyPeerConnectionEstablished(EOS_HP2P handle, EOS_NotificationId notificationId)
+{
+    Endpoint* endpoint = GetEndpoint(handle);
+    ScopeLock lock(endpoint->Owner->_locker);
+    endpoint->EstablishedHandler = nullptr;
+}
+
+EOS_NotificationId EOSP2PLoopback::AddNotifyPeerConnectionClosed(EOS_HP2P handle, const EOS_P2P_AddNotifyPeerConnectionClosedOptions* options, void* clientData, EOS_P2P_OnRemoteConnectionClosedCallback handler)
+{
+    Endpoint* endpoint = GetEndpoint(handle);
+    ScopeLock lock(endpoint->Owner->_locker);
+    endpoint->ClosedData = clientData;
+    endpoint->ClosedHandler = handler;
+    return ClosedNotification;
+}
+
+void EOSP2PLoopback::RemoveNotifyPeerConnectionClosed(EOS_HP2P handle, EOS_NotificationId notificationId)
+{
+    Endpoint* endpoint = GetEndpoint(handle);
+    ScopeLock lock(endpoint->Owner->_locker);
+    endpoint->ClosedHandler = nullptr;
+}
+
+EOS_NotificationId EOSP2PLoopback::AddNotifyIncomingPacketQueueFull(EOS_HP2P handle, const EOS_P2P_AddNotifyIncomingPacketQueueFullOptions* options, void* clientData, EOS_P2P_OnIncomingPacketQueueFullCallback handler)
+{
+    // Incoming queue is never full (packets stay in the loopback until received)
+    return QueueFullNotification;
+}
+
+void EOSP2PLoopback::RemoveNotifyIncomingPacketQueueFull(EOS_HP2P handle, EOS_NotificationId notificationId)
+{
+}
+
+EOS_EResult EOSP2PLoopback::SetPacketQueueSize(EOS_HP2P handle, const EOS_P2P_SetPacketQueueSizeOptions* options)
+{
+    Endpoint* endpoint = GetEndpoint(handle);
+    ScopeLock lock(endpoint->Owner->_locker);
+    endpoint->IncomingMaxSize = options->IncomingPacketQueueMaxSizeBytes;
+    endpoint->OutgoingMaxSize = options->OutgoingPacketQueueMaxSizeBytes;
+    return EOS_EResult::EOS_Success;
+}
+
+EOS_EResult EOSP2PLoopback::GetPacketQueueInfo(EOS_HP2P handle, const EOS_P2P_GetPacketQueueInfoOptions* options, EOS_P2P_PacketQueueInfo* outPacketQueueInfo)
+{
+    Endpoint* endpoint = GetEndpoint(handle);
+    EOSP2PLoopback* loopback = endpoint->Owner;
+    ScopeLock lock(loopback->_locker);
+    const double now = Platform::GetTimeSeconds();
+    endpoint->UpdateOutgoing(now);
+    outPacketQueueInfo->IncomingPacketQueueMaxSizeBytes = endpoint->IncomingMaxSize;
+    outPacketQueueInfo->IncomingPacketQueueCurrentSizeBytes = endpoint->IncomingSize;
+    outPacketQueueInfo->IncomingPacketQueueCurrentPacketCount = endpoint->Incoming.Count();
+    outPacketQueueInfo->OutgoingPacketQueueMaxSizeBytes = endpoint->OutgoingMaxSize;
+    outPacketQueueInfo->OutgoingPacketQueueCurrentSizeBytes = loopback->Settings.Bandwidth > 0 ? (uint64)(Math::Max(endpoint->LinkFreeTime - now, 0.0) * loopback->Settings.Bandwidth) : 0;
+    outPacketQueueInfo->OutgoingPacketQueueCurrentPacketCount = endpoint->Outgoing.Count();
+    return EOS_EResult::EOS_Success;
+}
+
+EOS_EResult EOSP2PLoopback::SetRelayControl(EOS_HP2P handle, const EOS_P2P_SetRelayControlOptions* options)
+{
+    return EOS_EResult::EOS_Success;
+}
+
+EOS_EResult EOSP2PLoopback::SetPortRange(EOS_HP2P handle, const EOS_P2P_SetPortRangeOptions* options)
+{
+    return EOS_EResult::EOS_Success;
+}
+
+EOS_ProductUserId EOSP2PLoopback::ProductUserIdFromString(const char* productUserIdString)
+{
+    const int32 prefixLength = sizeof(AddressPrefix) - 1;
+    if (!productUserIdString || StringUtils::Compare(productUserIdString, AddressPrefix, prefixLength) != 0)
+        return nullptr;
+    uint32 id = 0;
+    for (const char* c = productUserIdString + prefixLength; *c; c++)
+    {
+        if (*c < '0' || *c > '9')
+            return nullptr;
+        id = id * 10 + (uint32)(*c - '0');
+    }
+    ScopeLock lock(RegistryLocker);
+    Endpoint* endpoint = nullptr;
+    EndpointIds.TryGet(id, endpoint);
+    return (EOS_ProductUserId)endpoint;
+}
+
+EOS_EResult EOSP2PLoopback::ProductUserIdToString(EOS_ProductUserId accountId, char* outBuffer, int32_t* inOutBufferLength)
+{
+    Endpoint* endpoint = FindEndpoint(accountId);
+    if (!endpoint)
+        return EOS_EResult::EOS_InvalidParameters;
+    const StringAnsi text = StringAnsi::Format("{0}{1}", AddressPrefix, endpoint->Id);
+    if (text.Length() + 1 > *inOutBufferLength)
+    {
+        *inOutBufferLength = text.Length() + 1;
+        return EOS_EResult::EOS_LimitExceeded;
+    }
+    Platform::MemoryCopy(outBuffer, text.Get(), text.Length() + 1);
+    *inOutBufferLength = text.Length() + 1;
+    return EOS_EResult::EOS_Success;
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "Engine/Core/Collections/Array.h"
+#include "Engine/Core/Types/String.h"
+#include "Engine/Platform/CriticalSection.h"
+#include "EOSP2PApi.h"
+#include "EOSPlatformContext.h"
+
+class EOSP2PDriver;
+
+/// <summary>
+/// The simulated network link of the P2P loopback.
+/// </summary>
+API_STRUCT(NoDefault, Namespace="FlaxEngine.Online.EOS") struct ONLINEPLATFORMEOS_API EOSP2PLoopbackSettings
+{
+    DECLARE_SCRIPTING_TYPE_MINIMAL(EOSP2PLoopbackSettings);
+
+    /// <summary>
+    /// The one-way latency (in milliseconds).
+    /// </summary>
+    API_FIELD() float Latency = 30.0f;
+
+    /// <summary>
+    /// The maximum random latency (in milliseconds) added to every packet.
+    /// </summary>
+    API_FIELD() float Jitter = 5.0f;
+
+    /// <summary>
+    /// The chance (0-1) of losing the unreliable packet.
+    /// </summary>
+    API_FIELD() float PacketLoss = 0.0f;
+
+    /// <summary>
+    /// The chance (0-1) of delaying the unreliable packet by the additional latency, so the packets sent after it arrive first.
+    /// </summary>
+    API_FIELD() float Reordering = 0.0f;
+
+    /// <summary>
+    /// The upload bandwidth of every endpoint (in bytes per second). Packets wait in the outgoing queue until they can be sent. Use 0 for unlimited.
+    /// </summary>
+    API_FIELD() int32 Bandwidth = 0;
+
+    /// <summary>
+    /// The seed of the random generator, so the runs with the same settings lose and reorder the same packets.
+    /// </summary>
+    API_FIELD() int32 Seed = 0;
+};
+
+///<summary>
+/// In-process stand-in for the EOS P2P interface. Every endpoint acts as a separate local user (with its own context that doesn't create the EOS platform) and the packets between the endpoints go through the simulated link.
+/// Connection notifications are dispatched on Tick (as the EOS platform tick does). Reliable packets are never lost and the ordered ones keep their order.
+///</summary>
+class ONLINEPLATFORMEOS_API EOSP2PLoopback
+{
+public:
+    /// <summary>
+    /// The loopback P2P functions. The P2P handle passed to them is the endpoint.
+    /// </summary>
+    static const EOSP2PApi Api;
+
+    struct Endpoint;
+
+private:
+    struct Packet;
+
+    CriticalSection _locker;
+    Array<Endpoint*> _endpoints;
+    Array<Packet*> _pool;
+    uint64 _random = 0;
+    int64 _packetsSent = 0;
+    int64 _packetsLost = 0;
+
+public:
+    EOSP2PLoopback(const EOSP2PLoopbackSettings& settings);
+    ~EOSP2PLoopback();
+
+    /// <summary>
+    /// The simulated link settings.
+    /// </summary>
+    EOSP2PLoopbackSettings Settings;
+
+public:
+    /// <summary>
+    /// Adds the endpoint and sets up the driver to use it. Must be called before the driver initialization, the endpoint lives as long as the loopback.
+    /// </summary>
+    /// <returns>The address of the endpoint to connect to (for NetworkConfig.Address).</returns>
+    String Attach(EOSP2PDriver* driver);
+
+    /// <summary>
+    /// Dispatches the connection notifications of all the endpoints.
+    /// </summary>
+    void Tick();
+
+    /// <summary>
+    /// Gets the total amount of the packets sent through the loopback.
+    /// </summary>
+    int64 GetPacketsSent();
+
+    /// <summary>
+    /// Gets the total amount of the packets lost by the simulated link.
+    /// </summary>
+    int64 GetPacketsLost();
+
+private:
+    float Random();
+    static Endpoint* GetEndpoint(EOS_HP2P handle);
+    static Endpoint* FindEndpoint(EOS_ProductUserId userId);
+    static void Disconnect(Endpoint* endpoint, Endpoint* remote);
+
+    static EOS_EResult EOS_CALL SendPacket(EOS_HP2P handle, const EOS_P2P_SendPacketOptions* options);
+    static EOS_EResult EOS_CALL GetNextReceivedPacketSize(EOS_HP2P handle, const EOS_P2P_GetNextReceivedPacketSizeOptions* options, uint32_t* outPacketSizeBytes);
+    static EOS_EResult EOS_CALL ReceivePacket(EOS_HP2P handle, const EOS_P2P_ReceivePacketOptions* options, EOS_ProductUserId* outPeerId, EOS_P2P_SocketId* outSocketId, uint8_t* outChannel, void* outData, uint32_t* outBytesWritten);
+    static EOS_EResult EOS_CALL AcceptConnection(EOS_HP2P handle, const EOS_P2P_AcceptConnectionOptions* options);
+    static EOS_EResult EOS_CALL CloseConnection(EOS_HP2P handle, const EOS_P2P_CloseConnectionOptions* options);
+    static EOS_EResult EOS_CALL CloseConnections(EOS_HP2P handle, const EOS_P2P_CloseConnectionsOptions* options);
+    static EOS_NotificationId EOS_CALL AddNotifyPeerConnectionRequest(EOS_HP2P handle, const EOS_P2P_AddNotifyPeerConnectionRequestOptions* options, void* clientData, EOS_P2P_OnIncomingConnectionRequestCallback handler);
+    static void EOS_CALL RemoveNotifyPeerConnectionRequest(EOS_HP2P handle, EOS_NotificationId notificationId);
+    static EOS_NotificationId EOS_CALL AddNotifyPeerConnectionEstablished(EOS_HP2P handle, const EOS_P2P_AddNotifyPeerConnectionEstablishedOptions* options, void* clientData, EOS_P2P_OnPeerConnectionEstablishedCallback handler);
+    static void EOS_CALL RemoveNotifyPeerConnectionEstablished(EOS_HP2P handle, EOS_NotificationId notificationId);
+    static EOS_NotificationId EOS_CALL AddNotifyPeerConnectionClosed(EOS_HP2P handle, const EOS_P2P_AddNotifyPeerConnectionClosedOptions* options, void* clientData, EOS_P2P_OnRemoteConnectionClosedCallback handler);
+    static void EOS_CALL RemoveNotifyPeerConnectionClosed(EOS_HP2P handle, EOS_NotificationId notificationId);
+    static EOS_NotificationId EOS_CALL AddNotifyIncomingPacketQueueFull(EOS_HP2P handle, const EOS_P2P_AddNotifyIncomingPacketQueueFullOptions* options, void* clientData, EOS_P2P_OnIncomingPacketQueueFullCallback handler);
+    static void EOS_CALL RemoveNotifyIncomingPacketQueueFull(EOS_HP2P handle, EOS_NotificationId notificationId);
+    static EOS_EResult EOS_CALL SetPacketQueueSize(EOS_HP2P handle, const EOS_P2P_SetPacketQueueSizeOptions* options);
+    static EOS_EResult EOS_CALL GetPacketQueueInfo(EOS_HP2P handle, const EOS_P2P_GetPacketQueueInfoOptions* options, EOS_P2P_PacketQueueInfo* outPacketQueueInfo);
+    static EOS_EResult EOS_CALL SetRelayControl(EOS_HP2P handle, const EOS_P2P_SetRelayControlOptions* options);
+    static EOS_EResult EOS_CALL SetPortRange(EOS_HP2P handle, const EOS_P2P_SetPortRangeOptions* options);
+    static EOS_ProductUserId EOS_CALL ProductUserIdFromString(const char* productUserIdString);
+    static EOS_EResult EOS_CALL ProductUserIdToString(EOS_ProductUserId accountId, char* outBuffer, int32_t* inOutBufferLength);
+};
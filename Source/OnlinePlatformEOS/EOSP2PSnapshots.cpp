@@ -0,0 +1,247 @@
+#include "EOSP2PSnapshots.h"
+
+#include "Engine/Core/Log.h"
+#include "Engine/Core/Math/Math.h"
+#include "Engine/Platform/Platform.h"
+
+namespace
+{
+    // Written before the encoded data, baseline 0 means the snapshot is not delta-encoded
+    struct SnapshotHeader
+    {
+        uint32 Sequence;
+        uint32 Baseline;
+        uint32 Length;
+    };
+
+    // Control byte below RunFlag is followed by (value + 1) literal bytes, otherwise it stands for (value - RunFlag + 1) zero bytes
+    constexpr uint8 RunFlag = 0x80;
+    constexpr uint32 MaxRun = 128;
+
+    // Shorter zero runs are cheaper to keep in the literal
+    constexpr uint32 MinZeroRun = 3;
+
+    void XorBlock(uint8* data, const uint8* baseline, uint32 size)
+    {
+        // Word at a time (vectorized by the compiler), the tail byte by byte
+        uint32 i = 0;
+        for (; i + sizeof(uint64) <= size; i += sizeof(uint64))
+        {
+            uint64 a, b;
+            Platform::MemoryCopy(&a, data + i, sizeof(uint64));
+            Platform::MemoryCopy(&b, baseline + i, sizeof(uint64));
+            a ^= b;
+            Platform::MemoryCopy(data + i, &a, sizeof(uint64));
+        }
+        for (; i < size; i++)
+            data[i] ^= baseline[i];
+    }
+
+    uint32 GetZeroRun(const uint8* data, uint32 size)
+    {
+        // Skips the unchanged state a word at a time
+        size = Math::Min(size, MaxRun);
+        uint32 length = 0;
+        for (; length + sizeof(uint64) <= size; length += sizeof(uint64))
+        {
+            uint64 word;
+            Platform::MemoryCopy(&word, data + length, sizeof(uint64));
+            if (word != 0)
+                break;
+        }
+        while (length < size && data[length] == 0)
+            length++;
+        return length;
+    }
+
+    void WriteLiterals(uint8*& output, const uint8* data, uint32 count)
+    {
+        while (count != 0)
+        {
+            const uint32 length = Math::Min(count, MaxRun);
+            *output++ = (uint8)(length - 1);
+            Platform::MemoryCopy(output, data, length);
+            output += length;
+            data += length;
+            count -= length;
+        }
+    }
+
+    // Output needs space for size + size / MaxRun + 1 bytes
+    uint32 EncodeRuns(const uint8* data, uint32 size, uint8* output)
+    {
+        uint8* start = output;
+        uint32 position = 0;
+        uint32 literalStart = 0;
+        while (position < size)
+        {
+            const uint32 zeros = data[position] == 0 ? GetZeroRun(data + position, size - position) : 0;
+            if (zeros >= MinZeroRun || (zeros != 0 && position + zeros == size))
+            {
+                WriteLiterals(output, data + literalStart, position - literalStart);
+                *output++ = (uint8)(RunFlag + zeros - 1);
+                position += zeros;
+                literalStart = position;
+            }
+            else
+            {
+                position += Math::Max(zeros, 1u);
+            }
+        }
+        WriteLiterals(output, data + literalStart, position - literalStart);
+        return (uint32)(output - start);
+    }
+
+    bool DecodeRuns(const uint8* data, uint32 size, uint8* output, uint32 length)
+    {
+        uint32 position = 0;
+        uint32 written = 0;
+        while (position < size)
+        {
+            const uint8 control = data[position++];
+            if (control >= RunFlag)
+            {
+                const uint32 count = control - RunFlag + 1;
+                if (written + count > length)
+                    return true;
+                Platform::MemoryClear(output + written, count);
+                written += count;
+            }
+            else
+            {
+                const uint32 count = control + 1;
+                if (position + count > size || written + count > length)
+                    return true;
+                Platform::MemoryCopy(output + written, data + position, count);
+                position += count;
+                written += count;
+            }
+        }
+        return written != length;
+    }
+}
+
+EOSP2PSnapshots::~EOSP2PSnapshots()
+{
+    Clear();
+}
+
+void EOSP2PSnapshots::Encode(uint32 connectionId, const uint8* data, uint32 size, const uint8*& encoded, uint32& encodedSize)
+{
+    Connection* connection = GetConnection(connectionId);
+    SnapshotHeader header;
+    header.Sequence = connection->NextSequence++;
+    header.Baseline = 0;
+    header.Length = size;
+
+    // The baseline is used only while it's still in the history
+    const Snapshot* baseline = nullptr;
+    if (connection->AckedSequence != 0)
+    {
+        const Snapshot& e = connection->Sent[connection->AckedSequence % HistorySize];
+        if (e.Sequence == connection->AckedSequence)
+        {
+            baseline = &e;
+            header.Baseline = e.Sequence;
+        }
+    }
+
+    _delta.Resize((int32)size, false);
+    Platform::MemoryCopy(_delta.Get(), data, size);
+    if (baseline)
+        XorBlock(_delta.Get(), baseline->Data.Get(), Math::Min(size, (uint32)baseline->Data.Count()));
+    _encoded.Resize((int32)(sizeof(SnapshotHeader) + size + size / MaxRun + 1), false);
+    Platform::MemoryCopy(_encoded.Get(), &header, sizeof(header));
+    encodedSize = sizeof(header) + EncodeRuns(_delta.Get(), size, _encoded.Get() + sizeof(header));
+    encoded = _encoded.Get();
+
+    Snapshot& sent = connection->Sent[header.Sequence % HistorySize];
+    sent.Sequence = header.Sequence;
+    sent.Data.Set(data, (int32)size);
+    RawBytes += size;
+    EncodedBytes += encodedSize;
+}
+
+bool EOSP2PSnapshots::Decode(uint32 connectionId, const uint8* data, uint32 size, NetworkMessage& message)
+{
+    SnapshotHeader header;
+    if (size < sizeof(header))
+        return true;
+    Platform::MemoryCopy(&header, data, sizeof(header));
+    Connection* connection = GetConnection(connectionId);
+    if (header.Sequence <= connection->LastReceived)
+        return true;
+
+    const Snapshot* baseline = nullptr;
+    if (header.Baseline != 0)
+    {
+        const Snapshot& e = connection->Received[header.Baseline % HistorySize];
+        if (e.Sequence != header.Baseline)
+        {
+            LOG(Warning, "EOS P2P driver dropped snapshot {0} (baseline {1} is missing)", header.Sequence, header.Baseline);
+            return true;
+        }
+        baseline = &e;
+    }
+    if (header.Length > message.BufferSize || DecodeRuns(data + sizeof(header), size - sizeof(header), message.Buffer, header.Length))
+    {
+        LOG(Warning, "EOS P2P driver dropped invalid {0} bytes snapshot (message size limit is {1})", header.Length, message.BufferSize);
+        return true;
+    }
+    if (baseline)
+        XorBlock(message.Buffer, baseline->Data.Get(), Math::Min(header.Length, (uint32)baseline->Data.Count()));
+    message.Length = header.Length;
+    message.Position = 0;
+
+    Snapshot& received = connection->Received[header.Sequence % HistorySize];
+    received.Sequence = header.Sequence;
+    received.Data.Set(message.Buffer, (int32)header.Length);
+    connection->LastReceived = header.Sequence;
+    connection->AckPending = true;
+    return false;
+}
+
+void EOSP2PSnapshots::ReceiveAck(uint32 connectionId, uint32 sequence)
+{
+    Connection* connection;
+    if (!_connections.TryGet(connectionId, connection))
+        return;
+    if (sequence > connection->AckedSequence && sequence < connection->NextSequence && connection->Sent[sequence % HistorySize].Sequence == sequence)
+        connection->AckedSequence = sequence;
+}
+
+bool EOSP2PSnapshots::PopAck(uint32 connectionId, uint32& sequence)
+{
+    Connection* connection;
+    if (!_connections.TryGet(connectionId, connection) || !connection->AckPending)
+        return false;
+    connection->AckPending = false;
+    sequence = connection->LastReceived;
+    return true;
+}
+
+void EOSP2PSnapshots::RemoveConnection(uint32 connectionId)
+{
+    Connection* connection;
+    if (!_connections.TryGet(connectionId, connection))
+        return;
+    _connections.Remove(connectionId);
+    Delete(connection);
+}
+
+void EOSP2PSnapshots::Clear()
+{
+    for (auto& e : _connections)
+        Delete(e.Value);
+    _connections.Clear();
+}
+
+EOSP2PSnapshots::Connection* EOSP2PSnapshots::GetConnection(uint32 connectionId)
+{
+    Connection* connection;
+    if (_connections.TryGet(connectionId, connection))
+        return connection;
+    connection = New<Connection>();
+    _connections.Add(connectionId, connection);
+    return connection;
+}
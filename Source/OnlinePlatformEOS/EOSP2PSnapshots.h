@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Engine/Core/Collections/Array.h"
+#include "Engine/Core/Collections/Dictionary.h"
+#include "Engine/Networking/NetworkMessage.h"
+
+///<summary>
+/// Delta compression of the state snapshots sent over the unreliable P2P packets. Every snapshot is XORed against the latest snapshot the connection acknowledged (its baseline), so the unchanged state turns into the runs of zeros that are packed with the run-length encoding.
+/// Both sides keep the history of the recent snapshots per connection. When the acknowledged baseline is too old (or there is none yet), the snapshot is only run-length encoded.
+/// Not thread-safe, the owner serializes the calls.
+///</summary>
+class ONLINEPLATFORMEOS_API EOSP2PSnapshots
+{
+public:
+    /// <summary>
+    /// The amount of the recent snapshots kept per connection (the oldest baseline that can be used).
+    /// </summary>
+    static constexpr int32 HistorySize = 32;
+
+private:
+    struct Snapshot
+    {
+        uint32 Sequence = 0;
+        Array<uint8> Data;
+    };
+
+    struct Connection
+    {
+        uint32 NextSequence = 1;
+        uint32 AckedSequence = 0;
+        uint32 LastReceived = 0;
+        bool AckPending = false;
+        Snapshot Sent[HistorySize];
+        Snapshot Received[HistorySize];
+    };
+
+    Dictionary<uint32, Connection*> _connections;
+    Array<uint8> _delta;
+    Array<uint8> _encoded;
+
+public:
+    ~EOSP2PSnapshots();
+
+    /// <summary>
+    /// The total size (in bytes) of the snapshots passed to Encode.
+    /// </summary>
+    uint64 RawBytes = 0;
+
+    /// <summary>
+    /// The total size (in bytes) of the encoded snapshots.
+    /// </summary>
+    uint64 EncodedBytes = 0;
+
+public:
+    /// <summary>
+    /// Encodes the snapshot for the connection. The result is valid until the next call.
+    /// </summary>
+    void Encode(uint32 connectionId, const uint8* data, uint32 size, const uint8*& encoded, uint32& encodedSize);
+
+    /// <summary>
+    /// Decodes the snapshot received from the connection into the message. Fails for the stale snapshots (older than the last decoded one) and when the baseline is missing.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool Decode(uint32 connectionId, const uint8* data, uint32 size, NetworkMessage& message);
+
+    /// <summary>
+    /// Processes the acknowledgement of the snapshot sent to the connection (it becomes the baseline of the following snapshots).
+    /// </summary>
+    void ReceiveAck(uint32 connectionId, uint32 sequence);
+
+    /// <summary>
+    /// Gets the latest snapshot received from the connection if it wasn't acknowledged yet.
+    /// </summary>
+    bool PopAck(uint32 connectionId, uint32& sequence);
+
+    /// <summary>
+    /// Removes the connection state.
+    /// </summary>
+    void RemoveConnection(uint32 connectionId);
+
+    /// <summary>
+    /// Removes all the connections.
+    /// </summary>
+    void Clear();
+
+private:
+    Connection* GetConnection(uint32 connectionId);
+};
@@ -0,0 +1,427 @@
+#include "EOSP2PStreams.h"
+
+#include "Engine/Core/Log.h"
+#include "Engine/Core/Math/Math.h"
+#include "Engine/Networking/NetworkPeer.h"
+#include "Engine/Platform/Platform.h"
+
+namespace
+{
+    // Packets end with their type, the same way as the driver packets
+    enum class StreamPacketType : uint8
+    {
+        Data = 0,
+        Ack = 1,
+    };
+
+    struct SegmentHeader
+    {
+        uint32 PacketSeq;
+        uint32 MessageSeq;
+        uint32 Length;
+        uint16 Index;
+        uint8 Stream;
+        uint8 Padding;
+    };
+
+    struct AckHeader
+    {
+        // The latest received packet and the mask of the 64 packets before it (bit 0 is Largest - 1)
+        uint32 Largest;
+        uint32 Padding;
+        uint64 Mask;
+    };
+
+    constexpr uint32 SegmentOverhead = sizeof(SegmentHeader) + sizeof(StreamPacketType);
+    constexpr uint32 SegmentSize = EOS_P2P_MAX_PACKET_SIZE - SegmentOverhead;
+    constexpr uint32 AckSize = sizeof(AckHeader) + sizeof(StreamPacketType);
+
+    // Limit of the incomplete or out-of-order messages per stream (segments above it are dropped without the acknowledgement, so they get retransmitted later)
+    constexpr int32 MaxIncomingMessages = 1024;
+
+    // Amount of the later packets acknowledged before the packet is considered lost
+    constexpr uint32 FastRetransmitThreshold = 3;
+
+    constexpr float InitialRetransmitTimeout = 0.25f;
+    constexpr float MaxRetransmitTimeout = 2.0f;
+}
+
+EOSP2PStreams::~EOSP2PStreams()
+{
+    Array<NetworkMessage> released;
+    Clear(released);
+    _pool.ClearDelete();
+}
+
+void EOSP2PStreams::Init(NetworkPeer* host, const Array<StreamDesc>& streams, const SendPacketCallback& sendPacket)
+{
+    _host = host;
+    _streams = streams;
+    _sendPacket = sendPacket;
+
+    // Higher priority streams send first (the order of the streams is kept for the same priority)
+    _streamsByPriority.Clear();
+    for (int32 i = 0; i < _streams.Count(); i++)
+    {
+        int32 index = _streamsByPriority.Count();
+        while (index > 0 && _streams[_streamsByPriority[index - 1]].Priority < _streams[i].Priority)
+            index--;
+        _streamsByPriority.Insert(index, i);
+    }
+}
+
+bool EOSP2PStreams::Send(uint32 connectionId, int32 stream, const NetworkMessage& message)
+{
+    if (stream < 0 || stream >= _streams.Count())
+    {
+        LOG(Error, "EOS P2P stream {0} doesn't exist", stream);
+        return true;
+    }
+    const uint32 count = Math::Max<uint32>((message.Length + SegmentSize - 1) / SegmentSize, 1);
+    if (count > MAX_uint16)
+    {
+        LOG(Error, "EOS P2P stream can't send {0} bytes message (too many segments)", message.Length);
+        return true;
+    }
+    Connection* connection = GetConnection(connectionId);
+
+    SegmentHeader header;
+    header.PacketSeq = 0;
+    header.MessageSeq = connection->SendSeq[stream]++;
+    header.Length = message.Length;
+    header.Stream = (uint8)stream;
+    header.Padding = 0;
+    auto& pending = connection->Pending[stream];
+    for (uint32 index = 0; index < count; index++)
+    {
+        const uint32 offset = index * SegmentSize;
+        const uint32 size = message.Length != 0 ? Math::Min(SegmentSize, message.Length - offset) : 0;
+        header.Index = (uint16)index;
+        SentSegment* segment = AllocSegment();
+        Platform::MemoryCopy(segment->Data, message.Buffer + offset, size);
+        Platform::MemoryCopy(segment->Data + size, &header, sizeof(header));
+        segment->Data[size + sizeof(header)] = (uint8)StreamPacketType::Data;
+        segment->Size = size + SegmentOverhead;
+        segment->PacketSeq = 0;
+        segment->SendTime = 0.0;
+        segment->Retries = 0;
+        segment->FastRetransmit = false;
+        pending.Add(segment);
+    }
+    return false;
+}
+
+void EOSP2PStreams::Receive(uint32 connectionId, const uint8* data, uint32 size, double now)
+{
+    if (size == 0)
+        return;
+    Connection* connection = GetConnection(connectionId);
+    const StreamPacketType type = (StreamPacketType)data[size - 1];
+    if (type == StreamPacketType::Ack)
+    {
+        ReceiveAck(connection, data, size, now);
+        return;
+    }
+    if (type != StreamPacketType::Data || size < SegmentOverhead)
+        return;
+    if (ReceiveSegment(connectionId, connection, data, size))
+        return;
+
+    // Remember the packet for the next acknowledgement (even if its message was already delivered, the ack could have been lost)
+    uint32 seq;
+    Platform::MemoryCopy(&seq, data + size - SegmentOverhead, sizeof(seq));
+    if (connection->LargestReceived == 0 || seq > connection->LargestReceived)
+    {
+        if (connection->LargestReceived != 0)
+        {
+            const uint32 shift = seq - connection->LargestReceived;
+            if (shift < 64)
+                connection->ReceivedMask = (connection->ReceivedMask << shift) | (1ull << (shift - 1));
+            else
+                connection->ReceivedMask = shift == 64 ? 1ull << 63 : 0;
+        }
+        connection->LargestReceived = seq;
+    }
+    else if (seq < connection->LargestReceived && connection->LargestReceived - seq <= 64)
+    {
+        connection->ReceivedMask |= 1ull << (connection->LargestReceived - seq - 1);
+    }
+    connection->AckPending = true;
+}
+
+bool EOSP2PStreams::PopMessage(NetworkEvent& eventPtr)
+{
+    if (_deliveredStart >= _delivered.Count())
+        return false;
+    eventPtr = _delivered[_deliveredStart++];
+    if (_deliveredStart == _delivered.Count())
+    {
+        _delivered.Clear();
+        _deliveredStart = 0;
+    }
+    return true;
+}
+
+void EOSP2PStreams::Update(double now)
+{
+    for (auto& e : _connections)
+    {
+        const uint32 connectionId = e.Key;
+        Connection* connection = e.Value;
+
+        if (connection->AckPending)
+        {
+            connection->AckPending = false;
+            AckHeader ack;
+            ack.Largest = connection->LargestReceived;
+            ack.Padding = 0;
+            ack.Mask = connection->ReceivedMask;
+            uint8 packet[AckSize];
+            Platform::MemoryCopy(packet, &ack, sizeof(ack));
+            packet[sizeof(ack)] = (uint8)StreamPacketType::Ack;
+            _sendPacket(connectionId, packet, AckSize);
+        }
+
+        // Retransmit the lost segments (with the exponential backoff of the timeout)
+        const float rto = connection->SRTT > 0.0f ? Math::Clamp(connection->SRTT + 4.0f * connection->RTTVar, MinRetransmitTimeout, MaxRetransmitTimeout) : Math::Max(InitialRetransmitTimeout, MinRetransmitTimeout);
+        for (SentSegment* segment : connection->InFlight)
+        {
+            const float timeout = rto * (float)(1 << Math::Min(segment->Retries, 4));
+            if (segment->FastRetransmit || now - segment->SendTime >= timeout)
+            {
+                if (!segment->FastRetransmit)
+                    segment->Retries++;
+                SendSegment(connectionId, connection, segment, now);
+            }
+        }
+
+        // Send the queued segments by the stream priority while the window allows it
+        for (const int32 stream : _streamsByPriority)
+        {
+            auto& pending = connection->Pending[stream];
+            int32 sent = 0;
+            while (sent < pending.Count() && connection->InFlight.Count() < MaxInFlight)
+            {
+                SentSegment* segment = pending[sent++];
+                SendSegment(connectionId, connection, segment, now);
+                connection->InFlight.Add(segment);
+            }
+            for (int32 i = sent; i < pending.Count(); i++)
+                pending[i - sent] = pending[i];
+            pending.Resize(pending.Count() - sent);
+        }
+    }
+}
+
+void EOSP2PStreams::RemoveConnection(uint32 connectionId, Array<NetworkMessage>& released)
+{
+    Connection* connection;
+    if (!_connections.TryGet(connectionId, connection))
+        return;
+    _connections.Remove(connectionId);
+    ReleaseConnection(connection, released);
+}
+
+void EOSP2PStreams::Clear(Array<NetworkMessage>& released)
+{
+    for (auto& e : _connections)
+        ReleaseConnection(e.Value, released);
+    _connections.Clear();
+    for (int32 i = _deliveredStart; i < _delivered.Count(); i++)
+        released.Add(_delivered[i].Message);
+    _delivered.Clear();
+    _deliveredStart = 0;
+}
+
+EOSP2PStreams::Connection* EOSP2PStreams::GetConnection(uint32 connectionId)
+{
+    Connection* connection;
+    if (_connections.TryGet(connectionId, connection))
+        return connection;
+    connection = New<Connection>();
+    connection->Pending.Resize(_streams.Count());
+    connection->SendSeq.Resize(_streams.Count());
+    connection->Streams.Resize(_streams.Count());
+    for (uint32& seq : connection->SendSeq)
+        seq = 0;
+    _connections.Add(connectionId, connection);
+    return connection;
+}
+
+EOSP2PStreams::SentSegment* EOSP2PStreams::AllocSegment()
+{
+    if (_pool.HasItems())
+        return _pool.Pop();
+    return New<SentSegment>();
+}
+
+void EOSP2PStreams::SendSegment(uint32 connectionId, Connection* connection, SentSegment* segment, double now)
+{
+    // Every send (including the retransmission) gets the new packet sequence so the acknowledgements are not ambiguous
+    segment->PacketSeq = connection->NextPacketSeq++;
+    segment->SendTime = now;
+    segment->FastRetransmit = false;
+    Platform::MemoryCopy(segment->Data + segment->Size - SegmentOverhead, &segment->PacketSeq, sizeof(uint32));
+    _sendPacket(connectionId, segment->Data, segment->Size);
+}
+
+void EOSP2PStreams::ReceiveAck(Connection* connection, const uint8* data, uint32 size, double now)
+{
+    if (size != AckSize)
+        return;
+    AckHeader ack;
+    Platform::MemoryCopy(&ack, data, sizeof(ack));
+    for (int32 i = 0; i < connection->InFlight.Count(); i++)
+    {
+        SentSegment* segment = connection->InFlight[i];
+        const uint32 seq = segment->PacketSeq;
+        bool acked = seq == ack.Largest;
+        if (!acked && ack.Largest > seq && ack.Largest - seq <= 64)
+            acked = (ack.Mask & (1ull << (ack.Largest - seq - 1))) != 0;
+        if (acked)
+        {
+            if (seq == ack.Largest)
+            {
+                // Smoothed RTT and its variation for the retransmission timeout (as in TCP)
+                const float sample = (float)(now - segment->SendTime);
+                if (connection->SRTT <= 0.0f)
+                {
+                    connection->SRTT = sample;
+                    connection->RTTVar = sample * 0.5f;
+                }
+                else
+                {
+                    connection->RTTVar = connection->RTTVar * 0.75f + Math::Abs(connection->SRTT - sample) * 0.25f;
+                    connection->SRTT = connection->SRTT * 0.875f + sample * 0.125f;
+                }
+            }
+            _pool.Add(segment);
+            connection->InFlight.RemoveAt(i--);
+        }
+        else if (ack.Largest >= seq + FastRetransmitThreshold)
+        {
+            segment->FastRetransmit = true;
+        }
+    }
+}
+
+bool EOSP2PStreams::ReceiveSegment(uint32 connectionId, Connection* connection, const uint8* data, uint32 size)
+{
+    SegmentHeader header;
+    size -= SegmentOverhead;
+    Platform::MemoryCopy(&header, data + size, sizeof(header));
+    if (header.Stream >= _streams.Count())
+        return false;
+    const uint32 count = Math::Max<uint32>((header.Length + SegmentSize - 1) / SegmentSize, 1);
+    const uint32 offset = header.Index * SegmentSize;
+    if (header.Index >= count || size != (header.Length != 0 ? Math::Min(SegmentSize, header.Length - offset) : 0))
+    {
+        LOG(Warning, "EOS P2P stream dropped invalid segment");
+        return false;
+    }
+    const StreamDesc& desc = _streams[header.Stream];
+    ReceiveStream& stream = connection->Streams[header.Stream];
+    if (header.MessageSeq < stream.NextSeq || (!desc.Ordered && stream.Delivered.Contains(header.MessageSeq)))
+        return false;
+
+    Incoming* incoming = stream.Messages.TryGet(header.MessageSeq);
+    if (!incoming)
+    {
+        // The next message of the ordered stream is always accepted, otherwise the stream full of the later messages would stall
+        if (stream.Messages.Count() >= MaxIncomingMessages && (!desc.Ordered || header.MessageSeq != stream.NextSeq))
+            return true;
+        incoming = &stream.Messages[header.MessageSeq];
+        incoming->Length = header.Length;
+        incoming->Count = (uint16)count;
+        incoming->Received = 0;
+        incoming->Message = _host->CreateMessage();
+        if (header.Length > incoming->Message.BufferSize)
+        {
+            // Message can't be delivered, skip it so the ordered stream doesn't stall
+            LOG(Warning, "EOS P2P stream dropped {0} bytes message (message size limit is {1})", header.Length, incoming->Message.BufferSize);
+            _host->RecycleMessage(incoming->Message);
+            incoming->Message = NetworkMessage();
+            incoming->Received = incoming->Count - 1;
+        }
+        else
+        {
+            incoming->Mask.Resize((count + 31) / 32, false);
+            Platform::MemoryClear(incoming->Mask.Get(), incoming->Mask.Count() * sizeof(uint32));
+        }
+    }
+    else if (incoming->Length != header.Length || incoming->Count != count)
+    {
+        // The mask and the buffer are sized by the first segment of the message, drop the mismatching one without the ack
+        LOG(Warning, "EOS P2P stream dropped segment of {0} bytes message (expected {1} bytes)", header.Length, incoming->Length);
+        return true;
+    }
+    if (incoming->Complete)
+        return false;
+    if (incoming->Message.Buffer)
+    {
+        uint32& mask = incoming->Mask[header.Index / 32];
+        const uint32 bit = 1u << (header.Index % 32);
+        if (mask & bit)
+            return false;
+        mask |= bit;
+        Platform::MemoryCopy(incoming->Message.Buffer + offset, data, size);
+    }
+    if (++incoming->Received != incoming->Count)
+        return false;
+    incoming->Complete = true;
+
+    if (desc.Ordered)
+    {
+        // Deliver all the completed messages in order
+        while (Incoming* next = stream.Messages.TryGet(stream.NextSeq))
+        {
+            if (!next->Complete)
+                break;
+            Deliver(connectionId, *next);
+            stream.Messages.Remove(stream.NextSeq);
+            stream.NextSeq++;
+        }
+    }
+    else
+    {
+        Deliver(connectionId, *incoming);
+        stream.Messages.Remove(header.MessageSeq);
+        stream.Delivered.Add(header.MessageSeq);
+        while (stream.Delivered.Contains(stream.NextSeq))
+        {
+            stream.Delivered.Remove(stream.NextSeq);
+            stream.NextSeq++;
+        }
+    }
+    return false;
+}
+
+void EOSP2PStreams::Deliver(uint32 connectionId, Incoming& incoming)
+{
+    if (!incoming.Message.Buffer)
+        return;
+    NetworkEvent e;
+    e.EventType = NetworkEventType::Message;
+    e.Message = incoming.Message;
+    e.Message.Length = incoming.Length;
+    e.Message.Position = 0;
+    e.Sender.ConnectionId = connectionId;
+    _delivered.Add(e);
+    incoming.Message = NetworkMessage();
+}
+
+void EOSP2PStreams::ReleaseConnection(Connection* connection, Array<NetworkMessage>& released)
+{
+    _pool.Add(connection->InFlight);
+    for (const auto& pending : connection->Pending)
+        _pool.Add(pending);
+    for (const ReceiveStream& stream : connection->Streams)
+    {
+        for (const auto& e : stream.Messages)
+        {
+            if (e.Value.Message.Buffer)
+                released.Add(e.Value.Message);
+        }
+    }
+    Delete(connection);
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "Engine/Core/Collections/Array.h"
+#include "Engine/Core/Collections/Dictionary.h"
+#include "Engine/Core/Collections/HashSet.h"
+#include "Engine/Core/Delegate.h"
+#include "Engine/Networking/NetworkEvent.h"
+#include "Engine/Networking/NetworkMessage.h"
+#include "EOSSDK/Include/eos_p2p_types.h"
+
+class NetworkPeer;
+
+///<summary>
+/// Reliable message streams on top of the unreliable P2P packets. Every connection has multiple independent ordered or unordered streams, so the lost packet stalls only its own stream (no head-of-line blocking between the unrelated traffic).
+/// Packets are acknowledged selectively (the latest received packet and the mask of the 64 packets before it), lost ones are retransmitted after the timeout or right away once the later packets get acknowledged (fast retransmit).
+/// Not thread-safe, the owner serializes the calls.
+///</summary>
+class ONLINEPLATFORMEOS_API EOSP2PStreams
+{
+public:
+    /// <summary>
+    /// Sends the packet to the connection over the unreliable channel.
+    /// </summary>
+    typedef Function<void(uint32 connectionId, const uint8* data, uint32 size)> SendPacketCallback;
+
+    struct StreamDesc
+    {
+        bool Ordered;
+        int32 Priority;
+    };
+
+private:
+    struct SentSegment
+    {
+        uint32 PacketSeq;
+        uint32 Size;
+        double SendTime;
+        int32 Retries;
+        bool FastRetransmit;
+        uint8 Data[EOS_P2P_MAX_PACKET_SIZE];
+    };
+
+    struct Incoming
+    {
+        NetworkMessage Message;
+        uint32 Length = 0;
+        uint16 Count = 0;
+        uint16 Received = 0;
+        bool Complete = false;
+        Array<uint32> Mask;
+    };
+
+    struct ReceiveStream
+    {
+        // Next message to deliver on the ordered stream, the oldest not delivered message on the unordered stream
+        uint32 NextSeq = 0;
+        HashSet<uint32> Delivered;
+        Dictionary<uint32, Incoming> Messages;
+    };
+
+    struct Connection
+    {
+        Array<SentSegment*> InFlight;
+        Array<Array<SentSegment*>> Pending;
+        Array<uint32> SendSeq;
+        Array<ReceiveStream> Streams;
+        uint32 NextPacketSeq = 1;
+        uint32 LargestReceived = 0;
+        uint64 ReceivedMask = 0;
+        bool AckPending = false;
+        float SRTT = 0.0f;
+        float RTTVar = 0.0f;
+    };
+
+    NetworkPeer* _host = nullptr;
+    SendPacketCallback _sendPacket;
+    Array<StreamDesc> _streams;
+    Array<int32> _streamsByPriority;
+    Dictionary<uint32, Connection*> _connections;
+    Array<SentSegment*> _pool;
+    Array<NetworkEvent> _delivered;
+    int32 _deliveredStart = 0;
+
+public:
+    ~EOSP2PStreams();
+
+    /// <summary>
+    /// The maximum amount of the unacknowledged packets per connection.
+    /// </summary>
+    int32 MaxInFlight = 256;
+
+    /// <summary>
+    /// The minimum retransmission timeout (in seconds).
+    /// </summary>
+    float MinRetransmitTimeout = 0.1f;
+
+public:
+    /// <summary>
+    /// Sets up the streams. Both sides of the connection have to use the same streams.
+    /// </summary>
+    void Init(NetworkPeer* host, const Array<StreamDesc>& streams, const SendPacketCallback& sendPacket);
+
+    /// <summary>
+    /// Gets the amount of the streams.
+    /// </summary>
+    FORCE_INLINE int32 GetStreamsCount() const
+    {
+        return _streams.Count();
+    }
+
+    /// <summary>
+    /// Queues the message on the stream. Sent on the next update (streams with higher priority first).
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool Send(uint32 connectionId, int32 stream, const NetworkMessage& message);
+
+    /// <summary>
+    /// Processes the packet received from the connection.
+    /// </summary>
+    void Receive(uint32 connectionId, const uint8* data, uint32 size, double now);
+
+    /// <summary>
+    /// Pops the next message delivered by the streams.
+    /// </summary>
+    bool PopMessage(NetworkEvent& eventPtr);
+
+    /// <summary>
+    /// Sends the acknowledgements, retransmissions and the queued messages.
+    /// </summary>
+    void Update(double now);
+
+    /// <summary>
+    /// Removes the connection state. Messages owned by the connection are added to the list to recycle.
+    /// </summary>
+    void RemoveConnection(uint32 connectionId, Array<NetworkMessage>& released);
+
+    /// <summary>
+    /// Removes all the connections. Messages owned by the connections (and the not popped delivered messages) are added to the list to recycle.
+    /// </summary>
+    void Clear(Array<NetworkMessage>& released);
+
+private:
+    Connection* GetConnection(uint32 connectionId);
+    SentSegment* AllocSegment();
+    void SendSegment(uint32 connectionId, Connection* connection, SentSegment* segment, double now);
+    void ReceiveAck(Connection* connection, const uint8* data, uint32 size, double now);
+    bool ReceiveSegment(uint32 connectionId, Connection* connection, const uint8* data, uint32 size);
+    void Deliver(uint32 connectionId, Incoming& incoming);
+    void ReleaseConnection(Connection* connection, Array<NetworkMessage>& released);
+};
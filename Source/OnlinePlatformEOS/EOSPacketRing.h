@@ -0,0 +1,99 @@
+#pragma once
+
+#include "Engine/Core/Collections/Array.h"
+#include "Engine/Core/Math/Math.h"
+#include "Engine/Platform/Platform.h"
+#include "EOSSDK/Include/eos_p2p_types.h"
+
+///<summary>
+/// Lock-free single-producer single-consumer ring of the P2P packets. Slots are preallocated so the packets are written and read in-place.
+/// Only one thread at a time can produce and only one thread at a time can consume (eg. the consumer side can move between the threads if it's guarded by the lock).
+///</summary>
+class EOSPacketRing
+{
+public:
+    struct Packet
+    {
+        EOS_ProductUserId UserId;
+        uint32 ConnectionId;
+        uint32 Size;
+        uint8 Channel;
+        uint8 Data[EOS_P2P_MAX_PACKET_SIZE];
+    };
+
+private:
+    Array<Packet> _packets;
+    int64 _mask = 0;
+    volatile int64 _write = 0;
+    volatile int64 _read = 0;
+
+public:
+    /// <summary>
+    /// Allocates the ring slots (rounded up to the power of two). Must not be called while the ring is in use.
+    /// </summary>
+    void Init(int32 capacity)
+    {
+        capacity = Math::RoundUpToPowerOf2(Math::Max(capacity, 2));
+        _packets.Resize(capacity, false);
+        _mask = capacity - 1;
+        Platform::AtomicStore(&_write, 0);
+        Platform::AtomicStore(&_read, 0);
+    }
+
+    /// <summary>
+    /// Frees the ring slots. Must not be called while the ring is in use.
+    /// </summary>
+    void Release()
+    {
+        _packets.SetCapacity(0, false);
+        _mask = 0;
+        Platform::AtomicStore(&_write, 0);
+        Platform::AtomicStore(&_read, 0);
+    }
+
+    /// <summary>
+    /// Gets the amount of the packets in the ring.
+    /// </summary>
+    FORCE_INLINE int32 Count() const
+    {
+        return (int32)(Platform::AtomicRead((volatile int64*)&_write) - Platform::AtomicRead((volatile int64*)&_read));
+    }
+
+    /// <summary>
+    /// Gets the slot to write the next packet into (producer side). Returns null if the ring is full.
+    /// </summary>
+    Packet* BeginWrite()
+    {
+        const int64 write = Platform::AtomicRead(&_write);
+        if (_packets.IsEmpty() || write - Platform::AtomicRead(&_read) > _mask)
+            return nullptr;
+        return &_packets[(int32)(write & _mask)];
+    }
+
+    /// <summary>
+    /// Publishes the packet written to the slot from BeginWrite (producer side).
+    /// </summary>
+    void EndWrite()
+    {
+        Platform::AtomicStore(&_write, Platform::AtomicRead(&_write) + 1);
+    }
+
+    /// <summary>
+    /// Gets the oldest packet (consumer side). Returns null if the ring is empty.
+    /// </summary>
+    Packet* Peek()
+    {
+        const int64 read = Platform::AtomicRead(&_read);
+        if (read == Platform::AtomicRead(&_write))
+            return nullptr;
+        return &_packets[(int32)(read & _mask)];
+    }
+
+    /// <summary>
+    /// Releases the oldest packet slot (consumer side).
+    /// </summary>
+    void Pop()
+    {
+        Platform::AtomicStore(&_read, Platform::AtomicRead(&_read) + 1);
+    }
+};
@@ -0,0 +1,305 @@
+#include "EOSPlatformContext.h"
+#include "EOSAccountIdTable.h"
+#include "OnlinePlatformEOS.h"
+
+#include "Engine/Core/Log.h"
+#include "Engine/Core/Math/Math.h"
+#include "Engine/Engine/Engine.h"
+#include "Engine/Engine/Globals.h"
+#include "Engine/Platform/CriticalSection.h"
+#include "Engine/Platform/FileSystem.h"
+#include "Engine/Platform/Thread.h"
+#include "Engine/Threading/Threading.h"
+#include "Engine/Threading/ThreadSpawner.h"
+#include "Engine/Utilities/StringConverter.h"
+#include <EOSSDK/Include/eos_sdk.h>
+
+#include "EOSSDK/Include/eos_logging.h"
+
+namespace
+{
+    CriticalSection SDKLocker;
+    int32 SDKRefCount = 0;
+}
+
+extern "C" void EOS_CALL EOSSDKLogCallback(const EOS_LogMessage* message)
+{
+    switch (message->Level)
+    {
+    case EOS_ELogLevel::EOS_LOG_Fatal:
+        LOG(Fatal, "[EOS] {0}: {1}", String(message->Category), String(message->Message));
+        break;
+    case EOS_ELogLevel::EOS_LOG_Error:
+        LOG(Error, "[EOS] {0}: {1}", String(message->Category), String(message->Message));
+        break;
+    case EOS_ELogLevel::EOS_LOG_Warning:
+        LOG(Warning, "[EOS] {0}: {1}", String(message->Category), String(message->Message));
+        break;
+    case EOS_ELogLevel::EOS_LOG_Info:
+    case EOS_ELogLevel::EOS_LOG_Verbose:
+    case EOS_ELogLevel::EOS_LOG_VeryVerbose:
+        LOG(Info, "[EOS] {0}: {1}", String(message->Category), String(message->Message));
+        break;
+    default: break;
+    }
+}
+
+extern "C" void* EOS_MEMORY_CALL EOSAllocateMemory(size_t sizeInBytes, size_t alignment)
+{
+    return Allocator::Allocate(sizeInBytes, alignment);
+}
+
+void* Realloc(void* ptr, uint64 newSize, uint64 alignment)
+{
+    if (newSize == 0)
+    {
+        Allocator::Free(ptr);
+        return nullptr;
+    }
+    if (!ptr)
+        return Allocator::Allocate(newSize, alignment);
+    return _aligned_realloc(ptr, newSize, alignment);
+}
+
+
+extern "C" void* EOS_MEMORY_CALL EOSReallocateMemory(void* pointer, size_t sizeInBytes, size_t alignment)
+{
+    return Realloc(pointer, sizeInBytes, alignment);
+}
+
+extern "C" void EOS_MEMORY_CALL EOSReleaseMemory(void* pointer)
+{
+    Allocator::Free(pointer);
+}
+
+EOSPlatformContext::~EOSPlatformContext()
+{
+    Release();
+}
+
+bool EOSPlatformContext::InitializeSDK(const EOSSettings& settings)
+{
+    ScopeLock lock(SDKLocker);
+    if (SDKRefCount++ != 0)
+        return false;
+
+    // Initialize EOS
+    EOS_InitializeOptions initOptions = {};
+    initOptions.ApiVersion = EOS_INITIALIZE_API_LATEST;
+    initOptions.Reserved = nullptr;
+    initOptions.ProductName = settings.ProductName.Get();
+    initOptions.ProductVersion = settings.ProductVersion.Get();
+    initOptions.AllocateMemoryFunction = &EOSAllocateMemory;
+    initOptions.ReallocateMemoryFunction = &EOSReallocateMemory;
+    initOptions.ReleaseMemoryFunction = &EOSReleaseMemory;
+    initOptions.SystemInitializeOptions = nullptr;
+    initOptions.OverrideThreadAffinity = nullptr;
+
+    EOS_EResult initResult = EOS_Initialize(&initOptions);
+    if (initResult != EOS_EResult::EOS_Success && initResult != EOS_EResult::EOS_AlreadyConfigured)
+    {
+        LOG(Error, "EOS init failed. Init result: {0}", String(EOS_EResult_ToString(initResult)));
+        SDKRefCount--;
+        return true;
+    }
+
+    // Set Logging callback
+    EOS_Logging_SetCallback(&EOSSDKLogCallback);
+    EOS_Logging_SetLogLevel(EOS_ELogCategory::EOS_LC_ALL_CATEGORIES, static_cast<EOS_ELogLevel>(settings.LogLevel));
+    return false;
+}
+
+void EOSPlatformContext::ShutdownSDK()
+{
+    ScopeLock lock(SDKLocker);
+    if (SDKRefCount == 0 || --SDKRefCount != 0)
+        return;
+    EOS_Shutdown();
+
+    // Handles are no longer valid after the shutdown
+    EOSAccountIdTable::Clear();
+}
+
+bool EOSPlatformContext::Create(const EOSSettings& settings, const EOSPlatformContextOptions& options)
+{
+    if (Platform)
+        return false;
+
+    // TODO: put these options in settings in editor
+    EOS_Platform_Options platformOptions = {};
+    platformOptions.ApiVersion = EOS_PLATFORM_OPTIONS_API_LATEST;
+    platformOptions.Reserved = nullptr;
+    platformOptions.ProductId = settings.ProductID.Get();
+    platformOptions.SandboxId = settings.SandboxID.Get();
+    platformOptions.DeploymentId = settings.DeploymentID.Get();
+    platformOptions.ClientCredentials.ClientId = settings.DefaultClientID.Get();
+    platformOptions.ClientCredentials.ClientSecret = settings.DefaultClientSecret.Get();
+    platformOptions.bIsServer = options.IsServer ? EOS_TRUE : EOS_FALSE;
+    platformOptions.EncryptionKey = settings.EncryptionKey.IsEmpty() ? "0" : settings.EncryptionKey.Get();
+    platformOptions.OverrideCountryCode = nullptr;
+    platformOptions.OverrideLocaleCode = nullptr;
+    platformOptions.Flags = 0;
+    platformOptions.Flags |= EOS_PF_DISABLE_OVERLAY;
+    if (options.IsServer)
+        platformOptions.Flags |= EOS_PF_DISABLE_SOCIAL_OVERLAY;
+
+#if USE_EDITOR
+    platformOptions.Flags |= EOS_PF_LOADING_IN_EDITOR | EOS_PF_DISABLE_OVERLAY;
+#endif
+
+    // Each platform instance needs its own cache folder
+    String cacheFolder = Globals::TemporaryFolder;
+    if (options.CacheName.HasChars())
+    {
+        cacheFolder /= options.CacheName;
+        FileSystem::CreateDirectory(cacheFolder);
+    }
+    const StringAsANSI<> cacheDirectory(cacheFolder.Get(), cacheFolder.Length());
+    platformOptions.CacheDirectory = cacheDirectory.Get();
+    platformOptions.TickBudgetInMilliseconds = 0;
+    platformOptions.RTCOptions = nullptr;
+    platformOptions.IntegratedPlatformOptionsContainerHandle = nullptr;
+
+    Platform = EOS_Platform_Create(&platformOptions);
+    if (!Platform)
+    {
+        LOG(Error, "EOS failed to create platform.");
+        return true;
+    }
+    IsServer = options.IsServer;
+
+    if (!IsServer)
+        EOS_Platform_SetApplicationStatus(Platform, EOS_EApplicationStatus::EOS_AS_Foreground);
+
+    ProductUserIds.Clear();
+    return false;
+}
+
+void EOSPlatformContext::Release()
+{
+    StopServiceThread();
+    _refreshingAuth = false;
+    _authQueue.Clear();
+    ProductUserIds.Clear();
+    AccountId = nullptr;
+    ProductUserId = nullptr;
+    Platform::MemoryClear(&_interfaces, sizeof(_interfaces));
+    IsServer = false;
+    if (Platform)
+    {
+        EOS_Platform_Release(Platform);
+        Platform = nullptr;
+    }
+}
+
+void EOSPlatformContext::Tick()
+{
+    ScopeLock lock(Locker);
+    if (Platform)
+    {
+        Ticking();
+        EOS_Platform_Tick(Platform);
+    }
+}
+
+void EOSPlatformContext::RunAuthenticated(const Function<void()>& action)
+{
+    {
+        ScopeLock lock(Locker);
+        if (_refreshingAuth)
+        {
+            _authQueue.Add(action);
+            return;
+        }
+    }
+    action();
+}
+
+void EOSPlatformContext::BeginAuthRefresh()
+{
+    ScopeLock lock(Locker);
+    _refreshingAuth = true;
+}
+
+void EOSPlatformContext::EndAuthRefresh(bool success)
+{
+    Array<Function<void()>> queue;
+    {
+        ScopeLock lock(Locker);
+        _refreshingAuth = false;
+        queue.Swap(_authQueue);
+    }
+    if (!success)
+        return;
+    for (const auto& action : queue)
+        action();
+}
+
+bool EOSPlatformContext::StartServiceThread(float tickRate)
+{
+    if (_serviceThread)
+        return false;
+    _serviceTickRate = Math::Max(tickRate, 1.0f);
+    Platform::AtomicStore(&_serviceThreadExit, 0);
+    _serviceThread = ThreadSpawner::Start(Function<int32()>(this, &EOSPlatformContext::ServiceThreadRun), TEXT("EOS Service"), ThreadPriority::BelowNormal);
+    if (!_serviceThread)
+    {
+        LOG(Error, "EOS failed to start the service thread.");
+        return true;
+    }
+    return false;
+}
+
+void EOSPlatformContext::StopServiceThread()
+{
+    if (!_serviceThread)
+        return;
+    Platform::AtomicStore(&_serviceThreadExit, 1);
+    _serviceThread->Join();
+    Delete(_serviceThread);
+    _serviceThread = nullptr;
+}
+
+int32 EOSPlatformContext::ServiceThreadRun()
+{
+    const double tickInterval = 1.0 / _serviceTickRate;
+    while (Platform::AtomicRead(&_serviceThreadExit) == 0)
+    {
+        const double tickStart = Platform::GetTimeSeconds();
+        Tick();
+        const double remaining = tickInterval - (Platform::GetTimeSeconds() - tickStart);
+        if (remaining > 0.0)
+            Platform::Sleep((int32)(remaining * 1000.0));
+    }
+    return 0;
+}
+
+// Dedicated server uses client credentials only and gets just the server-side services
+#define IMPLEMENT_LAZY_INTERFACE(type, name, condition) \
+    type EOSPlatformContext::Get##name() \
+    { \
+        ScopeLock lock(Locker); \
+        if (!_interfaces.name && Platform && (condition)) \
+            _interfaces.name = EOS_Platform_Get##name##Interface(Platform); \
+        return _interfaces.name; \
+    }
+
+IMPLEMENT_LAZY_INTERFACE(EOS_HConnect, Connect, true);
+IMPLEMENT_LAZY_INTERFACE(EOS_HStats, Stats, true);
+IMPLEMENT_LAZY_INTERFACE(EOS_HSessions, Sessions, true);
+IMPLEMENT_LAZY_INTERFACE(EOS_HMetrics, Metrics, true);
+IMPLEMENT_LAZY_INTERFACE(EOS_HTitleStorage, TitleStorage, true);
+IMPLEMENT_LAZY_INTERFACE(EOS_HSanctions, Sanctions, true);
+IMPLEMENT_LAZY_INTERFACE(EOS_HAntiCheatServer, AntiCheatServer, IsServer);
+IMPLEMENT_LAZY_INTERFACE(EOS_HAuth, Auth, !IsServer);
+IMPLEMENT_LAZY_INTERFACE(EOS_HUserInfo, UserInfo, !IsServer);
+IMPLEMENT_LAZY_INTERFACE(EOS_HAchievements, Achievements, !IsServer);
+IMPLEMENT_LAZY_INTERFACE(EOS_HFriends, Friends, !IsServer);
+IMPLEMENT_LAZY_INTERFACE(EOS_HLeaderboards, Leaderboards, !IsServer);
+IMPLEMENT_LAZY_INTERFACE(EOS_HPlayerDataStorage, PlayerDataStorage, !IsServer);
+IMPLEMENT_LAZY_INTERFACE(EOS_HPresence, Presence, !IsServer);
+IMPLEMENT_LAZY_INTERFACE(EOS_HEcom, Ecom, !IsServer);
+IMPLEMENT_LAZY_INTERFACE(EOS_HP2P, P2P, !IsServer);
+IMPLEMENT_LAZY_INTERFACE(EOS_HLobby, Lobby, !IsServer);
+
+#undef IMPLEMENT_LAZY_INTERFACE
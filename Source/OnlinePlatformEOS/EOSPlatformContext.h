@@ -0,0 +1,191 @@
+#pragma once
+
+#include "Engine/Core/Collections/Array.h"
+#include "Engine/Core/Delegate.h"
+#include "Engine/Core/Types/String.h"
+#include "Engine/Platform/CriticalSection.h"
+#include "Engine/Online/IOnlinePlatform.h"
+#include "EOSSDK/Include/eos_achievements_types.h"
+#include "EOSSDK/Include/eos_anticheatserver_types.h"
+#include "EOSSDK/Include/eos_auth_types.h"
+#include "EOSSDK/Include/eos_connect_types.h"
+#include "EOSSDK/Include/eos_ecom_types.h"
+#include "EOSSDK/Include/eos_friends_types.h"
+#include "EOSSDK/Include/eos_leaderboards_types.h"
+#include "EOSSDK/Include/eos_lobby_types.h"
+#include "EOSSDK/Include/eos_metrics_types.h"
+#include "EOSSDK/Include/eos_p2p_types.h"
+#include "EOSSDK/Include/eos_playerdatastorage_types.h"
+#include "EOSSDK/Include/eos_presence_types.h"
+#include "EOSSDK/Include/eos_sanctions_types.h"
+#include "EOSSDK/Include/eos_sessions_types.h"
+#include "EOSSDK/Include/eos_stats_types.h"
+#include "EOSSDK/Include/eos_titlestorage_types.h"
+#include "EOSSDK/Include/eos_types.h"
+#include "EOSSDK/Include/eos_userinfo_types.h"
+
+class EOSSettings;
+class Thread;
+
+///<summary>
+/// The options used to create a single EOS platform instance.
+///</summary>
+struct EOSPlatformContextOptions
+{
+    /// <summary>
+    /// True if the platform is created as a dedicated server. Server platforms provide only the server-side interfaces (Connect, Sessions, Anti-Cheat Server, Metrics, Stats and Title Storage).
+    /// </summary>
+    bool IsServer = false;
+
+    /// <summary>
+    /// Name of the cache sub-folder (inside the temporary folder) used by this instance. Must be unique for every instance living in the same process. Empty to use the temporary folder directly.
+    /// </summary>
+    String CacheName;
+};
+
+///<summary>
+/// A single EOS platform instance with its service interfaces and the state of the local user logged in on it.
+/// Multiple contexts can coexist in the same process (eg. to simulate many clients during load testing).
+///</summary>
+class ONLINEPLATFORMEOS_API EOSPlatformContext
+{
+public:
+    EOS_HPlatform Platform = nullptr;
+    bool IsServer = false;
+
+    /// <summary>
+    /// Serializes the access to the SDK when the platform is ticked on the service thread. Hold it when calling into the SDK from other threads.
+    /// </summary>
+    CriticalSection Locker;
+
+    /// <summary>
+    /// Event called on every platform tick (right before the SDK tick) from the thread that ticks the platform, with Locker held. Used by the services to flush the batched requests.
+    /// </summary>
+    Action Ticking;
+
+    EOS_EpicAccountId AccountId = nullptr;
+    EOS_ProductUserId ProductUserId = nullptr;
+    Array<EOS_ProductUserId, HeapAllocation> ProductUserIds;
+
+public:
+    ~EOSPlatformContext();
+
+    /// <summary>
+    /// Initializes the EOS SDK for the process. Reference counted, every successful call has to be paired with ShutdownSDK.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    static bool InitializeSDK(const EOSSettings& settings);
+
+    /// <summary>
+    /// Releases the reference to the EOS SDK. The SDK is shut down when the last reference gets released.
+    /// </summary>
+    static void ShutdownSDK();
+
+    /// <summary>
+    /// Creates the EOS platform. Requires the SDK to be initialized. Can be called from any thread as long as the context is not used elsewhere until it returns.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool Create(const EOSSettings& settings, const EOSPlatformContextOptions& options);
+
+    /// <summary>
+    /// Releases the EOS platform and clears the user state.
+    /// </summary>
+    void Release();
+
+    /// <summary>
+    /// Ticks the EOS platform (dispatches the pending callbacks).
+    /// </summary>
+    void Tick();
+
+    /// <summary>
+    /// Starts ticking the platform on a dedicated service thread at the fixed rate (instead of the game thread). EOS callbacks are then invoked from the service thread with Locker held.
+    /// </summary>
+    /// <param name="tickRate">The amount of ticks per second.</param>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool StartServiceThread(float tickRate);
+
+    /// <summary>
+    /// Stops the service thread (if running).
+    /// </summary>
+    void StopServiceThread();
+
+    FORCE_INLINE bool HasServiceThread() const
+    {
+        return _serviceThread != nullptr;
+    }
+
+    /// <summary>
+    /// Runs the action that requires a valid user login (eg. uses ProductUserId). While the login token is being refreshed the action is queued and runs once the refresh completes.
+    /// </summary>
+    void RunAuthenticated(const Function<void()>& action);
+
+    /// <summary>
+    /// Marks the start of the login token refresh. Actions passed to RunAuthenticated get queued until EndAuthRefresh.
+    /// </summary>
+    void BeginAuthRefresh();
+
+    /// <summary>
+    /// Marks the end of the login token refresh and runs the queued actions.
+    /// </summary>
+    /// <param name="success">True if the refresh succeeded, otherwise the queued actions are dropped.</param>
+    void EndAuthRefresh(bool success = true);
+
+    FORCE_INLINE bool IsRefreshingAuth() const
+    {
+        return _refreshingAuth;
+    }
+
+    FORCE_INLINE bool IsCreated() const
+    {
+        return Platform != nullptr;
+    }
+
+public:
+    // Service interfaces are acquired lazily on the first use. Client-only interfaces are null with the server profile (and the Anti-Cheat Server interface with the client profile).
+    EOS_HConnect GetConnect();
+    EOS_HStats GetStats();
+    EOS_HSessions GetSessions();
+    EOS_HMetrics GetMetrics();
+    EOS_HTitleStorage GetTitleStorage();
+    EOS_HSanctions GetSanctions();
+    EOS_HAntiCheatServer GetAntiCheatServer();
+    EOS_HAuth GetAuth();
+    EOS_HUserInfo GetUserInfo();
+    EOS_HAchievements GetAchievements();
+    EOS_HFriends GetFriends();
+    EOS_HLeaderboards GetLeaderboards();
+    EOS_HPlayerDataStorage GetPlayerDataStorage();
+    EOS_HPresence GetPresence();
+    EOS_HEcom GetEcom();
+    EOS_HP2P GetP2P();
+    EOS_HLobby GetLobby();
+
+private:
+    struct
+    {
+        EOS_HConnect Connect;
+        EOS_HStats Stats;
+        EOS_HSessions Sessions;
+        EOS_HMetrics Metrics;
+        EOS_HTitleStorage TitleStorage;
+        EOS_HSanctions Sanctions;
+        EOS_HAntiCheatServer AntiCheatServer;
+        EOS_HAuth Auth;
+        EOS_HUserInfo UserInfo;
+        EOS_HAchievements Achievements;
+        EOS_HFriends Friends;
+        EOS_HLeaderboards Leaderboards;
+        EOS_HPlayerDataStorage PlayerDataStorage;
+        EOS_HPresence Presence;
+        EOS_HEcom Ecom;
+        EOS_HP2P P2P;
+        EOS_HLobby Lobby;
+    } _interfaces = {};
+    bool _refreshingAuth = false;
+    Array<Function<void()>> _authQueue;
+    Thread* _serviceThread = nullptr;
+    volatile int64 _serviceThreadExit = 0;
+    float _serviceTickRate = 10.0f;
+
+    int32 ServiceThreadRun();
+};
@@ -0,0 +1,613 @@
+#include "EOSServerBrowser.h"
+#include "EOSPlatformContext.h"
+
+#include "Engine/Core/Log.h"
+#include "Engine/Core/Collections/Sorting.h"
+#include "Engine/Core/Math/Math.h"
+#include "Engine/Threading/Threading.h"
+#include <EOSSDK/Include/eos_sdk.h>
+
+#include "EOSSDK/Include/eos_sessions.h"
+
+struct EOSServerBrowser::PendingSearch
+{
+    EOS_HSessionSearch Handle = nullptr;
+    bool Canceled = false;
+    bool Found = false;
+    EOSServerBrowser* Owner;
+    uint32 Count = 0;
+    uint32 Next = 0;
+};
+
+namespace
+{
+    struct SortKey
+    {
+        double Key;
+        int32 Row;
+
+        bool operator<(const SortKey& other) const
+        {
+            return Key < other.Key || (Key == other.Key && Row < other.Row);
+        }
+    };
+
+    struct StringKey
+    {
+        const StringAnsi* Value;
+        int32 Id;
+
+        bool operator<(const StringKey& other) const
+        {
+            return Value->Compare(*other.Value, StringSearchCase::IgnoreCase) < 0;
+        }
+    };
+
+    template<typename Predicate>
+    void Compact(Array<int32>& rows, Predicate predicate)
+    {
+        int32 count = 0;
+        for (int32 i = 0; i < rows.Count(); i++)
+        {
+            const int32 row = rows[i];
+            if (predicate(row))
+                rows[count++] = row;
+        }
+        rows.Resize(count);
+    }
+
+    // Removes the rows (ascending) from the column and moves the rest up
+    template<typename T>
+    void RemoveColumnRows(Array<T>& column, const Array<int32>& rows)
+    {
+        int32 count = rows[0], next = 0;
+        for (int32 row = rows[0]; row < column.Count(); row++)
+        {
+            if (next < rows.Count() && rows[next] == row)
+            {
+                next++;
+                continue;
+            }
+            column[count++] = MoveTemp(column[row]);
+        }
+        column.Resize(count);
+    }
+
+    bool CopyAttribute(EOS_HSessionDetails details, const StringAnsi& key, EOSSessionAttribute& result)
+    {
+        EOS_SessionDetails_CopySessionAttributeByKeyOptions options = {};
+        options.ApiVersion = EOS_SESSIONDETAILS_COPYSESSIONATTRIBUTEBYKEY_API_LATEST;
+        options.AttrKey = key.Get();
+        EOS_SessionDetails_Attribute* attribute;
+        if (key.IsEmpty() || EOS_SessionDetails_CopySessionAttributeByKey(details, &options, &attribute) != EOS_EResult::EOS_Success)
+            return false;
+        const bool valid = attribute->Data != nullptr;
+        if (valid)
+            result = EOSSessionAttribute::FromData(*attribute->Data, attribute->AdvertisementType);
+        EOS_SessionDetails_Attribute_Release(attribute);
+        return valid;
+    }
+}
+
+EOSServerBrowser::EOSServerBrowser(EOSPlatformContext* context)
+    : _context(context)
+{
+    _context->Ticking.Bind<EOSServerBrowser, &EOSServerBrowser::Flush>(this);
+}
+
+EOSServerBrowser::~EOSServerBrowser()
+{
+    _context->Ticking.Unbind<EOSServerBrowser, &EOSServerBrowser::Flush>(this);
+    Clear();
+}
+
+int32 EOSServerBrowser::AddColumn(const StringAnsiView& key, bool isString)
+{
+    ScopeLock lock(_context->Locker);
+    for (int32 i = 0; i < _customColumns.Count(); i++)
+    {
+        if (_customColumns[i].Key == key)
+            return (int32)EOSServerColumn::Custom + i;
+    }
+    auto& column = _customColumns.AddOne();
+    column.Key = key;
+    column.IsString = isString;
+    auto& values = _table.Custom.AddOne();
+    values.Resize(_table.Count());
+    for (double& value : values)
+        value = isString ? -1.0 : 0.0;
+    return (int32)EOSServerColumn::Custom + _customColumns.Count() - 1;
+}
+
+bool EOSServerBrowser::Search(const Array<EOSServerSearch>& searches)
+{
+    ScopeLock lock(_context->Locker);
+    Clear();
+    _searches = searches;
+    return StartSearches();
+}
+
+bool EOSServerBrowser::Refresh()
+{
+    ScopeLock lock(_context->Locker);
+    if (_searches.IsEmpty())
+        return true;
+    CancelSearches();
+    return StartSearches();
+}
+
+void EOSServerBrowser::Cancel()
+{
+    ScopeLock lock(_context->Locker);
+    CancelSearches();
+}
+
+void EOSServerBrowser::Clear()
+{
+    ScopeLock lock(_context->Locker);
+    CancelSearches();
+    for (const EOS_HSessionDetails details : _table.Details)
+        EOS_SessionDetails_Release(details);
+    _table.SessionId.Clear();
+    _table.HostAddress.Clear();
+    _table.Details.Clear();
+    _table.Ping.Clear();
+    _table.Players.Clear();
+    _table.MaxPlayers.Clear();
+    _table.Map.Clear();
+    _table.Mode.Clear();
+    for (auto& values : _table.Custom)
+        values.Clear();
+    _table.Generation.Clear();
+    _rows.Clear();
+}
+
+StringAnsi EOSServerBrowser::GetString(int32 id) const
+{
+    ScopeLock lock(_context->Locker);
+    return id >= 0 && id < _strings.Count() ? _strings[id] : StringAnsi::Empty;
+}
+
+int32 EOSServerBrowser::FindString(const StringAnsiView& value) const
+{
+    ScopeLock lock(_context->Locker);
+    int32 id;
+    return _stringIds.TryGet(StringAnsi(value), id) ? id : -1;
+}
+
+int32 EOSServerBrowser::FindRow(const StringAnsiView& sessionId) const
+{
+    ScopeLock lock(_context->Locker);
+    int32 row;
+    return _rows.TryGet(StringAnsi(sessionId), row) ? row : -1;
+}
+
+void EOSServerBrowser::SetPing(int32 row, int32 ping)
+{
+    ScopeLock lock(_context->Locker);
+    if (row >= 0 && row < _table.Count())
+        _table.Ping[row] = ping;
+}
+
+void EOSServerBrowser::Filter(const EOSServerFilter& filter, Array<int32>& result)
+{
+    ScopeLock lock(_context->Locker);
+    const int32 count = _table.Count();
+    result.Resize(count);
+    for (int32 row = 0; row < count; row++)
+        result[row] = row;
+
+    // Every predicate is a single pass over its column
+    if (filter.MaxPing > 0)
+    {
+        const int32* ping = _table.Ping.Get();
+        const int32 maxPing = filter.MaxPing;
+        Compact(result, [ping, maxPing](int32 row) { return ping[row] < 0 || ping[row] <= maxPing; });
+    }
+    if (filter.HideFull)
+    {
+        const int32* players = _table.Players.Get();
+        const int32* maxPlayers = _table.MaxPlayers.Get();
+        Compact(result, [players, maxPlayers](int32 row) { return players[row] < maxPlayers[row]; });
+    }
+    if (filter.HideEmpty)
+    {
+        const int32* players = _table.Players.Get();
+        Compact(result, [players](int32 row) { return players[row] > 0; });
+    }
+    if (filter.Map >= 0)
+    {
+        const int32* map = _table.Map.Get();
+        const int32 value = filter.Map;
+        Compact(result, [map, value](int32 row) { return map[row] == value; });
+    }
+    if (filter.Mode >= 0)
+    {
+        const int32* mode = _table.Mode.Get();
+        const int32 value = filter.Mode;
+        Compact(result, [mode, value](int32 row) { return mode[row] == value; });
+    }
+    for (const auto& range : filter.Ranges)
+    {
+        const int32 custom = range.Column - (int32)EOSServerColumn::Custom;
+        const double min = range.Min, max = range.Max;
+        if (custom >= 0 && custom < _table.Custom.Count())
+        {
+            const double* values = _table.Custom[custom].Get();
+            Compact(result, [values, min, max](int32 row) { return values[row] >= min && values[row] <= max; });
+        }
+        else
+        {
+            Compact(result, [this, &range, min, max](int32 row)
+            {
+                const double value = GetValue(row, range.Column);
+                return value >= min && value <= max;
+            });
+        }
+    }
+}
+
+void EOSServerBrowser::Sort(Array<int32>& rows, int32 column, bool descending)
+{
+    ScopeLock lock(_context->Locker);
+    const bool isString = column == (int32)EOSServerColumn::Map || column == (int32)EOSServerColumn::Mode ||
+            (column >= (int32)EOSServerColumn::Custom && column - (int32)EOSServerColumn::Custom < _customColumns.Count() && _customColumns[column - (int32)EOSServerColumn::Custom].IsString);
+    if (isString)
+        UpdateStringRanks();
+
+    // Sort the compact keys instead of the rows so the comparisons don't jump around the table
+    Array<SortKey> keys;
+    keys.Resize(rows.Count());
+    const double sign = descending ? -1.0 : 1.0;
+    for (int32 i = 0; i < rows.Count(); i++)
+    {
+        const int32 row = rows[i];
+        double value = GetValue(row, column);
+        if (isString)
+            value = value >= 0.0 ? (double)_stringRanks[(int32)value] : MAX_double;
+        else if (column == (int32)EOSServerColumn::Ping && value < 0.0)
+            value = MAX_double;
+        keys[i].Key = value == MAX_double ? MAX_double : value * sign;
+        keys[i].Row = row;
+    }
+    Sorting::QuickSort(keys.Get(), keys.Count());
+    for (int32 i = 0; i < rows.Count(); i++)
+        rows[i] = keys[i].Row;
+}
+
+void EOSServerBrowser::Flush()
+{
+    ScopeLock lock(_context->Locker);
+    if (_pending.IsEmpty())
+        return;
+    const int32 firstRow = _table.Count();
+    _changedRows.Clear();
+
+    // Ingest a page of the results so the large result sets are spread over multiple ticks
+    int32 budget = Math::Max(PageSize, 1);
+    for (int32 i = 0; i < _pending.Count() && budget > 0; i++)
+    {
+        PendingSearch* search = _pending[i];
+        if (!search->Found)
+            continue;
+        while (search->Next < search->Count && budget > 0)
+        {
+            EOS_SessionSearch_CopySearchResultByIndexOptions options = {};
+            options.ApiVersion = EOS_SESSIONSEARCH_COPYSEARCHRESULTBYINDEX_API_LATEST;
+            options.SessionIndex = search->Next++;
+            EOS_HSessionDetails details;
+            if (EOS_SessionSearch_CopySearchResultByIndex(search->Handle, &options, &details) == EOS_EResult::EOS_Success)
+                IngestResult(details);
+            budget--;
+        }
+    }
+    for (int32 i = _pending.Count() - 1; i >= 0; i--)
+    {
+        PendingSearch* search = _pending[i];
+        if (search->Found && search->Next >= search->Count)
+        {
+            EOS_SessionSearch_Release(search->Handle);
+            Delete(search);
+            _pending.RemoveAtKeepOrder(i);
+        }
+    }
+
+    if (_table.Count() > firstRow)
+        RowsAdded(firstRow, _table.Count() - firstRow);
+    if (_changedRows.HasItems())
+        RowsChanged(ToSpan(_changedRows));
+    if (_pending.IsEmpty())
+        Complete();
+}
+
+bool EOSServerBrowser::StartSearches()
+{
+    const auto sessions = _context->GetSessions();
+    if (!sessions)
+        return true;
+    _generation++;
+    _failed = false;
+    for (const EOSServerSearch& query : _searches)
+    {
+        EOS_Sessions_CreateSessionSearchOptions createOptions = {};
+        createOptions.ApiVersion = EOS_SESSIONS_CREATESESSIONSEARCH_API_LATEST;
+        createOptions.MaxSearchResults = (uint32)Math::Clamp(MaxResults, 1, EOS_SESSIONS_MAX_SEARCH_RESULTS);
+        EOS_HSessionSearch handle;
+        if (EOS_Sessions_CreateSessionSearch(sessions, &createOptions, &handle) != EOS_EResult::EOS_Success)
+        {
+            LOG(Warning, "EOS failed to create session search.");
+            _failed = true;
+            continue;
+        }
+
+        bool failed = false;
+        EOS_SessionSearch_SetParameterOptions parameterOptions = {};
+        parameterOptions.ApiVersion = EOS_SESSIONSEARCH_SETPARAMETER_API_LATEST;
+        EOS_Sessions_AttributeData data = {};
+        if (query.BucketId.HasChars())
+        {
+            data.ApiVersion = EOS_SESSIONS_ATTRIBUTEDATA_API_LATEST;
+            data.Key = EOS_SESSIONS_SEARCH_BUCKET_ID;
+            data.ValueType = EOS_EAttributeType::EOS_AT_STRING;
+            data.Value.AsUtf8 = query.BucketId.Get();
+            parameterOptions.Parameter = &data;
+            parameterOptions.ComparisonOp = EOS_EComparisonOp::EOS_CO_EQUAL;
+            failed |= EOS_SessionSearch_SetParameter(handle, &parameterOptions) != EOS_EResult::EOS_Success;
+        }
+        for (const EOSServerSearchParameter& parameter : query.Parameters)
+        {
+            parameter.Value.ToData(parameter.Key.Get(), data);
+            parameterOptions.Parameter = &data;
+            parameterOptions.ComparisonOp = parameter.Comparison;
+            failed |= EOS_SessionSearch_SetParameter(handle, &parameterOptions) != EOS_EResult::EOS_Success;
+        }
+        if (failed)
+        {
+            LOG(Warning, "EOS failed to set the session search parameters (bucket: {0}).", String(query.BucketId));
+            EOS_SessionSearch_Release(handle);
+            _failed = true;
+            continue;
+        }
+
+        auto search = New<PendingSearch>();
+        search->Owner = this;
+        search->Handle = handle;
+        _pending.Add(search);
+        EOS_SessionSearch_FindOptions findOptions = {};
+        findOptions.ApiVersion = EOS_SESSIONSEARCH_FIND_API_LATEST;
+        findOptions.LocalUserId = _context->ProductUserId;
+        EOS_SessionSearch_Find(handle, &findOptions, search, &EOSServerBrowser::OnFindComplete);
+    }
+    return _pending.IsEmpty();
+}
+
+void EOSServerBrowser::CancelSearches()
+{
+    for (PendingSearch* search : _pending)
+    {
+        if (search->Found)
+        {
+            EOS_SessionSearch_Release(search->Handle);
+            Delete(search);
+        }
+        else
+        {
+            // Released when the find completes
+            search->Canceled = true;
+        }
+    }
+    _pending.Clear();
+}
+
+int32 EOSServerBrowser::Intern(const char* value)
+{
+    const StringAnsi key(value);
+    int32 id;
+    if (_stringIds.TryGet(key, id))
+        return id;
+    id = _strings.Count();
+    _strings.Add(key);
+    _stringIds.Add(key, id);
+    return id;
+}
+
+void EOSServerBrowser::IngestResult(EOS_HSessionDetails details)
+{
+    EOS_SessionDetails_CopyInfoOptions infoOptions = {};
+    infoOptions.ApiVersion = EOS_SESSIONDETAILS_COPYINFO_API_LATEST;
+    EOS_SessionDetails_Info* info;
+    if (EOS_SessionDetails_CopyInfo(details, &infoOptions, &info) != EOS_EResult::EOS_Success || !info->SessionId)
+    {
+        EOS_SessionDetails_Release(details);
+        return;
+    }
+    const StringAnsi sessionId(info->SessionId);
+    int32 row;
+    bool added = false;
+    if (!_rows.TryGet(sessionId, row))
+    {
+        row = _table.Count();
+        _table.SessionId.Add(sessionId);
+        _table.HostAddress.AddOne();
+        _table.Details.Add(nullptr);
+        _table.Ping.Add(-1);
+        _table.Players.Add(0);
+        _table.MaxPlayers.Add(0);
+        _table.Map.Add(-1);
+        _table.Mode.Add(-1);
+        for (int32 i = 0; i < _table.Custom.Count(); i++)
+            _table.Custom[i].Add(_customColumns[i].IsString ? -1.0 : 0.0);
+        _table.Generation.Add(0);
+        _rows.Add(sessionId, row);
+        added = true;
+    }
+    else if (_table.Generation[row] == _generation)
+    {
+        // Already found by another search
+        EOS_SessionDetails_Info_Release(info);
+        EOS_SessionDetails_Release(details);
+        return;
+    }
+
+    bool changed = false;
+    const int32 maxPlayers = info->Settings ? (int32)info->Settings->NumPublicConnections : 0;
+    const int32 players = Math::Max(maxPlayers - (int32)info->NumOpenPublicConnections, 0);
+    if (_table.Players[row] != players || _table.MaxPlayers[row] != maxPlayers)
+    {
+        _table.Players[row] = players;
+        _table.MaxPlayers[row] = maxPlayers;
+        changed = true;
+    }
+    if (info->HostAddress && _table.HostAddress[row] != info->HostAddress)
+    {
+        _table.HostAddress[row] = info->HostAddress;
+        changed = true;
+    }
+    EOS_SessionDetails_Info_Release(info);
+
+    EOSSessionAttribute attribute;
+    int32 map = -1, mode = -1;
+    if (CopyAttribute(details, MapAttribute, attribute) && attribute.Type == EOS_EAttributeType::EOS_AT_STRING)
+        map = Intern(attribute.AsString.GetText());
+    if (CopyAttribute(details, ModeAttribute, attribute) && attribute.Type == EOS_EAttributeType::EOS_AT_STRING)
+        mode = Intern(attribute.AsString.GetText());
+    if (_table.Map[row] != map || _table.Mode[row] != mode)
+    {
+        _table.Map[row] = map;
+        _table.Mode[row] = mode;
+        changed = true;
+    }
+    for (int32 i = 0; i < _customColumns.Count(); i++)
+    {
+        const CustomColumn& column = _customColumns[i];
+        double value = column.IsString ? -1.0 : 0.0;
+        if (CopyAttribute(details, column.Key, attribute))
+        {
+            if (column.IsString)
+                value = attribute.Type == EOS_EAttributeType::EOS_AT_STRING ? (double)Intern(attribute.AsString.GetText()) : -1.0;
+            else
+                value = attribute.GetNumber();
+        }
+        double& current = _table.Custom[i][row];
+        if (current != value)
+        {
+            current = value;
+            changed = true;
+        }
+    }
+
+    // Keep the latest handle for joining
+    if (_table.Details[row])
+        EOS_SessionDetails_Release(_table.Details[row]);
+    _table.Details[row] = details;
+    _table.Generation[row] = _generation;
+    if (changed && !added)
+        _changedRows.Add(row);
+}
+
+void EOSServerBrowser::RemoveRows(const Array<int32>& rows)
+{
+    for (const int32 row : rows)
+    {
+        EOS_SessionDetails_Release(_table.Details[row]);
+        _rows.Remove(_table.SessionId[row]);
+    }
+
+    // Compact the columns in a single pass, the rows keep their order
+    RemoveColumnRows(_table.SessionId, rows);
+    RemoveColumnRows(_table.HostAddress, rows);
+    RemoveColumnRows(_table.Details, rows);
+    RemoveColumnRows(_table.Ping, rows);
+    RemoveColumnRows(_table.Players, rows);
+    RemoveColumnRows(_table.MaxPlayers, rows);
+    RemoveColumnRows(_table.Map, rows);
+    RemoveColumnRows(_table.Mode, rows);
+    for (auto& values : _table.Custom)
+        RemoveColumnRows(values, rows);
+    RemoveColumnRows(_table.Generation, rows);
+    for (int32 row = rows[0]; row < _table.Count(); row++)
+        _rows[_table.SessionId[row]] = row;
+}
+
+void EOSServerBrowser::UpdateStringRanks()
+{
+    if (_stringRanks.Count() == _strings.Count())
+        return;
+    Array<StringKey> keys;
+    keys.Resize(_strings.Count());
+    for (int32 i = 0; i < _strings.Count(); i++)
+    {
+        keys[i].Value = &_strings[i];
+        keys[i].Id = i;
+    }
+    Sorting::QuickSort(keys.Get(), keys.Count());
+    _stringRanks.Resize(_strings.Count());
+    for (int32 i = 0; i < keys.Count(); i++)
+        _stringRanks[keys[i].Id] = i;
+}
+
+double EOSServerBrowser::GetValue(int32 row, int32 column) const
+{
+    switch ((EOSServerColumn)column)
+    {
+    case EOSServerColumn::Ping:
+        return (double)_table.Ping[row];
+    case EOSServerColumn::Players:
+        return (double)_table.Players[row];
+    case EOSServerColumn::MaxPlayers:
+        return (double)_table.MaxPlayers[row];
+    case EOSServerColumn::OpenSlots:
+        return (double)(_table.MaxPlayers[row] - _table.Players[row]);
+    case EOSServerColumn::Map:
+        return (double)_table.Map[row];
+    case EOSServerColumn::Mode:
+        return (double)_table.Mode[row];
+    default:
+        break;
+    }
+    const int32 custom = column - (int32)EOSServerColumn::Custom;
+    return custom >= 0 && custom < _table.Custom.Count() ? _table.Custom[custom][row] : 0.0;
+}
+
+void EOSServerBrowser::Complete()
+{
+    // Rows not found by any of the searches are gone (unless some search failed, then they may still exist)
+    if (!_failed)
+    {
+        _removedRows.Clear();
+        for (int32 row = 0; row < _table.Count(); row++)
+        {
+            if (_table.Generation[row] != _generation)
+                _removedRows.Add(row);
+        }
+        if (_removedRows.HasItems())
+        {
+            RemoveRows(_removedRows);
+            RowsRemoved(ToSpan(_removedRows));
+        }
+    }
+    SearchCompleted();
+}
+
+void EOSServerBrowser::OnFindComplete(const EOS_SessionSearch_FindCallbackInfo* data)
+{
+    const auto search = (PendingSearch*)data->ClientData;
+    if (search->Canceled)
+    {
+        EOS_SessionSearch_Release(search->Handle);
+        Delete(search);
+        return;
+    }
+    search->Found = true;
+    if (data->ResultCode == EOS_EResult::EOS_Success)
+    {
+        EOS_SessionSearch_GetSearchResultCountOptions options = {};
+        options.ApiVersion = EOS_SESSIONSEARCH_GETSEARCHRESULTCOUNT_API_LATEST;
+        search->Count = EOS_SessionSearch_GetSearchResultCount(search->Handle, &options);
+    }
+    else if (data->ResultCode != EOS_EResult::EOS_NotFound)
+    {
+        LOG(Warning, "EOS failed to find sessions: {0}", String(EOS_EResult_ToString(data->ResultCode)));
+        search->Owner->_failed = true;
+    }
+}
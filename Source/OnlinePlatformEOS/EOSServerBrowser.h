@@ -0,0 +1,260 @@
+#pragma once
+
+#include "Engine/Core/Collections/Array.h"
+#include "Engine/Core/Collections/Dictionary.h"
+#include "Engine/Core/Delegate.h"
+#include "Engine/Core/Types/Span.h"
+#include "Engine/Core/Types/String.h"
+#include "EOSSessions.h"
+
+class EOSPlatformContext;
+
+///<summary>
+/// The columns of the server browser table. Custom attribute columns follow the built-in ones (Custom + index of the column).
+///</summary>
+enum class EOSServerColumn
+{
+    Ping = 0,
+    Players,
+    MaxPlayers,
+    OpenSlots,
+    Map,
+    Mode,
+    Custom,
+};
+
+///<summary>
+/// The parameter of the server search (compared with the session attribute on the backend).
+///</summary>
+struct EOSServerSearchParameter
+{
+    StringAnsi Key;
+    EOSSessionAttribute Value;
+    EOS_EOnlineComparisonOp Comparison = EOS_EComparisonOp::EOS_CO_EQUAL;
+};
+
+///<summary>
+/// The single server search (one EOS session search). Browsers run multiple searches in parallel (eg. one per bucket) and merge the results.
+///</summary>
+struct EOSServerSearch
+{
+    /// <summary>
+    /// The bucket to search (empty to search all the buckets).
+    /// </summary>
+    StringAnsi BucketId;
+
+    Array<EOSServerSearchParameter> Parameters;
+};
+
+///<summary>
+/// The client-side filter of the server browser table.
+///</summary>
+struct EOSServerFilter
+{
+    struct Range
+    {
+        int32 Column;
+        double Min;
+        double Max;
+    };
+
+    /// <summary>
+    /// The maximum ping (in milliseconds). Servers without the measured ping pass. Use 0 for any ping.
+    /// </summary>
+    int32 MaxPing = 0;
+
+    bool HideFull = false;
+    bool HideEmpty = false;
+
+    /// <summary>
+    /// The string ids (see FindString) of the map and the mode to show. Use -1 for any.
+    /// </summary>
+    int32 Map = -1;
+    int32 Mode = -1;
+
+    /// <summary>
+    /// The ranges of the numeric columns (inclusive).
+    /// </summary>
+    Array<Range> Ranges;
+};
+
+///<summary>
+/// The server browser built on the EOS session search.
+/// Searches run in parallel and their results are ingested in pages (a few rows per tick), so the rows are streamed to the UI as they arrive without the frame spikes.
+/// Results are stored in the columnar table (every column is a contiguous array and the strings are interned), so filtering and sorting tens of thousands of rows touches only the used columns.
+/// Refresh keeps the rows and reports only the ones that changed (or disappeared).
+/// Events are called from the thread that ticks the platform (with the context locker held). Hold the context locker while reading the table from the other thread.
+///</summary>
+class ONLINEPLATFORMEOS_API EOSServerBrowser
+{
+public:
+    // The table columns (indexed by the row)
+    struct Table
+    {
+        Array<StringAnsi> SessionId;
+        Array<StringAnsi> HostAddress;
+        Array<EOS_HSessionDetails> Details;
+        Array<int32> Ping;
+        Array<int32> Players;
+        Array<int32> MaxPlayers;
+        Array<int32> Map;
+        Array<int32> Mode;
+        Array<Array<double>> Custom;
+        Array<uint32> Generation;
+
+        FORCE_INLINE int32 Count() const
+        {
+            return SessionId.Count();
+        }
+    };
+
+private:
+    struct PendingSearch;
+    struct CustomColumn
+    {
+        StringAnsi Key;
+        bool IsString;
+    };
+
+    EOSPlatformContext* _context;
+    Table _table;
+    Dictionary<StringAnsi, int32> _rows;
+    Array<CustomColumn> _customColumns;
+    Array<StringAnsi> _strings;
+    Dictionary<StringAnsi, int32> _stringIds;
+    Array<int32> _stringRanks;
+    Array<EOSServerSearch> _searches;
+    Array<PendingSearch*> _pending;
+    Array<int32> _changedRows;
+    Array<int32> _removedRows;
+    uint32 _generation = 0;
+    bool _failed = false;
+
+public:
+    EOSServerBrowser(EOSPlatformContext* context);
+    ~EOSServerBrowser();
+
+    /// <summary>
+    /// The attributes with the map and the mode names.
+    /// </summary>
+    StringAnsi MapAttribute = "MAP";
+    StringAnsi ModeAttribute = "MODE";
+
+    /// <summary>
+    /// The maximum amount of the results of a single search.
+    /// </summary>
+    int32 MaxResults = EOS_SESSIONS_MAX_SEARCH_RESULTS;
+
+    /// <summary>
+    /// The amount of the results ingested per platform tick.
+    /// </summary>
+    int32 PageSize = 64;
+
+    /// <summary>
+    /// Event called when the rows get added to the table (first row index and the amount).
+    /// </summary>
+    Delegate<int32, int32> RowsAdded;
+
+    /// <summary>
+    /// Event called when the refreshed rows changed (row indices).
+    /// </summary>
+    Delegate<const Span<int32>&> RowsChanged;
+
+    /// <summary>
+    /// Event called when the rows that weren't found by the refresh got removed (row indices from before the removal, ascending). The rest of the rows keep their order, every row moves up by the amount of the removed rows before it.
+    /// </summary>
+    Delegate<const Span<int32>&> RowsRemoved;
+
+    /// <summary>
+    /// Event called when all the searches completed and their results got ingested.
+    /// </summary>
+    Action SearchCompleted;
+
+public:
+    /// <summary>
+    /// Adds the column of the custom session attribute. Must be called before the search.
+    /// </summary>
+    /// <returns>The column (Custom + index of the custom column).</returns>
+    int32 AddColumn(const StringAnsiView& key, bool isString = false);
+
+    /// <summary>
+    /// Clears the table and starts the searches.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool Search(const Array<EOSServerSearch>& searches);
+
+    /// <summary>
+    /// Runs the last searches again. Rows are kept, the changed ones are reported with RowsChanged and the ones not found anymore get removed at the end.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool Refresh();
+
+    /// <summary>
+    /// Cancels the searches in progress (the rows ingested so far are kept).
+    /// </summary>
+    void Cancel();
+
+    /// <summary>
+    /// Removes all the rows.
+    /// </summary>
+    void Clear();
+
+    FORCE_INLINE bool IsSearching() const
+    {
+        return _pending.HasItems();
+    }
+
+    FORCE_INLINE const Table& GetTable() const
+    {
+        return _table;
+    }
+
+    /// <summary>
+    /// Gets the interned string (map, mode or the custom string attribute).
+    /// </summary>
+    StringAnsi GetString(int32 id) const;
+
+    /// <summary>
+    /// Finds the id of the interned string (eg. for the filter).
+    /// </summary>
+    /// <returns>The string id or -1 if not found.</returns>
+    int32 FindString(const StringAnsiView& value) const;
+
+    /// <summary>
+    /// Finds the row of the session.
+    /// </summary>
+    /// <returns>The row index or -1 if not found.</returns>
+    int32 FindRow(const StringAnsiView& sessionId) const;
+
+    /// <summary>
+    /// Sets the ping of the server measured by the game (eg. by pinging its host address). Kept by the refresh.
+    /// </summary>
+    void SetPing(int32 row, int32 ping);
+
+    /// <summary>
+    /// Gets the rows that pass the filter (in the table order).
+    /// </summary>
+    void Filter(const EOSServerFilter& filter, Array<int32>& result);
+
+    /// <summary>
+    /// Sorts the rows (eg. the filtered ones) by the column. Strings are sorted alphabetically, ties keep the table order.
+    /// </summary>
+    void Sort(Array<int32>& rows, int32 column, bool descending = false);
+
+    /// <summary>
+    /// Ingests the next page of the search results. Called on every platform tick.
+    /// </summary>
+    void Flush();
+
+private:
+    bool StartSearches();
+    void CancelSearches();
+    int32 Intern(const char* value);
+    void IngestResult(EOS_HSessionDetails details);
+    void RemoveRows(const Array<int32>& rows);
+    void UpdateStringRanks();
+    double GetValue(int32 row, int32 column) const;
+    void Complete();
+
+    static void EOS_CALL OnFindComplete(const EOS_SessionSearch_FindCallbackInfo* data);
+};
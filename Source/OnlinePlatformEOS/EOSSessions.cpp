@@ -0,0 +1,749 @@
+#include "EOSSessions.h"
+#include "EOSPlatformContext.h"
+
+#include "Engine/Core/Log.h"
+#include "Engine/Core/Math/Math.h"
+#include "Engine/Platform/Platform.h"
+#include "Engine/Threading/Threading.h"
+#include <EOSSDK/Include/eos_sdk.h>
+
+#include "EOSSDK/Include/eos_sessions.h"
+
+struct EOSSessions::Session
+{
+    StringAnsi Name;
+    StringAnsi Id;
+    EOS_EOnlineSessionState State = EOS_EOnlineSessionState::EOS_OSS_Creating;
+    bool IsOwner = false;
+
+    // The local table (with the changes not sent yet)
+    EOSSessionSettings Settings;
+    Dictionary<StringAnsi, EOSSessionAttribute> Attributes;
+
+    // The state acknowledged by the backend (the changes are diffed against it)
+    EOSSessionSettings CommittedSettings;
+    Dictionary<StringAnsi, EOSSessionAttribute> CommittedAttributes;
+
+    Operation* Update = nullptr;
+    double DirtyTime = 0.0;
+    double LastUpdateTime = 0.0;
+
+    // The players waiting for the batched registration
+    Array<EOS_ProductUserId> QueuedRegistrations;
+    Array<EOS_ProductUserId> QueuedUnregistrations;
+    double RegistrationTime = 0.0;
+};
+
+struct EOSSessions::Operation
+{
+    EOSSessions* Owner;
+    StringAnsi SessionName;
+    Callback OnComplete;
+    bool Canceled = false;
+
+    // The state sent with the update
+    bool Create = false;
+    EOSSessionSettings Settings;
+    Dictionary<StringAnsi, EOSSessionAttribute> Attributes;
+
+    // The players sent with the registration (requeued if the batched one fails)
+    Array<EOS_ProductUserId> Players;
+    bool Batched = false;
+};
+
+EOSSessions::EOSSessions(EOSPlatformContext* context)
+    : _context(context)
+{
+    _context->Ticking.Bind<EOSSessions, &EOSSessions::Flush>(this);
+}
+
+EOSSessions::~EOSSessions()
+{
+    _context->Ticking.Unbind<EOSSessions, &EOSSessions::Flush>(this);
+    Clear();
+    _operations.ClearDelete();
+}
+
+bool EOSSessions::CreateSession(const StringAnsiView& name, const EOSSessionSettings& settings, const Callback& callback)
+{
+    ScopeLock lock(_context->Locker);
+    const StringAnsi sessionName(name);
+    if (_sessions.ContainsKey(sessionName))
+    {
+        LOG(Warning, "EOS session {0} already exists.", String(sessionName));
+        return true;
+    }
+    auto session = New<Session>();
+    session->Name = sessionName;
+    session->IsOwner = true;
+    session->Settings = settings;
+    _sessions[sessionName] = session;
+    if (SendUpdate(session, true, callback))
+    {
+        _sessions.Remove(sessionName);
+        Delete(session);
+        return true;
+    }
+    return false;
+}
+
+bool EOSSessions::JoinSession(const StringAnsiView& name, EOS_HSessionDetails details, bool presenceEnabled, const Callback& callback)
+{
+    ScopeLock lock(_context->Locker);
+    const auto sessions = _context->GetSessions();
+    const StringAnsi sessionName(name);
+    if (!sessions || !details || _sessions.ContainsKey(sessionName))
+        return true;
+    auto session = New<Session>();
+    session->Name = sessionName;
+    _sessions[sessionName] = session;
+
+    EOS_Sessions_JoinSessionOptions options = {};
+    options.ApiVersion = EOS_SESSIONS_JOINSESSION_API_LATEST;
+    options.SessionName = sessionName.Get();
+    options.SessionHandle = details;
+    options.LocalUserId = _context->ProductUserId;
+    options.bPresenceEnabled = presenceEnabled ? EOS_TRUE : EOS_FALSE;
+    EOS_Sessions_JoinSession(sessions, &options, BeginOperation(name, callback), &EOSSessions::OnJoinSessionComplete);
+    return false;
+}
+
+bool EOSSessions::DestroySession(const StringAnsiView& name, const Callback& callback)
+{
+    ScopeLock lock(_context->Locker);
+    const auto sessions = _context->GetSessions();
+    Session* session;
+    if (!sessions || !_sessions.TryGet(StringAnsi(name), session) || session->State == EOS_EOnlineSessionState::EOS_OSS_Destroying)
+        return true;
+    session->State = EOS_EOnlineSessionState::EOS_OSS_Destroying;
+    session->DirtyTime = 0.0;
+
+    EOS_Sessions_DestroySessionOptions options = {};
+    options.ApiVersion = EOS_SESSIONS_DESTROYSESSION_API_LATEST;
+    options.SessionName = session->Name.Get();
+    EOS_Sessions_DestroySession(sessions, &options, BeginOperation(name, callback), &EOSSessions::OnDestroySessionComplete);
+    return false;
+}
+
+bool EOSSessions::StartSession(const StringAnsiView& name, const Callback& callback)
+{
+    ScopeLock lock(_context->Locker);
+    const auto sessions = _context->GetSessions();
+    const StringAnsi sessionName(name);
+    if (!sessions || !_sessions.ContainsKey(sessionName))
+        return true;
+    EOS_Sessions_StartSessionOptions options = {};
+    options.ApiVersion = EOS_SESSIONS_STARTSESSION_API_LATEST;
+    options.SessionName = sessionName.Get();
+    EOS_Sessions_StartSession(sessions, &options, BeginOperation(name, callback), &EOSSessions::OnStartSessionComplete);
+    return false;
+}
+
+bool EOSSessions::EndSession(const StringAnsiView& name, const Callback& callback)
+{
+    ScopeLock lock(_context->Locker);
+    const auto sessions = _context->GetSessions();
+    const StringAnsi sessionName(name);
+    if (!sessions || !_sessions.ContainsKey(sessionName))
+        return true;
+    EOS_Sessions_EndSessionOptions options = {};
+    options.ApiVersion = EOS_SESSIONS_ENDSESSION_API_LATEST;
+    options.SessionName = sessionName.Get();
+    EOS_Sessions_EndSession(sessions, &options, BeginOperation(name, callback), &EOSSessions::OnEndSessionComplete);
+    return false;
+}
+
+bool EOSSessions::RegisterPlayers(const StringAnsiView& name, const Span<EOS_ProductUserId>& players, const Callback& callback)
+{
+    ScopeLock lock(_context->Locker);
+    const StringAnsi sessionName(name);
+    if (players.Length() == 0 || !_sessions.ContainsKey(sessionName))
+        return true;
+    return SendPlayers(sessionName, players, true, false, callback);
+}
+
+bool EOSSessions::UnregisterPlayers(const StringAnsiView& name, const Span<EOS_ProductUserId>& players, const Callback& callback)
+{
+    ScopeLock lock(_context->Locker);
+    const StringAnsi sessionName(name);
+    if (players.Length() == 0 || !_sessions.ContainsKey(sessionName))
+        return true;
+    return SendPlayers(sessionName, players, false, false, callback);
+}
+
+bool EOSSessions::QueueRegisterPlayer(const StringAnsiView& name, EOS_ProductUserId player)
+{
+    ScopeLock lock(_context->Locker);
+    return QueuePlayer(name, player, true);
+}
+
+bool EOSSessions::QueueUnregisterPlayer(const StringAnsiView& name, EOS_ProductUserId player)
+{
+    ScopeLock lock(_context->Locker);
+    return QueuePlayer(name, player, false);
+}
+
+EOSSessionRegistrationStats EOSSessions::GetRegistrationStats()
+{
+    ScopeLock lock(_context->Locker);
+    return _registrationStats;
+}
+
+bool EOSSessions::SetAttribute(const StringAnsiView& name, const StringAnsiView& key, const EOSSessionAttribute& value)
+{
+    ScopeLock lock(_context->Locker);
+    Session* session = GetOwnedSession(name);
+    if (!session || key.IsEmpty() || key.Length() > EOS_SESSIONMODIFICATION_MAX_SESSION_ATTRIBUTE_LENGTH)
+        return true;
+    const StringAnsi attributeKey(key);
+    EOSSessionAttribute* current = session->Attributes.TryGet(attributeKey);
+    if (current)
+    {
+        if (*current == value)
+            return false;
+        *current = value;
+    }
+    else
+    {
+        if (session->Attributes.Count() >= EOS_SESSIONMODIFICATION_MAX_SESSION_ATTRIBUTES)
+        {
+            LOG(Warning, "EOS session {0} has too many attributes to add {1}.", String(session->Name), String(attributeKey));
+            return true;
+        }
+        session->Attributes.Add(attributeKey, value);
+    }
+    MarkDirty(session, Platform::GetTimeSeconds());
+    return false;
+}
+
+bool EOSSessions::RemoveAttribute(const StringAnsiView& name, const StringAnsiView& key)
+{
+    ScopeLock lock(_context->Locker);
+    Session* session = GetOwnedSession(name);
+    if (!session)
+        return true;
+    if (session->Attributes.Remove(StringAnsi(key)))
+        MarkDirty(session, Platform::GetTimeSeconds());
+    return false;
+}
+
+bool EOSSessions::GetAttribute(const StringAnsiView& name, const StringAnsiView& key, EOSSessionAttribute& result)
+{
+    ScopeLock lock(_context->Locker);
+    Session* session = GetOwnedSession(name);
+    return session && session->Attributes.TryGet(StringAnsi(key), result);
+}
+
+bool EOSSessions::SetSettings(const StringAnsiView& name, const EOSSessionSettings& settings)
+{
+    ScopeLock lock(_context->Locker);
+    Session* session = GetOwnedSession(name);
+    if (!session || settings.MaxPlayers == 0 || settings.MaxPlayers > EOS_SESSIONS_MAXREGISTEREDPLAYERS)
+        return true;
+    if (session->Settings.UpdatableEquals(settings))
+        return false;
+    session->Settings = settings;
+    MarkDirty(session, Platform::GetTimeSeconds());
+    return false;
+}
+
+bool EOSSessions::GetSettings(const StringAnsiView& name, EOSSessionSettings& result)
+{
+    ScopeLock lock(_context->Locker);
+    Session* session = GetOwnedSession(name);
+    if (!session)
+        return false;
+    result = session->Settings;
+    return true;
+}
+
+StringAnsi EOSSessions::GetSessionId(const StringAnsiView& name)
+{
+    ScopeLock lock(_context->Locker);
+    Session* session;
+    if (_sessions.TryGet(StringAnsi(name), session))
+        return session->Id;
+    return StringAnsi::Empty;
+}
+
+EOS_EOnlineSessionState EOSSessions::GetState(const StringAnsiView& name)
+{
+    ScopeLock lock(_context->Locker);
+    Session* session;
+    if (_sessions.TryGet(StringAnsi(name), session))
+        return session->State;
+    return EOS_EOnlineSessionState::EOS_OSS_NoSession;
+}
+
+int64 EOSSessions::GetUpdateCount()
+{
+    ScopeLock lock(_context->Locker);
+    return _updateCount;
+}
+
+int64 EOSSessions::GetChangeCount()
+{
+    ScopeLock lock(_context->Locker);
+    return _changeCount;
+}
+
+void EOSSessions::Clear()
+{
+    ScopeLock lock(_context->Locker);
+    for (auto& e : _sessions)
+        Delete(e.Value);
+    _sessions.Clear();
+
+    // Operations are owned by the SDK callbacks that may still be in-flight
+    for (auto operation : _operations)
+        operation->Canceled = true;
+}
+
+void EOSSessions::Flush()
+{
+    ScopeLock lock(_context->Locker);
+    if (_sessions.IsEmpty())
+        return;
+    const double now = Platform::GetTimeSeconds();
+    const double window = (double)UpdateWindow;
+    for (auto& e : _sessions)
+    {
+        Session* session = e.Value;
+        if (session->Id.IsEmpty() || session->State == EOS_EOnlineSessionState::EOS_OSS_Destroying)
+            continue;
+        if (session->DirtyTime > 0.0 && !session->Update && now >= Math::Max(session->DirtyTime, session->LastUpdateTime) + window)
+        {
+            if (SendUpdate(session, false, Callback()))
+            {
+                // Try again in the next window
+                session->DirtyTime = now;
+            }
+        }
+        if (session->RegistrationTime > 0.0 && now >= session->RegistrationTime + (double)RegistrationWindow)
+        {
+            // Leaves go first so the slots are free for the joins
+            session->RegistrationTime = 0.0;
+            if (session->QueuedUnregistrations.HasItems())
+            {
+                SendPlayers(session->Name, ToSpan(session->QueuedUnregistrations), false, true, Callback());
+                session->QueuedUnregistrations.Clear();
+            }
+            if (session->QueuedRegistrations.HasItems())
+            {
+                SendPlayers(session->Name, ToSpan(session->QueuedRegistrations), true, true, Callback());
+                session->QueuedRegistrations.Clear();
+            }
+        }
+    }
+}
+
+EOSSessions::Session* EOSSessions::GetOwnedSession(const StringAnsiView& name)
+{
+    Session* session;
+    if (!_sessions.TryGet(StringAnsi(name), session) || !session->IsOwner || session->State == EOS_EOnlineSessionState::EOS_OSS_Destroying)
+        return nullptr;
+    return session;
+}
+
+void EOSSessions::MarkDirty(Session* session, double now)
+{
+    _changeCount++;
+    if (session->DirtyTime <= 0.0)
+        session->DirtyTime = now;
+}
+
+bool EOSSessions::SendUpdate(Session* session, bool create, const Callback& callback)
+{
+    const auto sessions = _context->GetSessions();
+    if (!sessions)
+        return true;
+    EOS_HSessionModification modification = nullptr;
+    EOS_EResult result;
+    if (create)
+    {
+        EOS_Sessions_CreateSessionModificationOptions options = {};
+        options.ApiVersion = EOS_SESSIONS_CREATESESSIONMODIFICATION_API_LATEST;
+        options.SessionName = session->Name.Get();
+        options.BucketId = session->Settings.BucketId.GetText();
+        options.MaxPlayers = session->Settings.MaxPlayers;
+        options.LocalUserId = _context->IsServer ? nullptr : _context->ProductUserId;
+        options.bPresenceEnabled = session->Settings.PresenceEnabled ? EOS_TRUE : EOS_FALSE;
+        options.SessionId = nullptr;
+        options.bSanctionsEnabled = session->Settings.SanctionsEnabled ? EOS_TRUE : EOS_FALSE;
+        result = EOS_Sessions_CreateSessionModification(sessions, &options, &modification);
+    }
+    else
+    {
+        EOS_Sessions_UpdateSessionModificationOptions options = {};
+        options.ApiVersion = EOS_SESSIONS_UPDATESESSIONMODIFICATION_API_LATEST;
+        options.SessionName = session->Name.Get();
+        result = EOS_Sessions_UpdateSessionModification(sessions, &options, &modification);
+    }
+    if (result != EOS_EResult::EOS_Success)
+    {
+        LOG(Warning, "EOS failed to modify session {0}: {1}", String(session->Name), String(EOS_EResult_ToString(result)));
+        return true;
+    }
+
+    const int32 changes = ApplyChanges(session, modification, create);
+    if (changes < 0 || (changes == 0 && !create))
+    {
+        // Nothing to send if the changes got reverted within the window
+        EOS_SessionModification_Release(modification);
+        if (changes < 0)
+            return true;
+        session->DirtyTime = 0.0;
+        return false;
+    }
+
+    // Remember the sent state so it becomes the new baseline once acknowledged
+    Operation* operation = BeginOperation(session->Name, callback);
+    operation->Create = create;
+    operation->Settings = session->Settings;
+    operation->Attributes = session->Attributes;
+    session->Update = operation;
+    session->DirtyTime = 0.0;
+    session->LastUpdateTime = Platform::GetTimeSeconds();
+    _updateCount++;
+
+    EOS_Sessions_UpdateSessionOptions options = {};
+    options.ApiVersion = EOS_SESSIONS_UPDATESESSION_API_LATEST;
+    options.SessionModificationHandle = modification;
+    EOS_Sessions_UpdateSession(sessions, &options, operation, &EOSSessions::OnUpdateSessionComplete);
+    EOS_SessionModification_Release(modification);
+    return false;
+}
+
+int32 EOSSessions::ApplyChanges(Session* session, EOS_HSessionModification modification, bool create)
+{
+    const EOSSessionSettings& settings = session->Settings;
+    const EOSSessionSettings& committed = session->CommittedSettings;
+    int32 changes = 0;
+
+    // Bucket and max players are part of the creation options
+    if (!create && settings.BucketId != committed.BucketId)
+    {
+        EOS_SessionModification_SetBucketIdOptions options = {};
+        options.ApiVersion = EOS_SESSIONMODIFICATION_SETBUCKETID_API_LATEST;
+        options.BucketId = settings.BucketId.GetText();
+        if (EOSModification::CheckResult(EOS_SessionModification_SetBucketId(modification, &options), "set the bucket id", "session"))
+            return -1;
+        changes++;
+    }
+    if (!create && settings.MaxPlayers != committed.MaxPlayers)
+    {
+        EOS_SessionModification_SetMaxPlayersOptions options = {};
+        options.ApiVersion = EOS_SESSIONMODIFICATION_SETMAXPLAYERS_API_LATEST;
+        options.MaxPlayers = settings.MaxPlayers;
+        if (EOSModification::CheckResult(EOS_SessionModification_SetMaxPlayers(modification, &options), "set the max players", "session"))
+            return -1;
+        changes++;
+    }
+    if (settings.HostAddress.HasChars() && (create || settings.HostAddress != committed.HostAddress))
+    {
+        EOS_SessionModification_SetHostAddressOptions options = {};
+        options.ApiVersion = EOS_SESSIONMODIFICATION_SETHOSTADDRESS_API_LATEST;
+        options.HostAddress = settings.HostAddress.Get();
+        if (EOSModification::CheckResult(EOS_SessionModification_SetHostAddress(modification, &options), "set the host address", "session"))
+            return -1;
+        changes++;
+    }
+    if (create || settings.PermissionLevel != committed.PermissionLevel)
+    {
+        EOS_SessionModification_SetPermissionLevelOptions options = {};
+        options.ApiVersion = EOS_SESSIONMODIFICATION_SETPERMISSIONLEVEL_API_LATEST;
+        options.PermissionLevel = settings.PermissionLevel;
+        if (EOSModification::CheckResult(EOS_SessionModification_SetPermissionLevel(modification, &options), "set the permission level", "session"))
+            return -1;
+        changes++;
+    }
+    if (create || settings.JoinInProgressAllowed != committed.JoinInProgressAllowed)
+    {
+        EOS_SessionModification_SetJoinInProgressAllowedOptions options = {};
+        options.ApiVersion = EOS_SESSIONMODIFICATION_SETJOININPROGRESSALLOWED_API_LATEST;
+        options.bAllowJoinInProgress = settings.JoinInProgressAllowed ? EOS_TRUE : EOS_FALSE;
+        if (EOSModification::CheckResult(EOS_SessionModification_SetJoinInProgressAllowed(modification, &options), "set the join in progress", "session"))
+            return -1;
+        changes++;
+    }
+    if (create || settings.InvitesAllowed != committed.InvitesAllowed)
+    {
+        EOS_SessionModification_SetInvitesAllowedOptions options = {};
+        options.ApiVersion = EOS_SESSIONMODIFICATION_SETINVITESALLOWED_API_LATEST;
+        options.bInvitesAllowed = settings.InvitesAllowed ? EOS_TRUE : EOS_FALSE;
+        if (EOSModification::CheckResult(EOS_SessionModification_SetInvitesAllowed(modification, &options), "set the invites", "session"))
+            return -1;
+        changes++;
+    }
+
+    // Only the added and modified keys, the unchanged ones are already on the backend
+    for (const auto& e : session->Attributes)
+    {
+        const EOSSessionAttribute* current = session->CommittedAttributes.TryGet(e.Key);
+        if (current && *current == e.Value)
+            continue;
+        EOS_Sessions_AttributeData data = {};
+        e.Value.ToData(e.Key.Get(), data);
+        EOS_SessionModification_AddAttributeOptions options = {};
+        options.ApiVersion = EOS_SESSIONMODIFICATION_ADDATTRIBUTE_API_LATEST;
+        options.SessionAttribute = &data;
+        options.AdvertisementType = e.Value.Visibility;
+        if (EOSModification::CheckResult(EOS_SessionModification_AddAttribute(modification, &options), "add the attribute", "session"))
+            return -1;
+        changes++;
+    }
+    for (const auto& e : session->CommittedAttributes)
+    {
+        if (session->Attributes.ContainsKey(e.Key))
+            continue;
+        EOS_SessionModification_RemoveAttributeOptions options = {};
+        options.ApiVersion = EOS_SESSIONMODIFICATION_REMOVEATTRIBUTE_API_LATEST;
+        options.Key = e.Key.Get();
+        if (EOSModification::CheckResult(EOS_SessionModification_RemoveAttribute(modification, &options), "remove the attribute", "session"))
+            return -1;
+        changes++;
+    }
+    return changes;
+}
+
+bool EOSSessions::QueuePlayer(const StringAnsiView& name, EOS_ProductUserId player, bool registering)
+{
+    Session* session;
+    if (!player || !_sessions.TryGet(StringAnsi(name), session) || session->State == EOS_EOnlineSessionState::EOS_OSS_Destroying)
+        return true;
+    auto& queue = registering ? session->QueuedRegistrations : session->QueuedUnregistrations;
+    auto& opposite = registering ? session->QueuedUnregistrations : session->QueuedRegistrations;
+
+    // The player that left and came back within the window (or the other way around) needs no call at all
+    if (opposite.Remove(player))
+    {
+        _registrationStats.CanceledPairs++;
+        return false;
+    }
+    if (!queue.Contains(player))
+        queue.Add(player);
+    if (session->RegistrationTime <= 0.0)
+        session->RegistrationTime = Platform::GetTimeSeconds();
+    return false;
+}
+
+bool EOSSessions::SendPlayers(const StringAnsi& name, const Span<EOS_ProductUserId>& players, bool registering, bool batched, const Callback& callback)
+{
+    const auto sessions = _context->GetSessions();
+    if (!sessions)
+        return true;
+    Operation* operation = BeginOperation(name, callback);
+    operation->Players.Add(players.Get(), players.Length());
+    if (batched)
+    {
+        const int32 count = players.Length();
+        _registrationStats.MaxBatchSize = Math::Max(_registrationStats.MaxBatchSize, count);
+        if (registering)
+        {
+            _registrationStats.RegisterCalls++;
+            _registrationStats.PlayersRegistered += count;
+        }
+        else
+        {
+            _registrationStats.UnregisterCalls++;
+            _registrationStats.PlayersUnregistered += count;
+        }
+    }
+    operation->Batched = batched;
+    if (registering)
+    {
+        EOS_Sessions_RegisterPlayersOptions options = {};
+        options.ApiVersion = EOS_SESSIONS_REGISTERPLAYERS_API_LATEST;
+        options.SessionName = name.Get();
+        options.PlayersToRegister = operation->Players.Get();
+        options.PlayersToRegisterCount = operation->Players.Count();
+        EOS_Sessions_RegisterPlayers(sessions, &options, operation, &EOSSessions::OnRegisterPlayersComplete);
+    }
+    else
+    {
+        EOS_Sessions_UnregisterPlayersOptions options = {};
+        options.ApiVersion = EOS_SESSIONS_UNREGISTERPLAYERS_API_LATEST;
+        options.SessionName = name.Get();
+        options.PlayersToUnregister = operation->Players.Get();
+        options.PlayersToUnregisterCount = operation->Players.Count();
+        EOS_Sessions_UnregisterPlayers(sessions, &options, operation, &EOSSessions::OnUnregisterPlayersComplete);
+    }
+    return false;
+}
+
+void EOSSessions::RequeuePlayers(Operation* operation, EOS_EResult result, bool registering)
+{
+    if (!operation->Batched || operation->Canceled || !EOSModification::IsRetryable(result))
+        return;
+
+    // Joins and leaves queued meanwhile still cancel the requeued ones
+    for (const EOS_ProductUserId player : operation->Players)
+        QueuePlayer(operation->SessionName, player, registering);
+}
+
+EOSSessions::Operation* EOSSessions::BeginOperation(const StringAnsiView& name, const Callback& callback)
+{
+    auto operation = New<Operation>();
+    operation->Owner = this;
+    operation->SessionName = name;
+    operation->OnComplete = callback;
+    _operations.Add(operation);
+    return operation;
+}
+
+void EOSSessions::EndOperation(Operation* operation, EOS_EResult result)
+{
+    _operations.Remove(operation);
+    if (!operation->Canceled && operation->OnComplete.IsBinded())
+        operation->OnComplete(result);
+    Delete(operation);
+}
+
+void EOSSessions::OnUpdateSessionComplete(const EOS_Sessions_UpdateSessionCallbackInfo* data)
+{
+    const auto operation = (Operation*)data->ClientData;
+    const auto owner = operation->Owner;
+    const EOS_EResult result = data->ResultCode;
+    Session* session = nullptr;
+    if (!operation->Canceled && owner->_sessions.TryGet(operation->SessionName, session) && session->Update == operation)
+    {
+        session->Update = nullptr;
+        if (result == EOS_EResult::EOS_Success)
+        {
+            // Changes made meanwhile are still dirty and get diffed against the new baseline
+            session->CommittedSettings = operation->Settings;
+            session->CommittedAttributes = operation->Attributes;
+            if (operation->Create)
+            {
+                session->Id = data->SessionId;
+                if (session->State == EOS_EOnlineSessionState::EOS_OSS_Creating)
+                    session->State = EOS_EOnlineSessionState::EOS_OSS_Pending;
+            }
+        }
+        else if (operation->Create)
+        {
+            LOG(Warning, "EOS failed to create session {0}: {1}", String(session->Name), String(EOS_EResult_ToString(result)));
+            owner->_sessions.Remove(session->Name);
+            Delete(session);
+            session = nullptr;
+        }
+        else if (EOSModification::IsRetryable(result))
+        {
+            LOG(Warning, "EOS failed to update session {0}, retrying: {1}", String(session->Name), String(EOS_EResult_ToString(result)));
+            session->DirtyTime = Platform::GetTimeSeconds();
+        }
+        else
+        {
+            // Revert the local table so it matches the backend
+            LOG(Warning, "EOS failed to update session {0}: {1}", String(session->Name), String(EOS_EResult_ToString(result)));
+            session->Settings = session->CommittedSettings;
+            session->Attributes = session->CommittedAttributes;
+            session->DirtyTime = 0.0;
+        }
+    }
+    const StringAnsi sessionName = operation->SessionName;
+    const bool notify = !operation->Canceled;
+    owner->EndOperation(operation, result);
+    if (notify)
+        owner->SessionUpdated(sessionName, result);
+}
+
+void EOSSessions::OnJoinSessionComplete(const EOS_Sessions_JoinSessionCallbackInfo* data)
+{
+    const auto operation = (Operation*)data->ClientData;
+    const auto owner = operation->Owner;
+    Session* session;
+    if (!operation->Canceled && owner->_sessions.TryGet(operation->SessionName, session) && session->State == EOS_EOnlineSessionState::EOS_OSS_Creating)
+    {
+        if (data->ResultCode == EOS_EResult::EOS_Success)
+        {
+            session->State = EOS_EOnlineSessionState::EOS_OSS_Pending;
+            EOS_Sessions_CopyActiveSessionHandleOptions options = {};
+            options.ApiVersion = EOS_SESSIONS_COPYACTIVESESSIONHANDLE_API_LATEST;
+            options.SessionName = session->Name.Get();
+            EOS_HActiveSession activeSession;
+            if (EOS_Sessions_CopyActiveSessionHandle(owner->_context->GetSessions(), &options, &activeSession) == EOS_EResult::EOS_Success)
+            {
+                EOS_ActiveSession_CopyInfoOptions infoOptions = {};
+                infoOptions.ApiVersion = EOS_ACTIVESESSION_COPYINFO_API_LATEST;
+                EOS_ActiveSession_Info* info;
+                if (EOS_ActiveSession_CopyInfo(activeSession, &infoOptions, &info) == EOS_EResult::EOS_Success)
+                {
+                    session->State = info->State;
+                    if (info->SessionDetails && info->SessionDetails->SessionId)
+                        session->Id = info->SessionDetails->SessionId;
+                    EOS_ActiveSession_Info_Release(info);
+                }
+                EOS_ActiveSession_Release(activeSession);
+            }
+        }
+        else
+        {
+            LOG(Warning, "EOS failed to join session {0}: {1}", String(session->Name), String(EOS_EResult_ToString(data->ResultCode)));
+            owner->_sessions.Remove(session->Name);
+            Delete(session);
+        }
+    }
+    owner->EndOperation(operation, data->ResultCode);
+}
+
+void EOSSessions::OnDestroySessionComplete(const EOS_Sessions_DestroySessionCallbackInfo* data)
+{
+    const auto operation = (Operation*)data->ClientData;
+    const auto owner = operation->Owner;
+    Session* session;
+    if (data->ResultCode != EOS_EResult::EOS_Success)
+        LOG(Warning, "EOS failed to destroy session {0}: {1}", String(operation->SessionName), String(EOS_EResult_ToString(data->ResultCode)));
+
+    // The session is gone locally even if the backend failed (it expires there on its own)
+    if (!operation->Canceled && owner->_sessions.TryGet(operation->SessionName, session) && session->State == EOS_EOnlineSessionState::EOS_OSS_Destroying)
+    {
+        owner->_sessions.Remove(operation->SessionName);
+        Delete(session);
+    }
+    owner->EndOperation(operation, data->ResultCode);
+}
+
+void EOSSessions::OnStartSessionComplete(const EOS_Sessions_StartSessionCallbackInfo* data)
+{
+    const auto operation = (Operation*)data->ClientData;
+    const auto owner = operation->Owner;
+    Session* session;
+    if (data->ResultCode != EOS_EResult::EOS_Success)
+        LOG(Warning, "EOS failed to start session {0}: {1}", String(operation->SessionName), String(EOS_EResult_ToString(data->ResultCode)));
+    else if (!operation->Canceled && owner->_sessions.TryGet(operation->SessionName, session) && session->State != EOS_EOnlineSessionState::EOS_OSS_Destroying)
+        session->State = EOS_EOnlineSessionState::EOS_OSS_InProgress;
+    owner->EndOperation(operation, data->ResultCode);
+}
+
+void EOSSessions::OnEndSessionComplete(const EOS_Sessions_EndSessionCallbackInfo* data)
+{
+    const auto operation = (Operation*)data->ClientData;
+    const auto owner = operation->Owner;
+    Session* session;
+    if (data->ResultCode != EOS_EResult::EOS_Success)
+        LOG(Warning, "EOS failed to end session {0}: {1}", String(operation->SessionName), String(EOS_EResult_ToString(data->ResultCode)));
+    else if (!operation->Canceled && owner->_sessions.TryGet(operation->SessionName, session) && session->State != EOS_EOnlineSessionState::EOS_OSS_Destroying)
+        session->State = EOS_EOnlineSessionState::EOS_OSS_Ended;
+    owner->EndOperation(operation, data->ResultCode);
+}
+
+void EOSSessions::OnRegisterPlayersComplete(const EOS_Sessions_RegisterPlayersCallbackInfo* data)
+{
+    const auto operation = (Operation*)data->ClientData;
+    if (data->ResultCode != EOS_EResult::EOS_Success)
+        LOG(Warning, "EOS failed to register players with session {0}: {1}", String(operation->SessionName), String(EOS_EResult_ToString(data->ResultCode)));
+    else if (data->SanctionedPlayersCount != 0)
+        LOG(Info, "EOS session {0} rejected {1} sanctioned player(s).", String(operation->SessionName), data->SanctionedPlayersCount);
+    operation->Owner->RequeuePlayers(operation, data->ResultCode, true);
+    operation->Owner->EndOperation(operation, data->ResultCode);
+}
+
+void EOSSessions::OnUnregisterPlayersComplete(const EOS_Sessions_UnregisterPlayersCallbackInfo* data)
+{
+    const auto operation = (Operation*)data->ClientData;
+    if (data->ResultCode != EOS_EResult::EOS_Success)
+        LOG(Warning, "EOS failed to unregister players from session {0}: {1}", String(operation->SessionName), String(EOS_EResult_ToString(data->ResultCode)));
+    operation->Owner->RequeuePlayers(operation, data->ResultCode, false);
+    operation->Owner->EndOperation(operation, data->ResultCode);
+}
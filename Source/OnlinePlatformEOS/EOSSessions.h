@@ -0,0 +1,276 @@
+#pragma once
+
+#include "Engine/Core/Collections/Array.h"
+#include "Engine/Core/Collections/Dictionary.h"
+#include "Engine/Core/Delegate.h"
+#include "Engine/Core/Types/Span.h"
+#include "Engine/Core/Types/String.h"
+#include "EOSAttribute.h"
+#include "EOSSDK/Include/eos_sessions_types.h"
+
+class EOSPlatformContext;
+
+///<summary>
+/// The value of the session attribute (the visibility is the advertisement type).
+///</summary>
+typedef EOSAttribute<EOS_Sessions_AttributeData, EOS_ESessionAttributeAdvertisementType, EOS_SESSIONS_ATTRIBUTEDATA_API_LATEST, EOS_ESessionAttributeAdvertisementType::EOS_SAAT_Advertise, EOS_ESessionAttributeAdvertisementType::EOS_SAAT_DontAdvertise> EOSSessionAttribute;
+
+///<summary>
+/// The settings of the session owned by the local user (or the dedicated server).
+///</summary>
+struct EOSSessionSettings
+{
+    /// <summary>
+    /// The bucket used by the searches to find the session (eg. "Mode:Region").
+    /// </summary>
+    StringAnsi BucketId;
+
+    /// <summary>
+    /// The address the clients connect to (empty to let the backend use the public address of the owner).
+    /// </summary>
+    StringAnsi HostAddress;
+
+    uint32 MaxPlayers = 16;
+    EOS_EOnlineSessionPermissionLevel PermissionLevel = EOS_EOnlineSessionPermissionLevel::EOS_OSPF_PublicAdvertised;
+    bool JoinInProgressAllowed = true;
+    bool InvitesAllowed = true;
+
+    /// <summary>
+    /// True if the session is associated with the presence of the local user. Used only on the creation.
+    /// </summary>
+    bool PresenceEnabled = false;
+
+    /// <summary>
+    /// True if the sanctioned players can't join or get registered. Used only on the creation.
+    /// </summary>
+    bool SanctionsEnabled = false;
+
+    /// <summary>
+    /// Compares the settings sent with the session updates (the ones used only on the creation are ignored).
+    /// </summary>
+    bool UpdatableEquals(const EOSSessionSettings& other) const
+    {
+        return BucketId == other.BucketId &&
+                HostAddress == other.HostAddress &&
+                MaxPlayers == other.MaxPlayers &&
+                PermissionLevel == other.PermissionLevel &&
+                JoinInProgressAllowed == other.JoinInProgressAllowed &&
+                InvitesAllowed == other.InvitesAllowed;
+    }
+};
+
+///<summary>
+/// The statistics of the batched player registrations.
+///</summary>
+struct EOSSessionRegistrationStats
+{
+    /// <summary>
+    /// The amount of the EOS_Sessions_RegisterPlayers and EOS_Sessions_UnregisterPlayers calls made by the batcher.
+    /// </summary>
+    int64 RegisterCalls = 0;
+    int64 UnregisterCalls = 0;
+
+    /// <summary>
+    /// The amount of the players sent with the batched calls.
+    /// </summary>
+    int64 PlayersRegistered = 0;
+    int64 PlayersUnregistered = 0;
+
+    /// <summary>
+    /// The amount of the joins and leaves of the same player within the window that canceled each other (counted as one per pair).
+    /// </summary>
+    int64 CanceledPairs = 0;
+
+    /// <summary>
+    /// The largest batch sent so far.
+    /// </summary>
+    int32 MaxBatchSize = 0;
+
+    float GetAverageBatchSize() const
+    {
+        const int64 calls = RegisterCalls + UnregisterCalls;
+        return calls != 0 ? (float)(PlayersRegistered + PlayersUnregistered) / (float)calls : 0.0f;
+    }
+};
+
+///<summary>
+/// The sessions of the local user (or the dedicated server).
+/// The attributes and the settings of the owned sessions are kept in the local table and the changes are diffed against the state acknowledged by the backend, so only the modified keys are sent.
+/// Changes made within the update window are coalesced into a single update (and the sessions never have more than one update in flight) to stay within the sessions rate limits.
+/// Player joins and leaves queued on the dedicated server are accumulated over the registration window, the join and the leave of the same player cancel each other and the rest is sent with a single call per direction.
+/// Completion callbacks are called from the thread that ticks the platform (with the context locker held).
+///</summary>
+class ONLINEPLATFORMEOS_API EOSSessions
+{
+public:
+    typedef Function<void(EOS_EResult)> Callback;
+
+private:
+    struct Session;
+    struct Operation;
+
+    EOSPlatformContext* _context;
+    Dictionary<StringAnsi, Session*> _sessions;
+    Array<Operation*> _operations;
+    int64 _updateCount = 0;
+    int64 _changeCount = 0;
+    EOSSessionRegistrationStats _registrationStats;
+
+public:
+    EOSSessions(EOSPlatformContext* context);
+    ~EOSSessions();
+
+    /// <summary>
+    /// The time (in seconds) the changes wait for the other changes before the session gets updated. Also the minimal interval between the updates of the session.
+    /// </summary>
+    float UpdateWindow = 1.0f;
+
+    /// <summary>
+    /// The time (in seconds) the queued player joins and leaves are accumulated for before they get registered with the session.
+    /// </summary>
+    float RegistrationWindow = 0.2f;
+
+    /// <summary>
+    /// Event called when the update of the owned session completes (with the session name and the result).
+    /// </summary>
+    Delegate<const StringAnsi&, EOS_EResult> SessionUpdated;
+
+public:
+    /// <summary>
+    /// Creates the session owned by the local user (or the dedicated server) with the given settings and the attributes set so far.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool CreateSession(const StringAnsiView& name, const EOSSessionSettings& settings, const Callback& callback = Callback());
+
+    /// <summary>
+    /// Joins the session found by the search or received with the invite. The details handle is not released.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool JoinSession(const StringAnsiView& name, EOS_HSessionDetails details, bool presenceEnabled, const Callback& callback = Callback());
+
+    /// <summary>
+    /// Leaves the joined session or destroys the owned session. The pending changes are dropped.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool DestroySession(const StringAnsiView& name, const Callback& callback = Callback());
+
+    /// <summary>
+    /// Marks the session as in progress.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool StartSession(const StringAnsiView& name, const Callback& callback = Callback());
+
+    /// <summary>
+    /// Marks the session as ended (it can be started again).
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool EndSession(const StringAnsiView& name, const Callback& callback = Callback());
+
+    /// <summary>
+    /// Registers the players with the session.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool RegisterPlayers(const StringAnsiView& name, const Span<EOS_ProductUserId>& players, const Callback& callback = Callback());
+
+    /// <summary>
+    /// Unregisters the players from the session.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool UnregisterPlayers(const StringAnsiView& name, const Span<EOS_ProductUserId>& players, const Callback& callback = Callback());
+
+    /// <summary>
+    /// Queues the player that joined the server for the registration with the session. Cancels the queued unregistration of the player.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool QueueRegisterPlayer(const StringAnsiView& name, EOS_ProductUserId player);
+
+    /// <summary>
+    /// Queues the player that left the server for the unregistration from the session. Cancels the queued registration of the player.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool QueueUnregisterPlayer(const StringAnsiView& name, EOS_ProductUserId player);
+
+    /// <summary>
+    /// Gets the statistics of the batched player registrations.
+    /// </summary>
+    EOSSessionRegistrationStats GetRegistrationStats();
+
+    /// <summary>
+    /// Sets the attribute of the owned session. Setting the current value does nothing, otherwise the change gets sent with the next update.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool SetAttribute(const StringAnsiView& name, const StringAnsiView& key, const EOSSessionAttribute& value);
+
+    /// <summary>
+    /// Removes the attribute of the owned session. The change gets sent with the next update.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool RemoveAttribute(const StringAnsiView& name, const StringAnsiView& key);
+
+    /// <summary>
+    /// Gets the attribute of the owned session from the local table (including the changes not sent yet).
+    /// </summary>
+    /// <returns>True if the attribute exists, otherwise false.</returns>
+    bool GetAttribute(const StringAnsiView& name, const StringAnsiView& key, EOSSessionAttribute& result);
+
+    /// <summary>
+    /// Changes the settings of the owned session. Only the modified settings get sent with the next update.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool SetSettings(const StringAnsiView& name, const EOSSessionSettings& settings);
+
+    /// <summary>
+    /// Gets the settings of the owned session (including the changes not sent yet).
+    /// </summary>
+    /// <returns>True if the session exists, otherwise false.</returns>
+    bool GetSettings(const StringAnsiView& name, EOSSessionSettings& result);
+
+    /// <summary>
+    /// Gets the backend id of the session (empty until the session gets created or joined).
+    /// </summary>
+    StringAnsi GetSessionId(const StringAnsiView& name);
+
+    /// <summary>
+    /// Gets the state of the session.
+    /// </summary>
+    EOS_EOnlineSessionState GetState(const StringAnsiView& name);
+
+    /// <summary>
+    /// Gets the total amount of the sent session updates (including the creations).
+    /// </summary>
+    int64 GetUpdateCount();
+
+    /// <summary>
+    /// Gets the total amount of the attribute and setting changes made locally. Compared with the update count shows how many changes got coalesced.
+    /// </summary>
+    int64 GetChangeCount();
+
+    /// <summary>
+    /// Removes all the sessions from the local table (doesn't leave them) and cancels the pending operations (without calling their callbacks).
+    /// </summary>
+    void Clear();
+
+    /// <summary>
+    /// Sends the updates and the queued player registrations of the sessions whose windows have passed. Called on every platform tick.
+    /// </summary>
+    void Flush();
+
+private:
+    Session* GetOwnedSession(const StringAnsiView& name);
+    void MarkDirty(Session* session, double now);
+    bool SendUpdate(Session* session, bool create, const Callback& callback);
+    int32 ApplyChanges(Session* session, EOS_HSessionModification modification, bool create);
+    bool QueuePlayer(const StringAnsiView& name, EOS_ProductUserId player, bool registering);
+    bool SendPlayers(const StringAnsi& name, const Span<EOS_ProductUserId>& players, bool registering, bool batched, const Callback& callback);
+    void RequeuePlayers(Operation* operation, EOS_EResult result, bool registering);
+    Operation* BeginOperation(const StringAnsiView& name, const Callback& callback);
+    void EndOperation(Operation* operation, EOS_EResult result);
+
+    static void EOS_CALL OnUpdateSessionComplete(const EOS_Sessions_UpdateSessionCallbackInfo* data);
+    static void EOS_CALL OnJoinSessionComplete(const EOS_Sessions_JoinSessionCallbackInfo* data);
+    static void EOS_CALL OnDestroySessionComplete(const EOS_Sessions_DestroySessionCallbackInfo* data);
+    static void EOS_CALL OnStartSessionComplete(const EOS_Sessions_StartSessionCallbackInfo* data);
+    static void EOS_CALL OnEndSessionComplete(const EOS_Sessions_EndSessionCallbackInfo* data);
+    static void EOS_CALL OnRegisterPlayersComplete(const EOS_Sessions_RegisterPlayersCallbackInfo* data);
+    static void EOS_CALL OnUnregisterPlayersComplete(const EOS_Sessions_UnregisterPlayersCallbackInfo* data);
+};
@@ -0,0 +1,599 @@
+#include "EOSTitleStorage.h"
+#include "EOSPlatformContext.h"
+
+#include "Engine/Core/Log.h"
+#include "Engine/Core/Math/Math.h"
+#include "Engine/Engine/Globals.h"
+#include "Engine/Platform/File.h"
+#include "Engine/Platform/FileSystem.h"
+#include "Engine/Platform/Platform.h"
+#include "Engine/Threading/Threading.h"
+#include <EOSSDK/Include/eos_sdk.h>
+
+#include "EOSSDK/Include/eos_titlestorage.h"
+
+namespace
+{
+    const uint32 MD5Constants[64] =
+    {
+        0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+        0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+        0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+        0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+        0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+        0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+        0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+        0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391,
+    };
+    const byte MD5Shifts[16] = { 7, 12, 17, 22, 5, 9, 14, 20, 4, 11, 16, 23, 6, 10, 15, 21 };
+
+    // Incremental MD5 (RFC 1321) of the downloaded chunks
+    struct MD5
+    {
+        uint32 State[4] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 };
+        uint64 Length = 0;
+        byte Buffer[64];
+
+        void Update(const byte* data, uint32 length)
+        {
+            uint32 index = (uint32)(Length & 63);
+            Length += length;
+            if (index != 0)
+            {
+                const uint32 fill = Math::Min(64 - index, length);
+                Platform::MemoryCopy(Buffer + index, data, fill);
+                data += fill;
+                length -= fill;
+                if (index + fill < 64)
+                    return;
+                Transform(Buffer);
+            }
+            for (; length >= 64; data += 64, length -= 64)
+                Transform(data);
+            if (length != 0)
+                Platform::MemoryCopy(Buffer, data, length);
+        }
+
+        StringAnsi Finish()
+        {
+            const uint64 bits = Length * 8;
+            byte padding[64] = { 0x80 };
+            const uint32 index = (uint32)(Length & 63);
+            Update(padding, index < 56 ? 56 - index : 120 - index);
+            byte size[8];
+            for (int32 i = 0; i < 8; i++)
+                size[i] = (byte)(bits >> (i * 8));
+            Update(size, 8);
+            const char* digits = "0123456789abcdef";
+            char hex[32];
+            for (int32 i = 0; i < 16; i++)
+            {
+                const byte value = (byte)(State[i / 4] >> ((i % 4) * 8));
+                hex[i * 2] = digits[value >> 4];
+                hex[i * 2 + 1] = digits[value & 15];
+            }
+            return StringAnsi(hex, 32);
+        }
+
+        void Transform(const byte* block)
+        {
+            uint32 x[16];
+            for (int32 i = 0; i < 16; i++)
+                x[i] = (uint32)block[i * 4] | (uint32)block[i * 4 + 1] << 8 | (uint32)block[i * 4 + 2] << 16 | (uint32)block[i * 4 + 3] << 24;
+            uint32 a = State[0], b = State[1], c = State[2], d = State[3];
+            for (int32 i = 0; i < 64; i++)
+            {
+                uint32 f, g;
+                if (i < 16)
+                {
+                    f = (b & c) | (~b & d);
+                    g = i;
+                }
+                else if (i < 32)
+                {
+                    f = (d & b) | (~d & c);
+                    g = (5 * i + 1) & 15;
+                }
+                else if (i < 48)
+                {
+                    f = b ^ c ^ d;
+                    g = (3 * i + 5) & 15;
+                }
+                else
+                {
+                    f = c ^ (b | ~d);
+                    g = (7 * i) & 15;
+                }
+                const uint32 shift = MD5Shifts[(i / 16) * 4 + (i % 4)];
+                const uint32 value = a + f + MD5Constants[i] + x[g];
+                a = d;
+                d = c;
+                c = b;
+                b += (value << shift) | (value >> (32 - shift));
+            }
+            State[0] += a;
+            State[1] += b;
+            State[2] += c;
+            State[3] += d;
+        }
+    };
+
+    String GetVersionPath(const String& path)
+    {
+        return path + TEXT(".md5");
+    }
+
+    void CopyMetadata(const EOS_TitleStorage_FileMetadata* metadata, EOSTitleStorageFile& result)
+    {
+        result.Filename = metadata->Filename;
+        result.MD5Hash = metadata->MD5Hash;
+        result.FileSize = metadata->FileSizeBytes;
+        result.DataSize = metadata->UnencryptedDataSizeBytes;
+    }
+}
+
+struct EOSTitleStorage::Transfer
+{
+    EOSTitleStorage* Owner;
+    EOSTitleStorageFile Metadata;
+    String Path;
+    String TempPath;
+    File* Output = nullptr;
+    EOS_HTitleStorageFileTransferRequest Handle = nullptr;
+    MD5 Hash;
+    uint32 Received = 0;
+    Array<FileCallback> Callbacks;
+    bool Canceled = false;
+};
+
+struct EOSTitleStorage::ListQuery
+{
+    EOSTitleStorage* Owner;
+    EOSTitleStorage::Callback Callback;
+    bool Canceled = false;
+};
+
+struct EOSTitleStorage::FileQuery
+{
+    EOSTitleStorage* Owner;
+    StringAnsi Filename;
+    FileCallback Callback;
+    bool Canceled = false;
+};
+
+struct EOSTitleStorage::ReadGroup
+{
+    EOSTitleStorage::Callback Callback;
+    int32 Remaining = 0;
+    EOS_EResult Result = EOS_EResult::EOS_Success;
+};
+
+EOSTitleStorage::EOSTitleStorage(EOSPlatformContext* context)
+    : _context(context)
+{
+}
+
+EOSTitleStorage::~EOSTitleStorage()
+{
+    Clear();
+}
+
+bool EOSTitleStorage::QueryFileList(const Array<StringAnsi>& tags, const Callback& callback)
+{
+    ScopeLock lock(_context->Locker);
+    const auto titleStorage = _context->GetTitleStorage();
+    if (!titleStorage || tags.IsEmpty())
+        return true;
+    Array<const char*, InlinedAllocation<16>> tagsAnsi;
+    for (const StringAnsi& tag : tags)
+        tagsAnsi.Add(tag.Get());
+    auto query = New<ListQuery>();
+    query->Owner = this;
+    query->Callback = callback;
+    _listQueries.Add(query);
+    EOS_TitleStorage_QueryFileListOptions options = {};
+    options.ApiVersion = EOS_TITLESTORAGE_QUERYFILELIST_API_LATEST;
+    options.LocalUserId = _context->ProductUserId;
+    options.ListOfTags = tagsAnsi.Get();
+    options.ListOfTagsCount = tagsAnsi.Count();
+    EOS_TitleStorage_QueryFileList(titleStorage, &options, query, &EOSTitleStorage::OnQueryFileListComplete);
+    return false;
+}
+
+const EOSTitleStorageFile* EOSTitleStorage::FindFile(const StringAnsiView& filename) const
+{
+    // The caller holds the Locker, the file is valid only until it gets released
+    for (const EOSTitleStorageFile& file : _files)
+    {
+        if (file.Filename == filename)
+            return &file;
+    }
+    return nullptr;
+}
+
+bool EOSTitleStorage::ReadFile(const StringAnsiView& filename, const FileCallback& callback)
+{
+    ScopeLock lock(_context->Locker);
+    const auto titleStorage = _context->GetTitleStorage();
+    if (!titleStorage || filename.IsEmpty())
+        return true;
+    EOSTitleStorageFile file;
+    if (TryGetMetadata(filename, file))
+        return Read(file, callback);
+
+    // Unknown file, query its metadata first
+    auto query = New<FileQuery>();
+    query->Owner = this;
+    query->Filename = StringAnsi(filename);
+    query->Callback = callback;
+    _fileQueries.Add(query);
+    EOS_TitleStorage_QueryFileOptions options = {};
+    options.ApiVersion = EOS_TITLESTORAGE_QUERYFILE_API_LATEST;
+    options.LocalUserId = _context->ProductUserId;
+    options.Filename = query->Filename.Get();
+    EOS_TitleStorage_QueryFile(titleStorage, &options, query, &EOSTitleStorage::OnQueryFileComplete);
+    return false;
+}
+
+bool EOSTitleStorage::ReadFiles(const Array<StringAnsi>& filenames, const Callback& callback)
+{
+    ScopeLock lock(_context->Locker);
+    if (!_context->GetTitleStorage())
+        return true;
+
+    // The extra remaining read is the loop itself, so the cached files can't complete the group before all the files got requested
+    auto group = New<ReadGroup>();
+    group->Callback = callback;
+    group->Remaining = filenames.Count() + 1;
+    _groups.Add(group);
+    for (const StringAnsi& filename : filenames)
+    {
+        const bool failed = ReadFile(filename, [this, group](EOS_EResult result, const String& path)
+        {
+            CompleteGroup(group, result);
+        });
+        if (failed)
+            CompleteGroup(group, EOS_EResult::EOS_InvalidParameters);
+    }
+    CompleteGroup(group, EOS_EResult::EOS_Success);
+    return false;
+}
+
+bool EOSTitleStorage::IsCached(const StringAnsiView& filename) const
+{
+    ScopeLock lock(_context->Locker);
+    EOSTitleStorageFile file;
+    return TryGetMetadata(filename, file) && IsCacheValid(file, GetCachePath(filename));
+}
+
+String EOSTitleStorage::GetCachePath(const StringAnsiView& filename) const
+{
+    // Files are kept flat in the cache folder
+    String name(filename.Get(), filename.Length());
+    name.Replace(TEXT('/'), TEXT('_'));
+    name.Replace(TEXT('\\'), TEXT('_'));
+    name.Replace(TEXT(':'), TEXT('_'));
+    return GetCacheFolder() / name;
+}
+
+void EOSTitleStorage::CancelDownloads()
+{
+    ScopeLock lock(_context->Locker);
+
+    // The queued ones go first, so completing the active ones doesn't start them (the callbacks may start new downloads that are kept)
+    Array<Transfer*> transfers(_queued);
+    for (auto i = _transfers.Begin(); i.IsNotEnd(); ++i)
+    {
+        if (!_queued.Contains(i->Value))
+            transfers.Add(i->Value);
+    }
+    for (Transfer* transfer : transfers)
+    {
+        // Skip the ones already completed by the callbacks (eg. the nested cancel)
+        Transfer* current;
+        if (!_transfers.TryGet(transfer->Metadata.Filename, current) || current != transfer)
+            continue;
+        if (transfer->Handle)
+        {
+            transfer->Canceled = true;
+            EOS_TitleStorageFileTransferRequest_CancelRequest(transfer->Handle);
+        }
+        CompleteTransfer(transfer, EOS_EResult::EOS_Canceled);
+    }
+}
+
+void EOSTitleStorage::Clear()
+{
+    ScopeLock lock(_context->Locker);
+    CancelDownloads();
+
+    // Queries are owned by the SDK callbacks that may still be in-flight
+    const Array<ListQuery*> listQueries = MoveTemp(_listQueries);
+    const Array<FileQuery*> fileQueries = MoveTemp(_fileQueries);
+    _files.Clear();
+    for (ListQuery* query : listQueries)
+    {
+        query->Canceled = true;
+        if (query->Callback.IsBinded())
+            query->Callback(EOS_EResult::EOS_Canceled);
+    }
+    for (FileQuery* query : fileQueries)
+    {
+        query->Canceled = true;
+        query->Callback(EOS_EResult::EOS_Canceled, String::Empty);
+    }
+    _groups.ClearDelete();
+}
+
+String EOSTitleStorage::GetCacheFolder() const
+{
+    return CacheFolder.HasChars() ? CacheFolder : Globals::ProductLocalFolder / String(TEXT("EOS/TitleStorage"));
+}
+
+bool EOSTitleStorage::TryGetMetadata(const StringAnsiView& filename, EOSTitleStorageFile& result) const
+{
+    ScopeLock lock(_context->Locker);
+    const EOSTitleStorageFile* file = FindFile(filename);
+    if (file)
+    {
+        result = *file;
+        return true;
+    }
+
+    // The SDK keeps the metadata of all the queried files (eg. by the startup warm-up)
+    const auto titleStorage = _context->GetTitleStorage();
+    if (!titleStorage)
+        return false;
+    const StringAnsi filenameAnsi(filename);
+    EOS_TitleStorage_CopyFileMetadataByFilenameOptions options = {};
+    options.ApiVersion = EOS_TITLESTORAGE_COPYFILEMETADATABYFILENAME_API_LATEST;
+    options.LocalUserId = _context->ProductUserId;
+    options.Filename = filenameAnsi.Get();
+    EOS_TitleStorage_FileMetadata* metadata;
+    if (EOS_TitleStorage_CopyFileMetadataByFilename(titleStorage, &options, &metadata) != EOS_EResult::EOS_Success)
+        return false;
+    CopyMetadata(metadata, result);
+    EOS_TitleStorage_FileMetadata_Release(metadata);
+    return true;
+}
+
+bool EOSTitleStorage::IsCacheValid(const EOSTitleStorageFile& file, const String& path) const
+{
+    // The cached file is valid as long as the hash from the metadata matches the one it was downloaded with
+    if (file.MD5Hash.IsEmpty() || !FileSystem::FileExists(path) || FileSystem::GetFileSize(path) != (uint64)file.DataSize)
+        return false;
+    Array<byte> version;
+    if (File::ReadAllBytes(GetVersionPath(path), version))
+        return false;
+    return StringAnsi((const char*)version.Get(), version.Count()).Compare(file.MD5Hash, StringSearchCase::IgnoreCase) == 0;
+}
+
+bool EOSTitleStorage::Read(const EOSTitleStorageFile& file, const FileCallback& callback)
+{
+    const String path = GetCachePath(file.Filename);
+    if (IsCacheValid(file, path))
+    {
+        callback(EOS_EResult::EOS_Success, path);
+        return false;
+    }
+
+    Transfer* transfer;
+    if (_transfers.TryGet(file.Filename, transfer))
+    {
+        transfer->Callbacks.Add(callback);
+        return false;
+    }
+    transfer = New<Transfer>();
+    transfer->Owner = this;
+    transfer->Metadata = file;
+    transfer->Path = path;
+    transfer->TempPath = path + TEXT(".part");
+    transfer->Callbacks.Add(callback);
+    _transfers.Add(file.Filename, transfer);
+    _queued.Add(transfer);
+    StartQueued();
+    return false;
+}
+
+void EOSTitleStorage::StartQueued()
+{
+    if (_queued.IsEmpty() || _activeCount >= Math::Max(MaxParallelDownloads, 1))
+        return;
+    const auto titleStorage = _context->GetTitleStorage();
+    FileSystem::CreateDirectory(GetCacheFolder());
+    while (_queued.HasItems() && _activeCount < Math::Max(MaxParallelDownloads, 1))
+    {
+        Transfer* transfer = _queued[0];
+        _queued.RemoveAtKeepOrder(0);
+        _activeCount++;
+
+        // Chunks are streamed into the temporary file, so the cached one gets replaced only once the new one is verified
+        transfer->Output = titleStorage ? File::Open(transfer->TempPath, FileMode::CreateAlways, FileAccess::Write) : nullptr;
+        if (!transfer->Output)
+        {
+            LOG(Warning, "EOS failed to open the Title Storage cache file {0}", transfer->TempPath);
+            CompleteTransfer(transfer, EOS_EResult::EOS_UnexpectedError);
+            return;
+        }
+        EOS_TitleStorage_ReadFileOptions options = {};
+        options.ApiVersion = EOS_TITLESTORAGE_READFILE_API_LATEST;
+        options.LocalUserId = _context->ProductUserId;
+        options.Filename = transfer->Metadata.Filename.Get();
+        options.ReadChunkLengthBytes = Math::Max(ChunkSize, 1024u);
+        options.ReadFileDataCallback = &EOSTitleStorage::OnReadFileData;
+        options.FileTransferProgressCallback = &EOSTitleStorage::OnFileTransferProgress;
+        transfer->Handle = EOS_TitleStorage_ReadFile(titleStorage, &options, transfer, &EOSTitleStorage::OnReadFileComplete);
+    }
+}
+
+EOS_EResult EOSTitleStorage::Verify(Transfer* transfer)
+{
+    const EOSTitleStorageFile& file = transfer->Metadata;
+    if (transfer->Received != file.DataSize)
+        return EOS_EResult::EOS_TitleStorage_FileCorrupted;
+
+    // The plain files are downloaded as they are stored, so they must match the hash from the metadata
+    // The hash of the encrypted file covers the stored data, not the decrypted one received here, so those are verified only by the size (the SDK fails the ones that can't be decrypted)
+    if (file.FileSize == file.DataSize && transfer->Hash.Finish().Compare(file.MD5Hash, StringSearchCase::IgnoreCase) != 0)
+        return EOS_EResult::EOS_TitleStorage_FileCorrupted;
+    return EOS_EResult::EOS_Success;
+}
+
+void EOSTitleStorage::CompleteTransfer(Transfer* transfer, EOS_EResult result)
+{
+    // Only the canceled downloads complete before they get started
+    const int32 queuedIndex = _queued.Find(transfer);
+    if (queuedIndex != -1)
+        _queued.RemoveAtKeepOrder(queuedIndex);
+    else
+        _activeCount--;
+    _transfers.Remove(transfer->Metadata.Filename);
+    if (result == EOS_EResult::EOS_Success)
+        result = Verify(transfer);
+    if (result == EOS_EResult::EOS_Success)
+    {
+        // Replace the cached file and remember the version it was downloaded with
+        const String versionPath = GetVersionPath(transfer->Path);
+        FileSystem::DeleteFile(versionPath);
+        if (FileSystem::MoveFile(transfer->Path, transfer->TempPath, true) ||
+            File::WriteAllBytes(versionPath, transfer->Metadata.MD5Hash.Get(), transfer->Metadata.MD5Hash.Length()))
+            result = EOS_EResult::EOS_UnexpectedError;
+    }
+    if (result != EOS_EResult::EOS_Success && result != EOS_EResult::EOS_Canceled)
+    {
+        LOG(Warning, "EOS failed to read Title Storage file {0}: {1}", String(transfer->Metadata.Filename), String(EOS_EResult_ToString(result)));
+        FileSystem::DeleteFile(transfer->TempPath);
+    }
+
+    // Keep the downloads going before calling back
+    StartQueued();
+    const String path = result == EOS_EResult::EOS_Success ? transfer->Path : String::Empty;
+    for (const FileCallback& callback : transfer->Callbacks)
+        callback(result, path);
+
+    // The canceled download in progress is released (and its temporary file removed) when the read completes
+    if (!transfer->Canceled)
+        Delete(transfer);
+}
+
+void EOSTitleStorage::CompleteGroup(ReadGroup* group, EOS_EResult result)
+{
+    if (result != EOS_EResult::EOS_Success && group->Result == EOS_EResult::EOS_Success)
+        group->Result = result;
+    if (--group->Remaining != 0)
+        return;
+    _groups.Remove(group);
+    if (group->Callback.IsBinded())
+        group->Callback(group->Result);
+    Delete(group);
+}
+
+void EOSTitleStorage::OnQueryFileListComplete(const EOS_TitleStorage_QueryFileListCallbackInfo* data)
+{
+    const auto query = (ListQuery*)data->ClientData;
+    if (!query->Canceled)
+    {
+        EOSTitleStorage* titleStorage = query->Owner;
+        titleStorage->_listQueries.Remove(query);
+        if (data->ResultCode == EOS_EResult::EOS_Success)
+        {
+            const auto handle = titleStorage->_context->GetTitleStorage();
+            EOS_TitleStorage_GetFileMetadataCountOptions countOptions = {};
+            countOptions.ApiVersion = EOS_TITLESTORAGE_GETFILEMETADATACOUNT_API_LATEST;
+            countOptions.LocalUserId = titleStorage->_context->ProductUserId;
+            const uint32 count = EOS_TitleStorage_GetFileMetadataCount(handle, &countOptions);
+            titleStorage->_files.Clear();
+            titleStorage->_files.EnsureCapacity((int32)count);
+            EOS_TitleStorage_CopyFileMetadataAtIndexOptions options = {};
+            options.ApiVersion = EOS_TITLESTORAGE_COPYFILEMETADATAATINDEX_API_LATEST;
+            options.LocalUserId = titleStorage->_context->ProductUserId;
+            for (uint32 i = 0; i < count; i++)
+            {
+                options.Index = i;
+                EOS_TitleStorage_FileMetadata* metadata;
+                if (EOS_TitleStorage_CopyFileMetadataAtIndex(handle, &options, &metadata) != EOS_EResult::EOS_Success)
+                    continue;
+                CopyMetadata(metadata, titleStorage->_files.AddOne());
+                EOS_TitleStorage_FileMetadata_Release(metadata);
+            }
+        }
+        else
+        {
+            LOG(Warning, "EOS failed to query Title Storage file list: {0}", String(EOS_EResult_ToString(data->ResultCode)));
+        }
+        if (query->Callback.IsBinded())
+            query->Callback(data->ResultCode);
+    }
+    Delete(query);
+}
+
+void EOSTitleStorage::OnQueryFileComplete(const EOS_TitleStorage_QueryFileCallbackInfo* data)
+{
+    const auto query = (FileQuery*)data->ClientData;
+    if (!query->Canceled)
+    {
+        EOSTitleStorage* titleStorage = query->Owner;
+        titleStorage->_fileQueries.Remove(query);
+        EOSTitleStorageFile file;
+        EOS_EResult result = data->ResultCode;
+        if (result == EOS_EResult::EOS_Success && !titleStorage->TryGetMetadata(query->Filename, file))
+            result = EOS_EResult::EOS_NotFound;
+        if (result != EOS_EResult::EOS_Success)
+        {
+            LOG(Warning, "EOS failed to query Title Storage file {0}: {1}", String(query->Filename), String(EOS_EResult_ToString(result)));
+            query->Callback(result, String::Empty);
+        }
+        else if (titleStorage->Read(file, query->Callback))
+        {
+            query->Callback(EOS_EResult::EOS_UnexpectedError, String::Empty);
+        }
+    }
+    Delete(query);
+}
+
+EOS_TitleStorage_EReadResult EOSTitleStorage::OnReadFileData(const EOS_TitleStorage_ReadFileDataCallbackInfo* data)
+{
+    const auto transfer = (Transfer*)data->ClientData;
+    if (transfer->Canceled)
+        return EOS_TitleStorage_EReadResult::EOS_TS_RR_CancelRequest;
+    if (data->DataChunkLengthBytes != 0)
+    {
+        if (transfer->Output->Write(data->DataChunk, data->DataChunkLengthBytes))
+        {
+            LOG(Warning, "EOS failed to write the Title Storage cache file {0}", transfer->TempPath);
+            return EOS_TitleStorage_EReadResult::EOS_TS_RR_FailRequest;
+        }
+        transfer->Hash.Update((const byte*)data->DataChunk, data->DataChunkLengthBytes);
+        transfer->Received += data->DataChunkLengthBytes;
+    }
+    return EOS_TitleStorage_EReadResult::EOS_TS_RR_ContinueReading;
+}
+
+void EOSTitleStorage::OnFileTransferProgress(const EOS_TitleStorage_FileTransferProgressCallbackInfo* data)
+{
+    const auto transfer = (Transfer*)data->ClientData;
+    if (!transfer->Canceled)
+        transfer->Owner->DownloadProgress(transfer->Metadata.Filename, data->BytesTransferred, data->TotalFileSizeBytes);
+}
+
+void EOSTitleStorage::OnReadFileComplete(const EOS_TitleStorage_ReadFileCallbackInfo* data)
+{
+    const auto transfer = (Transfer*)data->ClientData;
+    if (transfer->Output)
+    {
+        Delete(transfer->Output);
+        transfer->Output = nullptr;
+    }
+    if (transfer->Handle)
+    {
+        EOS_TitleStorageFileTransferRequest_Release(transfer->Handle);
+        transfer->Handle = nullptr;
+    }
+    if (transfer->Canceled)
+    {
+        FileSystem::DeleteFile(transfer->TempPath);
+        Delete(transfer);
+        return;
+    }
+    transfer->Owner->CompleteTransfer(transfer, data->ResultCode);
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include "Engine/Core/Collections/Array.h"
+#include "Engine/Core/Collections/Dictionary.h"
+#include "Engine/Core/Delegate.h"
+#include "Engine/Core/Types/String.h"
+#include "EOSSDK/Include/eos_titlestorage_types.h"
+
+class EOSPlatformContext;
+
+///<summary>
+/// The metadata of the Title Storage file.
+///</summary>
+struct EOSTitleStorageFile
+{
+    StringAnsi Filename;
+
+    /// <summary>
+    /// The MD5 hash (hex digits) of the stored file. Identifies the version of the file in the local cache.
+    /// The downloads of the plain files are verified against it. The encrypted files (FileSize differs from DataSize) are downloaded decrypted, so they are verified only by the size (the SDK fails the ones that can't be decrypted).
+    /// </summary>
+    StringAnsi MD5Hash;
+
+    /// <summary>
+    /// The size of the stored file (including the file header).
+    /// </summary>
+    uint32 FileSize = 0;
+
+    /// <summary>
+    /// The size of the file data (unencrypted), the size of the downloaded file.
+    /// </summary>
+    uint32 DataSize = 0;
+};
+
+///<summary>
+/// The Title Storage content service (eg. the live-ops config, playlists or localization) with the local cache on disk.
+/// Files are downloaded in parallel (up to MaxParallelDownloads) and their chunks are streamed straight to the disk and hashed on the way, so the downloads don't buffer whole files in memory and don't read them back for the verification.
+/// Every cached file keeps the hash from the metadata it was downloaded with, so the reads are served from the disk as long as the metadata doesn't change (no download on every launch).
+/// Callbacks are called from the thread that ticks the platform (with the context locker held). Hold the context locker while reading the listed files from the other thread.
+///</summary>
+class ONLINEPLATFORMEOS_API EOSTitleStorage
+{
+public:
+    typedef Function<void(EOS_EResult)> Callback;
+    typedef Function<void(EOS_EResult, const String&)> FileCallback;
+
+private:
+    struct Transfer;
+    struct ListQuery;
+    struct FileQuery;
+    struct ReadGroup;
+
+    EOSPlatformContext* _context;
+    Array<EOSTitleStorageFile> _files;
+    Dictionary<StringAnsi, Transfer*> _transfers;
+    Array<Transfer*> _queued;
+    Array<ListQuery*> _listQueries;
+    Array<FileQuery*> _fileQueries;
+    Array<ReadGroup*> _groups;
+    int32 _activeCount = 0;
+
+public:
+    EOSTitleStorage(EOSPlatformContext* context);
+    ~EOSTitleStorage();
+
+    /// <summary>
+    /// The folder of the local cache. Empty to use the EOS/TitleStorage folder in the product local folder.
+    /// </summary>
+    String CacheFolder;
+
+    /// <summary>
+    /// The maximum amount of the files downloaded at once.
+    /// </summary>
+    int32 MaxParallelDownloads = 4;
+
+    /// <summary>
+    /// The size (in bytes) of the chunks streamed to the disk.
+    /// </summary>
+    uint32 ChunkSize = 64 * 1024;
+
+    /// <summary>
+    /// Event called when the download progresses (the file, the downloaded bytes and the size of the file).
+    /// </summary>
+    Delegate<const StringAnsi&, uint32, uint32> DownloadProgress;
+
+public:
+    /// <summary>
+    /// Queries the list of the files with the tags.
+    /// </summary>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool QueryFileList(const Array<StringAnsi>& tags, const Callback& callback);
+
+    /// <summary>
+    /// Gets the files found by the last file list query.
+    /// </summary>
+    FORCE_INLINE const Array<EOSTitleStorageFile>& GetFiles() const
+    {
+        return _files;
+    }
+
+    /// <summary>
+    /// Gets the metadata of the file found by the file list query (or by any other query of the file).
+    /// </summary>
+    /// <param name="filename">The file.</param>
+    /// <param name="result">The metadata of the file.</param>
+    /// <returns>True if found, otherwise false.</returns>
+    bool TryGetMetadata(const StringAnsiView& filename, EOSTitleStorageFile& result) const;
+
+    /// <summary>
+    /// Reads the file. Calls back immediately with the path of the cached file if its metadata didn't change, otherwise the file gets downloaded (concurrent reads of the same file share the download).
+    /// The metadata gets queried first if the file isn't known yet (eg. wasn't listed by the file list query).
+    /// </summary>
+    /// <param name="filename">The file.</param>
+    /// <param name="callback">The callback to call with the path of the verified local file (empty if failed).</param>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool ReadFile(const StringAnsiView& filename, const FileCallback& callback);
+
+    /// <summary>
+    /// Reads the many files at once (eg. all the listed ones on the startup). The outdated ones get downloaded in parallel.
+    /// </summary>
+    /// <param name="filenames">The files.</param>
+    /// <param name="callback">The callback to call once all the files are ready. Gets the first error if any of the files failed.</param>
+    /// <returns>True if failed, otherwise false.</returns>
+    bool ReadFiles(const Array<StringAnsi>& filenames, const Callback& callback);
+
+    /// <summary>
+    /// Checks if the file is cached with its current metadata (the read won't download it).
+    /// </summary>
+    bool IsCached(const StringAnsiView& filename) const;
+
+    /// <summary>
+    /// Gets the path of the file in the local cache.
+    /// </summary>
+    String GetCachePath(const StringAnsiView& filename) const;
+
+    /// <summary>
+    /// Gets the amount of the downloads in progress or queued.
+    /// </summary>
+    FORCE_INLINE int32 GetDownloadCount() const
+    {
+        return _transfers.Count();
+    }
+
+    /// <summary>
+    /// Cancels the downloads (their callbacks get EOS_Canceled). The cached files are kept.
+    /// </summary>
+    void CancelDownloads();
+
+    /// <summary>
+    /// Cancels the downloads and the queries (their callbacks get EOS_Canceled) and removes the listed files. The cached files are kept.
+    /// </summary>
+    void Clear();
+
+private:
+    String GetCacheFolder() const;
+    const EOSTitleStorageFile* FindFile(const StringAnsiView& filename) const;
+    bool IsCacheValid(const EOSTitleStorageFile& file, const String& path) const;
+    bool Read(const EOSTitleStorageFile& file, const FileCallback& callback);
+    void StartQueued();
+    EOS_EResult Verify(Transfer* transfer);
+    void CompleteTransfer(Transfer* transfer, EOS_EResult result);
+    void CompleteGroup(ReadGroup* group, EOS_EResult result);
+
+    static void EOS_CALL OnQueryFileListComplete(const EOS_TitleStorage_QueryFileListCallbackInfo* data);
+    static void EOS_CALL OnQueryFileComplete(const EOS_TitleStorage_QueryFileCallbackInfo* data);
+    static EOS_TitleStorage_EReadResult EOS_CALL OnReadFileData(const EOS_TitleStorage_ReadFileDataCallbackInfo* data);
+    static void EOS_CALL OnFileTransferProgress(const EOS_TitleStorage_FileTransferProgressCallbackInfo* data);
+    static void EOS_CALL OnReadFileComplete(const EOS_TitleStorage_ReadFileCallbackInfo* data);
+};
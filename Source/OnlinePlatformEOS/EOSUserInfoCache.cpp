@@ -0,0 +1,343 @@
+#include "EOSUserInfoCache.h"
+#include "EOSAccountIdTable.h"
+#include "EOSPlatformContext.h"
+
+#include "Engine/Core/Log.h"
+#include "Engine/Platform/Platform.h"
+#include "Engine/Threading/Threading.h"
+#include "Engine/Utilities/StringConverter.h"
+#include <EOSSDK/Include/eos_sdk.h>
+
+#include "EOSSDK/Include/eos_userinfo.h"
+
+struct EOSUserInfoCache::Batch
+{
+    Array<EOS_EpicAccountId> AccountIds;
+    int32 Remaining = 0;
+    ResolveCallback Callback;
+};
+
+struct EOSUserInfoCache::NameRequest
+{
+    EOSUserInfoCache* Cache;
+    String Key;
+    Array<ResolveUserCallback, InlinedAllocation<1>> Callbacks;
+    bool Canceled = false;
+};
+
+EOSUserInfoCache::EOSUserInfoCache(EOSPlatformContext* context)
+    : _context(context)
+{
+}
+
+EOSUserInfoCache::~EOSUserInfoCache()
+{
+    Clear();
+    _nameRequests.ClearDelete();
+}
+
+bool EOSUserInfoCache::TryGet(EOS_EpicAccountId accountId, EOSUserInfo& result)
+{
+    ScopeLock lock(_locker);
+    const EOSUserInfo* entry = _entries.TryGet(accountId);
+    if (!entry || !IsValid(*entry, Platform::GetTimeSeconds()))
+        return false;
+    result = *entry;
+    return true;
+}
+
+void EOSUserInfoCache::Resolve(const Span<EOS_EpicAccountId>& accountIds, const ResolveCallback& callback)
+{
+    const auto userInfo = _context->GetUserInfo();
+    Array<EOS_EpicAccountId, InlinedAllocation<64>> toQuery;
+    Array<EOS_EpicAccountId, InlinedAllocation<64>> cached;
+    Array<EOSUserInfo> results;
+    Batch* batch = nullptr;
+    {
+        ScopeLock lock(_locker);
+        const double now = Platform::GetTimeSeconds();
+        for (int32 i = 0; i < accountIds.Length(); i++)
+        {
+            const EOS_EpicAccountId accountId = accountIds[i];
+            if (!accountId)
+                continue;
+            const EOSUserInfo* entry = _entries.TryGet(accountId);
+            if (entry && IsValid(*entry, now))
+            {
+                cached.Add(accountId);
+                if (callback.IsBinded())
+                    results.Add(*entry);
+                continue;
+            }
+            if (!userInfo)
+                continue;
+
+            // Missing users are collected into the batch that waits for all of them
+            if (!batch)
+            {
+                batch = New<Batch>();
+                batch->Callback = callback;
+                _batches.Add(batch);
+            }
+            batch->AccountIds.Add(accountId);
+            batch->Remaining++;
+            auto& waiting = _pending[accountId];
+            if (waiting.IsEmpty())
+                toQuery.Add(accountId);
+            waiting.Add(batch);
+        }
+        if (batch)
+            batch->AccountIds.Add(cached);
+    }
+    if (!batch)
+    {
+        if (callback.IsBinded())
+            callback(results);
+        return;
+    }
+
+    for (const EOS_EpicAccountId accountId : toQuery)
+    {
+        EOS_UserInfo_QueryUserInfoOptions options = {};
+        options.ApiVersion = EOS_USERINFO_QUERYUSERINFO_API_LATEST;
+        options.LocalUserId = _context->AccountId;
+        options.TargetUserId = accountId;
+        EOS_UserInfo_QueryUserInfo(userInfo, &options, this, &EOSUserInfoCache::OnQueryUserInfoComplete);
+    }
+}
+
+void EOSUserInfoCache::ResolveByDisplayName(const StringView& displayName, const ResolveUserCallback& callback)
+{
+    NameRequest* request = StartNameRequest(String(TEXT("name:")) + displayName, callback);
+    if (!request)
+        return;
+    const StringAsANSI<> displayNameAnsi(displayName.Get(), displayName.Length());
+    EOS_UserInfo_QueryUserInfoByDisplayNameOptions options = {};
+    options.ApiVersion = EOS_USERINFO_QUERYUSERINFOBYDISPLAYNAME_API_LATEST;
+    options.LocalUserId = _context->AccountId;
+    options.DisplayName = displayNameAnsi.Get();
+    EOS_UserInfo_QueryUserInfoByDisplayName(_context->GetUserInfo(), &options, request, &EOSUserInfoCache::OnQueryUserInfoByDisplayNameComplete);
+}
+
+void EOSUserInfoCache::ResolveByExternalAccount(const StringView& externalAccountId, EOS_EExternalAccountType accountType, const ResolveUserCallback& callback)
+{
+    NameRequest* request = StartNameRequest(String::Format(TEXT("{0}:{1}"), (int32)accountType, externalAccountId), callback);
+    if (!request)
+        return;
+    const StringAsANSI<> externalAccountIdAnsi(externalAccountId.Get(), externalAccountId.Length());
+    EOS_UserInfo_QueryUserInfoByExternalAccountOptions options = {};
+    options.ApiVersion = EOS_USERINFO_QUERYUSERINFOBYEXTERNALACCOUNT_API_LATEST;
+    options.LocalUserId = _context->AccountId;
+    options.ExternalAccountId = externalAccountIdAnsi.Get();
+    options.AccountType = accountType;
+    EOS_UserInfo_QueryUserInfoByExternalAccount(_context->GetUserInfo(), &options, request, &EOSUserInfoCache::OnQueryUserInfoByExternalAccountComplete);
+}
+
+void EOSUserInfoCache::Invalidate(EOS_EpicAccountId accountId)
+{
+    ScopeLock lock(_locker);
+    _entries.Remove(accountId);
+}
+
+void EOSUserInfoCache::Clear()
+{
+    ScopeLock lock(_locker);
+    _entries.Clear();
+    _pending.Clear();
+    _names.Clear();
+    _batches.ClearDelete();
+
+    // Name requests are owned by the SDK callbacks that may still be in-flight
+    for (auto request : _nameRequests)
+        request->Canceled = true;
+}
+
+EOSUserInfoCache::NameRequest* EOSUserInfoCache::StartNameRequest(const String& key, const ResolveUserCallback& callback)
+{
+    // The interface is got before locking, its lazy creation takes the context locker
+    const auto userInfo = _context->GetUserInfo();
+    EOSUserInfo result;
+    bool found = false;
+    NameRequest* request = nullptr;
+    {
+        ScopeLock lock(_locker);
+        EOS_EpicAccountId accountId;
+        const EOSUserInfo* entry = _names.TryGet(key, accountId) ? _entries.TryGet(accountId) : nullptr;
+        if (entry && IsValid(*entry, Platform::GetTimeSeconds()))
+        {
+            result = *entry;
+            found = true;
+        }
+        else
+        {
+            // Concurrent lookups of the same user share the query in flight
+            for (auto e : _nameRequests)
+            {
+                if (e->Key == key && !e->Canceled)
+                {
+                    e->Callbacks.Add(callback);
+                    return nullptr;
+                }
+            }
+            if (userInfo)
+            {
+                request = New<NameRequest>();
+                request->Cache = this;
+                request->Key = key;
+                request->Callbacks.Add(callback);
+                _nameRequests.Add(request);
+            }
+        }
+    }
+    if (!request)
+        callback(found ? &result : nullptr);
+    return request;
+}
+
+bool EOSUserInfoCache::IsValid(const EOSUserInfo& entry, double now) const
+{
+    return now - entry.FetchTime <= (double)TimeToLive;
+}
+
+bool EOSUserInfoCache::Store(EOS_EpicAccountId accountId, double now)
+{
+    EOS_UserInfo_CopyUserInfoOptions options = {};
+    options.ApiVersion = EOS_USERINFO_COPYUSERINFO_API_LATEST;
+    options.LocalUserId = _context->AccountId;
+    options.TargetUserId = accountId;
+    EOS_UserInfo* info;
+    const EOS_EResult result = EOS_UserInfo_CopyUserInfo(_context->GetUserInfo(), &options, &info);
+    if (result != EOS_EResult::EOS_Success)
+    {
+        LOG(Error, "EOS failed to copy user info: {0}", String(EOS_EResult_ToString(result)));
+        return true;
+    }
+
+    // Evict the expired entries first and the oldest one if still full
+    if (_entries.Count() >= MaxEntries && !_entries.ContainsKey(accountId))
+    {
+        for (auto i = _entries.Begin(); i.IsNotEnd(); ++i)
+        {
+            if (!IsValid(i->Value, now))
+                _entries.Remove(i);
+        }
+        if (_entries.Count() >= MaxEntries)
+        {
+            auto oldest = _entries.Begin();
+            for (auto i = _entries.Begin(); i.IsNotEnd(); ++i)
+            {
+                if (i->Value.FetchTime < oldest->Value.FetchTime)
+                    oldest = i;
+            }
+            if (oldest.IsNotEnd())
+                _entries.Remove(oldest);
+        }
+
+        // Names of the evicted users go with them
+        for (auto i = _names.Begin(); i.IsNotEnd(); ++i)
+        {
+            if (!_entries.ContainsKey(i->Value))
+                _names.Remove(i);
+        }
+    }
+
+    EOSUserInfo& entry = _entries[accountId];
+    entry.AccountId = accountId;
+    entry.Id = EOSAccountIdTable::GetId(accountId);
+    entry.DisplayName = String(info->DisplayName);
+    entry.Nickname = String(info->Nickname);
+    entry.Country = String(info->Country);
+    entry.PreferredLanguage = String(info->PreferredLanguage);
+    entry.FetchTime = now;
+    EOS_UserInfo_Release(info);
+    return false;
+}
+
+void EOSUserInfoCache::CompleteQuery(EOS_EpicAccountId accountId, bool success)
+{
+    Array<Batch*> done;
+    {
+        ScopeLock lock(_locker);
+        if (success)
+            Store(accountId, Platform::GetTimeSeconds());
+        Array<Batch*> waiting;
+        if (!_pending.TryGet(accountId, waiting))
+            return;
+        _pending.Remove(accountId);
+        for (auto batch : waiting)
+        {
+            if (--batch->Remaining == 0)
+            {
+                _batches.Remove(batch);
+                done.Add(batch);
+            }
+        }
+    }
+
+    for (auto batch : done)
+    {
+        if (batch->Callback.IsBinded())
+        {
+            Array<EOSUserInfo> results;
+            {
+                // Results include the users that were already cached when the batch started
+                ScopeLock lock(_locker);
+                results.EnsureCapacity(batch->AccountIds.Count());
+                for (const EOS_EpicAccountId id : batch->AccountIds)
+                {
+                    const EOSUserInfo* entry = _entries.TryGet(id);
+                    if (entry)
+                        results.Add(*entry);
+                }
+            }
+            batch->Callback(results);
+        }
+        Delete(batch);
+    }
+}
+
+void EOSUserInfoCache::CompleteNameRequest(NameRequest* request, EOS_EpicAccountId accountId, bool success)
+{
+    EOSUserInfo result;
+    bool found = false;
+    {
+        ScopeLock lock(_locker);
+        _nameRequests.Remove(request);
+        if (success && !request->Canceled && !Store(accountId, Platform::GetTimeSeconds()))
+        {
+            _names[request->Key] = accountId;
+            result = _entries[accountId];
+            found = true;
+        }
+    }
+    if (!request->Canceled)
+    {
+        for (const ResolveUserCallback& callback : request->Callbacks)
+            callback(found ? &result : nullptr);
+    }
+    Delete(request);
+}
+
+void EOSUserInfoCache::OnQueryUserInfoComplete(const EOS_UserInfo_QueryUserInfoCallbackInfo* data)
+{
+    const auto cache = (EOSUserInfoCache*)data->ClientData;
+    if (data->ResultCode != EOS_EResult::EOS_Success)
+        LOG(Warning, "EOS failed to query user info: {0}", String(EOS_EResult_ToString(data->ResultCode)));
+    cache->CompleteQuery(data->TargetUserId, data->ResultCode == EOS_EResult::EOS_Success);
+}
+
+void EOSUserInfoCache::OnQueryUserInfoByDisplayNameComplete(const EOS_UserInfo_QueryUserInfoByDisplayNameCallbackInfo* data)
+{
+    const auto request = (NameRequest*)data->ClientData;
+    if (data->ResultCode != EOS_EResult::EOS_Success)
+        LOG(Warning, "EOS failed to query user info by display name: {0}", String(EOS_EResult_ToString(data->ResultCode)));
+    request->Cache->CompleteNameRequest(request, data->TargetUserId, data->ResultCode == EOS_EResult::EOS_Success);
+}
+
+void EOSUserInfoCache::OnQueryUserInfoByExternalAccountComplete(const EOS_UserInfo_QueryUserInfoByExternalAccountCallbackInfo* data)
+{
+    const auto request = (NameRequest*)data->ClientData;
+    if (data->ResultCode != EOS_EResult::EOS_Success)
+        LOG(Warning, "EOS failed to query user info by external account: {0}", String(EOS_EResult_ToString(data->ResultCode)));
+    request->Cache->CompleteNameRequest(request, data->TargetUserId, data->ResultCode == EOS_EResult::EOS_Success);
+}
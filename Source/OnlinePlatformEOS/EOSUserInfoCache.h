@@ -0,0 +1,113 @@
+#pragma once
+
+#include "Engine/Core/Collections/Array.h"
+#include "Engine/Core/Collections/Dictionary.h"
+#include "Engine/Core/Delegate.h"
+#include "Engine/Core/Types/Guid.h"
+#include "Engine/Core/Types/Span.h"
+#include "Engine/Core/Types/String.h"
+#include "Engine/Platform/CriticalSection.h"
+#include "EOSSDK/Include/eos_userinfo_types.h"
+
+class EOSPlatformContext;
+
+///<summary>
+/// The cached information about the Epic account.
+///</summary>
+struct EOSUserInfo
+{
+    EOS_EpicAccountId AccountId = nullptr;
+    Guid Id;
+    String DisplayName;
+    String Nickname;
+    String Country;
+    String PreferredLanguage;
+    double FetchTime = 0.0;
+};
+
+///<summary>
+/// Cache of the Epic account user information (display names etc.) with the time-to-live and size bounds.
+/// Lookups of many users at once are resolved in a single pass: cached users are returned immediately and the missing ones are queried concurrently. Concurrent lookups of the same user share a single query.
+///</summary>
+class ONLINEPLATFORMEOS_API EOSUserInfoCache
+{
+public:
+    typedef Function<void(const Array<EOSUserInfo>&)> ResolveCallback;
+    typedef Function<void(const EOSUserInfo*)> ResolveUserCallback;
+
+private:
+    struct Batch;
+    struct NameRequest;
+
+    EOSPlatformContext* _context;
+    CriticalSection _locker;
+    Dictionary<EOS_EpicAccountId, EOSUserInfo> _entries;
+    Dictionary<EOS_EpicAccountId, Array<Batch*>> _pending;
+    Dictionary<String, EOS_EpicAccountId> _names;
+    Array<Batch*> _batches;
+    Array<NameRequest*> _nameRequests;
+
+public:
+    EOSUserInfoCache(EOSPlatformContext* context);
+    ~EOSUserInfoCache();
+
+    /// <summary>
+    /// The time (in seconds) after which the cached user information is queried again.
+    /// </summary>
+    float TimeToLive = 300.0f;
+
+    /// <summary>
+    /// The maximum amount of the cached users. The expired and then the oldest entries are evicted first (with the display names and the external accounts resolved to them).
+    /// </summary>
+    int32 MaxEntries = 1024;
+
+public:
+    /// <summary>
+    /// Gets the cached user information. Doesn't query the missing or expired user.
+    /// </summary>
+    /// <returns>True if the user is cached, otherwise false.</returns>
+    bool TryGet(EOS_EpicAccountId accountId, EOSUserInfo& result);
+
+    /// <summary>
+    /// Resolves the information of the many users at once. The callback gets called with the resolved users (users that failed to resolve are skipped) once all of them are ready. Called immediately if all the users are cached.
+    /// </summary>
+    /// <param name="accountIds">The users to resolve.</param>
+    /// <param name="callback">The callback to call once all the users are resolved. Can be null to just warm-up the cache.</param>
+    void Resolve(const Span<EOS_EpicAccountId>& accountIds, const ResolveCallback& callback);
+
+    /// <summary>
+    /// Resolves the user by the display name.
+    /// </summary>
+    /// <param name="displayName">The user display name.</param>
+    /// <param name="callback">The callback to call once the user is resolved. Gets null if failed.</param>
+    void ResolveByDisplayName(const StringView& displayName, const ResolveUserCallback& callback);
+
+    /// <summary>
+    /// Resolves the user by the linked external account (eg. the Steam account).
+    /// </summary>
+    /// <param name="externalAccountId">The external account id.</param>
+    /// <param name="accountType">The external account type.</param>
+    /// <param name="callback">The callback to call once the user is resolved. Gets null if failed.</param>
+    void ResolveByExternalAccount(const StringView& externalAccountId, EOS_EExternalAccountType accountType, const ResolveUserCallback& callback);
+
+    /// <summary>
+    /// Removes the user from the cache so it gets queried again on the next lookup.
+    /// </summary>
+    void Invalidate(EOS_EpicAccountId accountId);
+
+    /// <summary>
+    /// Removes all the cached users and cancels the pending lookups (without calling their callbacks).
+    /// </summary>
+    void Clear();
+
+private:
+    NameRequest* StartNameRequest(const String& key, const ResolveUserCallback& callback);
+    bool IsValid(const EOSUserInfo& entry, double now) const;
+    bool Store(EOS_EpicAccountId accountId, double now);
+    void CompleteQuery(EOS_EpicAccountId accountId, bool success);
+    void CompleteNameRequest(NameRequest* request, EOS_EpicAccountId accountId, bool success);
+
+    static void EOS_CALL OnQueryUserInfoComplete(const EOS_UserInfo_QueryUserInfoCallbackInfo* data);
+    static void EOS_CALL OnQueryUserInfoByDisplayNameComplete(const EOS_UserInfo_QueryUserInfoByDisplayNameCallbackInfo* data);
+    static void EOS_CALL OnQueryUserInfoByExternalAccountComplete(const EOS_UserInfo_QueryUserInfoByExternalAccountCallbackInfo* data);
+};
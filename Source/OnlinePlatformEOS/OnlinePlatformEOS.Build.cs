@@ -19,6 +19,7 @@ public class OnlinePlatformEOS : GameModule
         options.ScriptingAPI.IgnoreMissingDocumentationWarnings = true;
 
         options.PublicDependencies.Add("Online");
+        options.PublicDependencies.Add("Networking");
         options.PrivateDependencies.Add("EOSSDK");
     }
 }
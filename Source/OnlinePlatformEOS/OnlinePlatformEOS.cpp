@@ -1,4 +1,7 @@
 ﻿#include "OnlinePlatformEOS.h"
+#include "EOSAccountIdTable.h"
+#include "EOSAccountMappings.h"
+#include "EOSUserInfoCache.h"
 
 #include "Engine/Content/Content.h"
 #include "Engine/Content/JsonAsset.h"
@@ -21,115 +24,59 @@
 #include "Engine/Platform/Windows/WindowsWindow.h"
 #include "Engine/Scripting/ManagedCLR/MUtils.h"
 #include "Engine/Threading/JobSystem.h"
+#include "Engine/Threading/Threading.h"
+#include "Engine/Threading/ThreadSpawner.h"
+#include "Engine/Platform/Thread.h"
 #include "EOSSDK/Include/eos_achievements.h"
 #include "EOSSDK/Include/eos_auth.h"
+#include "EOSSDK/Include/eos_connect.h"
+#include "EOSSDK/Include/eos_ecom.h"
 #include "EOSSDK/Include/eos_friends.h"
 #include "EOSSDK/Include/eos_logging.h"
 #include "EOSSDK/Include/eos_presence.h"
+#include "EOSSDK/Include/eos_sanctions.h"
 #include "EOSSDK/Include/eos_stats.h"
+#include "EOSSDK/Include/eos_titlestorage.h"
 #include "EOSSDK/Include/eos_types.h"
 #include "EOSSDK/Include/eos_ui.h"
 #include "EOSSDK/Include/eos_userinfo.h"
 
 IMPLEMENT_GAME_SETTINGS_GETTER(EOSSettings, "EOS");
-EOS_HPlatform OnlinePlatformEOS::_platformInterface = nullptr;
-EOS_HUserInfo OnlinePlatformEOS::_userInfoInterface = nullptr;
-EOS_HPresence OnlinePlatformEOS::_presenceInterface = nullptr;
-EOS_HAuth OnlinePlatformEOS::_authInterface = nullptr;
-EOS_HAchievements OnlinePlatformEOS::_achievementsInterface = nullptr;
-EOS_HStats OnlinePlatformEOS::_statsInterface = nullptr;
-EOS_HFriends OnlinePlatformEOS::_friendsInterface = nullptr;
-EOS_HConnect OnlinePlatformEOS::_connectInterface = nullptr;
-EOS_HLeaderboards OnlinePlatformEOS::_leaderboardsInterface = nullptr;
-EOS_HPlayerDataStorage OnlinePlatformEOS::_playerDataStorageInterface = nullptr;
-EOS_EpicAccountId OnlinePlatformEOS::_accountID = nullptr;
-EOS_ProductUserId OnlinePlatformEOS::_productUserId = nullptr;
-Array<EOS_ProductUserId, HeapAllocation> OnlinePlatformEOS::_productUserIDs;
-Array<OnlineUser, HeapAllocation> OnlinePlatformEOS::_tempFriendsList;
-
-extern "C" void EOS_CALL EOSSDKLogCallback(const EOS_LogMessage* message)
-{
-    switch (message->Level)
-    {
-    case EOS_ELogLevel::EOS_LOG_Fatal:
-        LOG(Fatal, "[EOS] {0}: {1}", String(message->Category), String(message->Message));
-        break;
-    case EOS_ELogLevel::EOS_LOG_Error:
-        LOG(Error, "[EOS] {0}: {1}", String(message->Category), String(message->Message));
-        break;
-    case EOS_ELogLevel::EOS_LOG_Warning:
-        LOG(Warning, "[EOS] {0}: {1}", String(message->Category), String(message->Message));
-        break;
-    case EOS_ELogLevel::EOS_LOG_Info:
-    case EOS_ELogLevel::EOS_LOG_Verbose: 
-    case EOS_ELogLevel::EOS_LOG_VeryVerbose:
-        LOG(Info, "[EOS] {0}: {1}", String(message->Category), String(message->Message));
-        break;
-    default: break;
-    }
-}
-
-extern "C" void* EOS_MEMORY_CALL EOSAllocateMemory(size_t sizeInBytes, size_t alignment)
-{
-    return Allocator::Allocate(sizeInBytes, alignment);
-}
-
-void* Realloc(void* ptr, uint64 newSize, uint64 alignment)
-{
-    if (newSize == 0)
-    {
-        Allocator::Free(ptr);
-        return nullptr;
-    }
-    if (!ptr)
-        return Allocator::Allocate(newSize, alignment);
-    return _aligned_realloc(ptr, newSize, alignment);
-}
-
-
-extern "C" void* EOS_MEMORY_CALL EOSReallocateMemory(void* pointer, size_t sizeInBytes, size_t alignment)
-{
-    return Realloc(pointer, sizeInBytes, alignment);
-}
-
-extern "C" void EOS_MEMORY_CALL EOSReleaseMemory(void* pointer)
-{
-    Allocator::Free(pointer);
-}
 
 void OnlinePlatformEOS::OnConnectLoginComplete(const EOS_Connect_LoginCallbackInfo* data)
 {
+    const auto platform = (OnlinePlatformEOS*)data->ClientData;
     if (data->ResultCode == EOS_EResult::EOS_InvalidUser)
     {
         LOG(Error, "EOS failed to connect login, creating user: {0}", String(EOS_EResult_ToString(data->ResultCode)));
         EOS_Connect_CreateUserOptions options = {};
         options.ApiVersion = EOS_CONNECT_CREATEUSER_API_LATEST;
         options.ContinuanceToken = data->ContinuanceToken;
-        EOS_Connect_CreateUser(_connectInterface, &options, nullptr, &OnlinePlatformEOS::OnConnectCreateUserComplete);
+        EOS_Connect_CreateUser(platform->_context.GetConnect(), &options, platform, &OnlinePlatformEOS::OnConnectCreateUserComplete);
         return;
     }
     if (data->ResultCode != EOS_EResult::EOS_Success)
     {
         LOG(Error, "EOS failed to connect login: {0}", String(EOS_EResult_ToString(data->ResultCode)));
+        platform->EndLoginStep(EOSLoginStep::Connect, data->ResultCode);
         return;
     }
-    _productUserId = data->LocalUserId;
-    
-    QueryAchievementDefinitions();
-    QueryPlayerAchievements();
+    platform->CompleteConnectLogin(data->LocalUserId);
     LOG(Info, "EOS connect login complete");
-    //_productUserIDs.AddUnique(data->LocalUserId);
+    //platform->_context.ProductUserIds.AddUnique(data->LocalUserId);
 }
 
 void OnlinePlatformEOS::OnConnectCreateUserComplete(const EOS_Connect_CreateUserCallbackInfo* data)
 {
+    const auto platform = (OnlinePlatformEOS*)data->ClientData;
     if (data->ResultCode != EOS_EResult::EOS_Success)
     {
         LOG(Error, "EOS failed to create user: {0}", String(EOS_EResult_ToString(data->ResultCode)));
+        platform->EndLoginStep(EOSLoginStep::Connect, data->ResultCode);
         return;
     }
-    _productUserId = data->LocalUserId;
-    //_productUserIDs.AddUnique(data->LocalUserId);
+    platform->CompleteConnectLogin(data->LocalUserId);
+    //platform->_context.ProductUserIds.AddUnique(data->LocalUserId);
 }
 
 void OnlinePlatformEOS::OnCreateDeviceIDComplete(const EOS_Connect_CreateDeviceIdCallbackInfo* data)
@@ -143,6 +90,7 @@ void OnlinePlatformEOS::OnCreateDeviceIDComplete(const EOS_Connect_CreateDeviceI
 
 void OnlinePlatformEOS::OnAuthLoginComplete(const EOS_Auth_LoginCallbackInfo* data)
 {
+    const auto platform = (OnlinePlatformEOS*)data->ClientData;
     if (data->ResultCode == EOS_EResult::EOS_Auth_InvalidToken)
     {
         EOS_Auth_DeletePersistentAuthOptions deleteAuthOptions = {};
@@ -151,14 +99,15 @@ void OnlinePlatformEOS::OnAuthLoginComplete(const EOS_Auth_LoginCallbackInfo* da
         idCopyOptions.ApiVersion = EOS_AUTH_COPYIDTOKEN_API_LATEST;
         idCopyOptions.AccountId = data->LocalUserId;
         EOS_Auth_IdToken* idToken;
-        auto result = EOS_Auth_CopyIdToken(_authInterface, &idCopyOptions, &idToken);
+        auto result = EOS_Auth_CopyIdToken(platform->_context.GetAuth(), &idCopyOptions, &idToken);
         if (result != EOS_EResult::EOS_Success)
         {
-            LOG(Error, "EOS failed connect via auth login: {0}", String(EOS_EResult_ToString(data->ResultCode)));
+            LOG(Error, "EOS failed connect via auth login: {0}", String(EOS_EResult_ToString(result)));
+            platform->EndLoginStep(EOSLoginStep::Auth, result);
             return;
         }
         deleteAuthOptions.RefreshToken = idToken->JsonWebToken;
-        EOS_Auth_DeletePersistentAuth(_authInterface, &deleteAuthOptions, nullptr, nullptr);
+        EOS_Auth_DeletePersistentAuth(platform->_context.GetAuth(), &deleteAuthOptions, nullptr, nullptr);
 
         EOS_Auth_Credentials credentials = {};
         credentials.ApiVersion = EOS_AUTH_CREDENTIALS_API_LATEST;
@@ -171,13 +120,14 @@ void OnlinePlatformEOS::OnAuthLoginComplete(const EOS_Auth_LoginCallbackInfo* da
         LoginOptions.ScopeFlags = EOS_EAuthScopeFlags::EOS_AS_BasicProfile | EOS_EAuthScopeFlags::EOS_AS_FriendsList | EOS_EAuthScopeFlags::EOS_AS_Presence;
         LoginOptions.Credentials = &credentials;
 
-        EOS_Auth_Login(_authInterface, &LoginOptions, nullptr, &OnlinePlatformEOS::OnAuthLoginComplete);
+        EOS_Auth_Login(platform->_context.GetAuth(), &LoginOptions, platform, &OnlinePlatformEOS::OnAuthLoginComplete);
         return;
     }
 
     if (data->ResultCode != EOS_EResult::EOS_Success)
     {
         LOG(Error, "EOS failed to auth login: {0}", String(EOS_EResult_ToString(data->ResultCode)));
+        platform->EndLoginStep(EOSLoginStep::Auth, data->ResultCode);
         return;
     }
     
@@ -190,92 +140,106 @@ void OnlinePlatformEOS::OnAuthLoginComplete(const EOS_Auth_LoginCallbackInfo* da
     idCopyOptions.ApiVersion = EOS_AUTH_COPYIDTOKEN_API_LATEST;
     idCopyOptions.AccountId = data->LocalUserId;
     EOS_Auth_IdToken* idToken;
-    auto result = EOS_Auth_CopyIdToken(_authInterface, &idCopyOptions, &idToken);
+    auto result = EOS_Auth_CopyIdToken(platform->_context.GetAuth(), &idCopyOptions, &idToken);
     if (result != EOS_EResult::EOS_Success)
     {
-        LOG(Error, "EOS failed connect via auth login: {0}", String(EOS_EResult_ToString(data->ResultCode)));
+        LOG(Error, "EOS failed connect via auth login: {0}", String(EOS_EResult_ToString(result)));
+        platform->EndLoginStep(EOSLoginStep::Auth, result);
         return;
     }
+    platform->_context.AccountId = data->LocalUserId;
+
+    // Connect login and the Epic account data queries run concurrently
+    platform->BeginLoginStep(EOSLoginStep::Connect);
     connectCreds.Token = idToken->JsonWebToken;
     connectLoginOptions.Credentials = &connectCreds;
-    EOS_Connect_Login(_connectInterface, &connectLoginOptions, nullptr, &OnlinePlatformEOS::OnConnectLoginComplete);
+    EOS_Connect_Login(platform->_context.GetConnect(), &connectLoginOptions, platform, &OnlinePlatformEOS::OnConnectLoginComplete);
     EOS_Auth_IdToken_Release(idToken);
-    _accountID = data->LocalUserId;
-    QueryFriends();
+    platform->BeginLoginStep(EOSLoginStep::Friends);
+    platform->QueryFriends();
+    platform->BeginLoginStep(EOSLoginStep::Presence);
+    platform->QueryLocalPresence();
+    platform->EndLoginStep(EOSLoginStep::Auth, EOS_EResult::EOS_Success);
     LOG(Info, "EOS auth login complete");
 }
 
-void OnlinePlatformEOS::OnQueryFriendsComplete(const EOS_Friends_QueryFriendsCallbackInfo* data)
+void OnlinePlatformEOS::OnAuthLoginStatusChanged(const EOS_Auth_LoginStatusChangedCallbackInfo* data)
 {
-    if (data->ResultCode != EOS_EResult::EOS_Success)
-    {
-        LOG(Error, "EOS failed to query friends: {0}", String(EOS_EResult_ToString(data->ResultCode)));
+    const auto platform = (OnlinePlatformEOS*)data->ClientData;
+    if (data->LocalUserId != platform->_context.AccountId || data->CurrentStatus != EOS_ELoginStatus::EOS_LS_NotLoggedIn)
         return;
-    }
+    if (platform->_loginState != EOSLoginState::LoggedIn && platform->_loginState != EOSLoginState::Ready)
+        return;
+    LOG(Warning, "EOS auth login expired, logging in again");
+    platform->RefreshAuthLogin();
 }
 
-void OnlinePlatformEOS::OnQueryUserInfoComplete(const EOS_UserInfo_QueryUserInfoCallbackInfo* data)
+void OnlinePlatformEOS::OnAuthRefreshComplete(const EOS_Auth_LoginCallbackInfo* data)
 {
+    const auto platform = (OnlinePlatformEOS*)data->ClientData;
+    platform->_authRefreshInProgress = false;
     if (data->ResultCode != EOS_EResult::EOS_Success)
     {
-        LOG(Error, "EOS failed to query user info: {0}", String(EOS_EResult_ToString(data->ResultCode)));
+        platform->FailAuthRefresh(data->ResultCode);
         return;
     }
+    platform->_context.AccountId = data->LocalUserId;
+    platform->RefreshConnectLogin();
+}
 
-    EOS_UserInfo_CopyUserInfoOptions options = {};
-    options.ApiVersion = EOS_USERINFO_COPYUSERINFO_API_LATEST;
-    options.LocalUserId = data->LocalUserId;
-    options.TargetUserId = data->TargetUserId;
-    EOS_UserInfo* friendInfo;
-    EOS_UserInfo_CopyUserInfo(_userInfoInterface, &options, &friendInfo);
-    OnlineUser friendOnlineUser;
-    friendOnlineUser.Name = String(friendInfo->DisplayName);
-    
-    char epicAccountIdString[EOS_EPICACCOUNTID_MAX_LENGTH + 1];
-    int32 epicAccountIdStringLength;
-    auto result = EOS_EpicAccountId_ToString(friendInfo->UserId, epicAccountIdString, &epicAccountIdStringLength);
-    if (result != EOS_EResult::EOS_Success)
-    {
-        LOG(Error, "EOS failed to convert EpicAccountId to string in query user info: {0}", String(EOS_EResult_ToString(result)));
+void OnlinePlatformEOS::OnConnectLoginStatusChanged(const EOS_Connect_LoginStatusChangedCallbackInfo* data)
+{
+    const auto platform = (OnlinePlatformEOS*)data->ClientData;
+    if (data->LocalUserId != platform->_context.ProductUserId || data->CurrentStatus != EOS_ELoginStatus::EOS_LS_NotLoggedIn)
         return;
-    }
-    Guid::Parse(String(epicAccountIdString), friendOnlineUser.Id);
+    if (platform->_loginState != EOSLoginState::LoggedIn && platform->_loginState != EOSLoginState::Ready)
+        return;
+    LOG(Warning, "EOS connect login expired, logging in again");
+    platform->RefreshConnectLogin();
+}
 
-    auto job = JobSystem::Dispatch([data](auto i)
-    {
-        EOS_Presence_QueryPresenceOptions presenceQueryOptions = {};
-        presenceQueryOptions.ApiVersion = EOS_PRESENCE_QUERYPRESENCE_API_LATEST;
-        presenceQueryOptions.LocalUserId = data->LocalUserId;
-        presenceQueryOptions.TargetUserId = data->TargetUserId;
-        EOS_Presence_QueryPresence(_presenceInterface, &presenceQueryOptions, nullptr, &OnlinePlatformEOS::OnQueryPresenceComplete);
-    });
-    JobSystem::Wait(job);
+void OnlinePlatformEOS::OnConnectAuthExpiration(const EOS_Connect_AuthExpirationCallbackInfo* data)
+{
+    const auto platform = (OnlinePlatformEOS*)data->ClientData;
+    if (data->LocalUserId != platform->_context.ProductUserId)
+        return;
+    LOG(Info, "EOS connect login is about to expire, refreshing");
+    platform->RefreshConnectLogin();
+}
 
-    EOS_Presence_HasPresenceOptions hasPresenceOptions = {};
-    hasPresenceOptions.ApiVersion = EOS_PRESENCE_HASPRESENCE_API_LATEST;
-    hasPresenceOptions.LocalUserId = data->LocalUserId;
-    hasPresenceOptions.TargetUserId = data->TargetUserId;
+void OnlinePlatformEOS::OnConnectRefreshComplete(const EOS_Connect_LoginCallbackInfo* data)
+{
+    const auto platform = (OnlinePlatformEOS*)data->ClientData;
+    platform->_authRefreshInProgress = false;
+    if (data->ResultCode != EOS_EResult::EOS_Success)
+    {
+        platform->FailAuthRefresh(data->ResultCode);
+        return;
+    }
 
-    EOS_Bool hasPresence = EOS_Presence_HasPresence(_presenceInterface, &hasPresenceOptions);
+    // Same user logged in again so all the cached data stays valid
+    platform->_context.ProductUserId = data->LocalUserId;
+    platform->_authRefreshAttempts = 0;
+    platform->_authRefreshRetryTime = 0.0;
+    LOG(Info, "EOS connect login refreshed");
+    platform->_context.EndAuthRefresh();
+}
 
-    if (hasPresence == EOS_TRUE)
+void OnlinePlatformEOS::OnQueryFriendsComplete(const EOS_Friends_QueryFriendsCallbackInfo* data)
+{
+    const auto platform = (OnlinePlatformEOS*)data->ClientData;
+    platform->EndLoginStep(EOSLoginStep::Friends, data->ResultCode);
+    if (data->ResultCode != EOS_EResult::EOS_Success)
     {
-        EOS_Presence_CopyPresenceOptions copyPresenceOptions = {};
-        copyPresenceOptions.ApiVersion = EOS_PRESENCE_COPYPRESENCE_API_LATEST;
-        copyPresenceOptions.LocalUserId = data->LocalUserId;
-        copyPresenceOptions.TargetUserId = data->TargetUserId;
-        EOS_Presence_Info* presenceInfo;
-        EOS_Presence_CopyPresence(_presenceInterface, &copyPresenceOptions, &presenceInfo);
-        friendOnlineUser.PresenceState = ConvertPresenceStatus(presenceInfo->Status);
-        EOS_Presence_Info_Release(presenceInfo);
+        LOG(Error, "EOS failed to query friends: {0}", String(EOS_EResult_ToString(data->ResultCode)));
+        return;
     }
-    
-    _tempFriendsList.Add(friendOnlineUser);
-    EOS_UserInfo_Release(friendInfo);
 }
 
 void OnlinePlatformEOS::OnQueryAchievementDefinitionsComplete(const EOS_Achievements_OnQueryDefinitionsCompleteCallbackInfo* data)
 {
+    const auto platform = (OnlinePlatformEOS*)data->ClientData;
+    platform->EndWarmUp(EOSWarmUpFlags::AchievementDefinitions, platform->_startupTimings.AchievementDefinitions);
     if (data->ResultCode != EOS_EResult::EOS_Success)
     {
         LOG(Error, "EOS failed to query achievement definitions: {0}", String(EOS_EResult_ToString(data->ResultCode)));
@@ -286,6 +250,8 @@ void OnlinePlatformEOS::OnQueryAchievementDefinitionsComplete(const EOS_Achievem
 
 void OnlinePlatformEOS::OnQueryPlayerAchievementsComplete(const EOS_Achievements_OnQueryPlayerAchievementsCompleteCallbackInfo* data)
 {
+    const auto platform = (OnlinePlatformEOS*)data->ClientData;
+    platform->EndLoginStep(EOSLoginStep::Achievements, data->ResultCode);
     if (data->ResultCode != EOS_EResult::EOS_Success)
     {
         LOG(Error, "EOS failed to query player achievements: {0}", String(EOS_EResult_ToString(data->ResultCode)));
@@ -304,10 +270,57 @@ void OnlinePlatformEOS::OnUnlockAchievementsComplete(const EOS_Achievements_OnUn
 
 void OnlinePlatformEOS::OnQueryStatsComplete(const EOS_Stats_OnQueryStatsCompleteCallbackInfo* data)
 {
+    const auto platform = (OnlinePlatformEOS*)data->ClientData;
+    platform->EndLoginStep(EOSLoginStep::Stats, data->ResultCode);
+}
+
+void OnlinePlatformEOS::OnQuerySanctionsComplete(const EOS_Sanctions_QueryActivePlayerSanctionsCallbackInfo* data)
+{
+    const auto platform = (OnlinePlatformEOS*)data->ClientData;
+    platform->EndLoginStep(EOSLoginStep::Sanctions, data->ResultCode);
+    if (data->ResultCode != EOS_EResult::EOS_Success)
+    {
+        LOG(Error, "EOS failed to query sanctions: {0}", String(EOS_EResult_ToString(data->ResultCode)));
+        return;
+    }
+}
+
+void OnlinePlatformEOS::OnIngestStatComplete(const EOS_Stats_IngestStatCompleteCallbackInfo* data)
+{
+    if (data->ResultCode != EOS_EResult::EOS_Success)
+    {
+        LOG(Error, "EOS failed to ingest stat: {0}", String(EOS_EResult_ToString(data->ResultCode)));
+        return;
+    }
+}
+
+void OnlinePlatformEOS::OnWarmUpTitleStorageComplete(const EOS_TitleStorage_QueryFileListCallbackInfo* data)
+{
+    const auto platform = (OnlinePlatformEOS*)data->ClientData;
+    platform->EndWarmUp(EOSWarmUpFlags::TitleStorageManifest, platform->_startupTimings.TitleStorageManifest);
+    if (data->ResultCode != EOS_EResult::EOS_Success)
+    {
+        LOG(Error, "EOS failed to query title storage file list: {0}", String(EOS_EResult_ToString(data->ResultCode)));
+        return;
+    }
+}
+
+void OnlinePlatformEOS::OnWarmUpEntitlementsComplete(const EOS_Ecom_QueryEntitlementsCallbackInfo* data)
+{
+    const auto platform = (OnlinePlatformEOS*)data->ClientData;
+    platform->EndWarmUp(EOSWarmUpFlags::Entitlements, platform->_startupTimings.Entitlements);
+    if (data->ResultCode != EOS_EResult::EOS_Success)
+    {
+        LOG(Error, "EOS failed to query entitlements: {0}", String(EOS_EResult_ToString(data->ResultCode)));
+        return;
+    }
 }
 
 void OnlinePlatformEOS::OnQueryPresenceComplete(const EOS_Presence_QueryPresenceCallbackInfo* data)
 {
+    const auto platform = (OnlinePlatformEOS*)data->ClientData;
+    if (data->LocalUserId == data->TargetUserId)
+        platform->EndLoginStep(EOSLoginStep::Presence, data->ResultCode);
     if (data->ResultCode != EOS_EResult::EOS_Success)
     {
         LOG(Error, "EOS failed to find presence: {0}", String(EOS_EResult_ToString(data->ResultCode)));
@@ -317,6 +330,15 @@ void OnlinePlatformEOS::OnQueryPresenceComplete(const EOS_Presence_QueryPresence
 
 OnlinePlatformEOS::OnlinePlatformEOS(const SpawnParams& params)
     : ScriptingObject(params)
+    , _userInfoCache(&_context)
+    , _accountMappings(&_context)
+    , _sessions(&_context)
+    , _serverBrowser(&_context)
+    , _lobbies(&_context)
+    , _matchmaker(&_context)
+    , _leaderboards(&_context)
+    , _friendsLeaderboard(&_context, &_accountMappings)
+    , _titleStorage(&_context)
 {
 }
 
@@ -328,63 +350,33 @@ bool OnlinePlatformEOS::Initialize()
         LOG(Error, "EOS Settings failed to load.");
         return true;
     }
-    
-    // Initialize EOS
-    EOS_InitializeOptions initOptions = {};
-    initOptions.ApiVersion = EOS_INITIALIZE_API_LATEST;
-    initOptions.Reserved = nullptr;
-    initOptions.ProductName = settings->ProductName.Get();
-    initOptions.ProductVersion = settings->ProductVersion.Get();
-    initOptions.AllocateMemoryFunction = &EOSAllocateMemory;
-    initOptions.ReallocateMemoryFunction = &EOSReallocateMemory;
-    initOptions.ReleaseMemoryFunction = &EOSReleaseMemory;
-    initOptions.SystemInitializeOptions = nullptr;
-    initOptions.OverrideThreadAffinity = nullptr;
-
-    EOS_EResult initResult = EOS_Initialize(&initOptions);
-    if (initResult != EOS_EResult::EOS_Success)
-    {
-        LOG(Error, "EOS init failed. Init result: {0}", String(EOS_EResult_ToString(initResult)));
-        return true;
-    }
-
-    // Set Logging callback
-    EOS_Logging_SetCallback(&EOSSDKLogCallback);
-    SetEOSLogLevel(EOSLogCategory::AllCategories, EOSLogLevel::VeryVerbose); // TODO: disable once released
-    
-    // TODO: put these options in settings in editor
-    EOS_Platform_Options platformOptions = {};
-    platformOptions.ApiVersion = EOS_PLATFORM_OPTIONS_API_LATEST;
-    platformOptions.Reserved = nullptr;
-    platformOptions.ProductId = settings->ProductID.Get();
-    platformOptions.SandboxId = settings->SandboxID.Get();
-    platformOptions.DeploymentId = settings->DeploymentID.Get();
-    platformOptions.ClientCredentials.ClientId = settings->DefaultClientID.Get();
-    platformOptions.ClientCredentials.ClientSecret = settings->DefaultClientSecret.Get();
-    
-    if (Engine::IsHeadless())
-        platformOptions.bIsServer = EOS_TRUE;
-    else
-        platformOptions.bIsServer = EOS_FALSE;
-
-    platformOptions.EncryptionKey = settings->EncryptionKey.IsEmpty() ? "0" : settings->EncryptionKey.Get();
-    platformOptions.OverrideCountryCode = nullptr;
-    platformOptions.OverrideLocaleCode = nullptr;
-    platformOptions.Flags = 0;
-    platformOptions.Flags |= EOS_PF_DISABLE_OVERLAY;
-
-#if USE_EDITOR
-    platformOptions.Flags |= EOS_PF_LOADING_IN_EDITOR | EOS_PF_DISABLE_OVERLAY;
-#endif
-
-    const StringAsANSI<> cacheDirectory(Globals::TemporaryFolder.Get(), Globals::TemporaryFolder.Length());
-    platformOptions.CacheDirectory = cacheDirectory.Get();
-    platformOptions.TickBudgetInMilliseconds = 0;
-    platformOptions.RTCOptions = nullptr;
-    platformOptions.IntegratedPlatformOptionsContainerHandle = nullptr;
 
-    _platformInterface = EOS_Platform_Create(&platformOptions);
-    EOS_Platform_SetApplicationStatus(_platformInterface, EOS_EApplicationStatus::EOS_AS_Foreground);
+    _isServer = settings->Profile == EOSPlatformProfile::Server || (settings->Profile == EOSPlatformProfile::Auto && Engine::IsHeadless());
+    _startupTimings = EOSStartupTimings();
+    _userInfoCache.TimeToLive = settings->UserInfoTimeToLive;
+    _userInfoCache.MaxEntries = settings->UserInfoCacheSize;
+    _accountMappings.TimeToLive = settings->AccountMappingTimeToLive;
+    _sessions.UpdateWindow = settings->SessionUpdateWindow;
+    _sessions.RegistrationWindow = settings->SessionRegistrationWindow;
+    _lobbies.UpdateWindow = settings->LobbyUpdateWindow;
+    _leaderboards.TimeToLive = settings->LeaderboardTimeToLive;
+    _leaderboards.PageSize = settings->LeaderboardPageSize;
+    _friendsLeaderboard.TimeToLive = settings->FriendsLeaderboardTimeToLive;
+    _titleStorage.MaxParallelDownloads = settings->TitleStorageParallelDownloads;
+    Platform::AtomicStore(&_createState, 0);
+
+    // Create platform off the main thread so it doesn't delay the first frame
+    if (settings->CreatePlatformAsync && !_isServer)
+    {
+        _createThread = ThreadSpawner::Start(Function<int32()>(this, &OnlinePlatformEOS::CreatePlatform), TEXT("EOS Startup"));
+        if (_createThread)
+        {
+            Engine::LateUpdate.Bind<OnlinePlatformEOS, &OnlinePlatformEOS::OnUpdate>(this);
+            return false;
+        }
+    }
+    if (CreatePlatform() != 0)
+        return true;
     
 /*
     // Restart with Epic Launcher if not already launched
@@ -396,18 +388,6 @@ bool OnlinePlatformEOS::Initialize()
         return true;
     }
 */
-    _connectInterface = EOS_Platform_GetConnectInterface(_platformInterface);
-    _authInterface = EOS_Platform_GetAuthInterface(_platformInterface);
-    _userInfoInterface = EOS_Platform_GetUserInfoInterface(_platformInterface);
-    _achievementsInterface = EOS_Platform_GetAchievementsInterface(_platformInterface);
-    _statsInterface = EOS_Platform_GetStatsInterface(_platformInterface);
-    _friendsInterface = EOS_Platform_GetFriendsInterface(_platformInterface);
-    _leaderboardsInterface = EOS_Platform_GetLeaderboardsInterface(_platformInterface);
-    _playerDataStorageInterface = EOS_Platform_GetPlayerDataStorageInterface(_platformInterface);
-    _presenceInterface = EOS_Platform_GetPresenceInterface(_platformInterface);
-    
-    _productUserIDs.Clear();
-    _tempFriendsList.Clear();
     
     /*
     // Create Device ID
@@ -416,7 +396,7 @@ bool OnlinePlatformEOS::Initialize()
     auto deviceIdentifier = String::Format(TEXT("{0} {1} {2}"), ScriptingEnum::ToString<PlatformType>(Platform::GetPlatformType()), Platform::GetComputerName(), Platform::GetUniqueDeviceId().ToString());
     const StringAsANSI<> deviceID(deviceIdentifier.Get(), deviceIdentifier.Length());
     deviceIDOptions.DeviceModel =  deviceID.Get();
-    EOS_Connect_CreateDeviceId(_connectInterface, &deviceIDOptions, nullptr, &OnlinePlatformEOS::OnCreateDeviceIDComplete);
+    EOS_Connect_CreateDeviceId(_context.GetConnect(), &deviceIDOptions, this, &OnlinePlatformEOS::OnCreateDeviceIDComplete);
     
     // Initial login with device
     EOS_Connect_LoginOptions connectLoginOptions = {};
@@ -432,9 +412,22 @@ bool OnlinePlatformEOS::Initialize()
     const StringAsANSI<> displayName(Platform::GetComputerName().Get(), Platform::GetComputerName().Length());
     userLoginInfo.DisplayName = "Tom";//displayName.Get();
     connectLoginOptions.UserLoginInfo = &userLoginInfo;
-    EOS_Connect_Login(_connectInterface, &connectLoginOptions, nullptr, &OnlinePlatformEOS::OnConnectLoginComplete);
+    EOS_Connect_Login(_context.GetConnect(), &connectLoginOptions, this, &OnlinePlatformEOS::OnConnectLoginComplete);
     */
     
+    // Dedicated server ticks at the fixed low rate on the service thread
+    if (_isServer)
+    {
+        if (_context.StartServiceThread(settings->ServerTickRate))
+        {
+            _context.Release();
+            EOSPlatformContext::ShutdownSDK();
+            Platform::AtomicStore(&_createState, 0);
+            return true;
+        }
+        return false;
+    }
+
     //TODO: hook into changing EOS network status on game network status change
     Engine::LateUpdate.Bind<OnlinePlatformEOS, &OnlinePlatformEOS::OnUpdate>(this);
     return false;
@@ -443,23 +436,58 @@ bool OnlinePlatformEOS::Initialize()
 void OnlinePlatformEOS::Deinitialize()
 {
     Engine::LateUpdate.Unbind<OnlinePlatformEOS, &OnlinePlatformEOS::OnUpdate>(this);
-    _productUserIDs.Clear();
-    _userInfoInterface = nullptr;
-    _authInterface = nullptr;
-    _achievementsInterface = nullptr;
-    _statsInterface = nullptr;
-    _friendsInterface = nullptr;
-    _connectInterface = nullptr;
-    _leaderboardsInterface = nullptr;
-    _playerDataStorageInterface = nullptr;
-    _presenceInterface = nullptr;
-    EOS_Platform_Release(_platformInterface);
-    _platformInterface = nullptr;
-    EOS_Shutdown();
+    if (_createThread)
+    {
+        _createThread->Join();
+        Delete(_createThread);
+        _createThread = nullptr;
+    }
+
+    // Stop the service thread first, so no tick can deliver callbacks into the services being cleared
+    _context.StopServiceThread();
+    _userInfoCache.Clear();
+    _accountMappings.Clear();
+    _sessions.Clear();
+    _serverBrowser.Clear();
+    _lobbies.Clear();
+    _matchmaker.Clear();
+    _leaderboards.Clear();
+    _friendsLeaderboard.Clear();
+    _titleStorage.Clear();
+    if (Platform::AtomicRead(&_createState) == 1)
+    {
+        RemoveLoginNotifications();
+        _context.Release();
+        EOSPlatformContext::ShutdownSDK();
+    }
+    Platform::AtomicStore(&_createState, 0);
+    _loginState = EOSLoginState::LoggedOut;
+    _loginPending = 0;
+    _hasPendingLogin = false;
+    _pendingLoginUser = nullptr;
+    _warmUpPending = EOSWarmUpFlags::None;
+    _authRefreshInProgress = false;
+    _authRefreshAttempts = 0;
+    _authRefreshRetryTime = 0.0;
 }
 
 bool OnlinePlatformEOS::UserLogin(User* localUser)
 {
+    if (_isServer)
+    {
+        LOG(Warning, "EOS user login is not supported with the server profile (client credentials only).");
+        return true;
+    }
+    if (Platform::AtomicRead(&_createState) == 0)
+    {
+        // Platform is still being created, login once it's ready
+        _hasPendingLogin = true;
+        _pendingLoginUser = localUser;
+        return false;
+    }
+    if (_loginState == EOSLoginState::LoggingIn || _loginState == EOSLoginState::LoggedIn || _loginState == EOSLoginState::Ready)
+        return false;
+    BeginLogin();
 
     // Let Epic Launcher pass auth
     if (!Engine::GetCommandLine().IsEmpty())
@@ -499,7 +527,7 @@ bool OnlinePlatformEOS::UserLogin(User* localUser)
             LoginOptions.ScopeFlags = EOS_EAuthScopeFlags::EOS_AS_BasicProfile | EOS_EAuthScopeFlags::EOS_AS_FriendsList | EOS_EAuthScopeFlags::EOS_AS_Presence;
             LoginOptions.Credentials = &Credentials;
 
-            EOS_Auth_Login(_authInterface, &LoginOptions, nullptr, &OnlinePlatformEOS::OnAuthLoginComplete);
+            EOS_Auth_Login(_context.GetAuth(), &LoginOptions, this, &OnlinePlatformEOS::OnAuthLoginComplete);
             return false;
         }
     }
@@ -526,7 +554,7 @@ bool OnlinePlatformEOS::UserLogin(User* localUser)
     LoginOptions.ScopeFlags = EOS_EAuthScopeFlags::EOS_AS_BasicProfile | EOS_EAuthScopeFlags::EOS_AS_FriendsList | EOS_EAuthScopeFlags::EOS_AS_Presence;
     LoginOptions.Credentials = &credentials;
 
-    EOS_Auth_Login(_authInterface, &LoginOptions, nullptr, &OnlinePlatformEOS::OnAuthLoginComplete);
+    EOS_Auth_Login(_context.GetAuth(), &LoginOptions, this, &OnlinePlatformEOS::OnAuthLoginComplete);
 
     return false;
 }
@@ -538,49 +566,59 @@ bool OnlinePlatformEOS::UserLogout(User* localUser)
 
 bool OnlinePlatformEOS::GetUserLoggedIn(User* localUser)
 {
-    return false;
+    if (_loginState != EOSLoginState::LoggedIn && _loginState != EOSLoginState::Ready)
+        return false;
+    return EOS_Auth_GetLoginStatus(_context.GetAuth(), _context.AccountId) == EOS_ELoginStatus::EOS_LS_LoggedIn &&
+           EOS_Connect_GetLoginStatus(_context.GetConnect(), _context.ProductUserId) == EOS_ELoginStatus::EOS_LS_LoggedIn;
 }
 
 bool OnlinePlatformEOS::GetUser(OnlineUser& user, User* localUser)
 {
+    if (!_context.AccountId)
+        return true;
+    user.Id = EOSAccountIdTable::GetId(_context.AccountId);
     return false;
 }
 
 bool OnlinePlatformEOS::GetFriends(Array<OnlineUser, HeapAllocation>& friends, User* localUser)
 {
-    if (!_platformInterface || !_accountID)
+    if (!_context.Platform || !_context.AccountId)
     {
         LOG(Error, "EOS Get Friends Failed");
         return false;
     }
 
-    _tempFriendsList.Clear();
     QueryFriends();
     EOS_Friends_GetFriendsCountOptions countOptions = {};
     countOptions.ApiVersion = EOS_FRIENDS_GETFRIENDSCOUNT_API_LATEST;
-    countOptions.LocalUserId = _accountID;
-    auto friendsCount = EOS_Friends_GetFriendsCount(_friendsInterface, &countOptions);
+    countOptions.LocalUserId = _context.AccountId;
+    const auto friendsHandle = _context.GetFriends();
+    auto friendsCount = EOS_Friends_GetFriendsCount(friendsHandle, &countOptions);
+    Array<EOS_EpicAccountId, InlinedAllocation<64>> friendIds;
+    friendIds.Resize(friendsCount);
     for (int i = 0; i < friendsCount; i++)
     {
-        auto job = JobSystem::Dispatch([i](auto x)
-        {
-            EOS_Friends_GetFriendAtIndexOptions indexOptions = {};
-            indexOptions.ApiVersion = EOS_FRIENDS_GETFRIENDATINDEX_API_LATEST;
-            indexOptions.Index = i;
-            indexOptions.LocalUserId = _accountID;
-            auto friendsAccount = EOS_Friends_GetFriendAtIndex(_friendsInterface, &indexOptions);
-            
-            EOS_UserInfo_QueryUserInfoOptions queryUserOptions = {};
-            queryUserOptions.ApiVersion = EOS_USERINFO_QUERYUSERINFO_API_LATEST;
-            queryUserOptions.LocalUserId = _accountID;
-            queryUserOptions.TargetUserId = friendsAccount;
-            EOS_UserInfo_QueryUserInfo(_userInfoInterface, &queryUserOptions, nullptr, &OnlinePlatformEOS::OnQueryUserInfoComplete);
-        });
-        JobSystem::Wait(job);
+        EOS_Friends_GetFriendAtIndexOptions indexOptions = {};
+        indexOptions.ApiVersion = EOS_FRIENDS_GETFRIENDATINDEX_API_LATEST;
+        indexOptions.Index = i;
+        indexOptions.LocalUserId = _context.AccountId;
+        friendIds[i] = EOS_Friends_GetFriendAtIndex(friendsHandle, &indexOptions);
+    }
+
+    // Names come from the user info cache, the missing ones are resolved in a single pass and show up on the next call
+    _userInfoCache.Resolve(ToSpan(friendIds), EOSUserInfoCache::ResolveCallback());
+    friends.Clear();
+    friends.EnsureCapacity(friendsCount);
+    for (const EOS_EpicAccountId friendId : friendIds)
+    {
+        OnlineUser& friendOnlineUser = friends.AddOne();
+        friendOnlineUser.Id = EOSAccountIdTable::GetId(friendId);
+        EOSUserInfo info;
+        if (_userInfoCache.TryGet(friendId, info))
+            friendOnlineUser.Name = info.DisplayName;
+        friendOnlineUser.PresenceState = GetPresenceState(friendId);
     }
     LOG(Info, "EOS query friends complete. Friends found: {0}", friendsCount);
-    friends = _tempFriendsList;
-    _tempFriendsList.Clear();
     if (friendsCount > 0 && friends.Count() > 0)
     {
         return true;
@@ -588,9 +626,38 @@ bool OnlinePlatformEOS::GetFriends(Array<OnlineUser, HeapAllocation>& friends, U
     return false;
 }
 
+OnlinePresenceStates OnlinePlatformEOS::GetPresenceState(EOS_EpicAccountId accountId)
+{
+    const auto presence = _context.GetPresence();
+    EOS_Presence_HasPresenceOptions hasPresenceOptions = {};
+    hasPresenceOptions.ApiVersion = EOS_PRESENCE_HASPRESENCE_API_LATEST;
+    hasPresenceOptions.LocalUserId = _context.AccountId;
+    hasPresenceOptions.TargetUserId = accountId;
+    if (EOS_Presence_HasPresence(presence, &hasPresenceOptions) != EOS_TRUE)
+    {
+        EOS_Presence_QueryPresenceOptions presenceQueryOptions = {};
+        presenceQueryOptions.ApiVersion = EOS_PRESENCE_QUERYPRESENCE_API_LATEST;
+        presenceQueryOptions.LocalUserId = _context.AccountId;
+        presenceQueryOptions.TargetUserId = accountId;
+        EOS_Presence_QueryPresence(presence, &presenceQueryOptions, this, &OnlinePlatformEOS::OnQueryPresenceComplete);
+        return OnlinePresenceStates::Offline;
+    }
+
+    EOS_Presence_CopyPresenceOptions copyPresenceOptions = {};
+    copyPresenceOptions.ApiVersion = EOS_PRESENCE_COPYPRESENCE_API_LATEST;
+    copyPresenceOptions.LocalUserId = _context.AccountId;
+    copyPresenceOptions.TargetUserId = accountId;
+    EOS_Presence_Info* presenceInfo;
+    if (EOS_Presence_CopyPresence(presence, &copyPresenceOptions, &presenceInfo) != EOS_EResult::EOS_Success)
+        return OnlinePresenceStates::Offline;
+    const OnlinePresenceStates state = ConvertPresenceStatus(presenceInfo->Status);
+    EOS_Presence_Info_Release(presenceInfo);
+    return state;
+}
+
 bool OnlinePlatformEOS::GetAchievements(Array<OnlineAchievement, HeapAllocation>& achievements, User* localUser)
 {
-    if (!_platformInterface || !_productUserId)
+    if (!_context.Platform || !_context.ProductUserId)
         return false;
     
     // Query achievement definitions
@@ -601,24 +668,24 @@ bool OnlinePlatformEOS::GetAchievements(Array<OnlineAchievement, HeapAllocation>
     
     EOS_Achievements_GetPlayerAchievementCountOptions options = {};
     options.ApiVersion = EOS_ACHIEVEMENTS_GETPLAYERACHIEVEMENTCOUNT_API_LATEST;
-    options.UserId = _productUserId;
-    uint32 count = EOS_Achievements_GetPlayerAchievementCount(_achievementsInterface, &options);
+    options.UserId = _context.ProductUserId;
+    uint32 count = EOS_Achievements_GetPlayerAchievementCount(_context.GetAchievements(), &options);
     
     for (uint32 i = 0; i < count; i++)
     {
         EOS_Achievements_CopyPlayerAchievementByIndexOptions copyOptions = {};
         copyOptions.ApiVersion = EOS_ACHIEVEMENTS_COPYPLAYERACHIEVEMENTBYINDEX_API_LATEST;
         copyOptions.AchievementIndex = i;
-        copyOptions.LocalUserId = _productUserId;
-        copyOptions.TargetUserId = _productUserId;
+        copyOptions.LocalUserId = _context.ProductUserId;
+        copyOptions.TargetUserId = _context.ProductUserId;
         EOS_Achievements_PlayerAchievement* eosAchievement = {};
-        EOS_Achievements_CopyPlayerAchievementByIndex(_achievementsInterface, &copyOptions, &eosAchievement);
+        EOS_Achievements_CopyPlayerAchievementByIndex(_context.GetAchievements(), &copyOptions, &eosAchievement);
 
         EOS_Achievements_CopyAchievementDefinitionV2ByAchievementIdOptions copyDefinitionOptions = {};
         copyDefinitionOptions.ApiVersion = EOS_ACHIEVEMENTS_COPYACHIEVEMENTDEFINITIONV2BYACHIEVEMENTID_API_LATEST;
         copyDefinitionOptions.AchievementId = eosAchievement->AchievementId;
         EOS_Achievements_DefinitionV2* definition;
-        EOS_Achievements_CopyAchievementDefinitionV2ByAchievementId(_achievementsInterface, &copyDefinitionOptions, &definition);
+        EOS_Achievements_CopyAchievementDefinitionV2ByAchievementId(_context.GetAchievements(), &copyDefinitionOptions, &definition);
         
         OnlineAchievement achievement;
         achievement.Name = String(eosAchievement->DisplayName);
@@ -643,14 +710,18 @@ bool OnlinePlatformEOS::GetAchievements(Array<OnlineAchievement, HeapAllocation>
 
 bool OnlinePlatformEOS::UnlockAchievement(const StringView& name, User* localUser)
 {
-    EOS_Achievements_UnlockAchievementsOptions options = {};
-    options.ApiVersion = EOS_ACHIEVEMENTS_UNLOCKACHIEVEMENTS_API_LATEST;
-    options.UserId = _productUserId;
-    const StringAsANSI<> charName(name.Get(), name.Length());
-    const char* ids[1] = {charName.Get()};
-    options.AchievementIds = ids;
-    options.AchievementsCount = 1;
-    EOS_Achievements_UnlockAchievements(_achievementsInterface, &options, nullptr, &OnlinePlatformEOS::OnUnlockAchievementsComplete);
+    String achievementName(name);
+    _context.RunAuthenticated([this, achievementName]
+    {
+        EOS_Achievements_UnlockAchievementsOptions options = {};
+        options.ApiVersion = EOS_ACHIEVEMENTS_UNLOCKACHIEVEMENTS_API_LATEST;
+        options.UserId = _context.ProductUserId;
+        const StringAsANSI<> charName(achievementName.Get(), achievementName.Length());
+        const char* ids[1] = {charName.Get()};
+        options.AchievementIds = ids;
+        options.AchievementsCount = 1;
+        EOS_Achievements_UnlockAchievements(_context.GetAchievements(), &options, this, &OnlinePlatformEOS::OnUnlockAchievementsComplete);
+    });
     
     return false;
 }
@@ -702,26 +773,47 @@ void OnlinePlatformEOS::SetEOSLogLevel(EOSLogCategory logCategory, EOSLogLevel l
 
 void OnlinePlatformEOS::CheckApplicationStatus()
 {
-    if (!_platformInterface || Engine::ShouldExit())
+    if (!_context.Platform || _isServer || !Engine::MainWindow || Engine::ShouldExit())
         return;
 
-    auto status = EOS_Platform_GetApplicationStatus(_platformInterface);
+    auto status = EOS_Platform_GetApplicationStatus(_context.Platform);
     if (Engine::MainWindow->IsForegroundWindow() && status != EOS_EApplicationStatus::EOS_AS_Foreground)
     {
-        EOS_Platform_SetApplicationStatus(_platformInterface, EOS_EApplicationStatus::EOS_AS_Foreground);
+        EOS_Platform_SetApplicationStatus(_context.Platform, EOS_EApplicationStatus::EOS_AS_Foreground);
     }
     else if (Time::GetGamePaused() && !Engine::HasFocus && status != EOS_EApplicationStatus::EOS_AS_BackgroundSuspended)
     {
-        EOS_Platform_SetApplicationStatus(_platformInterface, EOS_EApplicationStatus::EOS_AS_BackgroundSuspended);
+        EOS_Platform_SetApplicationStatus(_context.Platform, EOS_EApplicationStatus::EOS_AS_BackgroundSuspended);
     }
     /*
     else if (!Engine::HasFocus && status != EOS_EApplicationStatus::EOS_AS_BackgroundConstrained)
     {
-        EOS_Platform_SetApplicationStatus(_platformInterface, EOS_EApplicationStatus::EOS_AS_BackgroundConstrained);
+        EOS_Platform_SetApplicationStatus(_context.Platform, EOS_EApplicationStatus::EOS_AS_BackgroundConstrained);
     }
     */
 }
 
+bool OnlinePlatformEOS::IngestPlayerStat(const StringView& name, int32 amount, EOS_ProductUserId player)
+{
+    if (!_context.GetStats() || !player)
+        return true;
+    const StringAsANSI<> statName(name.Get(), name.Length());
+    EOS_Stats_IngestData ingestData = {};
+    ingestData.ApiVersion = EOS_STATS_INGESTDATA_API_LATEST;
+    ingestData.StatName = statName.Get();
+    ingestData.IngestAmount = amount;
+
+    EOS_Stats_IngestStatOptions options = {};
+    options.ApiVersion = EOS_STATS_INGESTSTAT_API_LATEST;
+    options.LocalUserId = _isServer ? nullptr : _context.ProductUserId;
+    options.TargetUserId = player;
+    options.Stats = &ingestData;
+    options.StatsCount = 1;
+    ScopeLock lock(_context.Locker);
+    EOS_Stats_IngestStat(_context.GetStats(), &options, this, &OnlinePlatformEOS::OnIngestStatComplete);
+    return false;
+}
+
 bool OnlinePlatformEOS::RequestCurrentStats()
 {
     return false;
@@ -729,60 +821,406 @@ bool OnlinePlatformEOS::RequestCurrentStats()
 
 void OnlinePlatformEOS::OnUpdate()
 {
-    EOS_Platform_Tick(_platformInterface);
+    if (_createThread)
+    {
+        const int64 createState = Platform::AtomicRead(&_createState);
+        if (createState == 0)
+            return;
+        _createThread->Join();
+        Delete(_createThread);
+        _createThread = nullptr;
+        if (createState != 1)
+        {
+            Engine::LateUpdate.Unbind<OnlinePlatformEOS, &OnlinePlatformEOS::OnUpdate>(this);
+            return;
+        }
+        if (_hasPendingLogin)
+        {
+            _hasPendingLogin = false;
+            UserLogin(_pendingLoginUser);
+        }
+    }
+
+    if (_authRefreshRetryTime > 0.0 && Platform::GetTimeSeconds() >= _authRefreshRetryTime)
+    {
+        _authRefreshRetryTime = 0.0;
+        RefreshConnectLogin();
+    }
+
+    _context.Tick();
     CheckApplicationStatus();
 }
 
+int32 OnlinePlatformEOS::CreatePlatform()
+{
+    const auto settings = EOSSettings::Get();
+    double startTime = Platform::GetTimeSeconds();
+    if (!settings || EOSPlatformContext::InitializeSDK(*settings))
+    {
+        Platform::AtomicStore(&_createState, 2);
+        return 1;
+    }
+    _startupTimings.SDKInitialize = (float)((Platform::GetTimeSeconds() - startTime) * 1000.0);
+
+    startTime = Platform::GetTimeSeconds();
+    EOSPlatformContextOptions options;
+    options.IsServer = _isServer;
+    if (_context.Create(*settings, options))
+    {
+        EOSPlatformContext::ShutdownSDK();
+        Platform::AtomicStore(&_createState, 2);
+        return 1;
+    }
+    _startupTimings.PlatformCreate = (float)((Platform::GetTimeSeconds() - startTime) * 1000.0);
+    LOG(Info, "EOS platform created. SDK init: {0}ms, platform create: {1}ms", _startupTimings.SDKInitialize, _startupTimings.PlatformCreate);
+
+    Platform::AtomicStore(&_createState, 1);
+    return 0;
+}
+
+void OnlinePlatformEOS::StartWarmUp()
+{
+    const auto settings = EOSSettings::Get();
+    const EOSWarmUpFlags warmUp = settings ? settings->WarmUp : EOSWarmUpFlags::None;
+    if (warmUp == EOSWarmUpFlags::None)
+        return;
+    BeginLoginStep(EOSLoginStep::WarmUp);
+    _warmUpPending = warmUp;
+    _warmUpStartTime = Platform::GetTimeSeconds();
+
+    // All queries are issued at once and complete in parallel
+    if (EnumHasAnyFlags(warmUp, EOSWarmUpFlags::AchievementDefinitions))
+    {
+        QueryAchievementDefinitions();
+    }
+    if (EnumHasAnyFlags(warmUp, EOSWarmUpFlags::TitleStorageManifest))
+    {
+        Array<const char*, InlinedAllocation<16>> tags;
+        for (const auto& tag : settings->TitleStorageWarmUpTags)
+            tags.Add(tag.Get());
+        if (tags.HasItems() && _context.GetTitleStorage())
+        {
+            EOS_TitleStorage_QueryFileListOptions options = {};
+            options.ApiVersion = EOS_TITLESTORAGE_QUERYFILELIST_API_LATEST;
+            options.LocalUserId = _context.ProductUserId;
+            options.ListOfTags = tags.Get();
+            options.ListOfTagsCount = tags.Count();
+            EOS_TitleStorage_QueryFileList(_context.GetTitleStorage(), &options, this, &OnlinePlatformEOS::OnWarmUpTitleStorageComplete);
+        }
+        else
+        {
+            EndWarmUp(EOSWarmUpFlags::TitleStorageManifest, _startupTimings.TitleStorageManifest);
+        }
+    }
+    if (EnumHasAnyFlags(warmUp, EOSWarmUpFlags::Entitlements))
+    {
+        if (_context.AccountId && _context.GetEcom())
+        {
+            EOS_Ecom_QueryEntitlementsOptions options = {};
+            options.ApiVersion = EOS_ECOM_QUERYENTITLEMENTS_API_LATEST;
+            options.LocalUserId = _context.AccountId;
+            options.EntitlementNames = nullptr;
+            options.EntitlementNameCount = 0;
+            options.bIncludeRedeemed = EOS_FALSE;
+            EOS_Ecom_QueryEntitlements(_context.GetEcom(), &options, this, &OnlinePlatformEOS::OnWarmUpEntitlementsComplete);
+        }
+        else
+        {
+            EndWarmUp(EOSWarmUpFlags::Entitlements, _startupTimings.Entitlements);
+        }
+    }
+}
+
+void OnlinePlatformEOS::EndWarmUp(EOSWarmUpFlags item, float& timing)
+{
+    if (!EnumHasAnyFlags(_warmUpPending, item))
+        return;
+    _warmUpPending &= ~item;
+    timing = (float)((Platform::GetTimeSeconds() - _warmUpStartTime) * 1000.0);
+    if (_warmUpPending == EOSWarmUpFlags::None)
+    {
+        _startupTimings.WarmUp = timing;
+        LOG(Info, "EOS warm-up complete in {0}ms. Achievement definitions: {1}ms, title storage manifest: {2}ms, entitlements: {3}ms",
+            _startupTimings.WarmUp, _startupTimings.AchievementDefinitions, _startupTimings.TitleStorageManifest, _startupTimings.Entitlements);
+        EndLoginStep(EOSLoginStep::WarmUp, EOS_EResult::EOS_Success);
+    }
+}
+
+EOSLoginTimings OnlinePlatformEOS::GetLoginTimings() const
+{
+    EOSLoginTimings timings;
+    timings.Steps.Set(_loginStepTimings, (int32)EOSLoginStep::MAX);
+    timings.Total = _loginTotalTime;
+    return timings;
+}
+
+void OnlinePlatformEOS::BeginLogin()
+{
+    _loginState = EOSLoginState::LoggingIn;
+    _loginPending = 0;
+    _loginStartTime = Platform::GetTimeSeconds();
+    _loginTotalTime = 0.0f;
+    Platform::MemoryClear(_loginStepTimings, sizeof(_loginStepTimings));
+    BeginLoginStep(EOSLoginStep::Auth);
+}
+
+void OnlinePlatformEOS::BeginLoginStep(EOSLoginStep step)
+{
+    if (_loginState == EOSLoginState::LoggingIn || _loginState == EOSLoginState::LoggedIn)
+        _loginPending |= 1u << (uint32)step;
+}
+
+void OnlinePlatformEOS::EndLoginStep(EOSLoginStep step, EOS_EResult result)
+{
+    const uint32 stepMask = 1u << (uint32)step;
+    if ((_loginPending & stepMask) == 0)
+        return;
+    _loginPending &= ~stepMask;
+    _loginStepTimings[(int32)step] = (float)((Platform::GetTimeSeconds() - _loginStartTime) * 1000.0);
+    if (result != EOS_EResult::EOS_Success)
+    {
+        LOG(Warning, "EOS login step {0} failed: {1}", String(ScriptingEnum::ToString(step)), String(EOS_EResult_ToString(result)));
+        if (step == EOSLoginStep::Auth || step == EOSLoginStep::Connect)
+        {
+            FailLogin();
+            return;
+        }
+    }
+    if (step == EOSLoginStep::Connect)
+        _loginState = EOSLoginState::LoggedIn;
+
+    if (_loginState == EOSLoginState::LoggedIn && _loginPending == 0)
+    {
+        _loginState = EOSLoginState::Ready;
+        _loginTotalTime = (float)((Platform::GetTimeSeconds() - _loginStartTime) * 1000.0);
+        const EOSLoginTimings timings = GetLoginTimings();
+        LOG(Info, "EOS user ready in {0}ms", _loginTotalTime);
+        UserReady(timings);
+    }
+}
+
+void OnlinePlatformEOS::FailLogin()
+{
+    _loginState = EOSLoginState::Failed;
+    _loginPending = 0;
+    _authRefreshRetryTime = 0.0;
+    if (_context.IsRefreshingAuth())
+        _context.EndAuthRefresh(false);
+    UserLoginFailed();
+}
+
+void OnlinePlatformEOS::CompleteConnectLogin(EOS_ProductUserId userId)
+{
+    _context.ProductUserId = userId;
+    AddLoginNotifications();
+
+    // Per-user data queries run concurrently
+    BeginLoginStep(EOSLoginStep::Achievements);
+    QueryPlayerAchievements();
+    BeginLoginStep(EOSLoginStep::Stats);
+    QueryAllStats();
+    BeginLoginStep(EOSLoginStep::Sanctions);
+    QuerySanctions();
+    StartWarmUp();
+    EndLoginStep(EOSLoginStep::Connect, EOS_EResult::EOS_Success);
+}
+
+void OnlinePlatformEOS::AddLoginNotifications()
+{
+    if (_authLoginStatusId == EOS_INVALID_NOTIFICATIONID && _context.GetAuth())
+    {
+        EOS_Auth_AddNotifyLoginStatusChangedOptions options = {};
+        options.ApiVersion = EOS_AUTH_ADDNOTIFYLOGINSTATUSCHANGED_API_LATEST;
+        _authLoginStatusId = EOS_Auth_AddNotifyLoginStatusChanged(_context.GetAuth(), &options, this, &OnlinePlatformEOS::OnAuthLoginStatusChanged);
+    }
+    if (_connectLoginStatusId == EOS_INVALID_NOTIFICATIONID)
+    {
+        EOS_Connect_AddNotifyLoginStatusChangedOptions options = {};
+        options.ApiVersion = EOS_CONNECT_ADDNOTIFYLOGINSTATUSCHANGED_API_LATEST;
+        _connectLoginStatusId = EOS_Connect_AddNotifyLoginStatusChanged(_context.GetConnect(), &options, this, &OnlinePlatformEOS::OnConnectLoginStatusChanged);
+    }
+    if (_connectAuthExpirationId == EOS_INVALID_NOTIFICATIONID)
+    {
+        EOS_Connect_AddNotifyAuthExpirationOptions options = {};
+        options.ApiVersion = EOS_CONNECT_ADDNOTIFYAUTHEXPIRATION_API_LATEST;
+        _connectAuthExpirationId = EOS_Connect_AddNotifyAuthExpiration(_context.GetConnect(), &options, this, &OnlinePlatformEOS::OnConnectAuthExpiration);
+    }
+}
+
+void OnlinePlatformEOS::RemoveLoginNotifications()
+{
+    if (_authLoginStatusId != EOS_INVALID_NOTIFICATIONID)
+    {
+        EOS_Auth_RemoveNotifyLoginStatusChanged(_context.GetAuth(), _authLoginStatusId);
+        _authLoginStatusId = EOS_INVALID_NOTIFICATIONID;
+    }
+    if (_connectLoginStatusId != EOS_INVALID_NOTIFICATIONID)
+    {
+        EOS_Connect_RemoveNotifyLoginStatusChanged(_context.GetConnect(), _connectLoginStatusId);
+        _connectLoginStatusId = EOS_INVALID_NOTIFICATIONID;
+    }
+    if (_connectAuthExpirationId != EOS_INVALID_NOTIFICATIONID)
+    {
+        EOS_Connect_RemoveNotifyAuthExpiration(_context.GetConnect(), _connectAuthExpirationId);
+        _connectAuthExpirationId = EOS_INVALID_NOTIFICATIONID;
+    }
+}
+
+void OnlinePlatformEOS::RefreshAuthLogin()
+{
+    if (_authRefreshInProgress)
+        return;
+    _context.BeginAuthRefresh();
+    _authRefreshInProgress = true;
+
+    // Silent login with the refresh token stored by the SDK
+    EOS_Auth_Credentials credentials = {};
+    credentials.ApiVersion = EOS_AUTH_CREDENTIALS_API_LATEST;
+    credentials.Type = EOS_ELoginCredentialType::EOS_LCT_PersistentAuth;
+    credentials.Id = nullptr;
+    credentials.Token = nullptr;
+
+    EOS_Auth_LoginOptions loginOptions = {};
+    loginOptions.ApiVersion = EOS_AUTH_LOGIN_API_LATEST;
+    loginOptions.ScopeFlags = EOS_EAuthScopeFlags::EOS_AS_BasicProfile | EOS_EAuthScopeFlags::EOS_AS_FriendsList | EOS_EAuthScopeFlags::EOS_AS_Presence;
+    loginOptions.Credentials = &credentials;
+    EOS_Auth_Login(_context.GetAuth(), &loginOptions, this, &OnlinePlatformEOS::OnAuthRefreshComplete);
+}
+
+void OnlinePlatformEOS::RefreshConnectLogin()
+{
+    if (_authRefreshInProgress)
+        return;
+    _context.BeginAuthRefresh();
+    _authRefreshRetryTime = 0.0;
+
+    // Connect login needs a fresh Epic ID token, the Auth login gets refreshed by the SDK on its own unless it has expired too
+    EOS_Auth_CopyIdTokenOptions idCopyOptions = {};
+    idCopyOptions.ApiVersion = EOS_AUTH_COPYIDTOKEN_API_LATEST;
+    idCopyOptions.AccountId = _context.AccountId;
+    EOS_Auth_IdToken* idToken;
+    if (EOS_Auth_CopyIdToken(_context.GetAuth(), &idCopyOptions, &idToken) != EOS_EResult::EOS_Success)
+    {
+        RefreshAuthLogin();
+        return;
+    }
+    _authRefreshInProgress = true;
+
+    EOS_Connect_Credentials connectCreds = {};
+    connectCreds.ApiVersion = EOS_CONNECT_CREDENTIALS_API_LATEST;
+    connectCreds.Type = EOS_EExternalCredentialType::EOS_ECT_EPIC_ID_TOKEN;
+    connectCreds.Token = idToken->JsonWebToken;
+    EOS_Connect_LoginOptions connectLoginOptions = {};
+    connectLoginOptions.ApiVersion = EOS_CONNECT_LOGIN_API_LATEST;
+    connectLoginOptions.Credentials = &connectCreds;
+    EOS_Connect_Login(_context.GetConnect(), &connectLoginOptions, this, &OnlinePlatformEOS::OnConnectRefreshComplete);
+    EOS_Auth_IdToken_Release(idToken);
+}
+
+void OnlinePlatformEOS::FailAuthRefresh(EOS_EResult result)
+{
+    const auto settings = EOSSettings::Get();
+    const int32 maxAttempts = settings ? settings->AuthRefreshAttempts : 5;
+    const float retryDelay = settings ? settings->AuthRefreshRetryDelay : 5.0f;
+    _authRefreshAttempts++;
+    if (_authRefreshAttempts >= maxAttempts)
+    {
+        LOG(Error, "EOS failed to refresh the user login: {0}", String(EOS_EResult_ToString(result)));
+        _authRefreshAttempts = 0;
+        FailLogin();
+        return;
+    }
+
+    // Keep the requests queued and retry later
+    LOG(Warning, "EOS failed to refresh the user login (attempt {0}): {1}", _authRefreshAttempts, String(EOS_EResult_ToString(result)));
+    _authRefreshRetryTime = Platform::GetTimeSeconds() + retryDelay * (float)_authRefreshAttempts;
+}
+
 void OnlinePlatformEOS::QueryAchievementDefinitions()
 {
-    auto job = JobSystem::Dispatch([](auto i)
+    _context.RunAuthenticated([this]
     {
-        EOS_Achievements_QueryDefinitionsOptions queryOptions = {};
-        queryOptions.ApiVersion = EOS_ACHIEVEMENTS_QUERYDEFINITIONS_API_LATEST;
-        queryOptions.LocalUserId = _productUserId;
-        queryOptions.HiddenAchievementIds_DEPRECATED = nullptr;
-        queryOptions.HiddenAchievementsCount_DEPRECATED = 0;
-        EOS_Achievements_QueryDefinitions(_achievementsInterface, &queryOptions, nullptr, &OnlinePlatformEOS::OnQueryAchievementDefinitionsComplete);
+        // Interface is acquired on the calling thread since the lazy getter may need the context lock
+        const auto achievements = _context.GetAchievements();
+        auto job = JobSystem::Dispatch([this, achievements](auto i)
+        {
+            EOS_Achievements_QueryDefinitionsOptions queryOptions = {};
+            queryOptions.ApiVersion = EOS_ACHIEVEMENTS_QUERYDEFINITIONS_API_LATEST;
+            queryOptions.LocalUserId = _context.ProductUserId;
+            queryOptions.HiddenAchievementIds_DEPRECATED = nullptr;
+            queryOptions.HiddenAchievementsCount_DEPRECATED = 0;
+            EOS_Achievements_QueryDefinitions(achievements, &queryOptions, this, &OnlinePlatformEOS::OnQueryAchievementDefinitionsComplete);
+        });
+        JobSystem::Wait(job);
     });
-    JobSystem::Wait(job);
 }
 
 void OnlinePlatformEOS::QueryPlayerAchievements()
 {
-    auto job = JobSystem::Dispatch([](auto i)
+    _context.RunAuthenticated([this]
     {
-        EOS_Achievements_QueryPlayerAchievementsOptions queryOptions = {};
-        queryOptions.ApiVersion = EOS_ACHIEVEMENTS_QUERYPLAYERACHIEVEMENTS_API_LATEST;
-        queryOptions.LocalUserId = _productUserId;
-        queryOptions.TargetUserId = _productUserId;
-        EOS_Achievements_QueryPlayerAchievements(_achievementsInterface, &queryOptions, nullptr, &OnlinePlatformEOS::OnQueryPlayerAchievementsComplete);
+        const auto achievements = _context.GetAchievements();
+        auto job = JobSystem::Dispatch([this, achievements](auto i)
+        {
+            EOS_Achievements_QueryPlayerAchievementsOptions queryOptions = {};
+            queryOptions.ApiVersion = EOS_ACHIEVEMENTS_QUERYPLAYERACHIEVEMENTS_API_LATEST;
+            queryOptions.LocalUserId = _context.ProductUserId;
+            queryOptions.TargetUserId = _context.ProductUserId;
+            EOS_Achievements_QueryPlayerAchievements(achievements, &queryOptions, this, &OnlinePlatformEOS::OnQueryPlayerAchievementsComplete);
+        });
+        JobSystem::Wait(job);
     });
-    JobSystem::Wait(job);
 }
 
 void OnlinePlatformEOS::QueryFriends()
 {
-    auto job = JobSystem::Dispatch([](auto i)
+    const auto friends = _context.GetFriends();
+    auto job = JobSystem::Dispatch([this, friends](auto i)
     {
         EOS_Friends_QueryFriendsOptions queryOptions = {};
         queryOptions.ApiVersion = EOS_FRIENDS_QUERYFRIENDS_API_LATEST;
-        queryOptions.LocalUserId = _accountID;
-        EOS_Friends_QueryFriends(_friendsInterface, &queryOptions, nullptr, &OnlinePlatformEOS::OnQueryFriendsComplete);
+        queryOptions.LocalUserId = _context.AccountId;
+        EOS_Friends_QueryFriends(friends, &queryOptions, this, &OnlinePlatformEOS::OnQueryFriendsComplete);
     });
     JobSystem::Wait(job);
 }
 
 void OnlinePlatformEOS::QueryAllStats()
 {
-    auto job = JobSystem::Dispatch([](auto i)
+    _context.RunAuthenticated([this]
     {
-        EOS_Stats_QueryStatsOptions queryOptions = {};
-        queryOptions.ApiVersion = EOS_STATS_QUERYSTATS_API_LATEST;
-        queryOptions.LocalUserId = _productUserId;
-        queryOptions.TargetUserId = _productUserId;
-        EOS_Stats_QueryStats(_statsInterface, &queryOptions, nullptr, &OnlinePlatformEOS::OnQueryStatsComplete);
+        const auto stats = _context.GetStats();
+        auto job = JobSystem::Dispatch([this, stats](auto i)
+        {
+            EOS_Stats_QueryStatsOptions queryOptions = {};
+            queryOptions.ApiVersion = EOS_STATS_QUERYSTATS_API_LATEST;
+            queryOptions.LocalUserId = _context.ProductUserId;
+            queryOptions.TargetUserId = _context.ProductUserId;
+            EOS_Stats_QueryStats(stats, &queryOptions, this, &OnlinePlatformEOS::OnQueryStatsComplete);
+        });
+        JobSystem::Wait(job);
     });
-    JobSystem::Wait(job);
+}
+
+void OnlinePlatformEOS::QuerySanctions()
+{
+    _context.RunAuthenticated([this]
+    {
+        EOS_Sanctions_QueryActivePlayerSanctionsOptions queryOptions = {};
+        queryOptions.ApiVersion = EOS_SANCTIONS_QUERYACTIVEPLAYERSANCTIONS_API_LATEST;
+        queryOptions.LocalUserId = _context.ProductUserId;
+        queryOptions.TargetUserId = _context.ProductUserId;
+        EOS_Sanctions_QueryActivePlayerSanctions(_context.GetSanctions(), &queryOptions, this, &OnlinePlatformEOS::OnQuerySanctionsComplete);
+    });
+}
+
+void OnlinePlatformEOS::QueryLocalPresence()
+{
+    EOS_Presence_QueryPresenceOptions queryOptions = {};
+    queryOptions.ApiVersion = EOS_PRESENCE_QUERYPRESENCE_API_LATEST;
+    queryOptions.LocalUserId = _context.AccountId;
+    queryOptions.TargetUserId = _context.AccountId;
+    EOS_Presence_QueryPresence(_context.GetPresence(), &queryOptions, this, &OnlinePlatformEOS::OnQueryPresenceComplete);
 }
 
 OnlinePresenceStates OnlinePlatformEOS::ConvertPresenceStatus(EOS_Presence_EStatus status)
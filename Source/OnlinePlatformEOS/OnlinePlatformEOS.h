@@ -1,20 +1,37 @@
 ﻿#pragma once
 
 #include "Engine/Core/Collections/Array.h"
+#include "Engine/Core/Delegate.h"
 #include "Engine/Core/Config/Settings.h"
+#include "Engine/Core/Types/BaseTypes.h"
 #include "Engine/Online/IOnlinePlatform.h"
 #include "Engine/Scripting/ScriptingObject.h"
+#include "EOSAccountMappings.h"
+#include "EOSLobbies.h"
+#include "EOSMatchmaker.h"
+#include "EOSLeaderboards.h"
+#include "EOSFriendsLeaderboard.h"
+#include "EOSTitleStorage.h"
+#include "EOSPlatformContext.h"
+#include "EOSServerBrowser.h"
+#include "EOSSessions.h"
+#include "EOSUserInfoCache.h"
 #include "EOSSDK/Include/eos_achievements_types.h"
 #include "EOSSDK/Include/eos_auth_types.h"
 #include "EOSSDK/Include/eos_connect_types.h"
+#include "EOSSDK/Include/eos_ecom_types.h"
 #include "EOSSDK/Include/eos_friends_types.h"
 #include "EOSSDK/Include/eos_leaderboards_types.h"
 #include "EOSSDK/Include/eos_playerdatastorage_types.h"
 #include "EOSSDK/Include/eos_presence_types.h"
+#include "EOSSDK/Include/eos_sanctions_types.h"
 #include "EOSSDK/Include/eos_stats_types.h"
+#include "EOSSDK/Include/eos_titlestorage_types.h"
 #include "EOSSDK/Include/eos_types.h"
 #include "EOSSDK/Include/eos_userinfo_types.h"
 
+class Thread;
+
 ///<summary>
 /// Logging Categories
 ///</summary>
@@ -104,6 +121,127 @@ API_ENUM() enum class EOSLogLevel
 	VeryVerbose = 600
 };
 
+///<summary>
+/// The EOS platform profile.
+///</summary>
+API_ENUM() enum class EOSPlatformProfile
+{
+	/** Server profile when running headless, otherwise client profile */
+	Auto = 0,
+	/** Game client with the user login and social services */
+	Client = 1,
+	/** Dedicated server using client credentials only, with the server-side services ticked on a service thread */
+	Server = 2,
+};
+
+///<summary>
+/// The data queried in parallel as soon as the user login completes.
+///</summary>
+API_ENUM(Attributes="System.Flags") enum class EOSWarmUpFlags
+{
+	None = 0,
+	/** Achievement definitions */
+	AchievementDefinitions = 1 << 0,
+	/** Title Storage file list for the configured tags */
+	TitleStorageManifest = 1 << 1,
+	/** Ecom entitlements of the user */
+	Entitlements = 1 << 2,
+
+	All = AchievementDefinitions | TitleStorageManifest | Entitlements,
+};
+
+DECLARE_ENUM_OPERATORS(EOSWarmUpFlags);
+
+/// <summary>
+/// The timings of the EOS startup phases (in milliseconds).
+/// </summary>
+API_STRUCT(NoDefault, Namespace="FlaxEngine.Online.EOS") struct ONLINEPLATFORMEOS_API EOSStartupTimings
+{
+	DECLARE_SCRIPTING_TYPE_MINIMAL(EOSStartupTimings);
+
+	/// <summary>
+	/// The EOS SDK initialization time.
+	/// </summary>
+	API_FIELD() float SDKInitialize = 0.0f;
+
+	/// <summary>
+	/// The EOS platform creation time.
+	/// </summary>
+	API_FIELD() float PlatformCreate = 0.0f;
+
+	/// <summary>
+	/// The achievement definitions warm-up query time.
+	/// </summary>
+	API_FIELD() float AchievementDefinitions = 0.0f;
+
+	/// <summary>
+	/// The Title Storage manifest warm-up query time.
+	/// </summary>
+	API_FIELD() float TitleStorageManifest = 0.0f;
+
+	/// <summary>
+	/// The entitlements warm-up query time.
+	/// </summary>
+	API_FIELD() float Entitlements = 0.0f;
+
+	/// <summary>
+	/// The total warm-up time (all the warm-up queries run in parallel).
+	/// </summary>
+	API_FIELD() float WarmUp = 0.0f;
+};
+
+///<summary>
+/// The steps of the user login pipeline. Friends and presence start right after the Auth login, achievements, stats, sanctions and the warm-up set (eg. entitlements) right after the Connect login.
+///</summary>
+API_ENUM() enum class EOSLoginStep
+{
+	Auth = 0,
+	Connect,
+	Friends,
+	Presence,
+	Achievements,
+	Stats,
+	Sanctions,
+	WarmUp,
+
+	MAX
+};
+
+///<summary>
+/// The state of the user login.
+///</summary>
+API_ENUM() enum class EOSLoginState
+{
+	/** User is not logged in */
+	LoggedOut = 0,
+	/** Auth or Connect login is in progress */
+	LoggingIn,
+	/** User is logged in (Auth and Connect), per-user data is still being queried */
+	LoggedIn,
+	/** User is logged in and all the per-user data has been queried */
+	Ready,
+	/** Login failed */
+	Failed,
+};
+
+/// <summary>
+/// The timings of the user login pipeline steps (in milliseconds since the login start, 0 if not completed).
+/// </summary>
+API_STRUCT(NoDefault, Namespace="FlaxEngine.Online.EOS") struct ONLINEPLATFORMEOS_API EOSLoginTimings
+{
+	DECLARE_SCRIPTING_TYPE_MINIMAL(EOSLoginTimings);
+
+	/// <summary>
+	/// The completion time of every login step (indexed by EOSLoginStep).
+	/// </summary>
+	API_FIELD() Array<float> Steps;
+
+	/// <summary>
+	/// The time from the login start until the user got ready.
+	/// </summary>
+	API_FIELD() float Total = 0.0f;
+};
+
 /// <summary>
 /// The settings for EOS online platform.
 /// </summary>
@@ -122,6 +260,96 @@ public:
 	API_FIELD() StringAnsi DefaultClientID;
 	API_FIELD() StringAnsi DefaultClientSecret;
 	API_FIELD() StringAnsi EncryptionKey;
+
+	/// <summary>
+	/// The platform profile to use.
+	/// </summary>
+	API_FIELD() EOSPlatformProfile Profile = EOSPlatformProfile::Auto;
+
+	/// <summary>
+	/// The amount of platform ticks per second on the service thread used by the server profile.
+	/// </summary>
+	API_FIELD() float ServerTickRate = 10.0f;
+
+	/// <summary>
+	/// The EOS SDK log level used for all the categories.
+	/// </summary>
+	API_FIELD() EOSLogLevel LogLevel = EOSLogLevel::Warning;
+
+	/// <summary>
+	/// If checked, the EOS platform gets created on a background thread so it doesn't delay the first frame. User login requested meanwhile is deferred.
+	/// </summary>
+	API_FIELD() bool CreatePlatformAsync = true;
+
+	/// <summary>
+	/// The data to query in parallel as soon as the user login completes.
+	/// </summary>
+	API_FIELD() EOSWarmUpFlags WarmUp = EOSWarmUpFlags::AchievementDefinitions;
+
+	/// <summary>
+	/// The Title Storage tags used by the Title Storage manifest warm-up.
+	/// </summary>
+	API_FIELD() Array<StringAnsi> TitleStorageWarmUpTags;
+
+	/// <summary>
+	/// The amount of attempts to refresh the expiring user login before the user gets logged out.
+	/// </summary>
+	API_FIELD() int32 AuthRefreshAttempts = 5;
+
+	/// <summary>
+	/// The delay (in seconds) before retrying the failed user login refresh. Grows with every failed attempt.
+	/// </summary>
+	API_FIELD() float AuthRefreshRetryDelay = 5.0f;
+
+	/// <summary>
+	/// The time (in seconds) after which the cached user information (eg. display name) gets queried again.
+	/// </summary>
+	API_FIELD() float UserInfoTimeToLive = 300.0f;
+
+	/// <summary>
+	/// The maximum amount of users in the user information cache.
+	/// </summary>
+	API_FIELD() int32 UserInfoCacheSize = 1024;
+
+	/// <summary>
+	/// The time (in seconds) after which the cached product user and external account mappings get queried again.
+	/// </summary>
+	API_FIELD() float AccountMappingTimeToLive = 600.0f;
+
+	/// <summary>
+	/// The time (in seconds) the session attribute and setting changes are coalesced for before the session gets updated.
+	/// </summary>
+	API_FIELD() float SessionUpdateWindow = 1.0f;
+
+	/// <summary>
+	/// The time (in seconds) the player joins and leaves queued on the dedicated server are batched for before they get registered with the session.
+	/// </summary>
+	API_FIELD() float SessionRegistrationWindow = 0.2f;
+
+	/// <summary>
+	/// The time (in seconds) the lobby and member attribute changes are coalesced for before the lobby gets updated.
+	/// </summary>
+	API_FIELD() float LobbyUpdateWindow = 0.5f;
+
+	/// <summary>
+	/// The time (in seconds) after which the cached leaderboard ranks get queried again.
+	/// </summary>
+	API_FIELD() float LeaderboardTimeToLive = 60.0f;
+
+	/// <summary>
+	/// The amount of the records in the leaderboard page.
+	/// </summary>
+	API_FIELD() int32 LeaderboardPageSize = 25;
+
+	/// <summary>
+	/// The time (in seconds) after which the friends leaderboard refresh queries the scores of the user again.
+	/// </summary>
+	API_FIELD() float FriendsLeaderboardTimeToLive = 120.0f;
+
+	/// <summary>
+	/// The maximum amount of the Title Storage files downloaded at once.
+	/// </summary>
+	API_FIELD() int32 TitleStorageParallelDownloads = 4;
 };
 
 ///<summary>
@@ -131,20 +359,35 @@ API_CLASS(Sealed, Namespace="FlaxEngine.Online.EOS") class ONLINEPLATFORMEOS_API
 {
     DECLARE_SCRIPTING_TYPE(OnlinePlatformEOS);
 private:
-	static EOS_HPlatform _platformInterface;
-	static EOS_HUserInfo _userInfoInterface;
-	static EOS_HPresence _presenceInterface;
-	static EOS_HAuth _authInterface;
-	static EOS_HAchievements _achievementsInterface;
-	static EOS_HStats _statsInterface;
-	static EOS_HFriends _friendsInterface;
-	static EOS_HConnect _connectInterface;
-	static EOS_HLeaderboards _leaderboardsInterface;
-	static EOS_HPlayerDataStorage _playerDataStorageInterface;
-    static Array<EOS_ProductUserId, HeapAllocation> _productUserIDs;
-	static EOS_ProductUserId _productUserId;
-	static EOS_EpicAccountId _accountID;
-	static Array<OnlineUser, HeapAllocation> _tempFriendsList;
+	EOSPlatformContext _context;
+	EOSUserInfoCache _userInfoCache;
+	EOSAccountMappings _accountMappings;
+	EOSSessions _sessions;
+	EOSServerBrowser _serverBrowser;
+	EOSLobbies _lobbies;
+	EOSMatchmaker _matchmaker;
+	EOSLeaderboards _leaderboards;
+	EOSFriendsLeaderboard _friendsLeaderboard;
+	EOSTitleStorage _titleStorage;
+	bool _isServer = false;
+	Thread* _createThread = nullptr;
+	volatile int64 _createState = 0;
+	bool _hasPendingLogin = false;
+	User* _pendingLoginUser = nullptr;
+	EOSStartupTimings _startupTimings;
+	EOSWarmUpFlags _warmUpPending = EOSWarmUpFlags::None;
+	double _warmUpStartTime = 0.0;
+	EOSLoginState _loginState = EOSLoginState::LoggedOut;
+	uint32 _loginPending = 0;
+	double _loginStartTime = 0.0;
+	float _loginStepTimings[(int32)EOSLoginStep::MAX] = {};
+	float _loginTotalTime = 0.0f;
+	EOS_NotificationId _authLoginStatusId = EOS_INVALID_NOTIFICATIONID;
+	EOS_NotificationId _connectLoginStatusId = EOS_INVALID_NOTIFICATIONID;
+	EOS_NotificationId _connectAuthExpirationId = EOS_INVALID_NOTIFICATIONID;
+	bool _authRefreshInProgress = false;
+	int32 _authRefreshAttempts = 0;
+	double _authRefreshRetryTime = 0.0;
 	
 public:
     // [IOnlinePlatform]
@@ -168,13 +411,157 @@ public:
     API_FUNCTION() void SetEOSLogLevel(EOSLogCategory logCategory, EOSLogLevel logLevel);
 	void CheckApplicationStatus();
 
+	/// <summary>
+	/// Returns true if the platform runs with the dedicated server profile.
+	/// </summary>
+	API_PROPERTY() bool IsServer() const
+	{
+		return _isServer;
+	}
+
+	/// <summary>
+	/// Event called when the user login pipeline completes (user is logged in and all the per-user data has been queried).
+	/// </summary>
+	API_EVENT() Delegate<const EOSLoginTimings&> UserReady;
+
+	/// <summary>
+	/// Event called when the user login fails.
+	/// </summary>
+	API_EVENT() Action UserLoginFailed;
+
+	/// <summary>
+	/// Gets the current state of the user login.
+	/// </summary>
+	API_PROPERTY() EOSLoginState GetLoginState() const
+	{
+		return _loginState;
+	}
+
+	/// <summary>
+	/// Gets the timings of the user login pipeline steps.
+	/// </summary>
+	API_PROPERTY() EOSLoginTimings GetLoginTimings() const;
+
+	/// <summary>
+	/// Gets the timings of the EOS startup phases.
+	/// </summary>
+	API_PROPERTY() const EOSStartupTimings& GetStartupTimings() const
+	{
+		return _startupTimings;
+	}
+
+	/// <summary>
+	/// Ingests the stat on behalf of the player (dedicated server only).
+	/// </summary>
+	/// <param name="name">The stat name.</param>
+	/// <param name="amount">The amount to ingest.</param>
+	/// <param name="player">The player to ingest the stat for.</param>
+	/// <returns>True if failed, otherwise false.</returns>
+	bool IngestPlayerStat(const StringView& name, int32 amount, EOS_ProductUserId player);
+
+	/// <summary>
+	/// Gets the EOS platform context used by this online platform.
+	/// </summary>
+	FORCE_INLINE EOSPlatformContext& GetContext()
+	{
+		return _context;
+	}
+
+	/// <summary>
+	/// Gets the cache of the Epic account user information (display names etc.) used by friends, scoreboards, lobbies or chat.
+	/// </summary>
+	FORCE_INLINE EOSUserInfoCache& GetUserInfoCache()
+	{
+		return _userInfoCache;
+	}
+
+	/// <summary>
+	/// Gets the service that resolves the identities of the product users (eg. players joining the session) and the product users of the external accounts.
+	/// </summary>
+	FORCE_INLINE EOSAccountMappings& GetAccountMappings()
+	{
+		return _accountMappings;
+	}
+
+	/// <summary>
+	/// Gets the sessions of the local user (or the dedicated server).
+	/// </summary>
+	FORCE_INLINE EOSSessions& GetSessions()
+	{
+		return _sessions;
+	}
+
+	/// <summary>
+	/// Gets the server browser (session search with the client-side filtering and sorting).
+	/// </summary>
+	FORCE_INLINE EOSServerBrowser& GetServerBrowser()
+	{
+		return _serverBrowser;
+	}
+
+	/// <summary>
+	/// Gets the lobbies of the local user (with the local mirror of the lobby and member attributes).
+	/// </summary>
+	FORCE_INLINE EOSLobbies& GetLobbies()
+	{
+		return _lobbies;
+	}
+
+	/// <summary>
+	/// Gets the matchmaker (parallel lobby or session searches across the buckets with the scored results).
+	/// </summary>
+	FORCE_INLINE EOSMatchmaker& GetMatchmaker()
+	{
+		return _matchmaker;
+	}
+
+	/// <summary>
+	/// Gets the leaderboards (definitions and the paged rank windows cached with the time-to-live).
+	/// </summary>
+	FORCE_INLINE EOSLeaderboards& GetLeaderboards()
+	{
+		return _leaderboards;
+	}
+
+	/// <summary>
+	/// Gets the friends leaderboard (scores of the local user and the friends for the multiple stats, queried in batches).
+	/// </summary>
+	FORCE_INLINE EOSFriendsLeaderboard& GetFriendsLeaderboard()
+	{
+		return _friendsLeaderboard;
+	}
+
+	/// <summary>
+	/// Gets the Title Storage content service (files downloaded in parallel and cached on disk).
+	/// </summary>
+	FORCE_INLINE EOSTitleStorage& GetTitleStorage()
+	{
+		return _titleStorage;
+	}
+
 private:
     bool RequestCurrentStats();
     void OnUpdate();
-	static void QueryAchievementDefinitions();
-	static void QueryPlayerAchievements();
-	static void QueryFriends();
-	static void QueryAllStats();
+	int32 CreatePlatform();
+	void StartWarmUp();
+	void EndWarmUp(EOSWarmUpFlags item, float& timing);
+	void BeginLogin();
+	void BeginLoginStep(EOSLoginStep step);
+	void EndLoginStep(EOSLoginStep step, EOS_EResult result);
+	void FailLogin();
+	void CompleteConnectLogin(EOS_ProductUserId userId);
+	void AddLoginNotifications();
+	void RemoveLoginNotifications();
+	void RefreshAuthLogin();
+	void RefreshConnectLogin();
+	void FailAuthRefresh(EOS_EResult result);
+	void QuerySanctions();
+	void QueryLocalPresence();
+	void QueryAchievementDefinitions();
+	void QueryPlayerAchievements();
+	void QueryFriends();
+	void QueryAllStats();
+	OnlinePresenceStates GetPresenceState(EOS_EpicAccountId accountId);
 	static OnlinePresenceStates ConvertPresenceStatus(EOS_Presence_EStatus status);
 
 	// Callbacks
@@ -182,11 +569,19 @@ private:
 	static void EOS_CALL OnConnectCreateUserComplete(const EOS_Connect_CreateUserCallbackInfo* data);
 	static void EOS_CALL OnCreateDeviceIDComplete(const EOS_Connect_CreateDeviceIdCallbackInfo* data);
 	static void EOS_CALL OnAuthLoginComplete(const EOS_Auth_LoginCallbackInfo* data);
+	static void EOS_CALL OnAuthLoginStatusChanged(const EOS_Auth_LoginStatusChangedCallbackInfo* data);
+	static void EOS_CALL OnAuthRefreshComplete(const EOS_Auth_LoginCallbackInfo* data);
+	static void EOS_CALL OnConnectLoginStatusChanged(const EOS_Connect_LoginStatusChangedCallbackInfo* data);
+	static void EOS_CALL OnConnectAuthExpiration(const EOS_Connect_AuthExpirationCallbackInfo* data);
+	static void EOS_CALL OnConnectRefreshComplete(const EOS_Connect_LoginCallbackInfo* data);
 	static void EOS_CALL OnQueryFriendsComplete(const EOS_Friends_QueryFriendsCallbackInfo* data);
-	static void EOS_CALL OnQueryUserInfoComplete(const EOS_UserInfo_QueryUserInfoCallbackInfo* data);
 	static void EOS_CALL OnQueryAchievementDefinitionsComplete(const EOS_Achievements_OnQueryDefinitionsCompleteCallbackInfo* data);
 	static void EOS_CALL OnQueryPlayerAchievementsComplete(const EOS_Achievements_OnQueryPlayerAchievementsCompleteCallbackInfo* data);
 	static void EOS_CALL OnUnlockAchievementsComplete(const EOS_Achievements_OnUnlockAchievementsCompleteCallbackInfo* data);
 	static void EOS_CALL OnQueryStatsComplete(const EOS_Stats_OnQueryStatsCompleteCallbackInfo* data);
+	static void EOS_CALL OnIngestStatComplete(const EOS_Stats_IngestStatCompleteCallbackInfo* data);
+	static void EOS_CALL OnQuerySanctionsComplete(const EOS_Sanctions_QueryActivePlayerSanctionsCallbackInfo* data);
+	static void EOS_CALL OnWarmUpTitleStorageComplete(const EOS_TitleStorage_QueryFileListCallbackInfo* data);
+	static void EOS_CALL OnWarmUpEntitlementsComplete(const EOS_Ecom_QueryEntitlementsCallbackInfo* data);
 	static void EOS_CALL OnQueryPresenceComplete(const EOS_Presence_QueryPresenceCallbackInfo* data);
 };